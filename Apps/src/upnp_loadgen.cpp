@@ -0,0 +1,442 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Loopback load generator for a UPnP device and its control points.
+ *
+ * The program registers the sample TV device with the descriptions from
+ * Sample/web and a control point in the same process. Both communicate over
+ * the given local network interface or address. The loopback interface isn't
+ * supported by UpnpInit2(), but with a global IPv6 address of the local host,
+ * e.g. "-i 2001:db8::2", no traffic leaves the host. Concurrent control point
+ * workers then drive the device in consecutive phases, each for a given time:
+ *
+ * - **search**: SSDP M-SEARCH for the device UDN, latency up to the first
+ *   search result.
+ * - **action**: SOAP action PowerOn, latency of UpnpSendAction().
+ * - **event**: GENA subscriptions with events sent by the device to all
+ *   subscribers, latency from UpnpNotify() up to the event callback.
+ * - **description**: Download of the device description document, latency of
+ *   UpnpDownloadXmlDoc().
+ *
+ * Throughput and the p50, p99 and p999 latencies are reported for each phase.
+ */
+
+#include <upnp.hpp>
+#include <UpnpActionRequest.hpp>
+#include <UpnpDiscovery.hpp>
+#include <UpnpEvent.hpp>
+#include <UpnpSubscriptionRequest.hpp>
+
+/// \cond
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+/// \endcond
+
+namespace {
+
+constexpr char TV_UDN[]{"uuid:Upnp-TVEmulator-1_0-1234567890001"};
+constexpr char TV_SERVICE_TYPE[]{"urn:schemas-upnp-org:service:tvcontrol:1"};
+constexpr char TV_SERVICE_ID[]{"urn:upnp-org:serviceId:tvcontrol1"};
+constexpr char TV_CONTROL_PATH[]{"/upnp/control/tvcontrol1"};
+constexpr char TV_EVENT_PATH[]{"/upnp/event/tvcontrol1"};
+constexpr char TV_DESC_DOC[]{"tvdevicedesc.xml"};
+
+/// \brief Options from the command line.
+struct Options {
+    const char* iface{""};
+    const char* web_dir{"./Sample/web"};
+    const char* phase{"all"};
+    int seconds{5};
+    int workers{4};
+    int subscriptions{16};
+};
+
+UpnpDevice_Handle device_handle{-1};
+UpnpClient_Handle client_handle{-1};
+std::string base_url;
+
+using Clock = std::chrono::steady_clock;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+
+/*!
+ * \brief Collects latency samples of one phase and reports them.
+ */
+class CLatency {
+  public:
+    void add(int64_t a_ns) {
+        std::scoped_lock lock(m_mutex);
+        m_samples.push_back(a_ns);
+    }
+
+    void error() { m_errors++; }
+
+    void report(const char* a_phase, int a_seconds) {
+        std::scoped_lock lock(m_mutex);
+        std::sort(m_samples.begin(), m_samples.end());
+        const size_t count{m_samples.size()};
+        printf("%-12s %9zu ok %6lu err %10.1f/s", a_phase, count,
+               m_errors.load(), static_cast<double>(count) / a_seconds);
+        if (count > 0)
+            printf("  p50 %8.3f  p99 %8.3f  p999 %8.3f ms",
+                   this->percentile(0.5), this->percentile(0.99),
+                   this->percentile(0.999));
+        printf("\n");
+        m_samples.clear();
+        m_errors = 0;
+    }
+
+  private:
+    double percentile(double a_p) const {
+        size_t idx = static_cast<size_t>(a_p * (double)m_samples.size());
+        idx = std::min(idx, m_samples.size() - 1);
+        return static_cast<double>(m_samples[idx]) / 1e6;
+    }
+
+    std::mutex m_mutex;
+    std::vector<int64_t> m_samples;
+    std::atomic<unsigned long> m_errors{};
+};
+
+CLatency latency;
+
+/*!
+ * \brief A search request of one worker waiting for its first result.
+ */
+struct SearchWait {
+    std::mutex mutex;
+    std::condition_variable cond;
+    int64_t start{};
+    bool waiting{false};
+};
+
+// Number of events sent and received in the event phase.
+std::atomic<int64_t> events_sent{};
+std::atomic<int64_t> events_received{};
+
+
+/*!
+ * \brief Callback of the device.
+ */
+int device_callback(Upnp_EventType a_type, const void* a_event, void*) {
+    switch (a_type) {
+    case UPNP_EVENT_SUBSCRIPTION_REQUEST: {
+        auto sr = static_cast<const UpnpSubscriptionRequest*>(a_event);
+        const char* name[]{"Power"};
+        const char* value[]{"0"};
+        UpnpAcceptSubscription(device_handle,
+                               UpnpSubscriptionRequest_get_UDN_cstr(sr),
+                               UpnpSubscriptionRequest_get_ServiceId_cstr(sr),
+                               name, value, 1,
+                               UpnpSubscriptionRequest_get_SID_cstr(sr));
+    } break;
+
+    case UPNP_CONTROL_ACTION_REQUEST: {
+        auto ar = static_cast<UpnpActionRequest*>(
+            const_cast<void*>(a_event));
+        char response[256];
+        snprintf(response, sizeof(response),
+                 "<u:%sResponse xmlns:u=\"%s\">"
+                 "<Power>1</Power></u:%sResponse>",
+                 UpnpActionRequest_get_ActionName_cstr(ar), TV_SERVICE_TYPE,
+                 UpnpActionRequest_get_ActionName_cstr(ar));
+        UpnpActionRequest_set_ErrCode(ar, UPNP_E_SUCCESS);
+        UpnpActionRequest_set_ActionResult(ar, ixmlParseBuffer(response));
+    } break;
+
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*!
+ * \brief Callback of the control point.
+ */
+int client_callback(Upnp_EventType a_type, const void* a_event,
+                    void* a_cookie) {
+    switch (a_type) {
+    case UPNP_DISCOVERY_SEARCH_RESULT: {
+        auto sw = static_cast<SearchWait*>(a_cookie);
+        std::scoped_lock lock(sw->mutex);
+        if (sw->waiting) {
+            latency.add(now_ns() - sw->start);
+            sw->waiting = false;
+            sw->cond.notify_one();
+        }
+    } break;
+
+    case UPNP_EVENT_RECEIVED: {
+        // The device sends its send time as value of the state variable.
+        auto ev = static_cast<const UpnpEvent*>(a_event);
+        IXML_NodeList* nodes = ixmlDocument_getElementsByTagName(
+            UpnpEvent_get_ChangedVariables(ev), "Power");
+        IXML_Node* text = ixmlNode_getFirstChild(ixmlNodeList_item(nodes, 0));
+        const char* value = ixmlNode_getNodeValue(text);
+        if (value != nullptr && value[0] != '0') {
+            latency.add(now_ns() - std::strtoll(value, nullptr, 10));
+            events_received++;
+        }
+        ixmlNodeList_free(nodes);
+    } break;
+
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*!
+ * \brief Runs a worker function concurrently for the given time. The worker
+ * function gets the number of its worker.
+ */
+template <typename F> void run_workers(const Options& a_opts, F a_work) {
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (size_t i{}; i < static_cast<size_t>(a_opts.workers); i++)
+        threads.emplace_back([&stop, &a_work, i] {
+            while (!stop)
+                a_work(i);
+        });
+    std::this_thread::sleep_for(std::chrono::seconds(a_opts.seconds));
+    stop = true;
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void phase_search(const Options& a_opts) {
+    std::vector<SearchWait> waits(static_cast<size_t>(a_opts.workers));
+    run_workers(a_opts, [&waits](size_t a_worker) {
+        SearchWait& sw{waits[a_worker]};
+        std::unique_lock lock(sw.mutex);
+        sw.start = now_ns();
+        sw.waiting = true;
+        lock.unlock();
+        if (UpnpSearchAsync(client_handle, 1, TV_UDN, &sw) != UPNP_E_SUCCESS) {
+            latency.error();
+            return;
+        }
+        lock.lock();
+        if (!sw.cond.wait_for(lock, std::chrono::seconds(2),
+                              [&sw] { return !sw.waiting; })) {
+            sw.waiting = false;
+            latency.error();
+        }
+    });
+    // Late search results still use the wait objects as cookie.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+}
+
+void phase_action(const Options& a_opts) {
+    const std::string url{base_url + TV_CONTROL_PATH};
+    run_workers(a_opts, [&url](size_t) {
+        char action[160];
+        snprintf(action, sizeof(action), "<u:PowerOn xmlns:u=\"%s\"/>",
+                 TV_SERVICE_TYPE);
+        IXML_Document* request = ixmlParseBuffer(action);
+        IXML_Document* response{};
+        const int64_t start{now_ns()};
+        if (UpnpSendAction(client_handle, url.c_str(), TV_SERVICE_TYPE,
+                           nullptr, request, &response) == UPNP_E_SUCCESS) {
+            latency.add(now_ns() - start);
+        } else {
+            latency.error();
+        }
+        ixmlDocument_free(response);
+        ixmlDocument_free(request);
+    });
+}
+
+void phase_event(const Options& a_opts) {
+    const std::string url{base_url + TV_EVENT_PATH};
+    std::vector<std::string> sids;
+    for (int i{}; i < a_opts.subscriptions; i++) {
+        Upnp_SID sid;
+        int timeout{1800};
+        if (UpnpSubscribe(client_handle, url.c_str(), &timeout, sid) !=
+            UPNP_E_SUCCESS) {
+            latency.error();
+            continue;
+        }
+        sids.push_back(sid);
+    }
+    // Wait for the initial events of the subscriptions.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    events_sent = 0;
+    events_received = 0;
+
+    // One device thread notifies. The number of events in flight is limited
+    // so the event queues of the subscriptions do not drop them.
+    const int64_t max_in_flight{4 * static_cast<int64_t>(sids.size())};
+    const char* name[]{"Power"};
+    const auto end = Clock::now() + std::chrono::seconds(a_opts.seconds);
+    while (!sids.empty() && Clock::now() < end) {
+        if (events_sent - events_received >= max_in_flight) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::string value{std::to_string(now_ns())};
+        const char* val[]{value.c_str()};
+        if (UpnpNotify(device_handle, TV_UDN, TV_SERVICE_ID, name, val, 1) !=
+            UPNP_E_SUCCESS) {
+            latency.error();
+            continue;
+        }
+        events_sent += static_cast<int64_t>(sids.size());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    for (const auto& sid : sids)
+        UpnpUnSubscribe(client_handle, sid.c_str());
+}
+
+void phase_description(const Options& a_opts) {
+    const std::string url{base_url + "/" + TV_DESC_DOC};
+    run_workers(a_opts, [&url](size_t) {
+        IXML_Document* doc{};
+        const int64_t start{now_ns()};
+        if (UpnpDownloadXmlDoc(url.c_str(), &doc) == UPNP_E_SUCCESS) {
+            latency.add(now_ns() - start);
+        } else {
+            latency.error();
+        }
+        ixmlDocument_free(doc);
+    });
+}
+
+int start(const Options& a_opts) {
+    int ret = UpnpInit2(a_opts.iface, 0);
+    if (ret != UPNP_E_SUCCESS) {
+        fprintf(stderr, "UpnpInit2(\"%s\") failed with %d.\n", a_opts.iface,
+                ret);
+        return ret;
+    }
+    // A loopback address is provided as ULA/GUA address.
+    int address_family{AF_INET6};
+    if (*UpnpGetServerUlaGuaIp6Address() != '\0') {
+        base_url = std::string("http://[") + UpnpGetServerUlaGuaIp6Address() +
+                   "]:" + std::to_string(UpnpGetServerUlaGuaPort6());
+    } else if (*UpnpGetServerIp6Address() != '\0') {
+        base_url = std::string("http://[") + UpnpGetServerIp6Address() +
+                   "]:" + std::to_string(UpnpGetServerPort6());
+    } else {
+        base_url = std::string("http://") + UpnpGetServerIpAddress() + ":" +
+                   std::to_string(UpnpGetServerPort());
+        address_family = AF_INET;
+    }
+
+    ret = UpnpSetWebServerRootDir(a_opts.web_dir);
+    if (ret != UPNP_E_SUCCESS) {
+        fprintf(stderr, "Invalid web directory \"%s\" (%d).\n", a_opts.web_dir,
+                ret);
+        return ret;
+    }
+    const std::string desc_url{base_url + "/" + TV_DESC_DOC};
+    ret = UpnpRegisterRootDevice3(desc_url.c_str(), device_callback, nullptr,
+                                  &device_handle, address_family);
+    if (ret != UPNP_E_SUCCESS) {
+        fprintf(stderr, "Registering device %s failed with %d.\n",
+                desc_url.c_str(), ret);
+        return ret;
+    }
+    ret = UpnpRegisterClient(client_callback, nullptr, &client_handle);
+    if (ret != UPNP_E_SUCCESS) {
+        fprintf(stderr, "Registering control point failed with %d.\n", ret);
+        return ret;
+    }
+    printf("Device %s, %d workers, %d subscriptions, %d s per phase.\n",
+           desc_url.c_str(), a_opts.workers, a_opts.subscriptions,
+           a_opts.seconds);
+    return UPNP_E_SUCCESS;
+}
+
+void usage(const char* a_prog) {
+    fprintf(stderr,
+            "Usage: %s [-i iface] [-w web_dir] [-p phase] [-t seconds] "
+            "[-c workers] [-s subscriptions]\n"
+            "  iface    local network interface or address, default is the "
+            "best one\n"
+            "  web_dir  directory with the sample descriptions, default "
+            "\"./Sample/web\"\n"
+            "  phase    search, action, event, description or all (default)\n",
+            a_prog);
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    for (int i{1}; i < argc; i++) {
+        if (i + 1 >= argc || argv[i][0] != '-' || argv[i][2] != '\0') {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        const char* arg{argv[++i]};
+        switch (argv[i - 1][1]) {
+        case 'i':
+            opts.iface = arg;
+            break;
+        case 'w':
+            opts.web_dir = arg;
+            break;
+        case 'p':
+            opts.phase = arg;
+            break;
+        case 't':
+            opts.seconds = std::max(1, std::atoi(arg));
+            break;
+        case 'c':
+            opts.workers = std::max(1, std::atoi(arg));
+            break;
+        case 's':
+            opts.subscriptions = std::max(1, std::atoi(arg));
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (start(opts) != UPNP_E_SUCCESS) {
+        UpnpFinish();
+        return EXIT_FAILURE;
+    }
+
+    const struct {
+        const char* name;
+        void (*run)(const Options&);
+    } phases[]{{"search", phase_search},
+               {"action", phase_action},
+               {"event", phase_event},
+               {"description", phase_description}};
+    bool found{false};
+    for (const auto& phase : phases) {
+        if (::strcmp(opts.phase, "all") != 0 &&
+            ::strcmp(opts.phase, phase.name) != 0)
+            continue;
+        found = true;
+        phase.run(opts);
+        latency.report(phase.name, opts.seconds);
+    }
+    if (!found)
+        usage(argv[0]);
+
+    UpnpUnRegisterClient(client_handle);
+    UpnpUnRegisterRootDevice(device_handle);
+    UpnpFinish();
+    return found ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Benchmarks of the HTTP parser and message generator.
+ */
+
+#include <httpparser.hpp>
+#include <httpreadwrite.hpp>
+#include <statcodes.hpp>
+#include <UPnPsdk/strintmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+/// \cond
+#include <cstring>
+/// \endcond
+
+namespace {
+
+// Typical messages as received by SSDP, SOAP and GENA.
+constexpr char SSDP_MSEARCH[]{"M-SEARCH * HTTP/1.1\r\n"
+                              "HOST: 239.255.255.250:1900\r\n"
+                              "MAN: \"ssdp:discover\"\r\n"
+                              "MX: 3\r\n"
+                              "ST: ssdp:all\r\n"
+                              "USER-AGENT: Linux/6.1 UPnP/2.0 UPnPsdk/0.3\r\n"
+                              "\r\n"};
+
+constexpr char SSDP_NOTIFY[]{
+    "NOTIFY * HTTP/1.1\r\n"
+    "HOST: 239.255.255.250:1900\r\n"
+    "CACHE-CONTROL: max-age=1800\r\n"
+    "LOCATION: http://192.168.10.101:49152/tvdevicedesc.xml\r\n"
+    "NT: urn:schemas-upnp-org:device:tvdevice:1\r\n"
+    "NTS: ssdp:alive\r\n"
+    "SERVER: Linux/6.1 UPnP/2.0 UPnPsdk/0.3\r\n"
+    "USN: uuid:Upnp-TVEmulator-1_0-1234567890001::"
+    "urn:schemas-upnp-org:device:tvdevice:1\r\n"
+    "\r\n"};
+
+constexpr char SOAP_REQUEST[]{
+    "POST /upnp/control/tvcontrol1 HTTP/1.1\r\n"
+    "HOST: 192.168.10.101:49152\r\n"
+    "CONTENT-LENGTH: 255\r\n"
+    "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+    "SOAPACTION: \"urn:schemas-upnp-org:service:tvcontrol:1#PowerOn\"\r\n"
+    "USER-AGENT: Linux/6.1 UPnP/2.0 UPnPsdk/0.3\r\n"
+    "\r\n"
+    "<?xml version=\"1.0\"?>\r\n"
+    "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+    "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">\r\n"
+    "<s:Body><u:PowerOn xmlns:u=\"urn:schemas-upnp-org:service:tvcontrol:1\">"
+    "</u:PowerOn></s:Body></s:Envelope>\r\n"};
+
+constexpr char GENA_NOTIFY[]{
+    "NOTIFY /upnp/event/tvcontrol1 HTTP/1.1\r\n"
+    "HOST: 192.168.10.102:51234\r\n"
+    "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+    "CONTENT-LENGTH: 164\r\n"
+    "NT: upnp:event\r\n"
+    "NTS: upnp:propchange\r\n"
+    "SID: uuid:3e0dd4ca-4a69-11f1-8a53-525400123456\r\n"
+    "SEQ: 7\r\n"
+    "\r\n"
+    "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\r\n"
+    "<e:property><Power>1</Power></e:property>\r\n"
+    "<e:property><Volume>5</Volume></e:property>\r\n"
+    "</e:propertyset>\r\n"};
+
+void parse_request(benchmark::State& state, const char* a_msg) {
+    const size_t msg_len{::strlen(a_msg)};
+    for (auto _ : state) {
+        http_parser_t parser;
+        parser_request_init(&parser);
+        parse_status_t status = parser_append(&parser, a_msg, msg_len);
+        // An SSDP NOTIFY without body is accepted the same way as done by
+        // the SSDP event handler.
+        if (status != PARSE_SUCCESS &&
+            !(status == PARSE_FAILURE &&
+              parser.msg.method == HTTPMETHOD_NOTIFY &&
+              parser.valid_ssdp_notify_hack)) {
+            httpmsg_destroy(&parser.msg);
+            state.SkipWithError("parser_parse() failed.");
+            break;
+        }
+        benchmark::DoNotOptimize(parser.msg.method);
+        httpmsg_destroy(&parser.msg);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(msg_len));
+}
+
+void Parser_ssdp_msearch(benchmark::State& state) {
+    parse_request(state, SSDP_MSEARCH);
+}
+BENCHMARK(Parser_ssdp_msearch);
+
+void Parser_ssdp_notify(benchmark::State& state) {
+    parse_request(state, SSDP_NOTIFY);
+}
+BENCHMARK(Parser_ssdp_notify);
+
+void Parser_soap_request(benchmark::State& state) {
+    parse_request(state, SOAP_REQUEST);
+}
+BENCHMARK(Parser_soap_request);
+
+void Parser_gena_notify(benchmark::State& state) {
+    parse_request(state, GENA_NOTIFY);
+}
+BENCHMARK(Parser_gena_notify);
+
+// Same header as sent with a SOAP action response.
+void MakeMessage_soap_response(benchmark::State& state) {
+    for (auto _ : state) {
+        membuffer headers;
+        membuffer_init(&headers);
+        if (http_MakeMessage(&headers, 1, 1, "RNsDsSXcc", HTTP_OK, (off_t)1024,
+                             "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n",
+                             "EXT:\r\n", "redsonic") != 0) {
+            membuffer_destroy(&headers);
+            state.SkipWithError("http_MakeMessage() failed.");
+            break;
+        }
+        benchmark::DoNotOptimize(headers.buf);
+        membuffer_destroy(&headers);
+    }
+}
+BENCHMARK(MakeMessage_soap_response);
+
+// Lookup of header names as done for every parsed header line.
+void StrIntMap_index_of(benchmark::State& state) {
+    UPnPsdk::CStrIntMap http_header_names_table(Http_Header_Names);
+    constexpr const char* names[]{"HOST", "content-length", "SOAPACTION",
+                                  "user-agent", "X-Unknown-Header"};
+    size_t i{};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            http_header_names_table.index_of(names[i++ % std::size(names)]));
+    }
+}
+BENCHMARK(StrIntMap_index_of);
+
+} // anonymous namespace
@@ -0,0 +1,80 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Benchmarks of the ixml parser and printer with the description
+ * documents of the sample TV device.
+ */
+
+#include <ixml/ixml.hpp>
+
+#include <benchmark/benchmark.h>
+
+/// \cond
+#include <fstream>
+#include <sstream>
+#include <string>
+/// \endcond
+
+namespace {
+
+std::string read_file(const char* a_name) {
+    std::ifstream file(std::string(BENCH_WEB_DIR) + "/" + a_name);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+void parse_buffer(benchmark::State& state, const char* a_name) {
+    const std::string xml{read_file(a_name)};
+    if (xml.empty()) {
+        state.SkipWithError("Cannot read description document.");
+        return;
+    }
+    for (auto _ : state) {
+        IXML_Document* doc = ixmlParseBuffer(xml.c_str());
+        if (doc == nullptr) {
+            state.SkipWithError("ixmlParseBuffer() failed.");
+            break;
+        }
+        ixmlDocument_free(doc);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(xml.size()));
+}
+
+void print_node(benchmark::State& state, const char* a_name) {
+    IXML_Document* doc = ixmlParseBuffer(read_file(a_name).c_str());
+    if (doc == nullptr) {
+        state.SkipWithError("Cannot parse description document.");
+        return;
+    }
+    for (auto _ : state) {
+        DOMString str = ixmlPrintNode(reinterpret_cast<IXML_Node*>(doc));
+        benchmark::DoNotOptimize(str);
+        ixmlFreeDOMString(str);
+    }
+    ixmlDocument_free(doc);
+}
+
+void Ixml_parse_devicedesc(benchmark::State& state) {
+    parse_buffer(state, "tvdevicedesc.xml");
+}
+BENCHMARK(Ixml_parse_devicedesc);
+
+void Ixml_parse_scpd(benchmark::State& state) {
+    parse_buffer(state, "tvcontrolSCPD.xml");
+}
+BENCHMARK(Ixml_parse_scpd);
+
+void Ixml_print_devicedesc(benchmark::State& state) {
+    print_node(state, "tvdevicedesc.xml");
+}
+BENCHMARK(Ixml_print_devicedesc);
+
+void Ixml_print_scpd(benchmark::State& state) {
+    print_node(state, "tvcontrolSCPD.xml");
+}
+BENCHMARK(Ixml_print_scpd);
+
+} // anonymous namespace
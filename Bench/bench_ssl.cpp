@@ -0,0 +1,144 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \brief Benchmarks of TLS handshakes on the loopback interface with and
+ * without session resumption.
+ */
+
+#include <sock.hpp>
+#include <upnp.hpp>
+#include <cmake_vars.hpp>
+
+#include <UPnPsdk/socket.hpp>
+
+#include <benchmark/benchmark.h>
+
+/// \cond
+#include <atomic>
+#include <thread>
+/// \endcond
+
+namespace {
+
+/// \brief TLS server on the loopback interface that answers each connection
+/// with a short message.
+class CTlsServer {
+  public:
+    CTlsServer() : m_listenObj(SOCK_STREAM) {
+        m_ctx = SSL_CTX_new(TLS_server_method());
+        if (m_ctx == nullptr ||
+            SSL_CTX_use_certificate_file(m_ctx,
+                                         CMAKE_SOURCE_DIR "/Utest/cert.pem",
+                                         SSL_FILETYPE_PEM) != 1 ||
+            SSL_CTX_use_PrivateKey_file(m_ctx,
+                                        CMAKE_SOURCE_DIR "/Utest/key.pem",
+                                        SSL_FILETYPE_PEM) != 1)
+            throw std::runtime_error("Failed to create the server context.");
+        m_saObj = "[::1]";
+        m_listenObj.bind(&m_saObj);
+        m_listenObj.listen();
+        m_listenObj.local_saddr(&m_saObj);
+        m_thread = std::thread(&CTlsServer::run, this);
+    }
+
+    ~CTlsServer() {
+        // Wake up the server with a last connection.
+        m_stop = true;
+        SOCKET sock{::socket(AF_INET6, SOCK_STREAM, 0)};
+        ::connect(sock, &m_saObj.sa, m_saObj.sizeof_saddr());
+        m_thread.join();
+        CLOSE_SOCKET_P(sock);
+        SSL_CTX_free(m_ctx);
+    }
+
+    /// \brief Connects a new socket to the server.
+    SOCKET connect() {
+        SOCKET sock{::socket(AF_INET6, SOCK_STREAM, 0)};
+        if (::connect(sock, &m_saObj.sa, m_saObj.sizeof_saddr()) != 0) {
+            CLOSE_SOCKET_P(sock);
+            return INVALID_SOCKET;
+        }
+        return sock;
+    }
+
+  private:
+    void run() {
+        while (true) {
+            SOCKET client{::accept(m_listenObj, nullptr, nullptr)};
+            if (m_stop) {
+                CLOSE_SOCKET_P(client);
+                return;
+            }
+            SSL* ssl{SSL_new(m_ctx)};
+            SSL_set_fd(ssl, static_cast<int>(client));
+            if (SSL_accept(ssl) == 1) {
+                SSL_write(ssl, "test", 4);
+                SSL_shutdown(ssl);
+            }
+            SSL_free(ssl);
+            CLOSE_SOCKET_P(client);
+        }
+    }
+
+    SSL_CTX* m_ctx{};
+    UPnPsdk::CSocket m_listenObj;
+    UPnPsdk::SSockaddr m_saObj;
+    std::atomic<bool> m_stop{};
+    std::thread m_thread;
+};
+
+// Full handshake for every connection with a client context without session
+// cache, as it was done before sessions were resumed.
+void Tls_handshake_full(benchmark::State& state) {
+    SSL_CTX* ctx{SSL_CTX_new(TLS_client_method())};
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    CTlsServer server;
+    char buf[4];
+
+    for (auto _ : state) {
+        SOCKET sock{server.connect()};
+        SSL* ssl{SSL_new(ctx)};
+        SSL_set_fd(ssl, static_cast<int>(sock));
+        if (SSL_connect(ssl) != 1 || SSL_read(ssl, buf, sizeof(buf)) <= 0) {
+            state.SkipWithError("TLS connection failed.");
+            SSL_free(ssl);
+            CLOSE_SOCKET_P(sock);
+            break;
+        }
+        SSL_shutdown(ssl);
+        SSL_free(ssl);
+        CLOSE_SOCKET_P(sock);
+    }
+    SSL_CTX_free(ctx);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Tls_handshake_full)->UseRealTime();
+
+// Handshakes with sock_ssl_connect() that resume the cached session.
+void Tls_handshake_resumed(benchmark::State& state) {
+    if (::UpnpInitSslContext(0, TLS_client_method()) != UPNP_E_SUCCESS) {
+        state.SkipWithError("UpnpInitSslContext() failed.");
+        return;
+    }
+    CTlsServer server;
+    char buf[4];
+
+    for (auto _ : state) {
+        SOCKINFO info{};
+        info.socket = server.connect();
+        int timeout{5};
+        if (sock_ssl_connect(&info) != UPNP_E_SUCCESS ||
+            sock_read(&info, buf, sizeof(buf), &timeout) <= 0) {
+            state.SkipWithError("TLS connection failed.");
+            sock_destroy(&info, SD_BOTH);
+            break;
+        }
+        sock_destroy(&info, SD_BOTH);
+    }
+    ::freeSslCtx();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Tls_handshake_resumed)->UseRealTime();
+
+} // anonymous namespace
@@ -0,0 +1,95 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Benchmarks of the thread pool and the timer thread.
+ */
+
+#include <TimerThread.hpp>
+
+#include <benchmark/benchmark.h>
+
+/// \cond
+#include <atomic>
+#include <thread>
+#include <vector>
+/// \endcond
+
+namespace {
+
+std::atomic<int64_t> jobs_done{};
+
+void count_job(void*) { jobs_done.fetch_add(1, std::memory_order_relaxed); }
+
+void no_job(void*) {}
+
+// Throughput of jobs added to the thread pool. The argument is the number of
+// worker threads.
+void ThreadPool_add(benchmark::State& state) {
+    ThreadPoolAttr attr;
+    TPAttrInit(&attr);
+    TPAttrSetMinThreads(&attr, static_cast<int>(state.range(0)));
+    TPAttrSetMaxThreads(&attr, static_cast<int>(state.range(0)));
+    TPAttrSetMaxJobsTotal(&attr, 1 << 20);
+    ThreadPool tp{};
+    if (ThreadPoolInit(&tp, &attr) != 0) {
+        state.SkipWithError("ThreadPoolInit() failed.");
+        return;
+    }
+    jobs_done = 0;
+
+    ThreadPoolJob job;
+    TPJobInit(&job, count_job, nullptr);
+    int64_t jobs_added{};
+    for (auto _ : state) {
+        if (ThreadPoolAdd(&tp, &job, nullptr) != 0) {
+            state.SkipWithError("ThreadPoolAdd() failed.");
+            break;
+        }
+        jobs_added++;
+    }
+    // Wait until all jobs are finished so the pool is drained.
+    while (jobs_done.load(std::memory_order_relaxed) < jobs_added)
+        std::this_thread::yield();
+    ThreadPoolShutdown(&tp);
+    state.SetItemsProcessed(jobs_added);
+}
+BENCHMARK(ThreadPool_add)->Arg(1)->Arg(4)->UseRealTime();
+
+// Schedule and remove one timer event while the timer queue already holds
+// the given number of events.
+void TimerThread_schedule_remove(benchmark::State& state) {
+    ThreadPool tp{};
+    TimerThread timer{};
+    if (ThreadPoolInit(&tp, nullptr) != 0 ||
+        TimerThreadInit(&timer, &tp) != 0) {
+        state.SkipWithError("Initialization failed.");
+        return;
+    }
+    ThreadPoolJob job;
+    TPJobInit(&job, no_job, nullptr);
+
+    // Events spread over one hour so that none of them expires.
+    std::vector<int> ids(static_cast<size_t>(state.range(0)));
+    for (size_t i{}; i < ids.size(); i++) {
+        TimerThreadSchedule(&timer, 3600 + static_cast<time_t>(i % 3600),
+                            REL_SEC, &job, SHORT_TERM, &ids[i]);
+    }
+
+    ThreadPoolJob removed;
+    for (auto _ : state) {
+        int id;
+        if (TimerThreadSchedule(&timer, 1800, REL_SEC, &job, SHORT_TERM,
+                                &id) != 0 ||
+            TimerThreadRemove(&timer, id, &removed) != 0) {
+            state.SkipWithError("TimerThreadSchedule/Remove() failed.");
+            break;
+        }
+    }
+
+    TimerThreadShutdown(&timer);
+    ThreadPoolShutdown(&tp);
+}
+BENCHMARK(TimerThread_schedule_remove)->RangeMultiplier(8)->Range(1, 4096);
+
+} // anonymous namespace
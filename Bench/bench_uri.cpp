@@ -0,0 +1,45 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Benchmarks of the URI parser.
+ */
+
+#include <uri.hpp>
+
+#include <benchmark/benchmark.h>
+
+/// \cond
+#include <cstring>
+/// \endcond
+
+namespace {
+
+void parse(benchmark::State& state, const char* a_uri) {
+    const size_t uri_len{::strlen(a_uri)};
+    for (auto _ : state) {
+        uri_type out;
+        if (parse_uri(a_uri, uri_len, &out) != HTTP_SUCCESS) {
+            state.SkipWithError("parse_uri() failed.");
+            break;
+        }
+        benchmark::DoNotOptimize(out);
+    }
+}
+
+void Uri_parse_ipv4(benchmark::State& state) {
+    parse(state, "http://192.168.10.101:49152/tvdevicedesc.xml");
+}
+BENCHMARK(Uri_parse_ipv4);
+
+void Uri_parse_ipv6(benchmark::State& state) {
+    parse(state, "http://[2001:db8::1]:49152/upnp/event/tvcontrol1");
+}
+BENCHMARK(Uri_parse_ipv6);
+
+void Uri_parse_relative(benchmark::State& state) {
+    parse(state, "/upnp/control/tvcontrol1?query=1#fragment");
+}
+BENCHMARK(Uri_parse_relative);
+
+} // anonymous namespace
@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-07-08
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -391,6 +391,7 @@
 #include <UpnpEvent.hpp>
 #include <UpnpEventSubscribe.hpp>
 #include <UpnpFileInfo.hpp>
+#include <UpnpPropertySet.hpp>
 #include <UpnpStateVarComplete.hpp>
 #include <UpnpStateVarRequest.hpp>
 #include <UpnpSubscriptionRequest.hpp>
@@ -477,6 +478,26 @@ enum Upnp_DescType_e {
 
 typedef enum Upnp_DescType_e Upnp_DescType;
 
+/*!
+ * \brief Specifies a thread pool of the SDK in \b UpnpSetThreadPoolLimits.
+ */
+enum Upnp_ThreadPool_e {
+    /*! Sends GENA event notifications and runs the timer jobs. */
+    UPNP_THREADPOOL_SEND,
+
+    /*! Handles received SSDP messages and the callbacks of the control
+        point. */
+    UPNP_THREADPOOL_RECV,
+
+    /*! Handles the HTTP requests to the miniserver. */
+    UPNP_THREADPOOL_MINISERVER,
+
+    /* Always the last, please. */
+    UPNP_THREADPOOL_COUNT
+};
+
+typedef enum Upnp_ThreadPool_e Upnp_ThreadPool;
+
 #include <Callback.hpp>
 
 /// @} Constants and Types
@@ -495,6 +516,67 @@ extern "C" {
 /*! @{
  * \ingroup compaAPI-Addressing */
 
+/*!
+ * \brief Sets the limits of a thread pool of the SDK.
+ *
+ * Each thread pool starts workers when jobs are queued and workers exit after
+ * some idle time, always within the given limits. Without a target waiting
+ * time a new job adds a worker whenever all workers are busy. With a target
+ * waiting time the pool is sized adaptively: a new job adds a worker only if
+ * no idle worker is left for the queued jobs and they wait longer than the
+ * target, measured as moving average or as age of the oldest queued job. If
+ * the jobs wait less than half of the target, surplus idle workers exit
+ * earlier.
+ *
+ * For example, sending event notifications mostly blocks on the network and
+ * may need many threads, while parsing received messages is bound by the CPU
+ * and does not profit from more threads than cores.
+ *
+ * This function must be called before \b UpnpInit2. The defaults for all
+ * pools are \c MIN_THREADS, \c MAX_THREADS and \c THREAD_TARGET_WAIT_TIME.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_INVALID_PARAM: Invalid pool or limits.
+ *     \li \c UPNP_E_INIT: The SDK is already initialized.
+ */
+PUPNP_Api int UpnpSetThreadPoolLimits(
+    /*! [in] The thread pool to configure. */
+    Upnp_ThreadPool pool,
+    /*! [in] Minimum number of threads, at least 1. */
+    int minThreads,
+    /*! [in] Maximum number of threads, not less than \b minThreads. */
+    int maxThreads,
+    /*! [in] Target for the average waiting time of jobs in milliseconds, 0
+     * disables the adaptive sizing. */
+    int targetWaitTime);
+
+/*!
+ * \brief Pins the threads of a thread pool of the SDK to a set of CPUs.
+ *
+ * On servers with more than one CPU socket this keeps the threads of a pool
+ * on one core group and the memory they allocate on its local NUMA node. The
+ * miniserver thread that receives HTTP requests and SSDP messages runs on the
+ * miniserver pool together with the HTTP request handlers. The received SSDP
+ * messages are handled on the receive pool. If only the miniserver pool is
+ * pinned, the receive pool gets the same CPUs.
+ *
+ * This function must be called before \b UpnpInit2. Pinning is only
+ * supported on Linux.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_INVALID_PARAM: Invalid pool or CPU list, or pinning is
+ *             not supported.
+ *     \li \c UPNP_E_INIT: The SDK is already initialized.
+ */
+PUPNP_Api int UpnpSetThreadPoolCpus(
+    /*! [in] The thread pool to configure. */
+    Upnp_ThreadPool pool,
+    /*! [in] List of CPU numbers and ranges, e.g. "0-7,16-23". \b nullptr or
+     * an empty string does not pin the threads. */
+    const char* cpus);
+
 /*!
  * \brief Initializes the Linux SDK for UPnP Devices.
  *
@@ -986,6 +1068,29 @@ PUPNP_Api int UpnpSetMaxContentLength(
      * actions, in bytes. */
     size_t contentLength);
 
+/*!
+ * \brief Sets the number of listening sockets per local address that accept
+ * incoming HTTP connections.
+ *
+ * With more than one socket the miniserver binds them all to the same address
+ * and port with SO_REUSEPORT. The kernel distributes new connections over the
+ * sockets and each additional socket is served by its own acceptor thread.
+ * This spreads the accept load of busy devices over several CPU cores.
+ *
+ * It must be called before UpnpInit2() and takes effect with the next start
+ * of the miniserver. It is only supported on Linux and ignored on other
+ * platforms. The default is \c MINISERVER_ACCEPTORS = 1.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_INVALID_PARAM: \b count is less than 1 or greater than
+ *             \c MINISERVER_MAX_ACCEPTORS.
+ *     \li \c UPNP_E_INIT: The SDK is already initialized.
+ */
+PUPNP_Api int UpnpSetMiniServerAcceptors(
+    /*! [in] Number of listening sockets per local address. */
+    int count);
+
 /// @} Step 0: Addressing
 
 /******************************************************************************
@@ -1100,6 +1205,71 @@ PUPNP_Api int UpnpSendAdvertisementLowPower(
     /*! [in] RegistrationState as defined by UPnP Low Power. */
     int RegistrationState);
 
+/*!
+ * \brief Limits the rate of replies to search requests.
+ *
+ * A device replies to a search request after a random delay within the MX
+ * time given by the \glos{cp,control point}. Repeated search requests from the
+ * same source for the same target, or for a target that is covered by a
+ * pending "ssdp:all" reply, are merged into the pending reply. Requests for
+ * other targets are added to it. The rate limit is applied to the remaining
+ * requests of each source address. Requests above the limit are ignored.
+ *
+ * It can be called at any time and takes effect with the next request.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_INVALID_PARAM: \b repliesPerSecond is negative.
+ */
+PUPNP_Api int UpnpSetSsdpReplyRateLimit(
+    /*! [in] Maximal number of replied search requests per second and source
+     * address. 0 disables the limit (default). */
+    int repliesPerSecond);
+
+/*!
+ * \brief Enables or disables the cache of discovered devices and services.
+ *
+ * Devices repeat their advertisements periodically and reply to each search
+ * request. With the cache enabled, the SDK keeps the discovered devices and
+ * services by their USN and calls the control point callback with \c
+ * UPNP_DISCOVERY_ADVERTISEMENT_ALIVE only if one is seen for the first time,
+ * or if its LOCATION or BOOTID.UPNP.ORG has changed. Repeated advertisements
+ * only refresh the expiry time given by the CACHE-CONTROL max-age. Replies to
+ * a search are always reported with \c UPNP_DISCOVERY_SEARCH_RESULT and
+ * refresh the cache. If it expires, the entry is removed and reported
+ * with \c UPNP_DISCOVERY_ADVERTISEMENT_BYEBYE. The current entries can be
+ * queried with UpnpGetDiscoveredDevices().
+ *
+ * Disabling the cache removes all entries. The default is set with \c
+ * SSDP_DISCOVERY_CACHE.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ */
+PUPNP_Api int UpnpSetDiscoveryCache(
+    /*! [in] 1 to enable, 0 to disable the cache. */
+    int enable);
+
+/*!
+ * \brief Gets the devices and services from the discovery cache.
+ *
+ * For each entry of the cache, the function is called with \c
+ * UPNP_DISCOVERY_ADVERTISEMENT_ALIVE and an \b UpnpDiscovery structure with
+ * the last delivered information. The function may call SDK functions. This
+ * is a synchronous call.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_FINISH: The SDK is already terminated or
+ *                           is not initialized.
+ *     \li \c UPNP_E_INVALID_PARAM: \b Fun is a \c nullptr.
+ */
+PUPNP_Api int UpnpGetDiscoveredDevices(
+    /*! [in] Function to call for each entry. */
+    Upnp_FunPtr Fun,
+    /*! [in] The user data to pass when the function is invoked. */
+    const void* Cookie);
+
 /// @} Step 1: Discovery
 
 /******************************************************************************
@@ -1536,6 +1706,42 @@ PUPNP_Api int UpnpNotifyExt(
      * Universal Plug and Play Device Architecture specification. */
     IXML_Document* PropSet);
 
+/*!
+ * \brief Similar to UpnpNotifyExt() except that it takes a property set
+ * written with the \ref UpnpPropertySet writer.
+ *
+ * No DOM document is built or printed. This is the fastest way to send
+ * events at a high rate. The property set isn't modified and can be reused.
+ *
+ * This function is synchronous and generates no callbacks.
+ *
+ * This function may be called during a callback function to send out a
+ * notification.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_FINISH: The SDK is already terminated or
+ *                           is not initialized.
+ *     \li \c UPNP_E_INVALID_HANDLE: The handle is not a valid device
+ *             handle.
+ *     \li \c UPNP_E_INVALID_SERVICE: The \b DevId/\b ServName
+ *             pair refers to an invalid service.
+ *     \li \c UPNP_E_INVALID_PARAM: Either \b DevID, \b ServName, or \b PropSet
+ *             is not a valid pointer.
+ *     \li \c UPNP_E_OUTOF_MEMORY: Insufficient resources exist to
+ *             complete this operation.
+ */
+PUPNP_Api int UpnpNotifyPropertySet(
+    /*! [in] The handle to the device sending the event. */
+    UpnpDevice_Handle Hnd,
+    /*! [in] The device ID of the subdevice of the service generating the
+       event. */
+    const char* DevID,
+    /*! [in] The unique identifier of the service generating the event. */
+    const char* ServName,
+    /*! [in] The property set to send. */
+    const UpnpPropertySet* PropSet);
+
 /*!
  * \brief Renews a subscription that is about to expire.
  *
@@ -1686,6 +1892,46 @@ PUPNP_Api int UpnpSetMaxSubscriptionTimeOut(
     /*! The maximum subscription time-out to be accepted. */
     int MaxSubscriptionTimeOut);
 
+/*!
+ * \brief Enables the event driven delivery of event notifications.
+ *
+ * By default every NOTIFY request to a \glos{cp,control point} occupies a
+ * thread of the send thread pool until the control point has answered. With
+ * many subscribers one event needs many round trips to be delivered. If
+ * enabled, a single thread keeps all NOTIFY requests in flight on
+ * non-blocking sockets. Events to one subscription are still delivered in
+ * order of their SEQ number.
+ *
+ * This must be called before UpnpInit2().
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ *     \li \c UPNP_E_INIT: The SDK is already initialized.
+ */
+PUPNP_Api int UpnpSetAsyncEventDelivery(
+    /*! [in] Zero to disable (default), non-zero to enable. */
+    int enable);
+
+/*!
+ * \brief Enables coalescing of queued event notifications.
+ *
+ * If a \glos{cp,control point} answers slowly, events to its subscription
+ * are queued. With coalescing enabled, a new event is merged into the last
+ * queued event that hasn't been given to a send thread yet, instead of being
+ * queued on its own. For every state variable only its last value is sent.
+ * Fewer NOTIFY requests are sent and intermediate values are lost, so this
+ * must only be enabled if the control points are only interested in the
+ * current state. The SEQ numbers of the sent events are still consecutive.
+ *
+ * It can be called at any time and takes effect with the next event.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The operation completed successfully.
+ */
+PUPNP_Api int UpnpSetEventCoalescing(
+    /*! [in] Zero to disable (default), non-zero to enable. */
+    int enable);
+
 /*!
  * \brief Registers a \glos{cp,control point} to receive event notifications
  * from a \glos{upnpdev,UPnP device}.
@@ -2550,6 +2796,55 @@ PUPNP_Api int UpnpDownloadXmlDoc(
        document. */
     IXML_Document** xmlDoc);
 
+/*!
+ * \brief Function that is called with the result of
+ * UpnpDownloadXmlDocAsync().
+ *
+ * \b ErrCode is one of the error codes of UpnpDownloadXmlDoc(), or \c
+ * UPNP_E_FINISH if the SDK is terminated before the document is downloaded.
+ * On success, \b XmlDoc is the parsed document. The application is
+ * responsible for freeing it. On error it is \c nullptr.
+ */
+typedef void (*Upnp_DescriptionFunPtr)( //
+    int ErrCode,                        ///< [in]
+    const char* Url,                    ///< [in]
+    IXML_Document* XmlDoc,              ///< [in]
+    const void* Cookie                  ///< [in]
+);
+
+/*!
+ * \brief Downloads an XML document specified in a URL without blocking.
+ *
+ * A control point gets an advertisement for each device and service of a root
+ * device, all with the same description URL. This function downloads each URL
+ * only once, even if it is requested again while the download is running, and
+ * keeps the documents in a cache. A cached document is given without
+ * download if it is younger than \c DESCRIPTION_CACHE_FRESH_TIME seconds.
+ * Otherwise the SDK asks the device with its ETag and Last-Modified date if
+ * it has changed. At most \c DESCRIPTION_FETCH_JOBS downloads run at the same
+ * time.
+ *
+ * The function \b Fun is called with the parsed document on a thread of the
+ * SDK. For a fresh document in the cache it is called before this function
+ * returns.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The download is requested.
+ *     \li \c UPNP_E_FINISH: The SDK is already terminated or
+ *                           is not initialized.
+ *     \li \c UPNP_E_INVALID_PARAM: Either \b url or \b Fun
+ *             is not a valid pointer.
+ *     \li \c UPNP_E_OUTOF_MEMORY: There are insufficient resources to
+ *             download the XML document.
+ */
+PUPNP_Api int UpnpDownloadXmlDocAsync(
+    /*! [in] URL of the XML document. */
+    const char* url,
+    /*! [in] Function to call with the document. */
+    Upnp_DescriptionFunPtr Fun,
+    /*! [in] The user data to pass when the function is invoked. */
+    const void* Cookie);
+
 /// @} Control Point http API
 
 
@@ -0,0 +1,151 @@
+#ifndef COMPA_UPNPMETRICS_HPP
+#define COMPA_UPNPMETRICS_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \brief Runtime metrics of the UPnP library.
+ *
+ * The library counts HTTP requests, SSDP packets, GENA notifications and open
+ * sockets during normal operation. Counting only adds to a counter of a
+ * per-thread shard without locking. Reading a metric sums up all shards.
+ * Together with the current state of the thread pools and of the timer
+ * thread all metrics can be exported as text in the Prometheus exposition
+ * format with UpnpMetricsExport() or served by the internal webserver on a
+ * path set with UpnpSetMetricsPath().
+ */
+
+#include <UPnPsdk/visibility.hpp>
+/// \cond
+#include <stddef.h> // For size_t
+/// \endcond
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ * \brief Counters and gauges that can be read with UpnpMetricsGet().
+ */
+typedef enum Upnp_Metric_e {
+    UPNP_METRIC_SSDP_IN_NOTIFY,    ///< Received SSDP NOTIFY messages.
+    UPNP_METRIC_SSDP_IN_MSEARCH,   ///< Received SSDP M-SEARCH requests.
+    UPNP_METRIC_SSDP_IN_RESPONSE,  ///< Received SSDP search responses.
+    UPNP_METRIC_SSDP_IN_INVALID,   ///< Received invalid SSDP messages.
+    /// Received SSDP messages that are dropped as not of interest.
+    UPNP_METRIC_SSDP_IN_FILTERED,
+    UPNP_METRIC_SSDP_OUT_NOTIFY,   ///< Sent SSDP NOTIFY messages.
+    UPNP_METRIC_SSDP_OUT_MSEARCH,  ///< Sent SSDP M-SEARCH requests.
+    UPNP_METRIC_SSDP_OUT_RESPONSE, ///< Sent SSDP search responses.
+    UPNP_METRIC_GENA_NOTIFY_OK,    ///< Accepted GENA event notifications.
+    UPNP_METRIC_GENA_NOTIFY_FAILED, ///< Failed GENA event notifications.
+    UPNP_METRIC_SOCKETS_OPEN, ///< Gauge of open HTTP connection sockets.
+    /* Always the last, please. */
+    UPNP_METRIC_COUNT
+} Upnp_Metric;
+
+/*!
+ * \brief Histograms that can be read with UpnpMetricsGetHistogram().
+ */
+typedef enum Upnp_Histogram_e {
+    /// Time to deliver a GENA event notification to a subscriber.
+    UPNP_HISTOGRAM_GENA_NOTIFY,
+    /* Always the last, please. */
+    UPNP_HISTOGRAM_COUNT
+} Upnp_Histogram;
+
+/*!
+ * \brief Number of buckets of a histogram.
+ *
+ * Bucket \b i < UPNP_METRICS_BUCKETS - 1 counts the values that are greater
+ * than 2^(i-1) and not greater than 2^i microseconds. Bucket 0 counts all
+ * values up to one microsecond and the last bucket counts all values above
+ * 2^(UPNP_METRICS_BUCKETS - 2) microseconds.
+ */
+#define UPNP_METRICS_BUCKETS 24
+
+/*!
+ * \brief Content of a histogram.
+ */
+typedef struct s_UpnpMetricsHistogram {
+    /// Number of all observed values.
+    unsigned long long count;
+    /// Sum of all observed values in nanoseconds.
+    unsigned long long sum_ns;
+    /// Number of values in each bucket, not cumulative.
+    unsigned long long bucket[UPNP_METRICS_BUCKETS];
+} UpnpMetricsHistogram;
+
+/*!
+ * \brief Returns the current value of a counter or gauge.
+ *
+ * \returns The value or 0 if \p a_metric is invalid.
+ */
+UPnPsdk_VIS long long UpnpMetricsGet(
+    /*! [in] The metric to read. */
+    Upnp_Metric a_metric);
+
+/*!
+ * \brief Reads a histogram.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error: UPNP_E_INVALID_PARAM
+ */
+UPnPsdk_VIS int UpnpMetricsGetHistogram(
+    /*! [in] The histogram to read. */
+    Upnp_Histogram a_histogram,
+    /*! [out] Pointer to the structure that gets the histogram. */
+    UpnpMetricsHistogram* a_hist);
+
+/*!
+ * \brief Exports all metrics as text in the Prometheus exposition format.
+ *
+ * Besides the metrics above the text contains the HTTP requests answered by
+ * the miniserver by method and status class, the queue lengths, waiting times
+ * and threads of the receive, send and miniserver thread pools, and the
+ * number of events in the timer queue.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error:
+ *  - UPNP_E_INVALID_PARAM
+ *  - UPNP_E_OUTOF_MEMORY
+ *  - UPNP_E_BUFFER_TOO_SMALL, \p *a_len is set to the needed size. The size
+ *    may grow until the next call.
+ */
+UPnPsdk_VIS int UpnpMetricsExport(
+    /*! [out] Buffer that gets the null terminated text. It may be NULL to
+     * query the needed size. */
+    char* a_buf,
+    /*! [in,out] Size of the buffer. On return the length of the text
+     * including the terminating null byte. */
+    size_t* a_len);
+
+/*!
+ * \brief Serves the exported metrics on the internal webserver.
+ *
+ * GET and HEAD requests with exactly this path are answered with the text of
+ * UpnpMetricsExport() and content type "text/plain". It has only effect if
+ * the library is compiled with the webserver.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error: UPNP_E_INVALID_PARAM if the path does not start with '/' or is
+ *  too long.
+ */
+UPnPsdk_VIS int UpnpSetMetricsPath(
+    /*! [in] Absolute path, e.g. "/metrics". NULL or an empty string disables
+     * serving the metrics. */
+    const char* a_path);
+
+/*!
+ * \brief Sets all counters and histograms to zero. Gauges are not modified.
+ */
+UPnPsdk_VIS void UpnpMetricsReset(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // COMPA_UPNPMETRICS_HPP
@@ -0,0 +1,125 @@
+#ifndef COMPA_UPNPPROPERTYSET_HPP
+#define COMPA_UPNPPROPERTYSET_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief UpnpPropertySet object declaration.
+ */
+
+/*!
+ * \defgroup UpnpPropertySet The UpnpPropertySet Class
+ * \brief Streaming writer for the property set of an event notification.
+ *
+ * The `<e:propertyset>` XML document is written directly into one growing
+ * buffer without building a DOM tree. The object can be reused with
+ * UpnpPropertySet_clear() to avoid any memory allocation for the next event.
+ * It is sent with UpnpNotifyPropertySet().
+ * @{
+ */
+
+#include <UPnPsdk/visibility.hpp>
+/// \cond
+#include <stddef.h> // For size_t
+/// \endcond
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ * \brief Type of the property set writer.
+ */
+typedef struct s_UpnpPropertySet UpnpPropertySet;
+
+/*!
+ * \brief Constructor.
+ *
+ * \return A pointer to a new allocated object with an empty property set, or
+ * nullptr if there is not enough memory.
+ */
+PUPNP_Api UpnpPropertySet* UpnpPropertySet_new(void);
+
+/*!
+ * \brief Destructor.
+ */
+PUPNP_Api void UpnpPropertySet_delete(
+    /*! [in] The \em \b this pointer. */
+    UpnpPropertySet* p);
+
+/*!
+ * \brief Removes all properties but keeps the allocated buffer.
+ */
+PUPNP_Api void UpnpPropertySet_clear(
+    /*! [in] The \em \b this pointer. */
+    UpnpPropertySet* p);
+
+/*!
+ * \brief Appends a state variable with its value.
+ *
+ * The characters `<`, `>`, `&`, `'` and `"` of the value are replaced by their
+ * XML entities.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c UPNP_E_SUCCESS: The property has been appended.
+ *     \li \c UPNP_E_INVALID_PARAM: One of the arguments is a nullptr or the
+ *             name is empty.
+ *     \li \c UPNP_E_OUTOF_MEMORY: Insufficient resources exist to
+ *             complete this operation. The property set is unchanged.
+ */
+PUPNP_Api int UpnpPropertySet_add(
+    /*! [in] The \em \b this pointer. */
+    UpnpPropertySet* p,
+    /*! [in] Name of the state variable. It is used as element name and must
+     * be a valid XML name. */
+    const char* name,
+    /*! [in] Value of the state variable. */
+    const char* value);
+
+/*!
+ * \brief Appends a state variable with a value that is already valid XML
+ * content.
+ *
+ * The value is copied unchanged, the same as UpnpNotify() does.
+ *
+ * \return The same as UpnpPropertySet_add().
+ */
+PUPNP_Api int UpnpPropertySet_addRaw(
+    /*! [in] The \em \b this pointer. */
+    UpnpPropertySet* p,
+    /*! [in] Name of the state variable. */
+    const char* name,
+    /*! [in] Value of the state variable as XML content. */
+    const char* value);
+
+/*!
+ * \brief Returns the number of properties.
+ */
+PUPNP_Api int UpnpPropertySet_get_Count(
+    /*! [in] The \em \b this pointer. */
+    const UpnpPropertySet* p);
+
+/*!
+ * \brief Returns the complete null terminated property set document.
+ *
+ * It is valid until the object is modified or deleted.
+ */
+PUPNP_Api const char* UpnpPropertySet_get_String(
+    /*! [in] The \em \b this pointer. */
+    const UpnpPropertySet* p);
+
+/*!
+ * \brief Returns the length of the property set document excluding the
+ * terminating null byte.
+ */
+PUPNP_Api size_t UpnpPropertySet_get_Length(
+    /*! [in] The \em \b this pointer. */
+    const UpnpPropertySet* p);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/// @} UpnpPropertySet The UpnpPropertySet API
+
+#endif /* COMPA_UPNPPROPERTYSET_HPP */
@@ -5,7 +5,7 @@
  * Copyright (c) 2000-2003 Intel Corporation
  * All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-31
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-18
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -1666,6 +1666,57 @@ PUPNP_Api int ixmlParseBufferEx(
        \b NULL on an error. */
     IXML_Document** doc);
 
+/*!
+ * \brief Callbacks for ixmlParseBufferSax().
+ *
+ * Every callback may be \c NULL if the event is not of interest. A callback
+ * that returns another value than \c IXML_SUCCESS stops parsing and its
+ * return value is given back by ixmlParseBufferSax(). The string arguments are
+ * only valid during the call.
+ */
+typedef struct _IXML_SaxHandler {
+    /*! \brief Called for a start tag, before the attributes of the element.
+     * \b name includes the prefix, \b localName does not. */
+    int (*startElement)(void* userData, const char* name,
+                        const char* localName);
+    /*! \brief Called for every attribute of the last started element,
+     * including namespace definitions. */
+    int (*attribute)(void* userData, const char* name, const char* value);
+    /*! \brief Called for an end tag or after an empty element tag. */
+    int (*endElement)(void* userData, const char* name,
+                      const char* localName);
+    /*! \brief Called for text and CDATA content with resolved references.
+     * White space between elements is also reported. */
+    int (*characters)(void* userData, const char* text);
+} IXML_SaxHandler;
+
+/*!
+ * \brief Parses an XML text buffer and reports its content to callbacks
+ * without building a DOM tree.
+ *
+ * The buffer is read in place and is not copied. Only the token that is
+ * currently reported and the stack of open element names are allocated. This
+ * is useful to extract some values from a message, e.g. a SOAP response or a
+ * GENA property set, without creating and freeing a complete document.
+ *
+ * \return An integer representing one of the following:
+ *     \li \c IXML_SUCCESS: The operation completed successfully.
+ *     \li \c IXML_INVALID_PARAMETER: The \b buffer or the \b handler is not a
+ *           valid pointer or the buffer is empty.
+ *     \li \c IXML_INSUFFICIENT_MEMORY: Not enough free memory exists
+ *           to complete this operation.
+ *     \li \c IXML_SYNTAX_ERR or \c IXML_FAILED: The buffer is not well
+ *           formed XML.
+ *     \li Any other value returned by a callback.
+ */
+PUPNP_Api int ixmlParseBufferSax(
+    /*! [in] The buffer that contains the XML text to parse. */
+    const char* buffer,
+    /*! [in] The callbacks to call. */
+    const IXML_SaxHandler* handler,
+    /*! [in] Pointer that is given unchanged to every callback. */
+    void* userData);
+
 /*!
  * \brief Parses an XML text file converting it into an IXML DOM representation.
  *
@@ -6,7 +6,7 @@
  * Copyright (c) 2006 Rémi Turboult <r3mi@users.sourceforge.net>
  * All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-07-16
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-18
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -160,6 +160,36 @@ static inline void UpnpSetLogFileNames_Inlined(const char* ErrFileName,
 }
 #endif
 
+/*!
+ * \brief Enables or disables asynchronous logging.
+ *
+ * With asynchronous logging UpnpPrintf() only formats the message into a
+ * buffer of the calling thread without taking a lock. A background thread
+ * writes the messages to the log file. Each thread buffers up to 128 messages
+ * of at most 511 characters. If its buffer is full, further messages are
+ * dropped and counted. It must be called before UpnpInitLog() resp.
+ * UpnpInit2() to take effect.
+ */
+UPnPsdk_VIS void UpnpSetLogAsync(
+    /*! [in] 1 to enable, 0 to disable asynchronous logging. */
+    int enable);
+
+#if defined NDEBUG && !defined UPNP_DEBUG_C
+#define UpnpSetLogAsync UpnpSetLogAsync_Inlined
+static inline void UpnpSetLogAsync_Inlined(int enable) { (void)enable; }
+#endif
+
+/*!
+ * \brief Returns the number of log messages that have been dropped by
+ * asynchronous logging because a buffer was full.
+ */
+UPnPsdk_VIS unsigned long UpnpGetLogDropCount(void);
+
+#if defined NDEBUG && !defined UPNP_DEBUG_C
+#define UpnpGetLogDropCount UpnpGetLogDropCount_Inlined
+static inline unsigned long UpnpGetLogDropCount_Inlined(void) { return 0; }
+#endif
+
 /*!
  * \brief Check if the module is turned on for debug and returns the file
  * descriptor corresponding to the debug level.
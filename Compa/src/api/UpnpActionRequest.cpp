@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-08-17
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
 // Also Copyright by other contributor as noted below.
 /*!
  * \file
@@ -8,6 +8,7 @@
  */
 
 #include <UpnpActionRequest.hpp>
+#include <UpnpStringInline.hpp>
 #include <UPnPsdk/port_sock.hpp>
 
 /// \cond
@@ -15,6 +16,15 @@
 #include <string.h> /* for strlen(), strdup() */
 /// \endcond
 
+/// \brief Max. length of the embedded strings, longer ones are allocated.
+/// @{
+constexpr size_t ERRSTR_LEN{64};
+constexpr size_t ACTIONNAME_LEN{64};
+constexpr size_t DEVUDN_LEN{64};
+constexpr size_t SERVICEID_LEN{96};
+constexpr size_t OS_LEN{64};
+/// @}
+
 /// \brief s_UpnpActionRequest
 struct s_UpnpActionRequest {
     int m_ErrCode;                   ///< m_ErrCode
@@ -31,23 +41,30 @@ struct s_UpnpActionRequest {
 };
 
 UpnpActionRequest* UpnpActionRequest_new() {
-    struct s_UpnpActionRequest* p =
-        (s_UpnpActionRequest*)calloc(1, sizeof(struct s_UpnpActionRequest));
+    // All strings are embedded behind the structure so that the object
+    // needs only one memory allocation.
+    const size_t size =
+        sizeof(struct s_UpnpActionRequest) + UpnpString_inlineSize(ERRSTR_LEN) +
+        UpnpString_inlineSize(ACTIONNAME_LEN) +
+        UpnpString_inlineSize(DEVUDN_LEN) +
+        UpnpString_inlineSize(SERVICEID_LEN) + UpnpString_inlineSize(OS_LEN);
+    struct s_UpnpActionRequest* p = (s_UpnpActionRequest*)calloc(1, size);
 
     if (!p)
         return 0;
 
+    char* mem = (char*)p + sizeof(struct s_UpnpActionRequest);
     /*p->m_ErrCode = 0;*/
     /*p->m_Socket = 0;*/
-    p->m_ErrStr = UpnpString_new();
-    p->m_ActionName = UpnpString_new();
-    p->m_DevUDN = UpnpString_new();
-    p->m_ServiceID = UpnpString_new();
+    p->m_ErrStr = UpnpString_inlineNew(&mem, ERRSTR_LEN);
+    p->m_ActionName = UpnpString_inlineNew(&mem, ACTIONNAME_LEN);
+    p->m_DevUDN = UpnpString_inlineNew(&mem, DEVUDN_LEN);
+    p->m_ServiceID = UpnpString_inlineNew(&mem, SERVICEID_LEN);
     /*p->m_ActionRequest = 0;*/
     /*p->m_ActionResult = 0;*/
     /*p->m_SoapHeader = 0;*/
     /* memset(&p->m_CtrlPtIPAddr, 0, sizeof (struct sockaddr_storage)); */
-    p->m_Os = UpnpString_new();
+    p->m_Os = UpnpString_inlineNew(&mem, OS_LEN);
 
     return (UpnpActionRequest*)p;
 }
@@ -58,19 +75,19 @@ void UpnpActionRequest_delete(UpnpActionRequest* q) {
     if (!p)
         return;
 
-    UpnpString_delete(p->m_Os);
+    UpnpString_inlineDelete(p->m_Os);
     p->m_Os = 0;
     memset(&p->m_CtrlPtIPAddr, 0, sizeof(struct sockaddr_storage));
     p->m_SoapHeader = 0;
     p->m_ActionResult = 0;
     p->m_ActionRequest = 0;
-    UpnpString_delete(p->m_ServiceID);
+    UpnpString_inlineDelete(p->m_ServiceID);
     p->m_ServiceID = 0;
-    UpnpString_delete(p->m_DevUDN);
+    UpnpString_inlineDelete(p->m_DevUDN);
     p->m_DevUDN = 0;
-    UpnpString_delete(p->m_ActionName);
+    UpnpString_inlineDelete(p->m_ActionName);
     p->m_ActionName = 0;
-    UpnpString_delete(p->m_ErrStr);
+    UpnpString_inlineDelete(p->m_ErrStr);
     p->m_ErrStr = 0;
     p->m_Socket = 0;
     p->m_ErrCode = 0;
@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-08-17
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
 // Also Copyright by other contributor as noted below.
 /*!
  * \file
@@ -8,6 +8,7 @@
  */
 
 #include <UpnpDiscovery.hpp>
+#include <UpnpStringInline.hpp>
 #include <UPnPsdk/port_sock.hpp>
 
 /// \cond
@@ -15,6 +16,18 @@
 #include <string.h> /* for strlen(), strdup() */
 /// \endcond
 
+/// \brief Max. length of the embedded strings, longer ones are allocated.
+/// @{
+constexpr size_t DEVICEID_LEN{64};
+constexpr size_t DEVICETYPE_LEN{96};
+constexpr size_t SERVICETYPE_LEN{96};
+constexpr size_t SERVICEVER_LEN{16};
+constexpr size_t LOCATION_LEN{128};
+constexpr size_t OS_LEN{64};
+constexpr size_t DATE_LEN{32};
+constexpr size_t EXT_LEN{8};
+/// @}
+
 /// \brief s_UpnpDiscovery
 struct s_UpnpDiscovery {
     /// @{
@@ -34,22 +47,31 @@ struct s_UpnpDiscovery {
 };
 
 UpnpDiscovery* UpnpDiscovery_new() {
-    struct s_UpnpDiscovery* p =
-        (s_UpnpDiscovery*)calloc(1, sizeof(struct s_UpnpDiscovery));
+    // All strings are embedded behind the structure so that the object
+    // needs only one memory allocation.
+    const size_t size =
+        sizeof(struct s_UpnpDiscovery) + UpnpString_inlineSize(DEVICEID_LEN) +
+        UpnpString_inlineSize(DEVICETYPE_LEN) +
+        UpnpString_inlineSize(SERVICETYPE_LEN) +
+        UpnpString_inlineSize(SERVICEVER_LEN) +
+        UpnpString_inlineSize(LOCATION_LEN) + UpnpString_inlineSize(OS_LEN) +
+        UpnpString_inlineSize(DATE_LEN) + UpnpString_inlineSize(EXT_LEN);
+    struct s_UpnpDiscovery* p = (s_UpnpDiscovery*)calloc(1, size);
 
     if (!p)
         return 0;
 
+    char* mem = (char*)p + sizeof(struct s_UpnpDiscovery);
     /*p->m_ErrCode = 0;*/
     /*p->m_Expires = 0;*/
-    p->m_DeviceID = UpnpString_new();
-    p->m_DeviceType = UpnpString_new();
-    p->m_ServiceType = UpnpString_new();
-    p->m_ServiceVer = UpnpString_new();
-    p->m_Location = UpnpString_new();
-    p->m_Os = UpnpString_new();
-    p->m_Date = UpnpString_new();
-    p->m_Ext = UpnpString_new();
+    p->m_DeviceID = UpnpString_inlineNew(&mem, DEVICEID_LEN);
+    p->m_DeviceType = UpnpString_inlineNew(&mem, DEVICETYPE_LEN);
+    p->m_ServiceType = UpnpString_inlineNew(&mem, SERVICETYPE_LEN);
+    p->m_ServiceVer = UpnpString_inlineNew(&mem, SERVICEVER_LEN);
+    p->m_Location = UpnpString_inlineNew(&mem, LOCATION_LEN);
+    p->m_Os = UpnpString_inlineNew(&mem, OS_LEN);
+    p->m_Date = UpnpString_inlineNew(&mem, DATE_LEN);
+    p->m_Ext = UpnpString_inlineNew(&mem, EXT_LEN);
     /* memset(&p->m_DestAddr, 0, sizeof (struct sockaddr_storage)); */
 
     return (UpnpDiscovery*)p;
@@ -62,21 +84,21 @@ void UpnpDiscovery_delete(UpnpDiscovery* q) {
         return;
 
     memset(&p->m_DestAddr, 0, sizeof(struct sockaddr_storage));
-    UpnpString_delete(p->m_Ext);
+    UpnpString_inlineDelete(p->m_Ext);
     p->m_Ext = 0;
-    UpnpString_delete(p->m_Date);
+    UpnpString_inlineDelete(p->m_Date);
     p->m_Date = 0;
-    UpnpString_delete(p->m_Os);
+    UpnpString_inlineDelete(p->m_Os);
     p->m_Os = 0;
-    UpnpString_delete(p->m_Location);
+    UpnpString_inlineDelete(p->m_Location);
     p->m_Location = 0;
-    UpnpString_delete(p->m_ServiceVer);
+    UpnpString_inlineDelete(p->m_ServiceVer);
     p->m_ServiceVer = 0;
-    UpnpString_delete(p->m_ServiceType);
+    UpnpString_inlineDelete(p->m_ServiceType);
     p->m_ServiceType = 0;
-    UpnpString_delete(p->m_DeviceType);
+    UpnpString_inlineDelete(p->m_DeviceType);
     p->m_DeviceType = 0;
-    UpnpString_delete(p->m_DeviceID);
+    UpnpString_inlineDelete(p->m_DeviceID);
     p->m_DeviceID = 0;
     p->m_Expires = 0;
     p->m_ErrCode = 0;
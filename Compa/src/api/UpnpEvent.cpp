@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-03-03
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
 // Also Copyright by other contributor as noted below.
 /*!
  * \file
@@ -8,10 +8,16 @@
  */
 
 #include <UpnpEvent.hpp>
+#include <UpnpStringInline.hpp>
 
 #include <stdlib.h> /* for calloc(), free() */
 #include <string.h> /* for strlen(), strdup() */
 
+/// \brief Max. length of the embedded strings, longer ones are allocated.
+/// @{
+constexpr size_t SID_LEN{48};
+/// @}
+
 /// \brief s_UpnpEvent
 struct s_UpnpEvent {
     /// @{
@@ -23,14 +29,19 @@ struct s_UpnpEvent {
 };
 
 UpnpEvent* UpnpEvent_new() {
-    struct s_UpnpEvent* p = (s_UpnpEvent*)calloc(1, sizeof(struct s_UpnpEvent));
+    // All strings are embedded behind the structure so that the object
+    // needs only one memory allocation.
+    const size_t size =
+        sizeof(struct s_UpnpEvent) + UpnpString_inlineSize(SID_LEN);
+    struct s_UpnpEvent* p = (s_UpnpEvent*)calloc(1, size);
 
     if (!p)
         return 0;
 
+    char* mem = (char*)p + sizeof(struct s_UpnpEvent);
     /*p->m_EventKey = 0;*/
     /*p->m_ChangedVariables = 0;*/
-    p->m_SID = UpnpString_new();
+    p->m_SID = UpnpString_inlineNew(&mem, SID_LEN);
 
     return (UpnpEvent*)p;
 }
@@ -41,7 +52,7 @@ void UpnpEvent_delete(UpnpEvent* q) {
     if (!p)
         return;
 
-    UpnpString_delete(p->m_SID);
+    UpnpString_inlineDelete(p->m_SID);
     p->m_SID = 0;
     p->m_ChangedVariables = 0;
     p->m_EventKey = 0;
@@ -0,0 +1,425 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \brief Runtime metrics registry and its export in Prometheus text format.
+ */
+
+#include <metrics.hpp>
+#include <upnpapi.hpp>
+
+#include <UPnPsdk/synclog.hpp>
+
+/// \cond
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+/// \endcond
+
+namespace compa {
+
+MetricsShard g_metrics_shards[METRICS_SHARDS];
+
+namespace {
+
+/*! \name Scope restricted to file
+ * @{ */
+
+/// \brief Counter to distribute the threads over the shards.
+std::atomic<size_t> metrics_thread_count{0};
+
+/// \brief Protects the metrics path.
+pthread_mutex_t metrics_path_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief Path to serve the metrics on the webserver, empty if disabled.
+char metrics_path[LINE_SIZE];
+/// \brief The metrics path is set, checked without lock.
+std::atomic<bool> metrics_path_set{false};
+
+/// \brief Protects the thread pools and the timer thread while exported.
+pthread_mutex_t metrics_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief The thread pools and the timer thread can be exported.
+bool metrics_threads_enabled{false};
+
+/// \brief Names of the HTTP methods in the order of enum http_method_t.
+constexpr const char* metrics_http_method_name[METRICS_HTTP_METHODS]{
+    "PUT", "DELETE", "GET", "HEAD", "POST", "M-POST", "SUBSCRIBE",
+    "UNSUBSCRIBE", "NOTIFY", "M-SEARCH", "UNKNOWN", "SOAP", "SIMPLEGET"};
+
+/// \brief Names and labels of the counters of enum Upnp_Metric.
+constexpr struct {
+    const char* name;
+    const char* labels;
+} metrics_counter_name[UPNP_METRIC_COUNT]{
+    {"upnp_ssdp_packets_total", "direction=\"in\",type=\"notify\""},
+    {"upnp_ssdp_packets_total", "direction=\"in\",type=\"msearch\""},
+    {"upnp_ssdp_packets_total", "direction=\"in\",type=\"response\""},
+    {"upnp_ssdp_packets_total", "direction=\"in\",type=\"invalid\""},
+    {"upnp_ssdp_packets_total", "direction=\"in\",type=\"filtered\""},
+    {"upnp_ssdp_packets_total", "direction=\"out\",type=\"notify\""},
+    {"upnp_ssdp_packets_total", "direction=\"out\",type=\"msearch\""},
+    {"upnp_ssdp_packets_total", "direction=\"out\",type=\"response\""},
+    {"upnp_gena_notify_total", "result=\"success\""},
+    {"upnp_gena_notify_total", "result=\"failure\""},
+    {"upnp_sockets_open", nullptr}};
+
+/// \brief Names of the histograms of enum Upnp_Histogram.
+constexpr const char* metrics_histogram_name[UPNP_HISTOGRAM_COUNT]{
+    "upnp_gena_notify_duration_seconds"};
+
+/// \brief Sums up a counter over all shards.
+uint64_t sum_counter(Upnp_Metric a_metric) {
+    uint64_t sum{};
+    for (const MetricsShard& shard : g_metrics_shards)
+        sum += shard.counter[a_metric].load(std::memory_order_relaxed);
+    return sum;
+}
+
+/// \brief Sums up a histogram over all shards.
+void sum_histogram(Upnp_Histogram a_hist, UpnpMetricsHistogram* a_out) {
+    memset(a_out, 0, sizeof(*a_out));
+    for (const MetricsShard& shard : g_metrics_shards) {
+        for (int i{0}; i < UPNP_METRICS_BUCKETS; i++) {
+            const uint64_t num{
+                shard.hist[a_hist][i].load(std::memory_order_relaxed)};
+            a_out->bucket[i] += num;
+            a_out->count += num;
+        }
+        a_out->sum_ns += shard.hist_sum[a_hist].load(std::memory_order_relaxed);
+    }
+}
+
+/*!
+ * \brief Appends a formatted line to a buffer.
+ *
+ * \returns **0** on success, UPNP_E_OUTOF_MEMORY otherwise.
+ */
+#if (__GNUC__ >= 3)
+__attribute__((format(__printf__, 2, 3)))
+#endif
+int append(membuffer* a_buf, const char* a_fmt, ...) {
+    char line[256];
+    va_list argp;
+    va_start(argp, a_fmt);
+    int len = vsnprintf(line, sizeof(line), a_fmt, argp);
+    va_end(argp);
+    if (len < 0 || static_cast<size_t>(len) >= sizeof(line))
+        return UPNP_E_OUTOF_MEMORY;
+    if (membuffer_append(a_buf, line, static_cast<size_t>(len)) != 0)
+        return UPNP_E_OUTOF_MEMORY;
+    return 0;
+}
+
+/// \brief Appends the counters of enum Upnp_Metric.
+int export_counters(membuffer* a_buf) {
+    int ret{0};
+    ret |= append(a_buf, "# HELP upnp_ssdp_packets_total SSDP packets by "
+                         "direction and type.\n"
+                         "# TYPE upnp_ssdp_packets_total counter\n");
+    for (int i{UPNP_METRIC_SSDP_IN_NOTIFY}; i <= UPNP_METRIC_SSDP_OUT_RESPONSE;
+         i++) {
+        ret |= append(a_buf, "%s{%s} %llu\n", metrics_counter_name[i].name,
+                      metrics_counter_name[i].labels,
+                      static_cast<unsigned long long>(
+                          sum_counter(static_cast<Upnp_Metric>(i))));
+    }
+    ret |= append(a_buf, "# HELP upnp_gena_notify_total GENA event "
+                         "notifications sent to subscribers.\n"
+                         "# TYPE upnp_gena_notify_total counter\n");
+    for (int i{UPNP_METRIC_GENA_NOTIFY_OK}; i <= UPNP_METRIC_GENA_NOTIFY_FAILED;
+         i++) {
+        ret |= append(a_buf, "%s{%s} %llu\n", metrics_counter_name[i].name,
+                      metrics_counter_name[i].labels,
+                      static_cast<unsigned long long>(
+                          sum_counter(static_cast<Upnp_Metric>(i))));
+    }
+    ret |= append(a_buf,
+                  "# HELP upnp_sockets_open Open HTTP connection sockets.\n"
+                  "# TYPE upnp_sockets_open gauge\n"
+                  "upnp_sockets_open %lld\n",
+                  static_cast<long long>(
+                      sum_counter(UPNP_METRIC_SOCKETS_OPEN)));
+    return ret;
+}
+
+/// \brief Appends the answered HTTP requests.
+int export_http(membuffer* a_buf) {
+    int ret{0};
+    ret |= append(a_buf, "# HELP upnp_http_requests_total HTTP requests "
+                         "answered by the miniserver.\n"
+                         "# TYPE upnp_http_requests_total counter\n");
+    for (int method{0}; method < METRICS_HTTP_METHODS; method++) {
+        for (int status_class{0}; status_class < METRICS_HTTP_CLASSES;
+             status_class++) {
+            uint64_t sum{};
+            for (const MetricsShard& shard : g_metrics_shards)
+                sum += shard.http[method][status_class].load(
+                    std::memory_order_relaxed);
+            if (sum == 0)
+                continue;
+            ret |= append(a_buf,
+                          "upnp_http_requests_total{method=\"%s\","
+                          "code=\"%dxx\"} %llu\n",
+                          metrics_http_method_name[method], status_class + 1,
+                          static_cast<unsigned long long>(sum));
+        }
+    }
+    return ret;
+}
+
+/*!
+ * \brief Appends the samples of one histogram.
+ *
+ * \returns **0** on success, UPNP_E_OUTOF_MEMORY otherwise.
+ */
+int append_histogram(
+    /*! [in,out] Buffer to append to. */
+    membuffer* a_buf,
+    /*! [in] Name of the histogram. */
+    const char* a_name,
+    /*! [in] Labels without braces, empty string if none. */
+    const char* a_labels,
+    /*! [in] Number of all values. */
+    unsigned long long a_count,
+    /*! [in] Sum of all values in nanoseconds. */
+    unsigned long long a_sum_ns,
+    /*! [in] UPNP_METRICS_BUCKETS buckets, not cumulative. */
+    const unsigned long long* a_bucket) {
+    const char* sep{*a_labels ? "," : ""};
+    int ret{0};
+    unsigned long long cumulated{};
+    for (int b{0}; b < UPNP_METRICS_BUCKETS - 1; b++) {
+        cumulated += a_bucket[b];
+        ret |= append(a_buf, "%s_bucket{%s%sle=\"%g\"} %llu\n", a_name,
+                      a_labels, sep, static_cast<double>(1ULL << b) / 1e6,
+                      cumulated);
+    }
+    ret |= append(a_buf, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", a_name,
+                  a_labels, sep, a_count);
+    if (*a_labels)
+        ret |= append(a_buf,
+                      "%s_sum{%s} %.9f\n"
+                      "%s_count{%s} %llu\n",
+                      a_name, a_labels, static_cast<double>(a_sum_ns) / 1e9,
+                      a_name, a_labels, a_count);
+    else
+        ret |= append(a_buf,
+                      "%s_sum %.9f\n"
+                      "%s_count %llu\n",
+                      a_name, static_cast<double>(a_sum_ns) / 1e9, a_name,
+                      a_count);
+    return ret;
+}
+
+/// \brief Appends the histograms of enum Upnp_Histogram.
+int export_histograms(membuffer* a_buf) {
+    int ret{0};
+    UpnpMetricsHistogram hist;
+    for (int i{0}; i < UPNP_HISTOGRAM_COUNT; i++) {
+        const char* name{metrics_histogram_name[i]};
+        sum_histogram(static_cast<Upnp_Histogram>(i), &hist);
+        ret |= append(a_buf, "# TYPE %s histogram\n", name);
+        ret |= append_histogram(a_buf, name, "", hist.count, hist.sum_ns,
+                                hist.bucket);
+    }
+    return ret;
+}
+
+/// \brief Appends the state of the thread pools and the timer thread.
+int export_threads(membuffer* a_buf) {
+    const struct {
+        const char* name;
+        ThreadPool* tp;
+    } pools[]{{"recv", &gRecvThreadPool},
+              {"send", &gSendThreadPool},
+              {"miniserver", &gMiniServerThreadPool}};
+    constexpr const char* prio[]{"high", "med", "low"};
+
+    int ret{0};
+    ThreadPoolStats stats[std::size(pools)];
+    for (size_t i{0}; i < std::size(pools); i++) {
+        if (ThreadPoolGetStats(pools[i].tp, &stats[i]) != 0)
+            memset(&stats[i], 0, sizeof(stats[i]));
+    }
+    ret |= append(a_buf, "# HELP upnp_threadpool_jobs_queued Jobs waiting "
+                         "in the queues of a thread pool.\n"
+                         "# TYPE upnp_threadpool_jobs_queued gauge\n");
+    for (size_t i{0}; i < std::size(pools); i++) {
+        const int queued[]{stats[i].currentJobsHQ, stats[i].currentJobsMQ,
+                           stats[i].currentJobsLQ};
+        for (size_t p{0}; p < std::size(prio); p++)
+            ret |= append(a_buf,
+                          "upnp_threadpool_jobs_queued{pool=\"%s\","
+                          "priority=\"%s\"} %d\n",
+                          pools[i].name, prio[p], queued[p]);
+    }
+    // The thread pools index their times by enum ThreadPriority.
+    constexpr ThreadPriority prio_idx[]{HIGH_PRIORITY, MED_PRIORITY,
+                                        LOW_PRIORITY};
+    constexpr struct {
+        const char* name;
+        const char* help;
+        bool run;
+    } times[]{{"upnp_threadpool_wait_seconds",
+               "Time jobs waited in the queues of a thread pool.", false},
+              {"upnp_threadpool_run_seconds",
+               "Time jobs were running on a thread pool.", true}};
+    char labels[64];
+    for (const auto& t : times) {
+        ret |= append(a_buf,
+                      "# HELP %s %s\n"
+                      "# TYPE %s histogram\n",
+                      t.name, t.help, t.name);
+        for (size_t i{0}; i < std::size(pools); i++) {
+            const ThreadPoolTimes* pool_times{t.run ? stats[i].runTime
+                                                    : stats[i].waitTime};
+            for (size_t p{0}; p < std::size(prio); p++) {
+                const ThreadPoolTimes& tt{pool_times[prio_idx[p]]};
+                snprintf(labels, sizeof(labels),
+                         "pool=\"%s\",priority=\"%s\"", pools[i].name,
+                         prio[p]);
+                ret |= append_histogram(a_buf, t.name, labels, tt.jobs,
+                                        tt.sum_ns, tt.bucket);
+            }
+        }
+    }
+    ret |= append(a_buf, "# HELP upnp_threadpool_threads Threads of a "
+                         "thread pool by state.\n"
+                         "# TYPE upnp_threadpool_threads gauge\n");
+    for (size_t i{0}; i < std::size(pools); i++) {
+        ret |= append(
+            a_buf,
+            "upnp_threadpool_threads{pool=\"%s\",state=\"total\"} %d\n"
+            "upnp_threadpool_threads{pool=\"%s\",state=\"working\"} %d\n"
+            "upnp_threadpool_threads{pool=\"%s\",state=\"idle\"} %d\n"
+            "upnp_threadpool_threads{pool=\"%s\",state=\"persistent\"} %d\n",
+            pools[i].name, stats[i].totalThreads, pools[i].name,
+            stats[i].workerThreads, pools[i].name, stats[i].idleThreads,
+            pools[i].name, stats[i].persistentThreads);
+    }
+
+    long timer_events{0};
+    pthread_mutex_lock(&gTimerThread.mutex);
+    timer_events = ListSize(&gTimerThread.eventQ);
+    pthread_mutex_unlock(&gTimerThread.mutex);
+    ret |= append(a_buf,
+                  "# HELP upnp_timer_events_queued Events scheduled on the "
+                  "timer thread.\n"
+                  "# TYPE upnp_timer_events_queued gauge\n"
+                  "upnp_timer_events_queued %ld\n",
+                  timer_events);
+    return ret;
+}
+
+/// @} // Functions scope restricted to file
+} // anonymous namespace
+
+
+size_t metrics_next_shard() {
+    return metrics_thread_count.fetch_add(1, std::memory_order_relaxed) %
+           METRICS_SHARDS;
+}
+
+int metrics_export(membuffer* a_buf) {
+    int ret{0};
+    ret |= export_http(a_buf);
+    ret |= export_counters(a_buf);
+    ret |= export_histograms(a_buf);
+    // The thread pools and the timer thread only exist while the library is
+    // initialized. Hold them until they are exported.
+    pthread_mutex_lock(&metrics_threads_mutex);
+    if (metrics_threads_enabled)
+        ret |= export_threads(a_buf);
+    pthread_mutex_unlock(&metrics_threads_mutex);
+    return ret == 0 ? UPNP_E_SUCCESS : UPNP_E_OUTOF_MEMORY;
+}
+
+void metrics_threads_enable(bool a_enable) {
+    pthread_mutex_lock(&metrics_threads_mutex);
+    metrics_threads_enabled = a_enable;
+    pthread_mutex_unlock(&metrics_threads_mutex);
+}
+
+bool metrics_is_path(const char* a_path, size_t a_len) {
+    if (!metrics_path_set.load(std::memory_order_acquire))
+        return false;
+    pthread_mutex_lock(&metrics_path_mutex);
+    bool found{strlen(metrics_path) == a_len &&
+               strncmp(metrics_path, a_path, a_len) == 0};
+    pthread_mutex_unlock(&metrics_path_mutex);
+    return found;
+}
+
+} // namespace compa
+
+
+long long UpnpMetricsGet(Upnp_Metric a_metric) {
+    if (a_metric < 0 || a_metric >= UPNP_METRIC_COUNT)
+        return 0;
+    return static_cast<long long>(compa::sum_counter(a_metric));
+}
+
+int UpnpMetricsGetHistogram(Upnp_Histogram a_histogram,
+                            UpnpMetricsHistogram* a_hist) {
+    if (a_histogram < 0 || a_histogram >= UPNP_HISTOGRAM_COUNT ||
+        a_hist == nullptr)
+        return UPNP_E_INVALID_PARAM;
+    compa::sum_histogram(a_histogram, a_hist);
+    return UPNP_E_SUCCESS;
+}
+
+int UpnpMetricsExport(char* a_buf, size_t* a_len) {
+    TRACE("Executing UpnpMetricsExport()")
+    if (a_len == nullptr)
+        return UPNP_E_INVALID_PARAM;
+
+    membuffer text;
+    membuffer_init(&text);
+    int ret = compa::metrics_export(&text);
+    if (ret == UPNP_E_SUCCESS) {
+        const size_t needed{text.length + 1};
+        if (a_buf == nullptr || *a_len < needed) {
+            ret = UPNP_E_BUFFER_TOO_SMALL;
+        } else {
+            memcpy(a_buf, text.buf, text.length);
+            a_buf[text.length] = '\0';
+        }
+        *a_len = needed;
+    }
+    membuffer_destroy(&text);
+    return ret;
+}
+
+int UpnpSetMetricsPath(const char* a_path) {
+    TRACE("Executing UpnpSetMetricsPath()")
+    const bool enable{a_path != nullptr && *a_path != '\0'};
+    if (enable && (*a_path != '/' || strlen(a_path) >= LINE_SIZE))
+        return UPNP_E_INVALID_PARAM;
+
+    pthread_mutex_lock(&compa::metrics_path_mutex);
+    if (enable)
+        strcpy(compa::metrics_path, a_path);
+    else
+        compa::metrics_path[0] = '\0';
+    compa::metrics_path_set.store(enable, std::memory_order_release);
+    pthread_mutex_unlock(&compa::metrics_path_mutex);
+    return UPNP_E_SUCCESS;
+}
+
+void UpnpMetricsReset() {
+    TRACE("Executing UpnpMetricsReset()")
+    for (compa::MetricsShard& shard : compa::g_metrics_shards) {
+        for (int i{0}; i < UPNP_METRIC_COUNT; i++) {
+            if (i != UPNP_METRIC_SOCKETS_OPEN)
+                shard.counter[i].store(0, std::memory_order_relaxed);
+        }
+        for (auto& method : shard.http)
+            for (auto& num : method)
+                num.store(0, std::memory_order_relaxed);
+        for (int h{0}; h < UPNP_HISTOGRAM_COUNT; h++) {
+            for (auto& num : shard.hist[h])
+                num.store(0, std::memory_order_relaxed);
+            shard.hist_sum[h].store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,264 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief UpnpPropertySet object implementation.
+ */
+
+/*!
+ * \addtogroup UpnpPropertySet
+ * @{
+ */
+
+#include <UpnpPropertySet.hpp>
+#include <API.hpp>
+#include <gena.hpp>
+
+#include <umock/stdlib.hpp>
+
+/// \cond
+#include <cstring>
+/// \endcond
+
+namespace {
+
+/// \brief Closing tag of the property set, always kept at the end.
+constexpr char PROPERTYSET_TRAILER[]{"</e:propertyset>\n\n"};
+/// \brief Length of the closing tag.
+constexpr size_t PROPERTYSET_TRAILER_LEN{sizeof(PROPERTYSET_TRAILER) - 1};
+/// \brief Characters that are replaced by an XML entity.
+constexpr char XML_SPECIAL_CHARS[]{"<>&'\""};
+/// \brief Initial size of the buffer.
+constexpr size_t PROPERTYSET_INITIAL_SIZE{256};
+
+/*!
+ * \brief Returns the length of a value after escaping.
+ *
+ * Runs of ordinary characters are skipped with strcspn() that is vectorized by
+ * the C library on common platforms.
+ */
+size_t escaped_length(
+    /*! [in] Value to escape. */
+    const char* value) {
+    size_t len{};
+    while (true) {
+        size_t run = strcspn(value, XML_SPECIAL_CHARS);
+        len += run;
+        value += run;
+        switch (*value) {
+        case '\0':
+            return len;
+        case '<':
+        case '>':
+            len += sizeof("&lt;") - 1;
+            break;
+        case '&':
+            len += sizeof("&amp;") - 1;
+            break;
+        default: // '\'' and '"'
+            len += sizeof("&apos;") - 1;
+            break;
+        }
+        value++;
+    }
+}
+
+/*!
+ * \brief Copies a value and replaces special characters by XML entities.
+ *
+ * Runs of ordinary characters are copied with one memcpy().
+ *
+ * \return Pointer behind the last written character.
+ */
+char* copy_escaped(
+    /*! [out] Destination with at least escaped_length() bytes space. */
+    char* dst,
+    /*! [in] Value to escape. */
+    const char* value) {
+    while (true) {
+        size_t run = strcspn(value, XML_SPECIAL_CHARS);
+        memcpy(dst, value, run);
+        dst += run;
+        value += run;
+
+        const char* entity;
+        switch (*value) {
+        case '\0':
+            return dst;
+        case '<':
+            entity = "&lt;";
+            break;
+        case '>':
+            entity = "&gt;";
+            break;
+        case '&':
+            entity = "&amp;";
+            break;
+        case '\'':
+            entity = "&apos;";
+            break;
+        default:
+            entity = "&quot;";
+            break;
+        }
+        size_t entity_len = strlen(entity);
+        memcpy(dst, entity, entity_len);
+        dst += entity_len;
+        value++;
+    }
+}
+
+} // anonymous namespace
+
+/*!
+ * \brief Internal implementation of the class UpnpPropertySet.
+ *
+ * \internal
+ */
+struct s_UpnpPropertySet {
+    /// \brief Length of the document excluding terminating null byte.
+    size_t m_length;
+    /// \brief Size of the allocated buffer.
+    size_t m_size;
+    /// \brief Number of properties.
+    int m_count;
+    /// \brief Null terminated document, always complete with the trailer.
+    char* m_buf;
+};
+
+namespace {
+
+/*!
+ * \brief Makes room for more bytes before the trailer.
+ *
+ * \return Pointer to the position of the trailer, where the new content is to
+ * be written, or nullptr if there is not enough memory.
+ */
+char* reserve(
+    /*! [in] The \em \b this pointer. */
+    UpnpPropertySet* p,
+    /*! [in] Number of bytes that will be inserted. */
+    size_t needed) {
+    size_t required = p->m_length + needed + 1;
+    if (required > p->m_size) {
+        size_t size = p->m_size * 2;
+        if (size < required)
+            size = required;
+        char* buf = (char*)umock::stdlib_h.realloc(p->m_buf, size);
+        if (buf == nullptr)
+            return nullptr;
+        p->m_buf = buf;
+        p->m_size = size;
+    }
+    return p->m_buf + p->m_length - PROPERTYSET_TRAILER_LEN;
+}
+
+/*!
+ * \brief Appends a property, escaped or raw.
+ */
+int add_property(
+    /*! [in] The \em \b this pointer. */
+    UpnpPropertySet* p,
+    /*! [in] Name of the state variable. */
+    const char* name,
+    /*! [in] Value of the state variable. */
+    const char* value,
+    /*! [in] Escape the value if true. */
+    bool escape) {
+    static constexpr char PROP_OPEN[]{"<e:property>\n<"};
+    static constexpr char PROP_CLOSE[]{">\n</e:property>\n"};
+
+    if (p == nullptr || name == nullptr || value == nullptr || *name == '\0')
+        return UPNP_E_INVALID_PARAM;
+
+    size_t name_len = strlen(name);
+    size_t value_len = escape ? escaped_length(value) : strlen(value);
+    size_t needed = sizeof(PROP_OPEN) - 1 + name_len + 1 + value_len + 2 +
+                    name_len + sizeof(PROP_CLOSE) - 1;
+    char* dst = reserve(p, needed);
+    if (dst == nullptr)
+        return UPNP_E_OUTOF_MEMORY;
+
+    memcpy(dst, PROP_OPEN, sizeof(PROP_OPEN) - 1);
+    dst += sizeof(PROP_OPEN) - 1;
+    memcpy(dst, name, name_len);
+    dst += name_len;
+    *dst++ = '>';
+    if (escape) {
+        dst = copy_escaped(dst, value);
+    } else {
+        memcpy(dst, value, value_len);
+        dst += value_len;
+    }
+    *dst++ = '<';
+    *dst++ = '/';
+    memcpy(dst, name, name_len);
+    dst += name_len;
+    memcpy(dst, PROP_CLOSE, sizeof(PROP_CLOSE) - 1);
+    dst += sizeof(PROP_CLOSE) - 1;
+    memcpy(dst, PROPERTYSET_TRAILER, PROPERTYSET_TRAILER_LEN + 1);
+
+    p->m_length += needed;
+    p->m_count++;
+
+    return UPNP_E_SUCCESS;
+}
+
+} // anonymous namespace
+
+UpnpPropertySet* UpnpPropertySet_new() {
+    UpnpPropertySet* p =
+        (UpnpPropertySet*)umock::stdlib_h.calloc(1, sizeof(UpnpPropertySet));
+    if (p == nullptr)
+        return nullptr;
+    p->m_buf = (char*)umock::stdlib_h.malloc(PROPERTYSET_INITIAL_SIZE);
+    if (p->m_buf == nullptr) {
+        umock::stdlib_h.free(p);
+        return nullptr;
+    }
+    p->m_size = PROPERTYSET_INITIAL_SIZE;
+    UpnpPropertySet_clear(p);
+
+    return p;
+}
+
+void UpnpPropertySet_delete(UpnpPropertySet* p) {
+    if (p == nullptr)
+        return;
+    umock::stdlib_h.free(p->m_buf);
+    umock::stdlib_h.free(p);
+}
+
+void UpnpPropertySet_clear(UpnpPropertySet* p) {
+    static constexpr char header[]{XML_PROPERTYSET_HEADER};
+    static_assert(sizeof(header) + PROPERTYSET_TRAILER_LEN <=
+                  PROPERTYSET_INITIAL_SIZE);
+
+    memcpy(p->m_buf, header, sizeof(header) - 1);
+    memcpy(p->m_buf + sizeof(header) - 1, PROPERTYSET_TRAILER,
+           PROPERTYSET_TRAILER_LEN + 1);
+    p->m_length = sizeof(header) - 1 + PROPERTYSET_TRAILER_LEN;
+    p->m_count = 0;
+}
+
+int UpnpPropertySet_add(UpnpPropertySet* p, const char* name,
+                        const char* value) {
+    return add_property(p, name, value, true);
+}
+
+int UpnpPropertySet_addRaw(UpnpPropertySet* p, const char* name,
+                           const char* value) {
+    return add_property(p, name, value, false);
+}
+
+int UpnpPropertySet_get_Count(const UpnpPropertySet* p) { return p->m_count; }
+
+const char* UpnpPropertySet_get_String(const UpnpPropertySet* p) {
+    return p->m_buf;
+}
+
+size_t UpnpPropertySet_get_Length(const UpnpPropertySet* p) {
+    return p->m_length;
+}
+
+/*! @} UpnpPropertySet */
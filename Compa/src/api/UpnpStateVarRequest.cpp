@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-08-17
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
 // Also Copyright by other contributor as noted below.
 /*!
  * \file
@@ -8,6 +8,7 @@
  */
 
 #include <UpnpStateVarRequest.hpp>
+#include <UpnpStringInline.hpp>
 #include <UPnPsdk/port_sock.hpp>
 
 /// \cond
@@ -15,6 +16,14 @@
 #include <cstring> /* for strlen(), strdup() */
 /// \endcond
 
+/// \brief Max. length of the embedded strings, longer ones are allocated.
+/// @{
+constexpr size_t ERRSTR_LEN{64};
+constexpr size_t DEVUDN_LEN{64};
+constexpr size_t SERVICEID_LEN{96};
+constexpr size_t STATEVARNAME_LEN{64};
+/// @}
+
 /// \brief With header typedef "protected" s_UpnpStateVarRequest
 struct s_UpnpStateVarRequest {
     /// @{
@@ -31,18 +40,25 @@ struct s_UpnpStateVarRequest {
 };
 
 UpnpStateVarRequest* UpnpStateVarRequest_new() {
-    struct s_UpnpStateVarRequest* p =
-        (s_UpnpStateVarRequest*)calloc(1, sizeof(struct s_UpnpStateVarRequest));
+    // All strings are embedded behind the structure so that the object
+    // needs only one memory allocation.
+    const size_t size =
+        sizeof(struct s_UpnpStateVarRequest) +
+        UpnpString_inlineSize(ERRSTR_LEN) + UpnpString_inlineSize(DEVUDN_LEN) +
+        UpnpString_inlineSize(SERVICEID_LEN) +
+        UpnpString_inlineSize(STATEVARNAME_LEN);
+    struct s_UpnpStateVarRequest* p = (s_UpnpStateVarRequest*)calloc(1, size);
 
     if (!p)
         return 0;
 
+    char* mem = (char*)p + sizeof(struct s_UpnpStateVarRequest);
     /*p->m_ErrCode = 0;*/
     /*p->m_Socket = 0;*/
-    p->m_ErrStr = UpnpString_new();
-    p->m_DevUDN = UpnpString_new();
-    p->m_ServiceID = UpnpString_new();
-    p->m_StateVarName = UpnpString_new();
+    p->m_ErrStr = UpnpString_inlineNew(&mem, ERRSTR_LEN);
+    p->m_DevUDN = UpnpString_inlineNew(&mem, DEVUDN_LEN);
+    p->m_ServiceID = UpnpString_inlineNew(&mem, SERVICEID_LEN);
+    p->m_StateVarName = UpnpString_inlineNew(&mem, STATEVARNAME_LEN);
     /* memset(&p->m_CtrlPtIPAddr, 0, sizeof (struct sockaddr_storage)); */
     /*p->m_CurrentVal = 0;*/
 
@@ -58,13 +74,13 @@ void UpnpStateVarRequest_delete(UpnpStateVarRequest* q) {
     ixmlFreeDOMString(p->m_CurrentVal);
     p->m_CurrentVal = 0;
     memset(&p->m_CtrlPtIPAddr, 0, sizeof(struct sockaddr_storage));
-    UpnpString_delete(p->m_StateVarName);
+    UpnpString_inlineDelete(p->m_StateVarName);
     p->m_StateVarName = 0;
-    UpnpString_delete(p->m_ServiceID);
+    UpnpString_inlineDelete(p->m_ServiceID);
     p->m_ServiceID = 0;
-    UpnpString_delete(p->m_DevUDN);
+    UpnpString_inlineDelete(p->m_DevUDN);
     p->m_DevUDN = 0;
-    UpnpString_delete(p->m_ErrStr);
+    UpnpString_inlineDelete(p->m_ErrStr);
     p->m_ErrStr = 0;
     p->m_Socket = 0;
     p->m_ErrCode = 0;
@@ -1,5 +1,5 @@
 // Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-08-17
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
 // Also Copyright by other contributor who haven't made a note.
 // Last compare with pupnp original source file on 2023-04-26, ver 1.14.15
 /*!
@@ -14,8 +14,9 @@
  * Do not use this as example to other classes. Please take a look at any
  * other one.
  *
- * \todo Always alloc a minimum size like 64 bytes or so and when shrinking
- * do not perform a new memory allocation.
+ * An UpnpString can also be embedded into the allocation of its owning object
+ * with UpnpString_inlineNew(). It then uses a fixed buffer directly behind
+ * its structure and only allocates memory if a longer string is set.
  *
  * @{
  */
@@ -24,6 +25,7 @@
 #ifndef COMPA_UPNPSTRING_HPP
 #error "Wrong UpnpString.hpp header file included."
 #endif
+#include <UpnpStringInline.hpp>
 #include <UPnPsdk/port.hpp>
 
 #include <umock/stdlib.hpp>
@@ -77,8 +79,32 @@ struct s_UpnpString {
     /*! \brief Pointer to a dynamically allocated area that holds the NULL
      * terminated string. */
     char* m_string;
+    /*! \brief Embedded buffer behind this structure, or NULL if the object
+     * was created with UpnpString_new(). */
+    char* m_buffer;
+    /*! \brief Max. string length excluding terminating null byte ('\0') that
+     * fits into the embedded buffer. */
+    size_t m_capacity;
 };
 
+/*!
+ * \brief Copy a string into the embedded buffer if it fits.
+ *
+ * \returns 1 if the string has been set, otherwise 0.
+ */
+static int set_inline(UpnpString* p, const char* s, size_t len) {
+    if (!p->m_buffer || len > p->m_capacity)
+        return 0;
+    // The source may be the current string itself.
+    memmove(p->m_buffer, s, len);
+    p->m_buffer[len] = '\0';
+    if (p->m_string != p->m_buffer)
+        umock::stdlib_h.free(p->m_string);
+    p->m_string = p->m_buffer;
+    p->m_length = len;
+    return 1;
+}
+
 UpnpString* UpnpString_new() {
     /* All bytes are zero, and so is the length of the string. */
     UpnpString* p =
@@ -105,6 +131,31 @@ error_handler1:
     return NULL;
 }
 
+size_t UpnpString_inlineSize(size_t capacity) {
+    const size_t align = alignof(UpnpString);
+    return (sizeof(UpnpString) + capacity + 1 + align - 1) / align * align;
+}
+
+UpnpString* UpnpString_inlineNew(char** mem, size_t capacity) {
+    UpnpString* p = (UpnpString*)*mem;
+    *mem += UpnpString_inlineSize(capacity);
+    p->m_buffer = (char*)p + sizeof(UpnpString);
+    p->m_buffer[0] = '\0';
+    p->m_capacity = capacity;
+    p->m_string = p->m_buffer;
+    p->m_length = 0;
+    return p;
+}
+
+void UpnpString_inlineDelete(UpnpString* p) {
+    if (!p)
+        return;
+    if (p->m_string != p->m_buffer)
+        umock::stdlib_h.free(p->m_string);
+    p->m_string = NULL;
+    p->m_length = 0;
+}
+
 void UpnpString_delete(UpnpString* p) {
     UpnpString* q = (UpnpString*)p;
 
@@ -171,10 +222,13 @@ const char* UpnpString_get_String(const UpnpString* p) {
 int UpnpString_set_String(UpnpString* p, const char* s) {
     if (!p || !s)
         return 0;
+    if (set_inline(p, s, strlen(s)))
+        return 1;
     char* q = umock::string_h.strdup(s);
     if (!q)
         goto error_handler1;
-    umock::stdlib_h.free(((UpnpString*)p)->m_string);
+    if (p->m_string != p->m_buffer)
+        umock::stdlib_h.free(((UpnpString*)p)->m_string);
     ((UpnpString*)p)->m_length = strlen(q);
     ((UpnpString*)p)->m_string = q;
 
@@ -185,10 +239,13 @@ error_handler1:
 int UpnpString_set_StringN(UpnpString* p, const char* s, size_t n) {
     if (!p || !s)
         return 0;
+    if (set_inline(p, s, strnlen(s, n)))
+        return 1;
     char* q = umock::string_h.strndup(s, n);
     if (!q)
         goto error_handler1;
-    umock::stdlib_h.free(((UpnpString*)p)->m_string);
+    if (p->m_string != p->m_buffer)
+        umock::stdlib_h.free(((UpnpString*)p)->m_string);
     ((UpnpString*)p)->m_length = strlen(q);
     ((UpnpString*)p)->m_string = q;
 
@@ -0,0 +1,266 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup compa-Description
+ * \brief Asynchronous download of description documents with a cache for
+ * control points (for internal use only).
+ */
+
+#include <description_cache.hpp>
+#include <httpreadwrite.hpp>
+#include <statcodes.hpp>
+#include <upnpapi.hpp>
+
+#ifndef COMPA_INTERNAL_CONFIG_HPP
+#error "No or wrong config.hpp header file included."
+#endif
+
+/// \cond
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+/// \endcond
+
+namespace {
+
+/// \brief Clock for the download time of the documents.
+using Clock = std::chrono::steady_clock;
+
+/// \brief Request that waits for a document.
+struct DescWaiter {
+    Upnp_DescriptionFunPtr fun; ///< Function to call with the document.
+    const void* cookie;         ///< User data passed to the function.
+};
+
+/// \brief Entry of the cache.
+struct DescEntry {
+    std::string doc;           ///< Document, empty if not yet downloaded.
+    std::string etag;          ///< ETag of the document.
+    std::string last_modified; ///< Last-Modified date of the document.
+    Clock::time_point fetched; ///< Time of the last download.
+    unsigned long used{};      ///< Use counter for the least recently used.
+    bool in_flight{};          ///< Set while the document is downloading.
+    std::vector<DescWaiter> waiters; ///< Requests for the running download.
+};
+
+/// \brief Mutex to protect the cache and the download queue.
+pthread_mutex_t gDescCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief Entries of the cache with the URL as key.
+std::map<std::string, DescEntry> gDescCache;
+/// \brief URLs waiting for a download job.
+std::deque<std::string> gDescQueue;
+/// \brief Number of running download jobs.
+int gDescJobs{0};
+/// \brief Counter to mark the last use of an entry.
+unsigned long gDescUsed{0};
+
+/*!
+ * \brief Parses a description document.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error:
+ *  - UPNP_E_OUTOF_MEMORY
+ *  - UPNP_E_INVALID_DESC
+ */
+int parse_description(const std::string& a_doc, IXML_Document** a_xml) {
+    const int ret_code{ixmlParseBufferEx(a_doc.c_str(), a_xml)};
+    if (ret_code == IXML_SUCCESS)
+        return UPNP_E_SUCCESS;
+    *a_xml = nullptr;
+    UpnpPrintf(UPNP_CRITICAL, API, __FILE__, __LINE__,
+               "Invalid Description, ixml error code: %d\n", ret_code);
+    return ret_code == IXML_INSUFFICIENT_MEMORY ? UPNP_E_OUTOF_MEMORY
+                                                : UPNP_E_INVALID_DESC;
+}
+
+/// \brief Calls the functions of waiting requests with a document.
+void deliver(int a_ret_code, const std::string& a_url, const std::string& a_doc,
+             const std::vector<DescWaiter>& a_waiters) {
+    for (const DescWaiter& waiter : a_waiters) {
+        IXML_Document* xml{nullptr};
+        int ret_code{a_ret_code};
+        if (ret_code == UPNP_E_SUCCESS)
+            ret_code = parse_description(a_doc, &xml);
+        waiter.fun(ret_code, a_url.c_str(), xml, waiter.cookie);
+    }
+}
+
+/*!
+ * \brief Removes the least recently used documents if the cache is full.
+ *
+ * \note The caller must hold the cache mutex.
+ */
+void evict_entries() {
+    while (gDescCache.size() > DESCRIPTION_CACHE_SIZE) {
+        auto lru{gDescCache.end()};
+        for (auto it{gDescCache.begin()}; it != gDescCache.end(); ++it) {
+            if (!it->second.in_flight &&
+                (lru == gDescCache.end() || it->second.used < lru->second.used))
+                lru = it;
+        }
+        if (lru == gDescCache.end())
+            break;
+        gDescCache.erase(lru);
+    }
+}
+
+/*!
+ * \brief Stores the result of a download and finishes all requests that wait
+ * for it.
+ */
+void complete_fetch(
+    /*! [in] URL of the document. */
+    const std::string& a_url,
+    /*! [in] Return code of http_DownloadIfModified(). */
+    int a_ret_code,
+    /*! [in] Downloaded document or nullptr. It is freed. */
+    char* a_document,
+    /*! [in] ETag of the downloaded document. */
+    const char* a_etag,
+    /*! [in] Last-Modified date of the downloaded document. */
+    const char* a_last_modified) {
+    std::vector<DescWaiter> waiters;
+    std::string doc;
+
+    pthread_mutex_lock(&gDescCacheMutex);
+    auto it{gDescCache.find(a_url)};
+    if (it == gDescCache.end()) {
+        // The cache was cleared.
+        pthread_mutex_unlock(&gDescCacheMutex);
+        free(a_document);
+        return;
+    }
+    DescEntry& entry{it->second};
+    if (a_ret_code == UPNP_E_SUCCESS) {
+        entry.doc.assign(a_document != nullptr ? a_document : "");
+        entry.etag.assign(a_etag);
+        entry.last_modified.assign(a_last_modified);
+        entry.fetched = Clock::now();
+    } else if (a_ret_code == HTTP_NOT_MODIFIED && !entry.doc.empty()) {
+        a_ret_code = UPNP_E_SUCCESS;
+        entry.fetched = Clock::now();
+    } else if (a_ret_code > 0) {
+        /* error reply was received */
+        a_ret_code = UPNP_E_INVALID_URL;
+    }
+    entry.in_flight = false;
+    waiters.swap(entry.waiters);
+    doc = entry.doc;
+    if (a_ret_code != UPNP_E_SUCCESS)
+        gDescCache.erase(it);
+    pthread_mutex_unlock(&gDescCacheMutex);
+    free(a_document);
+
+    deliver(a_ret_code, a_url, doc, waiters);
+}
+
+/// \brief Downloads a document, conditional if it is cached.
+void fetch_description(const std::string& a_url) {
+    char etag[LINE_SIZE]{};
+    char last_modified[LINE_SIZE]{};
+    char content_type[LINE_SIZE];
+    char* document{nullptr};
+    size_t doc_length;
+
+    pthread_mutex_lock(&gDescCacheMutex);
+    auto it{gDescCache.find(a_url)};
+    if (it != gDescCache.end() && !it->second.doc.empty()) {
+        it->second.etag.copy(etag, LINE_SIZE - 1);
+        it->second.last_modified.copy(last_modified, LINE_SIZE - 1);
+    }
+    pthread_mutex_unlock(&gDescCacheMutex);
+
+    const int ret_code{http_DownloadIfModified(
+        a_url.c_str(), HTTP_DEFAULT_TIMEOUT, etag, last_modified, &document,
+        &doc_length, content_type)};
+    complete_fetch(a_url, ret_code, document, etag, last_modified);
+}
+
+/// \brief Download job that works on the queue until it is empty.
+void fetch_job(void*) {
+    pthread_mutex_lock(&gDescCacheMutex);
+    while (!gDescQueue.empty()) {
+        const std::string url{std::move(gDescQueue.front())};
+        gDescQueue.pop_front();
+        pthread_mutex_unlock(&gDescCacheMutex);
+        fetch_description(url);
+        pthread_mutex_lock(&gDescCacheMutex);
+    }
+    gDescJobs--;
+    pthread_mutex_unlock(&gDescCacheMutex);
+}
+
+} // anonymous namespace
+
+
+int description_fetch(const char* a_url, Upnp_DescriptionFunPtr a_fun,
+                      const void* a_cookie) {
+    int ret_code{UPNP_E_SUCCESS};
+
+    pthread_mutex_lock(&gDescCacheMutex);
+    auto [it, inserted] = gDescCache.try_emplace(a_url);
+    DescEntry& entry{it->second};
+    entry.used = ++gDescUsed;
+    if (entry.in_flight) {
+        // Wait for the running download.
+        entry.waiters.push_back({a_fun, a_cookie});
+        pthread_mutex_unlock(&gDescCacheMutex);
+        return UPNP_E_SUCCESS;
+    }
+    if (!entry.doc.empty() &&
+        Clock::now() - entry.fetched <
+            std::chrono::seconds(DESCRIPTION_CACHE_FRESH_TIME)) {
+        const std::string doc{entry.doc};
+        pthread_mutex_unlock(&gDescCacheMutex);
+        deliver(UPNP_E_SUCCESS, a_url, doc, {{a_fun, a_cookie}});
+        return UPNP_E_SUCCESS;
+    }
+
+    entry.in_flight = true;
+    entry.waiters.push_back({a_fun, a_cookie});
+    gDescQueue.emplace_back(a_url);
+    if (inserted)
+        evict_entries();
+    if (gDescJobs < DESCRIPTION_FETCH_JOBS) {
+        ThreadPoolJob job;
+        memset(&job, 0, sizeof(job));
+        TPJobInit(&job, (UPnPsdk::start_routine)fetch_job, nullptr);
+        TPJobSetPriority(&job, MED_PRIORITY);
+        if (ThreadPoolAdd(&gSendThreadPool, &job, nullptr) == 0) {
+            gDescJobs++;
+        } else if (gDescJobs == 0) {
+            // No job would ever download the document.
+            gDescQueue.pop_back();
+            entry.waiters.pop_back();
+            entry.in_flight = false;
+            if (entry.doc.empty())
+                gDescCache.erase(it);
+            ret_code = UPNP_E_OUTOF_MEMORY;
+        }
+    }
+    pthread_mutex_unlock(&gDescCacheMutex);
+
+    return ret_code;
+}
+
+void description_cache_clear() {
+    std::vector<std::pair<std::string, std::vector<DescWaiter>>> pending;
+
+    pthread_mutex_lock(&gDescCacheMutex);
+    for (auto& [url, entry] : gDescCache) {
+        if (!entry.waiters.empty())
+            pending.emplace_back(url, std::move(entry.waiters));
+    }
+    gDescCache.clear();
+    gDescQueue.clear();
+    gDescJobs = 0;
+    pthread_mutex_unlock(&gDescCacheMutex);
+
+    for (const auto& [url, waiters] : pending)
+        deliver(UPNP_E_FINISH, url, std::string(), waiters);
+}
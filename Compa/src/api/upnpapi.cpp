@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-05-10
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -42,9 +42,13 @@
 
 #include <uuid.hpp>
 #include <miniserver.hpp> // Needed for one of the compile options
+#include <description_cache.hpp>
 #include <httpreadwrite.hpp>
+#include <metrics.hpp>
+#include <ssdp_cache.hpp>
 #include <ssdp_ctrlpt.hpp>
 #include <ssdp_device.hpp>
+#include <ssdp_filter.hpp>
 #include <soap_device.hpp>
 #include <soap_ctrlpt.hpp>
 
@@ -61,6 +65,8 @@
 
 /* Needed for GENA */
 #include <gena.hpp>
+#include <gena_notify.hpp>
+#include <ObjectPool.hpp>
 
 #ifdef COMPA_HAVE_WEBSERVER
 #include <urlconfig.hpp>
@@ -70,6 +76,7 @@
 #include <sys/stat.h>
 
 #include <cassert>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
 
@@ -116,6 +123,22 @@ ThreadPool gRecvThreadPool;
 /*! \brief Mini server thread pool. */
 ThreadPool gMiniServerThreadPool;
 
+/*! \brief Limits of the thread pools, indexed by enum Upnp_ThreadPool and
+ * set with UpnpSetThreadPoolLimits(). */
+static struct {
+    ThreadPool* tp;
+    int minThreads;
+    int maxThreads;
+    int targetWaitTime;
+#ifdef TP_HAVE_AFFINITY
+    cpu_set_t cpuSet{}; // set with UpnpSetThreadPoolCpus()
+#endif
+} threadPoolLimits[UPNP_THREADPOOL_COUNT]{
+    {&gSendThreadPool, MIN_THREADS, MAX_THREADS, THREAD_TARGET_WAIT_TIME},
+    {&gRecvThreadPool, MIN_THREADS, MAX_THREADS, THREAD_TARGET_WAIT_TIME},
+    {&gMiniServerThreadPool, MIN_THREADS, MAX_THREADS,
+     THREAD_TARGET_WAIT_TIME}};
+
 /*! \brief Flag to indicate the state of web server */
 WebServerState bWebServerState = WEB_SERVER_DISABLED;
 
@@ -184,6 +207,29 @@ int g_UpnpSdkEQMaxLen = MAX_SUBSCRIPTION_QUEUED_EVENTS;
  * standard, at the price of higher potential memory use. */
 int g_UpnpSdkEQMaxAge = MAX_SUBSCRIPTION_EVENT_AGE;
 
+/*! \brief Global variable to enable the event driven GENA notify engine.
+ *
+ * If set, UpnpInit2() starts the engine and NOTIFY requests are delivered by
+ * it on non-blocking sockets instead of blocking a send thread for each
+ * request. Set with UpnpSetAsyncEventDelivery(). */
+int g_UpnpSdkAsyncNotify = 0;
+
+/*! \brief Global variable to enable coalescing of queued events.
+ *
+ * If set, a new event is merged into the last not yet active event on the
+ * queue of a subscription so that only the last value of a state variable is
+ * sent. Set with UpnpSetEventCoalescing() at any time, so it is atomic. */
+std::atomic<int> g_UpnpSdkEQCoalesce{0};
+
+/*! \brief Global variable with the maximal number of replied search requests
+ * per second and source address, 0 if unlimited. Set with
+ * UpnpSetSsdpReplyRateLimit(). */
+int g_UpnpSdkSsdpReplyLimit = SSDP_REPLY_RATE_LIMIT;
+
+/*! \brief Global variable with the number of listening sockets per local
+ * address of the miniserver. Set with UpnpSetMiniServerAcceptors(). */
+int g_UpnpSdkMiniServerAcceptors = MINISERVER_ACCEPTORS;
+
 /*! \brief Global variable to denote the state of Upnp SDK == 0 if
  * uninitialized, == 1 if initialized. */
 int UpnpSdkInit = 0;
@@ -589,6 +635,9 @@ int UpnpRegisterRootDevice3(const char* const DescUrl, const Upnp_FunPtr Fun,
     default:
         UpnpSdkDeviceregisteredV6 = 1;
     }
+#ifdef COMPA_HAVE_DEVICE_SSDP
+    ssdp_filter_update();
+#endif
 
     retVal = UPNP_E_SUCCESS;
 
@@ -673,26 +722,27 @@ static int UpnpInitThreadPools() {
     ThreadPoolAttr attr;
 
     TPAttrInit(&attr);
-    TPAttrSetMaxThreads(&attr, MAX_THREADS);
-    TPAttrSetMinThreads(&attr, MIN_THREADS);
     TPAttrSetStackSize(&attr, THREAD_STACK_SIZE);
     TPAttrSetJobsPerThread(&attr, JOBS_PER_THREAD);
     TPAttrSetIdleTime(&attr, THREAD_IDLE_TIME);
     TPAttrSetMaxJobsTotal(&attr, maxJobsTotal);
 
-    if (ThreadPoolInit(&gSendThreadPool, &attr) != UPNP_E_SUCCESS) {
-        ret = UPNP_E_INIT_FAILED;
-        goto exit_function;
-    }
-
-    if (ThreadPoolInit(&gRecvThreadPool, &attr) != UPNP_E_SUCCESS) {
-        ret = UPNP_E_INIT_FAILED;
-        goto exit_function;
-    }
-
-    if (ThreadPoolInit(&gMiniServerThreadPool, &attr) != UPNP_E_SUCCESS) {
-        ret = UPNP_E_INIT_FAILED;
-        goto exit_function;
+    for (int i{0}; i < UPNP_THREADPOOL_COUNT; i++) {
+        TPAttrSetMinThreads(&attr, threadPoolLimits[i].minThreads);
+        TPAttrSetMaxThreads(&attr, threadPoolLimits[i].maxThreads);
+        TPAttrSetTargetWaitTime(&attr, threadPoolLimits[i].targetWaitTime);
+#ifdef TP_HAVE_AFFINITY
+        const cpu_set_t* cpus{&threadPoolLimits[i].cpuSet};
+        // SSDP messages received by the miniserver thread are handled on the
+        // recv pool. Keep them on the same CPUs if not set otherwise.
+        if (i == UPNP_THREADPOOL_RECV && CPU_COUNT(cpus) == 0)
+            cpus = &threadPoolLimits[UPNP_THREADPOOL_MINISERVER].cpuSet;
+        TPAttrSetCpuSet(&attr, cpus);
+#endif
+        if (ThreadPoolInit(threadPoolLimits[i].tp, &attr) != UPNP_E_SUCCESS) {
+            ret = UPNP_E_INIT_FAILED;
+            goto exit_function;
+        }
     }
 
 exit_function:
@@ -770,6 +820,19 @@ static int UpnpInitPreamble() {
 
         return retVal;
     }
+    compa::metrics_threads_enable(true);
+
+#ifdef COMPA_HAVE_DEVICE_GENA
+    /* Start the GENA notify engine if enabled. */
+    if (g_UpnpSdkAsyncNotify) {
+        retVal = genaNotifyEngineStart(&gSendThreadPool);
+        if (retVal != UPNP_E_SUCCESS) {
+            UpnpFinish();
+
+            return retVal;
+        }
+    }
+#endif
 
     return UPNP_E_SUCCESS;
 }
@@ -812,6 +875,78 @@ static int UpnpInitStartServers(
     return UPNP_E_SUCCESS;
 }
 
+int UpnpSetThreadPoolLimits(Upnp_ThreadPool pool, int minThreads,
+                            int maxThreads, int targetWaitTime) {
+    int retVal = UPNP_E_SUCCESS;
+
+    if (pool < 0 || pool >= UPNP_THREADPOOL_COUNT || minThreads < 1 ||
+        maxThreads < minThreads || targetWaitTime < 0)
+        return UPNP_E_INVALID_PARAM;
+
+    if (pthread_mutex_lock(&compa::sdkInit_mutex) != 0)
+        return UPNP_E_INIT_FAILED;
+    if (UpnpSdkInit == 1) {
+        retVal = UPNP_E_INIT;
+    } else {
+        threadPoolLimits[pool].minThreads = minThreads;
+        threadPoolLimits[pool].maxThreads = maxThreads;
+        threadPoolLimits[pool].targetWaitTime = targetWaitTime;
+    }
+    pthread_mutex_unlock(&compa::sdkInit_mutex);
+
+    return retVal;
+}
+
+int UpnpSetThreadPoolCpus(Upnp_ThreadPool pool, const char* cpus) {
+#ifdef TP_HAVE_AFFINITY
+    int retVal = UPNP_E_SUCCESS;
+    cpu_set_t cpuSet;
+    const char* p = cpus;
+
+    if (pool < 0 || pool >= UPNP_THREADPOOL_COUNT)
+        return UPNP_E_INVALID_PARAM;
+    CPU_ZERO(&cpuSet);
+    // Parse a list like "0-3,8,10-11".
+    while (p && *p) {
+        char* end;
+        const unsigned long first = strtoul(p, &end, 10);
+        unsigned long last = first;
+        if (end == p || !isdigit(static_cast<unsigned char>(*p)))
+            return UPNP_E_INVALID_PARAM;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtoul(p, &end, 10);
+            if (end == p || !isdigit(static_cast<unsigned char>(*p)))
+                return UPNP_E_INVALID_PARAM;
+            p = end;
+        }
+        if (last < first || last >= CPU_SETSIZE)
+            return UPNP_E_INVALID_PARAM;
+        for (unsigned long cpu = first; cpu <= last; cpu++)
+            CPU_SET(cpu, &cpuSet);
+        if (*p == ',' && *(p + 1) != '\0')
+            p++;
+        else if (*p != '\0')
+            return UPNP_E_INVALID_PARAM;
+    }
+
+    if (pthread_mutex_lock(&compa::sdkInit_mutex) != 0)
+        return UPNP_E_INIT_FAILED;
+    if (UpnpSdkInit == 1)
+        retVal = UPNP_E_INIT;
+    else
+        threadPoolLimits[pool].cpuSet = cpuSet;
+    pthread_mutex_unlock(&compa::sdkInit_mutex);
+
+    return retVal;
+#else
+    (void)pool;
+    (void)cpus;
+    return UPNP_E_INVALID_PARAM;
+#endif
+}
+
 int UpnpInit2(const char* IfName, unsigned short DestPort) {
     UPnPsdk_LOGINFO("MSG1096") "Executing...\n";
     int retVal;
@@ -920,6 +1055,8 @@ int UpnpFinish() {
         return UPNP_E_FINISH;
     UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
                "UpnpFinish: UpnpSdkInit is ONE\n");
+    // Wait for an export of the metrics that reads the thread pools.
+    compa::metrics_threads_enable(false);
     // May be usable for DEBUG:
     // PrintThreadPoolStats(&gSendThreadPool, __FILE__, __LINE__,
     //                      "Send Thread Pool");
@@ -943,6 +1080,12 @@ int UpnpFinish() {
     }
 #endif
     TimerThreadShutdown(&gTimerThread);
+#ifdef COMPA_HAVE_CTRLPT_SSDP
+    ssdp_cache_clear();
+#endif
+#ifdef COMPA_HAVE_DEVICE_GENA
+    genaNotifyEngineStop();
+#endif
 #ifdef COMPA_HAVE_MINISERVER
     StopMiniServer();
 #endif
@@ -958,9 +1101,13 @@ int UpnpFinish() {
     ThreadPoolShutdown(&gSendThreadPool);
     PrintThreadPoolStats(&gRecvThreadPool, __FILE__, __LINE__,
                          "Recv Thread Pool");
+#ifdef COMPA_HAVE_CTRLPT_DESCRIPTION
+    description_cache_clear();
+#endif
 #ifdef COMPA_HAVE_CTRLPT_GENA
     clientSubscribeMutexDestroy();
 #endif
+    ObjectPoolTrim();
     pthread_rwlock_destroy(&GlobalHndRWLock);
 #ifdef COMPA_HAVE_OPTION_SSDP
     uuidMutexDestroy(); // May fail but not checked due to compatibility.
@@ -1157,6 +1304,9 @@ int UpnpRegisterRootDevice(const char* const DescUrl, const Upnp_FunPtr Fun,
 #endif // COMPA_HAVE_DEVICE_GENA
 
     UpnpSdkDeviceRegisteredV4 = 1;
+#ifdef COMPA_HAVE_DEVICE_SSDP
+    ssdp_filter_update();
+#endif
 
     retVal = UPNP_E_SUCCESS;
 
@@ -1320,6 +1470,9 @@ int UpnpRegisterRootDevice2(const Upnp_DescType descriptionType,
 #endif // COMPA_HAVE_DEVICE_GENA
 
     UpnpSdkDeviceRegisteredV4 = 1;
+#ifdef COMPA_HAVE_DEVICE_SSDP
+    ssdp_filter_update();
+#endif
 
     retVal = UPNP_E_SUCCESS;
 
@@ -1387,6 +1540,9 @@ int UpnpUnRegisterRootDeviceLowPower(UpnpDevice_Handle Hnd, int PowerState,
         SleepPeriod = -1;
     HInfo->SleepPeriod = SleepPeriod;
     HInfo->RegistrationState = RegistrationState;
+#ifdef COMPA_HAVE_DEVICE_SSDP
+    ssdp_device_send_update(HInfo);
+#endif
     HandleUnlock();
 
     retVal = AdvertiseAndReply(-1, Hnd, (enum SsdpSearchType)0,
@@ -1421,7 +1577,13 @@ int UpnpUnRegisterRootDeviceLowPower(UpnpDevice_Handle Hnd, int PowerState,
     default:
         break;
     }
+#ifdef COMPA_HAVE_DEVICE_SSDP
+    ssdp_device_send_free(HInfo);
+#endif
     FreeHandle(Hnd);
+#ifdef COMPA_HAVE_DEVICE_SSDP
+    ssdp_filter_update();
+#endif
     HandleUnlock();
 
     UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
@@ -1468,9 +1630,13 @@ int UpnpRegisterClient(Upnp_FunPtr Fun, const void* Cookie,
     HInfo->MaxAge = 0;
     HInfo->MaxSubscriptions = UPNP_INFINITE;
     HInfo->MaxSubscriptionTimeOut = UPNP_INFINITE;
+    HInfo->SsdpSend = NULL;
 #endif
     HandleTable[*Hnd] = HInfo;
     UpnpSdkClientRegistered += 1;
+#ifdef COMPA_HAVE_CTRLPT_SSDP
+    ssdp_filter_update();
+#endif
     HandleUnlock();
 
     UpnpPrintf(UPNP_ALL, API, __FILE__, __LINE__,
@@ -1522,6 +1688,9 @@ int UpnpUnRegisterClient(UpnpClient_Handle Hnd) {
     ListDestroy(&HInfo->SsdpSearchList, 0);
     FreeHandle(Hnd);
     UpnpSdkClientRegistered -= 1;
+#ifdef COMPA_HAVE_CTRLPT_SSDP
+    ssdp_filter_update();
+#endif
     HandleUnlock();
 
     UpnpPrintf(UPNP_ALL, API, __FILE__, __LINE__,
@@ -1782,6 +1951,7 @@ int UpnpSendAdvertisementLowPower(UpnpDevice_Handle Hnd, int Exp,
         SleepPeriod = -1;
     SInfo->SleepPeriod = SleepPeriod;
     SInfo->RegistrationState = RegistrationState;
+    ssdp_device_send_update(SInfo);
     HandleUnlock();
     retVal = AdvertiseAndReply(1, Hnd, (enum SsdpSearchType)0,
                                (struct sockaddr*)NULL, (char*)NULL, (char*)NULL,
@@ -1843,6 +2013,14 @@ int UpnpSendAdvertisementLowPower(UpnpDevice_Handle Hnd, int Exp,
 
     return retVal;
 }
+
+int UpnpSetSsdpReplyRateLimit(int repliesPerSecond) {
+    if (repliesPerSecond < 0)
+        return UPNP_E_INVALID_PARAM;
+    g_UpnpSdkSsdpReplyLimit = repliesPerSecond;
+
+    return UPNP_E_SUCCESS;
+}
 #endif /* COMPA_HAVE_DEVICE_SSDP */
 
 #ifdef COMPA_HAVE_CTRLPT_SSDP
@@ -1883,6 +2061,23 @@ int UpnpSearchAsync(UpnpClient_Handle Hnd, int Mx, const char* Target_const,
 
     return UPNP_E_SUCCESS;
 }
+
+int UpnpSetDiscoveryCache(int enable) {
+    ssdp_cache_enable(enable != 0);
+
+    return UPNP_E_SUCCESS;
+}
+
+int UpnpGetDiscoveredDevices(Upnp_FunPtr Fun, const void* Cookie) {
+    if (UpnpSdkInit != 1)
+        return UPNP_E_FINISH;
+    if (Fun == nullptr)
+        return UPNP_E_INVALID_PARAM;
+
+    ssdp_cache_get(Fun, (void*)Cookie);
+
+    return UPNP_E_SUCCESS;
+}
 #endif /* COMPA_HAVE_CTRLPT_SSDP */
 
 /*******************************************************************************
@@ -1961,6 +2156,28 @@ int UpnpSetMaxSubscriptionTimeOut(UpnpDevice_Handle Hnd,
 }
 #endif /* COMPA_HAVE_DEVICE_GENA */
 
+#ifdef COMPA_HAVE_DEVICE_GENA
+int UpnpSetAsyncEventDelivery(int enable) {
+    int retVal = UPNP_E_SUCCESS;
+
+    if (pthread_mutex_lock(&compa::sdkInit_mutex) != 0)
+        return UPNP_E_INIT_FAILED;
+    if (UpnpSdkInit == 1)
+        retVal = UPNP_E_INIT;
+    else
+        g_UpnpSdkAsyncNotify = enable ? 1 : 0;
+    pthread_mutex_unlock(&compa::sdkInit_mutex);
+
+    return retVal;
+}
+
+int UpnpSetEventCoalescing(int enable) {
+    g_UpnpSdkEQCoalesce.store(enable ? 1 : 0, std::memory_order_relaxed);
+
+    return UPNP_E_SUCCESS;
+}
+#endif /* COMPA_HAVE_DEVICE_GENA */
+
 #ifdef COMPA_HAVE_CTRLPT_GENA
 int UpnpSubscribe(UpnpClient_Handle Hnd, const char* EvtUrl_const, int* TimeOut,
                   Upnp_SID SubsId) {
@@ -2407,6 +2624,43 @@ int UpnpNotifyExt(UpnpDevice_Handle Hnd, const char* DevID_const,
 }
 #endif /* COMPA_HAVE_DEVICE_GENA */
 
+#ifdef COMPA_HAVE_DEVICE_GENA
+int UpnpNotifyPropertySet(UpnpDevice_Handle Hnd, const char* DevID,
+                          const char* ServName,
+                          const UpnpPropertySet* PropSet) {
+    struct Handle_Info* SInfo = NULL;
+    int retVal;
+
+    if (UpnpSdkInit != 1) {
+        return UPNP_E_FINISH;
+    }
+
+    UpnpPrintf(UPNP_ALL, API, __FILE__, __LINE__,
+               "Inside UpnpNotifyPropertySet \n");
+
+    HandleReadLock();
+    switch (GetHandleInfo(Hnd, &SInfo)) {
+    case HND_DEVICE:
+        break;
+    default:
+        HandleUnlock();
+        return UPNP_E_INVALID_HANDLE;
+    }
+    if (DevID == NULL || ServName == NULL || PropSet == NULL) {
+        HandleUnlock();
+        return UPNP_E_INVALID_PARAM;
+    }
+
+    HandleUnlock();
+    retVal = genaNotifyAllPropertySet(Hnd, DevID, ServName, PropSet);
+
+    UpnpPrintf(UPNP_ALL, API, __FILE__, __LINE__,
+               "Exiting UpnpNotifyPropertySet \n");
+
+    return retVal;
+}
+#endif /* COMPA_HAVE_DEVICE_GENA */
+
 #ifdef COMPA_HAVE_DEVICE_GENA
 int UpnpAcceptSubscription(UpnpDevice_Handle Hnd, const char* DevID_const,
                            const char* ServName_const,
@@ -3161,6 +3415,19 @@ int UpnpDownloadXmlDoc(const char* url, IXML_Document** xmlDoc) {
     }
 }
 
+#ifdef COMPA_HAVE_CTRLPT_DESCRIPTION
+int UpnpDownloadXmlDocAsync(const char* url, Upnp_DescriptionFunPtr Fun,
+                            const void* Cookie) {
+    TRACE("Executing UpnpDownloadXmlDocAsync()")
+    if (UpnpSdkInit != 1)
+        return UPNP_E_FINISH;
+    if (url == nullptr || Fun == nullptr)
+        return UPNP_E_INVALID_PARAM;
+
+    return description_fetch(url, Fun, Cookie);
+}
+#endif
+
 /*!
  * \brief Schedule async functions in threadpool.
  */
@@ -3690,3 +3957,22 @@ int UpnpSetMaxContentLength(size_t contentLength) {
 
     return errCode;
 }
+
+#ifdef COMPA_HAVE_WEBSERVER
+int UpnpSetMiniServerAcceptors(int count) {
+    int retVal = UPNP_E_SUCCESS;
+
+    if (count < 1 || count > MINISERVER_MAX_ACCEPTORS)
+        return UPNP_E_INVALID_PARAM;
+
+    if (pthread_mutex_lock(&compa::sdkInit_mutex) != 0)
+        return UPNP_E_INIT_FAILED;
+    if (UpnpSdkInit == 1)
+        retVal = UPNP_E_INIT;
+    else
+        g_UpnpSdkMiniServerAcceptors = count;
+    pthread_mutex_unlock(&compa::sdkInit_mutex);
+
+    return retVal;
+}
+#endif // COMPA_HAVE_WEBSERVER
@@ -3,7 +3,7 @@
  * Copyright (c) 2000-2003 Intel Corporation
  * All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-05-06
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -45,8 +45,11 @@
 #include <umock/stdio.hpp>
 
 /// \cond
+#include <atomic>
 #include <cstdarg>
 #include <cstring>
+#include <new>
+#include <thread>
 /// \endcond
 
 namespace {
@@ -54,6 +57,68 @@ namespace {
 /*! Mutex to synchronize all the log file operations in the debug mode */
 pthread_mutex_t debug_mutex;
 
+/*! \name Asynchronous logging
+ * With UpnpSetLogAsync() every thread that logs gets its own single producer
+ * single consumer ring buffer. UpnpPrintf() only formats the message into the
+ * next free record of the ring without any lock. A background writer thread
+ * drains all rings, formats the header and writes to the log file. If a ring
+ * is full the message is dropped and counted.
+ * @{ */
+/// \brief Number of records in the ring buffer of one thread (power of 2).
+constexpr size_t LOG_RING_SIZE{128};
+/// \brief Maximal length of one formatted message including null byte.
+constexpr size_t LOG_MSG_SIZE{512};
+/// \brief Interval in milliseconds the writer thread polls the rings.
+constexpr long LOG_WRITER_INTERVAL_MS{20};
+
+/// \brief One log message, encoded by the calling thread.
+struct LogRecord {
+    time_t time;                 ///< Time of the call.
+    unsigned long long thread;   ///< Id of the calling thread.
+    const char* file;            ///< Static source file name.
+    int line;                    ///< Source line number.
+    Upnp_LogLevel level;         ///< Log level.
+    Dbg_Module module;           ///< Program module.
+    char msg[LOG_MSG_SIZE];      ///< Formatted message.
+};
+
+/// \brief Ring buffer of one thread.
+struct LogRing {
+    /// \brief Next record to write, only modified by the owning thread.
+    std::atomic<size_t> head{0};
+    /// \brief Next record to read, only modified by the writer.
+    std::atomic<size_t> tail{0};
+    /// \brief Next ring in the list of all rings.
+    LogRing* next{nullptr};
+    /// \brief The records.
+    LogRecord rec[LOG_RING_SIZE];
+};
+
+/*! \brief Protects the list of rings, writing the rings to the log file and
+ * opening or closing the log file. It is never taken on the logging path of a
+ * thread. */
+pthread_mutex_t log_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief Condition to wake up the writer thread for termination.
+pthread_cond_t log_writer_cond = PTHREAD_COND_INITIALIZER;
+/// \brief List of all rings.
+LogRing* log_rings{nullptr};
+/// \brief Set by UpnpSetLogAsync().
+bool log_async_wanted{false};
+/// \brief The writer thread is running and takes messages.
+std::atomic<bool> log_async_running{false};
+/*! \brief Number of threads that have seen the writer running and put a
+ * message into their ring buffer. */
+std::atomic<int> log_pushers{0};
+/// \brief Request to the writer thread to terminate.
+bool log_writer_stop{false};
+/// \brief The writer thread.
+pthread_t log_writer_thread;
+/// \brief Number of messages dropped because a ring was full.
+std::atomic<unsigned long> log_dropped{0};
+/// \brief Number of dropped messages already reported in the log.
+unsigned long log_dropped_reported{0};
+/// @}
+
 } // namespace
 
 
@@ -70,6 +135,9 @@ static int initwascalled;
 /*! Name of the output file. We keep a copy */
 static char* fileName;
 
+static void UpnpLogWriterStart();
+static void UpnpLogWriterStop();
+
 /* This is called from UpnpInit2(). So the user must call UpnpSetLogFileNames()
  * before. This can be called again, for example to rotate the log
  * file, and we try to avoid multiple calls to the mutex init, with a
@@ -85,6 +153,11 @@ int UpnpInitLog() {
         return UPNP_E_SUCCESS;
     }
 
+    // The writer thread must not use the file while it is reopened.
+    UpnpLogWriterStop();
+
+    // A thread that exits still writes its ring buffer to the file.
+    pthread_mutex_lock(&log_ring_mutex);
     if (filed != nullptr && filed != stderr) {
         umock::stdio_h.fclose(filed);
         filed = nullptr;
@@ -103,6 +176,9 @@ int UpnpInitLog() {
     // If not set, always set to stderr, also as fallback for a wrong fileName.
     if (filed == nullptr)
         filed = stderr;
+    pthread_mutex_unlock(&log_ring_mutex);
+
+    UpnpLogWriterStart();
 
     return UPNP_E_SUCCESS;
 }
@@ -116,16 +192,21 @@ void UpnpSetLogLevel(Upnp_LogLevel log_level) {
 void UpnpCloseLog() {
     TRACE("Executing UpnpCloseLog()")
 
+    // Write pending messages before closing the file.
+    UpnpLogWriterStop();
+
     /* Calling lock() assumes that someone called UpnpInitLog(), but
      * this is reasonable as it is called from UpnpInit2(). We risk a
      * crash if we do this without a lock.*/
     if (initwascalled)
         umock::pthread_h.pthread_mutex_lock(&debug_mutex);
 
+    pthread_mutex_lock(&log_ring_mutex);
     if (filed != nullptr && filed != stderr) {
         umock::stdio_h.fclose(filed);
     }
     filed = nullptr;
+    pthread_mutex_unlock(&log_ring_mutex);
     setlogwascalled = 0;
     int init_called = initwascalled;
     initwascalled = 0;
@@ -159,12 +240,21 @@ static int DebugAtThisLevel(Upnp_LogLevel DLevel, Dbg_Module Module) {
             (Module == HTTP && DEBUG_HTTP));
 }
 
+/// \brief Returns the id of the calling thread for the log output.
+static unsigned long long UpnpLogThreadId() {
+#ifdef __PTW32_DLLPORT
+    return *(unsigned long long int*)pthread_self().p;
+#else
+    return (unsigned long long int)pthread_self();
+#endif
+}
+
 /// \brief Display File and Line.
 static void UpnpDisplayFileAndLine(FILE* a_fp, const char* DbgFileName,
                                    int DbgLineNo, Upnp_LogLevel DLevel,
-                                   Dbg_Module Module) {
+                                   Dbg_Module Module, time_t now,
+                                   unsigned long long thread) {
     char timebuf[26];
-    time_t now = time(NULL);
     const char* smod;
 #if 0
 	char *slev;
@@ -231,15 +321,200 @@ static void UpnpDisplayFileAndLine(FILE* a_fp, const char* DbgFileName,
 #endif
 
     fprintf(a_fp, "%s UPNP-%s-%s: Thread:0x%llX [%s:%d]: ", timebuf, smod, slev,
-#ifdef __PTW32_DLLPORT
-            *(unsigned long long int*)pthread_self().p
-#else
-            (unsigned long long int)pthread_self()
-#endif
-            ,
-            DbgFileName, DbgLineNo);
+            thread, DbgFileName, DbgLineNo);
+}
+
+namespace {
+
+/// \brief Owner of the ring buffer of a thread, frees it on thread exit.
+struct LogRingOwner {
+    /// \brief The ring buffer or nullptr if the thread never logged async.
+    LogRing* ring{nullptr};
+
+    ~LogRingOwner();
+};
+
+/// \brief Ring buffer of the calling thread.
+thread_local LogRingOwner log_ring_owner;
+
+} // namespace
+
+/*!
+ * \brief Writes all records of a ring to the log file.
+ *
+ * Must be called with log_ring_mutex locked.
+ *
+ * \return Number of written records.
+ */
+static size_t UpnpLogDrainRing(LogRing* a_ring) {
+    size_t tail = a_ring->tail.load(std::memory_order_relaxed);
+    size_t head = a_ring->head.load(std::memory_order_acquire);
+    size_t count = head - tail;
+
+    for (; tail != head; tail++) {
+        const LogRecord& rec = a_ring->rec[tail & (LOG_RING_SIZE - 1)];
+        if (filed != nullptr) {
+            UpnpDisplayFileAndLine(filed, rec.file, rec.line, rec.level,
+                                   rec.module, rec.time, rec.thread);
+            fputs(rec.msg, filed);
+        }
+    }
+    a_ring->tail.store(tail, std::memory_order_release);
+
+    return count;
+}
+
+/*!
+ * \brief Writes all pending records of all threads and reports dropped
+ * messages.
+ *
+ * Must be called with log_ring_mutex locked.
+ */
+static void UpnpLogDrainAll() {
+    size_t count{};
+
+    for (LogRing* ring = log_rings; ring != nullptr; ring = ring->next)
+        count += UpnpLogDrainRing(ring);
+
+    unsigned long dropped = log_dropped.load(std::memory_order_relaxed);
+    if (dropped != log_dropped_reported && filed != nullptr) {
+        fprintf(filed, "UPnPsdk: %lu log messages dropped, buffer full.\n",
+                dropped - log_dropped_reported);
+        log_dropped_reported = dropped;
+        count++;
+    }
+    if (count > 0 && filed != nullptr && filed != stderr)
+        fflush(filed);
 }
 
+LogRingOwner::~LogRingOwner() {
+    if (this->ring == nullptr)
+        return;
+
+    pthread_mutex_lock(&log_ring_mutex);
+    LogRing** pp = &log_rings;
+    while (*pp != this->ring)
+        pp = &(*pp)->next;
+    *pp = this->ring->next;
+    // Don't lose the last messages of the thread.
+    UpnpLogDrainRing(this->ring);
+    pthread_mutex_unlock(&log_ring_mutex);
+
+    delete this->ring;
+}
+
+/// \brief Returns the ring buffer of the calling thread, creates it if needed.
+static LogRing* UpnpLogGetRing() {
+    if (log_ring_owner.ring == nullptr) {
+        LogRing* ring = new (std::nothrow) LogRing;
+        if (ring == nullptr)
+            return nullptr;
+        pthread_mutex_lock(&log_ring_mutex);
+        ring->next = log_rings;
+        log_rings = ring;
+        pthread_mutex_unlock(&log_ring_mutex);
+        log_ring_owner.ring = ring;
+    }
+    return log_ring_owner.ring;
+}
+
+/// \brief The background thread that writes the log records.
+static void* UpnpLogWriter(void*) {
+    struct timespec abstime;
+
+    pthread_mutex_lock(&log_ring_mutex);
+    while (!log_writer_stop) {
+        UpnpLogDrainAll();
+        timespec_get(&abstime, TIME_UTC);
+        abstime.tv_nsec += LOG_WRITER_INTERVAL_MS * 1000000L;
+        if (abstime.tv_nsec >= 1000000000L) {
+            abstime.tv_sec++;
+            abstime.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&log_writer_cond, &log_ring_mutex, &abstime);
+    }
+    UpnpLogDrainAll();
+    pthread_mutex_unlock(&log_ring_mutex);
+
+    return nullptr;
+}
+
+/// \brief Starts the writer thread if asynchronous logging is wanted.
+static void UpnpLogWriterStart() {
+    if (!log_async_wanted || log_async_running.load())
+        return;
+
+    log_writer_stop = false;
+    if (pthread_create(&log_writer_thread, nullptr, UpnpLogWriter, nullptr) !=
+        0) {
+        // Stay with synchronous logging.
+        return;
+    }
+    log_async_running.store(true, std::memory_order_release);
+}
+
+/// \brief Stops the writer thread after it has written all pending records.
+static void UpnpLogWriterStop() {
+    if (!log_async_running.load())
+        return;
+
+    log_async_running.store(false);
+    // Wait for messages that are just put into a ring buffer, so they are
+    // written by the final drain of the writer thread.
+    while (log_pushers.load() != 0)
+        std::this_thread::yield();
+    pthread_mutex_lock(&log_ring_mutex);
+    log_writer_stop = true;
+    pthread_cond_signal(&log_writer_cond);
+    pthread_mutex_unlock(&log_ring_mutex);
+    pthread_join(log_writer_thread, nullptr);
+}
+
+/*!
+ * \brief Puts a message into the ring buffer of the calling thread.
+ *
+ * It takes no lock and does no I/O. If the ring is full the message is
+ * dropped and counted.
+ */
+static void UpnpLogPush(Upnp_LogLevel DLevel, Dbg_Module Module,
+                        const char* DbgFileName, int DbgLineNo,
+                        const char* FmtStr, va_list ArgList) {
+    LogRing* ring = UpnpLogGetRing();
+    if (ring == nullptr) {
+        log_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= LOG_RING_SIZE) {
+        log_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogRecord& rec = ring->rec[head & (LOG_RING_SIZE - 1)];
+    rec.time = time(NULL);
+    rec.thread = UpnpLogThreadId();
+    rec.file = DbgFileName + CMAKE_SOURCE_PATH_LENGTH;
+    rec.line = DbgLineNo;
+    rec.level = DLevel;
+    rec.module = Module;
+    int len = vsnprintf(rec.msg, sizeof(rec.msg), FmtStr, ArgList);
+    if (len < 0) {
+        rec.msg[0] = '\0';
+    } else if ((size_t)len >= sizeof(rec.msg)) {
+        // Keep the line end of a truncated message.
+        rec.msg[sizeof(rec.msg) - 2] = '\n';
+    }
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void UpnpSetLogAsync(int enable) {
+    TRACE("Executing UpnpSetLogAsync()")
+    log_async_wanted = (enable != 0);
+}
+
+unsigned long UpnpGetLogDropCount() { return log_dropped.load(); }
+
 /// \hidecallergraph
 void UpnpPrintf(Upnp_LogLevel DLevel, Dbg_Module Module,
                 const char* DbgFileName, int DbgLineNo, const char* FmtStr,
@@ -254,6 +529,22 @@ void UpnpPrintf(Upnp_LogLevel DLevel, Dbg_Module Module,
 
     if (!DebugAtThisLevel(DLevel, Module))
         return;
+    if (log_async_running.load(std::memory_order_acquire)) {
+        // Announce the message before checking again. So either
+        // UpnpLogWriterStop() waits for it, or it is written synchronously.
+        log_pushers.fetch_add(1);
+        if (log_async_running.load()) {
+            if (DbgFileName) {
+                va_start(ArgList, FmtStr);
+                UpnpLogPush(DLevel, Module, DbgFileName, DbgLineNo, FmtStr,
+                            ArgList);
+                va_end(ArgList);
+            }
+            log_pushers.fetch_sub(1);
+            return;
+        }
+        log_pushers.fetch_sub(1);
+    }
     umock::pthread_h.pthread_mutex_lock(&debug_mutex);
     if (filed == nullptr) {
         umock::pthread_h.pthread_mutex_unlock(&debug_mutex);
@@ -265,7 +556,8 @@ void UpnpPrintf(Upnp_LogLevel DLevel, Dbg_Module Module,
         // flush stdout to have a sequencial output with stderr on screen.
         fflush(stdout); // Don't mock this because we use it for debuging.
         UpnpDisplayFileAndLine(filed, DbgFileName + CMAKE_SOURCE_PATH_LENGTH,
-                               DbgLineNo, DLevel, Module);
+                               DbgLineNo, DLevel, Module, time(NULL),
+                               UpnpLogThreadId());
         vfprintf(filed, FmtStr, ArgList);
         if (filed != nullptr && filed != stderr)
             fflush(filed); // Don't mock this because we use it for debuging.
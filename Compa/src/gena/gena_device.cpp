@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-07-16
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -39,8 +39,11 @@
 
 #include <assert.h>
 
+#include <ObjectPool.hpp>
 #include <gena.hpp>
+#include <gena_notify.hpp>
 #include <httpreadwrite.hpp>
+#include <metrics.hpp>
 #include <parsetools.hpp>
 #include <ssdp_common.hpp>
 #include <statcodes.hpp>
@@ -50,6 +53,8 @@
 #include <UpnpSubscriptionRequest.hpp>
 #include <webserver.hpp>
 
+#include <vector>
+
 /// \brief Invalid job id
 #define STALE_JOBID (INVALID_JOB_ID - 1)
 
@@ -62,7 +67,8 @@ namespace {
 /*!
  * \brief Generates XML property set for notifications.
  *
- * \return UPNP_E_SUCCESS if successful else returns GENA_E_BAD_HANDLE.
+ * \return UPNP_E_SUCCESS if successful else UPNP_E_OUTOF_MEMORY or
+ *  UPNP_E_INVALID_PARAM.
  *
  * \note The XML_VERSION comment is NOT sent due to interoperability issues
  *  with other UPnP vendors.
@@ -76,60 +82,157 @@ int GeneratePropertySet(
     int count,
     /*! [out] PropertySet node in the string format. */
     DOMString* out) {
-    char* buffer;
-    int counter = 0;
-    size_t size = 0;
-
-    /*size += strlen(XML_VERSION);*/
-    size += strlen(XML_PROPERTYSET_HEADER);
-    size += strlen("</e:propertyset>\n\n");
-    for (counter = 0; counter < count; counter++) {
-        size += strlen("<e:property>\n</e:property>\n");
-        size += 2 * strlen(names[counter]) + strlen(values[counter]) +
-                strlen("<></>\n");
-    }
-
-    size_t buffer_len{size + 1};
-    buffer = (char*)malloc(buffer_len);
-    if (buffer == NULL)
+    UpnpPropertySet* propset = UpnpPropertySet_new();
+    if (propset == NULL)
         return UPNP_E_OUTOF_MEMORY;
-    memset(buffer, 0, size + 1);
-    /*
-    strcpy(buffer,XML_VERSION);
-    strcat(buffer, XML_PROPERTYSET_HEADER);
-    */
-    strcpy(buffer, XML_PROPERTYSET_HEADER);
-    for (counter = 0; counter < count; counter++) {
-        strcat(buffer, "<e:property>\n");
-        snprintf(&buffer[strlen(buffer)], buffer_len,
-                 "<%s>%s</%s>\n</e:property>\n", names[counter],
-                 values[counter], names[counter]);
-    }
-    strcat(buffer, "</e:propertyset>\n\n");
-    *out = ixmlCloneDOMString(buffer);
-    free(buffer);
-
-    return XML_SUCCESS;
+
+    /* Values are XML content given by the application, not escaped here. */
+    int ret = XML_SUCCESS;
+    for (int counter = 0; counter < count; counter++) {
+        ret = UpnpPropertySet_addRaw(propset, names[counter], values[counter]);
+        if (ret != UPNP_E_SUCCESS)
+            break;
+    }
+    if (ret == UPNP_E_SUCCESS) {
+        *out = ixmlCloneDOMString(UpnpPropertySet_get_String(propset));
+        if (*out == NULL)
+            ret = UPNP_E_OUTOF_MEMORY;
+    }
+    UpnpPropertySet_delete(propset);
+
+    return ret;
+}
+
+/*!
+ * \brief Allocates a ThreadPoolJob from the notify pool.
+ *
+ * \return Pointer to a zeroed job or nullptr if there is not enough memory.
+ */
+ThreadPoolJob* alloc_notify_job() {
+    ThreadPoolJob* job = (ThreadPoolJob*)ObjectPoolAlloc(sizeof(ThreadPoolJob));
+    if (job != nullptr)
+        memset(job, 0, sizeof(ThreadPoolJob));
+    return job;
+}
+
+/*!
+ * \brief Returns a ThreadPoolJob to the notify pool.
+ *
+ * It is also the free function of the `outgoing` list of a subscription.
+ */
+void free_notify_job(
+    /*! [in] Job allocated with alloc_notify_job(). */
+    void* job) {
+    if (job == nullptr)
+        return;
+    ObjectPoolFree(job, sizeof(ThreadPoolJob));
+}
+
+/*!
+ * \brief Creates a pre-rendered event.
+ *
+ * UDN, servId and the common headers are rendered once into the same
+ * allocation as the event. On success the event takes ownership of
+ * **propertySet**.
+ *
+ * \return Pointer to the event with a reference count of 0, or nullptr if
+ * there is not enough memory.
+ */
+notify_event* new_notify_event(
+    /*! [in] UDN of the device. */
+    const char* UDN,
+    /*! [in] Service id of the service. */
+    const char* servId,
+    /*! [in] The evented XML. */
+    DOMString propertySet) {
+    static const char* HEADER_LINE_1 =
+        "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n";
+    static const char* HEADER_LINE_2A = "CONTENT-LENGTH: ";
+    static const char* HEADER_LINE_2B = "\r\n";
+    static const char* HEADER_LINE_3 = "NT: upnp:event\r\n";
+    static const char* HEADER_LINE_4 = "NTS: upnp:propchange\r\n";
+    size_t UDN_size = strlen(UDN) + 1;
+    size_t servId_size = strlen(servId) + 1;
+    size_t headers_size = strlen(HEADER_LINE_1) + strlen(HEADER_LINE_2A) +
+                          MAX_CONTENT_LENGTH + strlen(HEADER_LINE_2B) +
+                          strlen(HEADER_LINE_3) + strlen(HEADER_LINE_4) + 1;
+    notify_event* ev = (notify_event*)malloc(sizeof(notify_event) + UDN_size +
+                                             servId_size + headers_size);
+    if (ev == nullptr) {
+        UpnpPrintf(UPNP_ALL, GENA, __FILE__, __LINE__,
+                   "new_notify_event(): Error UPNP_E_OUTOF_MEMORY\n");
+        return nullptr;
+    }
+    ev->reference_count = 0;
+    ev->propertySet = propertySet;
+    ev->UDN = (char*)(ev + 1);
+    ev->servId = ev->UDN + UDN_size;
+    ev->headers = ev->servId + servId_size;
+    memcpy(ev->UDN, UDN, UDN_size);
+    memcpy(ev->servId, servId, servId_size);
+    int rc = snprintf(ev->headers, headers_size, "%s%s%" PRIzu "%s%s%s",
+                      HEADER_LINE_1, HEADER_LINE_2A, strlen(propertySet) + 2,
+                      HEADER_LINE_2B, HEADER_LINE_3, HEADER_LINE_4);
+    if (rc < 0 || (size_t)rc >= headers_size) {
+        UpnpPrintf(UPNP_ALL, GENA, __FILE__, __LINE__,
+                   "new_notify_event(): Error UPNP_E_OUTOF_MEMORY\n");
+        free(ev);
+        return nullptr;
+    }
+    return ev;
+}
+
+/*!
+ * \brief Frees a pre-rendered event if no notification uses it anymore.
+ */
+void free_notify_event(
+    /*! [in] Event created with new_notify_event(). */
+    notify_event* ev) {
+    if (ev->reference_count == 0) {
+        ixmlFreeDOMString(ev->propertySet);
+        free(ev);
+    }
 }
 
 /*!
- * \brief Frees memory used in notify_threads if the reference count is 0,
- * otherwise decrements the refrence count.
+ * \brief Allocates a notify_thread_struct from the notify pool and takes a
+ * reference to the event.
+ *
+ * \return Pointer to the structure or nullptr if there is not enough memory.
+ */
+notify_thread_struct* alloc_notify_struct(
+    /*! [in] Event to notify. */
+    notify_event* ev,
+    /*! [in] SID of the subscription to notify. */
+    const char* sid,
+    /*! [in] Device handle. */
+    UpnpDevice_Handle device_handle) {
+    notify_thread_struct* p =
+        (notify_thread_struct*)ObjectPoolAlloc(sizeof(notify_thread_struct));
+    if (p == nullptr)
+        return nullptr;
+
+    ev->reference_count++;
+    p->event = ev;
+    strncpy(p->sid, sid, sizeof p->sid);
+    p->sid[sizeof p->sid - 1] = 0;
+    p->ctime = time(0);
+    p->device_handle = device_handle;
+    return p;
+}
+
+/*!
+ * \brief Returns a notify_thread_struct to the notify pool and frees its event
+ * if the reference count gets 0, otherwise decrements the reference count.
  */
 void free_notify_struct(
     /*! [in] Notify structure. */
     void* input) {
     notify_thread_struct* p = (notify_thread_struct*)input;
 
-    (*p->reference_count)--;
-    if (*p->reference_count == 0) {
-        free(p->headers);
-        ixmlFreeDOMString(p->propertySet);
-        free(p->servId);
-        free(p->UDN);
-        free(p->reference_count);
-    }
-    free(p);
+    p->event->reference_count--;
+    free_notify_event(p->event);
+    ObjectPoolFree(p, sizeof(notify_thread_struct));
 }
 
 /*!
@@ -142,8 +245,10 @@ void free_notify_struct(
 inline int notify_send_and_recv(
     /*! [in] subscription callback URL (URL of the control point). */
     uri_type* destination_url,
-    /*! [in] Common HTTP headers. */
-    membuffer* mid_msg,
+    /*! [in] Common HTTP headers without SID and SEQ. */
+    const char* headers,
+    /*! [in] Subscription to notify, only SID and event key are used. */
+    const subscription* sub,
     /*! [in] The evented XML. */
     char* propertySet,
     /*! [out] The response from the control point. */
@@ -171,12 +276,16 @@ inline int notify_send_and_recv(
         sock_destroy(&info, SD_BOTH);
         return ret_code;
     }
-    /* make start line and HOST header */
+    /* make start line and HOST header, only SID and SEQ are not rendered
+     * with the common headers */
     membuffer_init(&start_msg);
     if (http_MakeMessage(&start_msg, 1, 1,
                          "q"
-                         "s",
-                         HTTPMETHOD_NOTIFY, &url, mid_msg->buf) != 0) {
+                         "s"
+                         "ssc"
+                         "sdcc",
+                         HTTPMETHOD_NOTIFY, &url, headers, "SID: ", sub->sid,
+                         "SEQ: ", sub->ToSendEventKey) != 0) {
         membuffer_destroy(&start_msg);
         sock_destroy(&info, SD_BOTH);
         return UPNP_E_OUTOF_MEMORY;
@@ -228,30 +337,18 @@ int genaNotify(
        function. */
     subscription* sub) {
     size_t i;
-    membuffer mid_msg;
     uri_type* url;
     http_parser_t response{};
     int return_code = -1;
 
-    membuffer_init(&mid_msg);
-    if (http_MakeMessage(&mid_msg, 1, 1,
-                         "s"
-                         "ssc"
-                         "sdcc",
-                         headers, "SID: ", sub->sid,
-                         "SEQ: ", sub->ToSendEventKey) != 0) {
-        membuffer_destroy(&mid_msg);
-        return UPNP_E_OUTOF_MEMORY;
-    }
     /* send a notify to each url until one goes thru */
     for (i = 0; i < sub->DeliveryURLs.size; i++) {
         url = &sub->DeliveryURLs.parsedURLs[i];
         return_code =
-            notify_send_and_recv(url, &mid_msg, propertySet, &response);
+            notify_send_and_recv(url, headers, sub, propertySet, &response);
         if (return_code == UPNP_E_SUCCESS)
             break;
     }
-    membuffer_destroy(&mid_msg);
     if (return_code == UPNP_E_SUCCESS) {
         if (response.msg.status_code == HTTP_OK)
             return_code = GENA_SUCCESS;
@@ -269,53 +366,29 @@ int genaNotify(
 }
 
 /*!
- * \brief Thread job to Notify a control point.
- *
- * It validates the subscription and copies the subscription. Also make sure
- * that events are sent in order.
+ * \brief Finishes the delivery of a notification.
  *
- * \note calls the genaNotify to do the actual work.
+ * Increments the event key of the subscription, removes the finished event
+ * from the head of its queue and schedules the next one. This keeps the events
+ * in order. The result and time of the delivery are recorded to the metrics.
  */
-void genaNotifyThread(
-    /*! [in] notify thread structure containing all the headers and property
-       set info. */
-    void* input) {
+void genaNotifyThreadDone(
+    /*! [in] notify thread structure of the finished notification. */
+    void* input,
+    /*! [in] Result of the delivery. */
+    int return_code) {
     subscription* sub;
     service_info* service;
-    subscription sub_copy;
     notify_thread_struct* in = (notify_thread_struct*)input;
-    int return_code;
     struct Handle_Info* handle_info;
 
-    /* This should be a HandleLock and not a HandleReadLock otherwise if
-     * there is a lot of notifications, then multiple threads will acquire a
-     * read lock and the thread which sends the notification will be blocked
-     * forever on the HandleLock at the end of this function. */
-    /*HandleReadLock(); */
-    HandleLock();
-    /* validate context */
-
-    if (GetHandleInfo(in->device_handle, &handle_info) != HND_DEVICE) {
-        free_notify_struct(in);
-        HandleUnlock();
-        return;
-    }
-
-    if (((service = FindServiceId(&handle_info->ServiceTable, in->servId,
-                                  in->UDN)) == 0) ||
-        !service->active ||
-        ((sub = GetSubscriptionSID(in->sid, service)) == 0) ||
-        copy_subscription(sub, &sub_copy) != HTTP_SUCCESS) {
-        free_notify_struct(in);
-        HandleUnlock();
-        return;
-    }
+    /* Both, the blocking and the engine delivery, finish here. */
+    compa::metrics_add(return_code == GENA_SUCCESS
+                           ? UPNP_METRIC_GENA_NOTIFY_OK
+                           : UPNP_METRIC_GENA_NOTIFY_FAILED);
+    compa::metrics_observe(UPNP_HISTOGRAM_GENA_NOTIFY,
+                           compa::metrics_now() - in->start);
 
-    HandleUnlock();
-
-    /* send the notify */
-    return_code = genaNotify(in->headers, in->propertySet, &sub_copy);
-    freeSubscription(&sub_copy);
     HandleLock();
     if (GetHandleInfo(in->device_handle, &handle_info) != HND_DEVICE) {
         free_notify_struct(in);
@@ -323,8 +396,8 @@ void genaNotifyThread(
         return;
     }
     /* validate context */
-    if (((service = FindServiceId(&handle_info->ServiceTable, in->servId,
-                                  in->UDN)) == 0) ||
+    if (((service = FindServiceId(&handle_info->ServiceTable,
+                                  in->event->servId, in->event->UDN)) == 0) ||
         !service->active ||
         ((sub = GetSubscriptionSID(in->sid, service)) == 0)) {
         free_notify_struct(in);
@@ -361,46 +434,66 @@ void genaNotifyThread(
     HandleUnlock();
 }
 
+
 /*!
- * \brief Allocates the GENA header.
+ * \brief Thread job to Notify a control point.
  *
- * \note The header must be destroyed after with a call to free(), otherwise
- * there will be a memory leak.
+ * It validates the subscription and copies the subscription. Also make sure
+ * that events are sent in order.
  *
- * \return Pointer to the constructed header string.
+ * \note calls the genaNotify to do the actual work, or submits it to the
+ * notify engine if that is running.
  */
-char* AllocGenaHeaders(
-    /*! [in] Pointer to the property set string. */
-    const DOMString propertySet) {
-    static const char* HEADER_LINE_1 =
-        "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n";
-    static const char* HEADER_LINE_2A = "CONTENT-LENGTH: ";
-    static const char* HEADER_LINE_2B = "\r\n";
-    static const char* HEADER_LINE_3 = "NT: upnp:event\r\n";
-    static const char* HEADER_LINE_4 = "NTS: upnp:propchange\r\n";
-    char* headers = NULL;
-    size_t headers_size = 0;
-    int line = 0;
-    int rc = 0;
+void genaNotifyThread(
+    /*! [in] notify thread structure containing all the headers and property
+       set info. */
+    void* input) {
+    subscription* sub;
+    service_info* service;
+    subscription sub_copy;
+    notify_thread_struct* in = (notify_thread_struct*)input;
+    int return_code;
+    struct Handle_Info* handle_info;
 
-    headers_size = strlen(HEADER_LINE_1) + strlen(HEADER_LINE_2A) +
-                   MAX_CONTENT_LENGTH + strlen(HEADER_LINE_2B) +
-                   strlen(HEADER_LINE_3) + strlen(HEADER_LINE_4) + 1;
-    headers = (char*)malloc(headers_size);
-    if (headers == NULL) {
-        line = __LINE__;
-        goto ExitFunction;
+    /* This should be a HandleLock and not a HandleReadLock otherwise if
+     * there is a lot of notifications, then multiple threads will acquire a
+     * read lock and the thread which sends the notification will be blocked
+     * forever on the HandleLock at the end of this function. */
+    /*HandleReadLock(); */
+    HandleLock();
+    /* validate context */
+
+    if (GetHandleInfo(in->device_handle, &handle_info) != HND_DEVICE) {
+        free_notify_struct(in);
+        HandleUnlock();
+        return;
     }
-    rc = snprintf(headers, headers_size, "%s%s%" PRIzu "%s%s%s", HEADER_LINE_1,
-                  HEADER_LINE_2A, strlen(propertySet) + 2, HEADER_LINE_2B,
-                  HEADER_LINE_3, HEADER_LINE_4);
 
-ExitFunction:
-    if (headers == NULL || rc < 0 || (unsigned int)rc >= headers_size) {
-        UpnpPrintf(UPNP_ALL, GENA, __FILE__, line,
-                   "AllocGenaHeaders(): Error UPNP_E_OUTOF_MEMORY\n");
+    if (((service = FindServiceId(&handle_info->ServiceTable,
+                                  in->event->servId, in->event->UDN)) == 0) ||
+        !service->active ||
+        ((sub = GetSubscriptionSID(in->sid, service)) == 0) ||
+        copy_subscription(sub, &sub_copy) != HTTP_SUCCESS) {
+        free_notify_struct(in);
+        HandleUnlock();
+        return;
     }
-    return headers;
+
+    HandleUnlock();
+
+    in->start = compa::metrics_now();
+    /* hand over to the notify engine, it finishes with genaNotifyThreadDone */
+    if (genaNotifyEngineIsRunning() &&
+        genaNotifyEngineSubmit(&sub_copy, in->event->headers,
+                               in->event->propertySet, genaNotifyThreadDone,
+                               in) == UPNP_E_SUCCESS)
+        return;
+
+    /* send the notify */
+    return_code =
+        genaNotify(in->event->headers, in->event->propertySet, &sub_copy);
+    freeSubscription(&sub_copy);
+    genaNotifyThreadDone(in, return_code);
 }
 
 /*! \brief We take ownership of propertySet and will free it */
@@ -410,10 +503,7 @@ int genaInitNotifyCommon(UpnpDevice_Handle device_handle, char* UDN,
     int ret = GENA_SUCCESS;
     int line = 0;
 
-    int* reference_count = NULL;
-    char* UDN_copy = NULL;
-    char* servId_copy = NULL;
-    char* headers = NULL;
+    notify_event* event = NULL;
     notify_thread_struct* thread_struct = NULL;
 
     subscription* sub = NULL;
@@ -424,31 +514,15 @@ int genaInitNotifyCommon(UpnpDevice_Handle device_handle, char* UDN,
     UpnpPrintf(UPNP_INFO, GENA, __FILE__, __LINE__,
                "GENA BEGIN INITIAL NOTIFY COMMON\n");
 
-    job = (ThreadPoolJob*)malloc(sizeof(ThreadPoolJob));
+    job = alloc_notify_job();
     if (job == NULL) {
         line = __LINE__;
         ret = UPNP_E_OUTOF_MEMORY;
         goto ExitFunction;
     }
-    memset(job, 0, sizeof(ThreadPoolJob));
 
-    reference_count = (int*)malloc(sizeof(int));
-    if (reference_count == NULL) {
-        line = __LINE__;
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
-    }
-    *reference_count = 0;
-
-    UDN_copy = strdup(UDN);
-    if (UDN_copy == NULL) {
-        line = __LINE__;
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
-    }
-
-    servId_copy = strdup(servId);
-    if (servId_copy == NULL) {
+    event = new_notify_event(UDN, servId, propertySet);
+    if (event == NULL) {
         line = __LINE__;
         ret = UPNP_E_OUTOF_MEMORY;
         goto ExitFunction;
@@ -481,31 +555,13 @@ int genaInitNotifyCommon(UpnpDevice_Handle device_handle, char* UDN,
                "FOUND SUBSCRIPTION IN INIT NOTIFY: SID %s", sid);
     sub->active = 1;
 
-    headers = AllocGenaHeaders(propertySet);
-    if (headers == NULL) {
-        line = __LINE__;
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
-    }
-
     /* schedule thread for initial notification */
 
-    thread_struct = (notify_thread_struct*)malloc(sizeof(notify_thread_struct));
+    thread_struct = alloc_notify_struct(event, sid, device_handle);
     if (thread_struct == NULL) {
         line = __LINE__;
         ret = UPNP_E_OUTOF_MEMORY;
     } else {
-        *reference_count = 1;
-        thread_struct->servId = servId_copy;
-        thread_struct->UDN = UDN_copy;
-        thread_struct->headers = headers;
-        thread_struct->propertySet = propertySet;
-        memset(thread_struct->sid, 0, sizeof(thread_struct->sid));
-        strncpy(thread_struct->sid, sid, sizeof(thread_struct->sid) - 1);
-        thread_struct->ctime = time(0);
-        thread_struct->reference_count = reference_count;
-        thread_struct->device_handle = device_handle;
-
         TPJobInit(job, (UPnPsdk::start_routine)genaNotifyThread, thread_struct);
         TPJobSetFreeFunction(job, (free_routine)free_notify_struct);
         TPJobSetPriority(job, MED_PRIORITY);
@@ -531,13 +587,13 @@ int genaInitNotifyCommon(UpnpDevice_Handle device_handle, char* UDN,
 
 ExitFunction:
     if (ret != GENA_SUCCESS) {
-        free(job);
-        free(thread_struct);
-        free(headers);
-        ixmlFreeDOMString(propertySet);
-        free(servId_copy);
-        free(UDN_copy);
-        free(reference_count);
+        free_notify_job(job);
+        if (thread_struct != NULL)
+            free_notify_struct(thread_struct);
+        else if (event != NULL)
+            free_notify_event(event);
+        else
+            ixmlFreeDOMString(propertySet);
     }
 
     HandleUnlock();
@@ -548,6 +604,227 @@ ExitFunction:
     return ret;
 }
 
+/*!
+ * \brief Returns the first element child of a node.
+ *
+ * \return Pointer to the element or nullptr if there is none.
+ */
+IXML_Node* GetFirstElementChild(
+    /*! [in] Parent node. */
+    IXML_Node* node) {
+    IXML_Node* child = ixmlNode_getFirstChild(node);
+    while (child != nullptr &&
+           ixmlNode_getNodeType(child) != eELEMENT_NODE) {
+        child = ixmlNode_getNextSibling(child);
+    }
+    return child;
+}
+
+/*!
+ * \brief Merges two XML property sets.
+ *
+ * Every property of **newer** replaces the property of **older** with the
+ * same state variable, or is appended if **older** doesn't have it.
+ *
+ * \return The merged property set, to be freed with ixmlFreeDOMString(), or
+ * nullptr if one of the property sets could not be parsed or on error.
+ */
+DOMString MergePropertySets(
+    /*! [in] Property set of the queued event. */
+    const char* older,
+    /*! [in] Property set of the new event. */
+    const char* newer) {
+    IXML_Document* older_doc{nullptr};
+    IXML_Document* newer_doc{nullptr};
+    IXML_Node* older_root;
+    IXML_Node* newer_root;
+    DOMString merged{nullptr};
+
+    if (ixmlParseBufferEx(older, &older_doc) != IXML_SUCCESS ||
+        ixmlParseBufferEx(newer, &newer_doc) != IXML_SUCCESS)
+        goto ExitFunction;
+    older_root = GetFirstElementChild((IXML_Node*)older_doc);
+    newer_root = GetFirstElementChild((IXML_Node*)newer_doc);
+    if (older_root == nullptr || newer_root == nullptr)
+        goto ExitFunction;
+
+    for (IXML_Node* prop = GetFirstElementChild(newer_root); prop != nullptr;
+         prop = ixmlNode_getNextSibling(prop)) {
+        if (ixmlNode_getNodeType(prop) != eELEMENT_NODE)
+            continue;
+        IXML_Node* var = GetFirstElementChild(prop);
+        if (var == nullptr)
+            continue;
+
+        // Look for the property of the same state variable in the older set.
+        IXML_Node* old_prop = GetFirstElementChild(older_root);
+        for (; old_prop != nullptr;
+             old_prop = ixmlNode_getNextSibling(old_prop)) {
+            IXML_Node* old_var = GetFirstElementChild(old_prop);
+            if (old_var != nullptr &&
+                strcmp(ixmlNode_getNodeName(old_var),
+                       ixmlNode_getNodeName(var)) == 0)
+                break;
+        }
+
+        IXML_Node* new_prop{nullptr};
+        if (ixmlDocument_importNode(older_doc, prop, 1, &new_prop) !=
+            IXML_SUCCESS)
+            goto ExitFunction;
+        int rc;
+        if (old_prop != nullptr) {
+            IXML_Node* removed{nullptr};
+            rc = ixmlNode_replaceChild(older_root, new_prop, old_prop,
+                                       &removed);
+            if (rc == IXML_SUCCESS)
+                ixmlNode_free(removed);
+        } else {
+            rc = ixmlNode_appendChild(older_root, new_prop);
+        }
+        if (rc != IXML_SUCCESS) {
+            ixmlNode_free(new_prop);
+            goto ExitFunction;
+        }
+    }
+    merged = ixmlPrintNode((IXML_Node*)older_doc);
+
+ExitFunction:
+    ixmlDocument_free(older_doc);
+    ixmlDocument_free(newer_doc);
+    return merged;
+}
+
+/*!
+ * \brief Queued event to coalesce with and the merged event replacing it.
+ *
+ * Both events are pinned with a reference so they stay valid while the handle
+ * lock isn't held.
+ */
+struct coalesce_merge {
+    notify_event* queued; ///< Last queued event of subscriptions.
+    notify_event* merged; ///< Merged event, or nullptr if merging failed.
+};
+
+/*!
+ * \brief Collects the distinct last queued events of all subscriptions of a
+ * service that can be coalesced.
+ *
+ * Only an event that isn't the head of the queue can be merged. The head is
+ * already given to the thread pool. Subscriptions with a backlog from the same
+ * events share their last queued event, so it is merged only once.
+ *
+ * \note The handle lock must be held.
+ */
+void collectCoalesceEvents(
+    /*! [in] Service with the subscriptions. */
+    service_info* service,
+    /*! [in,out] Collected events. */
+    std::vector<coalesce_merge>& merges) {
+    for (subscription* finger = GetFirstSubscription(service); finger;
+         finger = GetNextSubscription(service, finger)) {
+        if (ListSize(&finger->outgoing) < 2)
+            continue;
+        ListNode* node = ListTail(&finger->outgoing);
+        if (node == nullptr)
+            continue;
+        notify_event* queued =
+            ((notify_thread_struct*)((ThreadPoolJob*)node->item)->arg)->event;
+        bool found{false};
+        for (const coalesce_merge& merge : merges)
+            found = found || merge.queued == queued;
+        if (found)
+            continue;
+        queued->reference_count++;
+        merges.push_back({queued, nullptr});
+    }
+}
+
+/*!
+ * \brief Merges a new event into each collected queued event.
+ *
+ * The merged events are new pre-rendered events because the queued ones are
+ * shared with other subscriptions.
+ *
+ * \note It parses XML and must be called without holding the handle lock.
+ */
+void mergeCoalesceEvents(
+    /*! [in,out] Collected events. */
+    std::vector<coalesce_merge>& merges,
+    /*! [in] Property set of the new event. */
+    const char* propertySet) {
+    for (coalesce_merge& merge : merges) {
+        DOMString propertySet_merged =
+            MergePropertySets(merge.queued->propertySet, propertySet);
+        if (propertySet_merged == nullptr)
+            continue;
+        merge.merged = new_notify_event(
+            merge.queued->UDN, merge.queued->servId, propertySet_merged);
+        if (merge.merged == nullptr) {
+            ixmlFreeDOMString(propertySet_merged);
+            continue;
+        }
+        merge.merged->reference_count++;
+    }
+}
+
+/*!
+ * \brief Releases the pinned events of coalescing.
+ *
+ * \note The handle lock must be held.
+ */
+void releaseCoalesceEvents(
+    /*! [in,out] Collected events. */
+    std::vector<coalesce_merge>& merges) {
+    for (coalesce_merge& merge : merges) {
+        merge.queued->reference_count--;
+        free_notify_event(merge.queued);
+        if (merge.merged != nullptr) {
+            merge.merged->reference_count--;
+            free_notify_event(merge.merged);
+        }
+    }
+    merges.clear();
+}
+
+/*!
+ * \brief Replaces the last queued event of a subscription by its merged
+ * event.
+ *
+ * The replacement keeps the creation time of the queued event so a backlog
+ * still ages out with the maximal event age.
+ *
+ * \note The handle lock must be held.
+ *
+ * \return 1 if the event has been merged, 0 if it must be queued as usual.
+ */
+int coalesceEvent(
+    /*! [in] Queue of the subscription. */
+    LinkedList* listp,
+    /*! [in] Merged events from mergeCoalesceEvents(). */
+    const std::vector<coalesce_merge>& merges) {
+    if (ListSize(listp) < 2)
+        return 0;
+    ListNode* node = ListTail(listp);
+    if (node == nullptr)
+        return 0;
+    ThreadPoolJob* job = (ThreadPoolJob*)node->item;
+    notify_thread_struct* queued = (notify_thread_struct*)job->arg;
+
+    for (const coalesce_merge& merge : merges) {
+        if (merge.queued != queued->event || merge.merged == nullptr)
+            continue;
+        notify_thread_struct* merged = alloc_notify_struct(
+            merge.merged, queued->sid, queued->device_handle);
+        if (merged == nullptr)
+            return 0;
+        merged->ctime = queued->ctime;
+        job->arg = merged;
+        free_notify_struct(queued);
+        return 1;
+    }
+    return 0;
+}
+
 /*!
  * \brief This gets called before queuing a new event.
  *
@@ -577,7 +854,7 @@ void maybeDiscardEvents(LinkedList* listp) {
         if (ListSize(listp) > g_UpnpSdkEQMaxLen ||
             now - ntsp->ctime > g_UpnpSdkEQMaxAge) {
             free_notify_struct(ntsp);
-            free(node->item);
+            free_notify_job(node->item);
             ListDelNode(listp, node, 0);
         } else {
             /* If the list is smaller than the max and the oldest
@@ -593,47 +870,36 @@ int genaNotifyAllCommon(UpnpDevice_Handle device_handle, char* UDN,
     int ret = GENA_SUCCESS;
     int line = 0;
 
-    int* reference_count = NULL;
-    char* UDN_copy = NULL;
-    char* servId_copy = NULL;
-    char* headers = NULL;
+    notify_event* event = NULL;
     notify_thread_struct* thread_s = NULL;
 
     subscription* finger = NULL;
     service_info* service = NULL;
     struct Handle_Info* handle_info;
+    std::vector<coalesce_merge> merges;
 
     UpnpPrintf(UPNP_INFO, GENA, __FILE__, __LINE__,
                "GENA BEGIN NOTIFY ALL COMMON\n");
 
-    /* Keep this allocation first */
-    reference_count = (int*)malloc(sizeof(int));
-    if (reference_count == NULL) {
-        line = __LINE__;
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
-    }
-    *reference_count = 0;
-
-    UDN_copy = strdup(UDN);
-    if (UDN_copy == NULL) {
-        line = __LINE__;
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
-    }
-
-    servId_copy = strdup(servId);
-    if (servId_copy == NULL) {
+    /* The event is rendered only once and shared by all subscriptions */
+    event = new_notify_event(UDN, servId, propertySet);
+    if (event == NULL) {
+        ixmlFreeDOMString(propertySet);
         line = __LINE__;
         ret = UPNP_E_OUTOF_MEMORY;
         goto ExitFunction;
     }
 
-    headers = AllocGenaHeaders(propertySet);
-    if (headers == NULL) {
-        line = __LINE__;
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
+    if (g_UpnpSdkEQCoalesce.load(std::memory_order_relaxed)) {
+        /* Merging parses XML. It is done once per queued event and without
+           holding the handle lock. */
+        HandleLock();
+        if (GetHandleInfo(device_handle, &handle_info) == HND_DEVICE &&
+            (service = FindServiceId(&handle_info->ServiceTable, servId,
+                                     UDN)) != NULL)
+            collectCoalesceEvents(service, merges);
+        HandleUnlock();
+        mergeCoalesceEvents(merges, propertySet);
     }
 
     HandleLock();
@@ -649,34 +915,25 @@ int genaNotifyAllCommon(UpnpDevice_Handle device_handle, char* UDN,
                 ThreadPoolJob* job = NULL;
                 ListNode* node;
 
-                thread_s =
-                    (notify_thread_struct*)malloc(sizeof(notify_thread_struct));
-                if (thread_s == NULL) {
+                if (coalesceEvent(&finger->outgoing, merges)) {
+                    finger = GetNextSubscription(service, finger);
+                    continue;
+                }
+                maybeDiscardEvents(&finger->outgoing);
+                job = alloc_notify_job();
+                if (!job) {
                     line = __LINE__;
                     ret = UPNP_E_OUTOF_MEMORY;
                     break;
                 }
-
-                (*reference_count)++;
-                thread_s->reference_count = reference_count;
-                thread_s->UDN = UDN_copy;
-                thread_s->servId = servId_copy;
-                thread_s->headers = headers;
-                thread_s->propertySet = propertySet;
-                strncpy(thread_s->sid, finger->sid, sizeof thread_s->sid);
-                thread_s->sid[sizeof thread_s->sid - 1] = 0;
-                thread_s->ctime = time(0);
-                thread_s->device_handle = device_handle;
-
-                maybeDiscardEvents(&finger->outgoing);
-                job = (ThreadPoolJob*)malloc(sizeof(ThreadPoolJob));
-                if (!job) {
-                    free(thread_s);
+                thread_s =
+                    alloc_notify_struct(event, finger->sid, device_handle);
+                if (thread_s == NULL) {
+                    free_notify_job(job);
                     line = __LINE__;
                     ret = UPNP_E_OUTOF_MEMORY;
                     break;
                 }
-                memset(job, 0, sizeof(ThreadPoolJob));
                 TPJobInit(job, (UPnPsdk::start_routine)genaNotifyThread,
                           thread_s);
                 TPJobSetFreeFunction(job, (free_routine)free_notify_struct);
@@ -710,16 +967,10 @@ int genaNotifyAllCommon(UpnpDevice_Handle device_handle, char* UDN,
 
 ExitFunction:
     /* The only case where we want to free memory here is if the
-       struct was never queued. Else, let the normal cleanup take place.
-       reference_count is allocated first so it's ok to do nothing if it's 0
-    */
-    if (reference_count && *reference_count == 0) {
-        free(headers);
-        ixmlFreeDOMString(propertySet);
-        free(servId_copy);
-        free(UDN_copy);
-        free(reference_count);
-    }
+       event was never queued. Else, let the normal cleanup take place. */
+    if (event != NULL)
+        free_notify_event(event);
+    releaseCoalesceEvents(merges);
 
     HandleUnlock();
 
@@ -828,7 +1079,7 @@ void freeSubscriptionQueuedEvents(subscription* sub) {
             } else {
                 free_notify_struct((notify_thread_struct*)job->arg);
             }
-            free(node->item);
+            free_notify_job(node->item);
             ListDelNode(&sub->outgoing, node, 0);
             node = ListHead(&sub->outgoing);
         }
@@ -934,6 +1185,35 @@ ExitFunction:
     return ret;
 }
 
+int genaNotifyAllPropertySet(UpnpDevice_Handle device_handle,
+                             const char* UDN, const char* servId,
+                             const UpnpPropertySet* PropSet) {
+    int ret = GENA_SUCCESS;
+    int line = 0;
+
+    DOMString propertySet = NULL;
+
+    UpnpPrintf(UPNP_INFO, GENA, __FILE__, __LINE__,
+               "GENA BEGIN NOTIFY ALL PROPERTYSET\n");
+
+    propertySet = ixmlCloneDOMString(UpnpPropertySet_get_String(PropSet));
+    if (propertySet == NULL) {
+        line = __LINE__;
+        ret = UPNP_E_OUTOF_MEMORY;
+        goto ExitFunction;
+    }
+
+    ret = genaNotifyAllCommon(device_handle, (char*)UDN, (char*)servId,
+                              propertySet);
+
+ExitFunction:
+
+    UpnpPrintf(UPNP_INFO, GENA, __FILE__, line,
+               "GENA END NOTIFY ALL PROPERTYSET, ret = %d\n", ret);
+
+    return ret;
+}
+
 int genaNotifyAll(UpnpDevice_Handle device_handle, char* UDN, char* servId,
                   char** VarNames, char** VarValues, int var_count) {
     int ret = GENA_SUCCESS;
@@ -1151,7 +1431,7 @@ void gena_process_subscription_request(SOCKINFO* info,
     sub->DeliveryURLs.size = 0;
     sub->DeliveryURLs.URLs = NULL;
     sub->DeliveryURLs.parsedURLs = NULL;
-    if (ListInit(&sub->outgoing, 0, free) != 0) {
+    if (ListInit(&sub->outgoing, 0, free_notify_job) != 0) {
         error_respond(info, HTTP_INTERNAL_SERVER_ERROR, request);
         HandleUnlock();
         goto exit_function;
@@ -0,0 +1,659 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \brief Event driven delivery engine for GENA notifications.
+ */
+
+#include <gena_notify.hpp>
+
+#include <gena.hpp>
+#include <httpreadwrite.hpp>
+#include <metrics.hpp>
+#include <statcodes.hpp>
+#include <upnpapi.hpp>
+
+#include <UPnPsdk/socket.hpp>
+
+#include <umock/sys_socket.hpp>
+#include <umock/winsock2.hpp>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+/// \cond
+namespace {
+
+/// \brief Progress of a single NOTIFY request.
+enum notify_state {
+    NOTIFY_CONNECTING, ///< Waiting for the non-blocking connect.
+    NOTIFY_SENDING,    ///< Sending the request.
+    NOTIFY_RECEIVING,  ///< Receiving the response.
+    NOTIFY_DONE        ///< Finished, return_code is valid.
+};
+
+/// \brief A NOTIFY request to one subscription, handled by the engine.
+struct notify_delivery {
+    notify_delivery* next;
+    /// Own copy of the subscription. Only DeliveryURLs, sid and
+    /// ToSendEventKey are used.
+    subscription sub;
+    const char* propertySet;
+    size_t propertySet_len;
+    /// Common headers with SID and SEQ.
+    membuffer mid_msg;
+    /// Request line with HOST header, followed by mid_msg.
+    membuffer start_msg;
+    /// Index of the delivery URL in use.
+    size_t url_idx;
+    SOCKET sock;
+    notify_state state;
+    /// Bytes sent from start_msg, propertySet and the final CRLF.
+    size_t sent;
+    http_parser_t response;
+    int parser_initialized;
+    int ok_on_close;
+    time_t deadline;
+    int return_code;
+    gena_notify_done_routine done;
+    void* cookie;
+};
+
+/// \brief State of the notify engine.
+struct notify_engine {
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    /// Engine accepts submissions.
+    int running;
+    /// Engine job should stop.
+    int shutdown;
+    /// Loopback datagram socket connected to itself to wake up poll().
+    SOCKET wake_sock;
+    /// Submitted deliveries not yet taken by the engine job.
+    notify_delivery* submitted_head;
+    notify_delivery* submitted_tail;
+};
+
+notify_engine gEngine{PTHREAD_MUTEX_INITIALIZER,
+                      PTHREAD_COND_INITIALIZER,
+                      0,
+                      0,
+                      INVALID_SOCKET,
+                      nullptr,
+                      nullptr};
+
+/*!
+ * \brief Portable poll() on sockets.
+ */
+inline int poll_sockets(pollfd* fds, size_t nfds, int timeout_ms) {
+#ifdef _WIN32
+    return WSAPoll(fds, static_cast<ULONG>(nfds), timeout_ms);
+#else
+    return poll(fds, static_cast<nfds_t>(nfds), timeout_ms);
+#endif
+}
+
+/*!
+ * \brief Returns true if the last socket operation would block.
+ */
+inline bool would_block(bool on_connect) {
+#ifdef _WIN32
+    (void)on_connect;
+    return umock::winsock2_h.WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    if (on_connect)
+        return errno == EINPROGRESS;
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+/*!
+ * \brief Sends a byte to the wakeup socket so the engine job reevaluates its
+ * queue.
+ */
+void wakeup_engine() {
+    constexpr char buf[]{"W"};
+    umock::sys_socket_h.send(gEngine.wake_sock, buf, 1, MSG_NOSIGNAL);
+}
+
+/*!
+ * \brief Binds a datagram socket to a loopback address and connects it to
+ * itself.
+ *
+ * \returns 0 on success, otherwise -1.
+ */
+int connect_to_self(SOCKET sock, sockaddr_storage* saddr,
+                    socklen_t saddr_len) {
+    sockaddr* sa{reinterpret_cast<sockaddr*>(saddr)};
+    if (umock::sys_socket_h.bind(sock, sa, saddr_len) != 0 ||
+        umock::sys_socket_h.getsockname(sock, sa, &saddr_len) != 0 ||
+        umock::sys_socket_h.connect(sock, sa, saddr_len) != 0 ||
+        sock_make_no_blocking(sock) != 0)
+        return -1;
+    return 0;
+}
+
+/*!
+ * \brief Creates the wakeup socket, bound to a loopback interface and
+ * connected to itself.
+ *
+ * The IPv6 loopback interface is preferred. Hosts without it, e.g. with IPv6
+ * disabled, use the IPv4 loopback interface.
+ */
+SOCKET create_wake_sock() {
+    SOCKET sock{INVALID_SOCKET};
+    sockaddr_storage saddr{};
+    try {
+        sock = UPnPsdk::socket(SOCK_DGRAM);
+    } catch (const std::exception& ex) {
+        UPnPsdk_LOGCATCH("MSG1179") "catched next line...\n" << ex.what();
+    }
+    if (sock != INVALID_SOCKET) {
+        sockaddr_in6* saddr6{reinterpret_cast<sockaddr_in6*>(&saddr)};
+        saddr6->sin6_family = static_cast<sa_family_t>(AF_INET6);
+        inet_pton(AF_INET6, "::1", &saddr6->sin6_addr);
+        if (connect_to_self(sock, &saddr, sizeof(sockaddr_in6)) == 0)
+            return sock;
+        CLOSE_SOCKET_P(sock);
+    }
+
+    sock = umock::sys_socket_h.socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock != INVALID_SOCKET) {
+        memset(&saddr, 0, sizeof(saddr));
+        sockaddr_in* saddr4{reinterpret_cast<sockaddr_in*>(&saddr)};
+        saddr4->sin_family = static_cast<sa_family_t>(AF_INET);
+        inet_pton(AF_INET, "127.0.0.1", &saddr4->sin_addr);
+        if (connect_to_self(sock, &saddr, sizeof(sockaddr_in)) == 0)
+            return sock;
+    }
+    UPnPsdk::CSocketErr serrObj;
+    serrObj.catch_error();
+    UPnPsdk_LOGERR("MSG1180") "failed to set up wakeup socket("
+        << sock << "): " << serrObj.error_str() << "\n";
+    if (sock != INVALID_SOCKET)
+        CLOSE_SOCKET_P(sock);
+    return INVALID_SOCKET;
+}
+
+/*!
+ * \brief Closes the connection of a delivery and frees its response.
+ */
+void close_connection(notify_delivery* d) {
+    if (d->sock != INVALID_SOCKET) {
+        umock::sys_socket_h.shutdown(d->sock, SD_BOTH);
+        CLOSE_SOCKET_P(d->sock);
+        d->sock = INVALID_SOCKET;
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
+    }
+    if (d->parser_initialized) {
+        httpmsg_destroy(&d->response.msg);
+        d->parser_initialized = 0;
+    }
+}
+
+/*!
+ * \brief Calls the done routine and frees a delivery.
+ */
+void finish_delivery(notify_delivery* d) {
+    close_connection(d);
+    d->done(d->cookie, d->return_code);
+    membuffer_destroy(&d->start_msg);
+    membuffer_destroy(&d->mid_msg);
+    freeSubscription(&d->sub);
+    free(d);
+}
+
+/*!
+ * \brief Starts a non-blocking connection to the current delivery URL.
+ *
+ * Steps forward to the next delivery URL until a connection could be
+ * initiated. If there are no URLs left the delivery is NOTIFY_DONE.
+ */
+void start_connection(notify_delivery* d, time_t now) {
+    for (; d->url_idx < d->sub.DeliveryURLs.size; d->url_idx++) {
+        uri_type url = d->sub.DeliveryURLs.parsedURLs[d->url_idx];
+        /* set pathquery to "/" if it is empty, same as http_Connect() */
+        if (url.pathquery.size == (size_t)0) {
+            url.pathquery.buff = "/";
+            url.pathquery.size = (size_t)1;
+        }
+        UpnpPrintf(UPNP_ALL, GENA, __FILE__, __LINE__,
+                   "gena notify to: %.*s\n", (int)url.hostport.text.size,
+                   url.hostport.text.buff);
+
+        membuffer_destroy(&d->start_msg);
+        membuffer_init(&d->start_msg);
+        if (http_MakeMessage(&d->start_msg, 1, 1,
+                             "q"
+                             "s",
+                             HTTPMETHOD_NOTIFY, &url, d->mid_msg.buf) != 0) {
+            d->return_code = UPNP_E_OUTOF_MEMORY;
+            break;
+        }
+
+        // The socket is always AF_INET6. Map an IPv4 destination.
+        sockaddr_in6 saddr{};
+        const sockaddr_storage& dest = url.hostport.IPaddress;
+        if (dest.ss_family == AF_INET6) {
+            memcpy(&saddr, &dest, sizeof(saddr));
+        } else if (dest.ss_family == AF_INET) {
+            const sockaddr_in& dest4 =
+                reinterpret_cast<const sockaddr_in&>(dest);
+            saddr.sin6_family = static_cast<sa_family_t>(AF_INET6);
+            saddr.sin6_port = dest4.sin_port;
+            saddr.sin6_addr.s6_addr[10] = 0xff;
+            saddr.sin6_addr.s6_addr[11] = 0xff;
+            memcpy(&saddr.sin6_addr.s6_addr[12], &dest4.sin_addr, 4);
+        } else {
+            d->return_code = UPNP_E_SOCKET_CONNECT;
+            continue;
+        }
+
+        try {
+            d->sock = UPnPsdk::socket(SOCK_STREAM);
+        } catch (const std::exception& ex) {
+            UPnPsdk_LOGCATCH("MSG1181") "catched next line...\n" << ex.what();
+            d->return_code = UPNP_E_OUTOF_SOCKET;
+            break;
+        }
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
+        if (sock_make_no_blocking(d->sock) != 0) {
+            close_connection(d);
+            d->return_code = UPNP_E_OUTOF_SOCKET;
+            break;
+        }
+        d->sent = 0;
+        d->ok_on_close = 0;
+        d->deadline = now + GENA_NOTIFICATION_SENDING_TIMEOUT;
+        if (umock::sys_socket_h.connect(d->sock,
+                                        reinterpret_cast<sockaddr*>(&saddr),
+                                        sizeof(saddr)) == 0) {
+            d->state = NOTIFY_SENDING;
+            return;
+        }
+        if (would_block(true)) {
+            d->state = NOTIFY_CONNECTING;
+            return;
+        }
+        close_connection(d);
+        d->return_code = UPNP_E_SOCKET_CONNECT;
+    }
+    d->state = NOTIFY_DONE;
+}
+
+/*!
+ * \brief Gives up the current delivery URL and tries the next one.
+ */
+void next_url(notify_delivery* d, int return_code, time_t now) {
+    close_connection(d);
+    d->return_code = return_code;
+    d->url_idx++;
+    start_connection(d, now);
+}
+
+/*!
+ * \brief Evaluates the complete response of the control point, the same as
+ * genaNotify() does.
+ */
+void response_received(notify_delivery* d) {
+    if (d->response.msg.status_code == HTTP_OK)
+        d->return_code = GENA_SUCCESS;
+    else if (d->response.msg.status_code == HTTP_PRECONDITION_FAILED)
+        /* Invalid SID gets removed */
+        d->return_code = GENA_E_NOTIFY_UNACCEPTED_REMOVE_SUB;
+    else
+        d->return_code = GENA_E_NOTIFY_UNACCEPTED;
+    close_connection(d);
+    d->state = NOTIFY_DONE;
+}
+
+/*!
+ * \brief Sends as much of the request as the socket accepts.
+ */
+void send_request(notify_delivery* d, time_t now) {
+    /* note: end of notification will contain "\r\n" twice */
+    const char* const segs[]{d->start_msg.buf, d->propertySet, "\r\n"};
+    const size_t lens[]{d->start_msg.length, d->propertySet_len, 2};
+
+    for (;;) {
+        size_t offset{d->sent};
+        size_t i{};
+        while (i < 3 && offset >= lens[i])
+            offset -= lens[i++];
+        if (i == 3)
+            break;
+        SSIZEP_T num_written = umock::sys_socket_h.send(
+            d->sock, segs[i] + offset, static_cast<SIZEP_T>(lens[i] - offset),
+            MSG_NOSIGNAL);
+        if (num_written < 0) {
+            if (would_block(false))
+                return;
+            next_url(d, UPNP_E_SOCKET_WRITE, now);
+            return;
+        }
+        d->sent += static_cast<size_t>(num_written);
+    }
+    parser_response_init(&d->response, HTTPMETHOD_NOTIFY);
+    d->parser_initialized = 1;
+    d->state = NOTIFY_RECEIVING;
+    d->deadline = now + GENA_NOTIFICATION_ANSWERING_TIMEOUT;
+}
+
+/*!
+ * \brief Reads what is available of the response and parses it, the same as
+ * http_RecvMessage() does.
+ */
+void recv_response(notify_delivery* d, time_t now) {
+    size_t buf_len;
+
+    for (;;) {
+        /* Receive directly into the message buffer of the parser. */
+        char* buf = parser_get_tail(&d->response, 1024, &buf_len);
+        if (buf == nullptr) {
+            next_url(d, UPNP_E_OUTOF_MEMORY, now);
+            return;
+        }
+        SSIZEP_T num_read = umock::sys_socket_h.recv(
+            d->sock, buf, static_cast<SIZEP_T>(buf_len), 0);
+        if (num_read > 0) {
+            switch (parser_append_tail(&d->response,
+                                       static_cast<size_t>(num_read))) {
+            case PARSE_SUCCESS:
+                if (g_maxContentLength > (size_t)0 &&
+                    d->response.content_length >
+                        (unsigned int)g_maxContentLength) {
+                    next_url(d, UPNP_E_OUTOF_BOUNDS, now);
+                    return;
+                }
+                [[fallthrough]];
+            case PARSE_CONTINUE_1:
+                response_received(d);
+                return;
+            case PARSE_FAILURE:
+            case PARSE_NO_MATCH:
+                next_url(d, UPNP_E_BAD_HTTPMSG, now);
+                return;
+            case PARSE_INCOMPLETE_ENTITY:
+                /* read until close */
+                d->ok_on_close = 1;
+                break;
+            default:
+                break;
+            }
+        } else if (num_read == 0) {
+            if (d->ok_on_close)
+                response_received(d);
+            else
+                next_url(d, UPNP_E_BAD_HTTPMSG, now);
+            return;
+        } else {
+            if (!would_block(false))
+                next_url(d, UPNP_E_SOCKET_READ, now);
+            return;
+        }
+    }
+}
+
+/*!
+ * \brief Advances the state of a delivery after poll() has returned.
+ */
+void advance_delivery(notify_delivery* d, short revents, time_t now) {
+    if (revents == 0) {
+        if (now < d->deadline)
+            return;
+        next_url(d,
+                 d->state == NOTIFY_CONNECTING ? UPNP_E_SOCKET_CONNECT
+                                               : UPNP_E_TIMEDOUT,
+                 now);
+        return;
+    }
+    if (d->state == NOTIFY_CONNECTING) {
+        int valopt{};
+        socklen_t len{sizeof(valopt)};
+        if (umock::sys_socket_h.getsockopt(d->sock, SOL_SOCKET, SO_ERROR,
+                                           &valopt, &len) < 0 ||
+            valopt != 0) {
+            next_url(d, UPNP_E_SOCKET_CONNECT, now);
+            return;
+        }
+        d->state = NOTIFY_SENDING;
+    }
+    if (d->state == NOTIFY_SENDING) {
+        send_request(d, now);
+        return;
+    }
+    if (d->state == NOTIFY_RECEIVING)
+        recv_response(d, now);
+}
+
+/*!
+ * \brief Persistent job of the notify engine.
+ */
+void notify_engine_thread(void*) {
+    // Deliveries in flight, max GENA_NOTIFY_ENGINE_MAX_CONNECTIONS.
+    notify_delivery* active[GENA_NOTIFY_ENGINE_MAX_CONNECTIONS];
+    size_t num_active{};
+    // Deliveries waiting for a free connection slot, in submission order.
+    notify_delivery* pending_head{nullptr};
+    notify_delivery* pending_tail{nullptr};
+    pollfd fds[GENA_NOTIFY_ENGINE_MAX_CONNECTIONS + 1];
+
+    UpnpPrintf(UPNP_INFO, GENA, __FILE__, __LINE__,
+               "GENA notify engine started\n");
+    for (;;) {
+        pthread_mutex_lock(&gEngine.mutex);
+        if (gEngine.shutdown) {
+            pthread_mutex_unlock(&gEngine.mutex);
+            break;
+        }
+        if (gEngine.submitted_head) {
+            if (pending_tail)
+                pending_tail->next = gEngine.submitted_head;
+            else
+                pending_head = gEngine.submitted_head;
+            pending_tail = gEngine.submitted_tail;
+            gEngine.submitted_head = nullptr;
+            gEngine.submitted_tail = nullptr;
+        }
+        pthread_mutex_unlock(&gEngine.mutex);
+
+        time_t now = time(nullptr);
+        while (pending_head &&
+               num_active < GENA_NOTIFY_ENGINE_MAX_CONNECTIONS) {
+            notify_delivery* d = pending_head;
+            pending_head = d->next;
+            if (!pending_head)
+                pending_tail = nullptr;
+            d->next = nullptr;
+            start_connection(d, now);
+            if (d->state == NOTIFY_DONE)
+                finish_delivery(d);
+            else
+                active[num_active++] = d;
+        }
+
+        // Wait for events, at most until the next deadline.
+        time_t next_deadline{now + 1};
+        fds[0].fd = gEngine.wake_sock;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        for (size_t i{}; i < num_active; i++) {
+            fds[i + 1].fd = active[i]->sock;
+            fds[i + 1].events =
+                active[i]->state == NOTIFY_RECEIVING ? POLLIN : POLLOUT;
+            fds[i + 1].revents = 0;
+            if (active[i]->deadline < next_deadline)
+                next_deadline = active[i]->deadline;
+        }
+        int timeout_ms = next_deadline > now
+                             ? static_cast<int>(next_deadline - now) * 1000
+                             : 0;
+        if (poll_sockets(fds, num_active + 1, timeout_ms) < 0 &&
+            !would_block(false)) {
+            UPnPsdk::CSocketErr serrObj;
+            serrObj.catch_error();
+            UPnPsdk_LOGERR("MSG1182") "poll() failed: "
+                << serrObj.error_str() << "\n";
+        }
+
+        if (fds[0].revents) {
+            char buf[16];
+            while (umock::sys_socket_h.recv(gEngine.wake_sock, buf,
+                                            sizeof(buf), 0) > 0) {
+            }
+        }
+        now = time(nullptr);
+        // Deliveries are removed by moving the last one into the gap. Its
+        // poll result is moved too.
+        for (size_t i{}; i < num_active;) {
+            advance_delivery(active[i], fds[i + 1].revents, now);
+            if (active[i]->state != NOTIFY_DONE) {
+                i++;
+                continue;
+            }
+            finish_delivery(active[i]);
+            num_active--;
+            active[i] = active[num_active];
+            fds[i + 1].revents = fds[num_active + 1].revents;
+        }
+    }
+
+    // Finish all deliveries that are left.
+    pthread_mutex_lock(&gEngine.mutex);
+    if (pending_tail)
+        pending_tail->next = gEngine.submitted_head;
+    else
+        pending_head = gEngine.submitted_head;
+    gEngine.submitted_head = nullptr;
+    gEngine.submitted_tail = nullptr;
+    pthread_mutex_unlock(&gEngine.mutex);
+    for (size_t i{}; i < num_active; i++) {
+        active[i]->return_code = UPNP_E_FINISH;
+        finish_delivery(active[i]);
+    }
+    while (pending_head) {
+        notify_delivery* d = pending_head;
+        pending_head = d->next;
+        d->return_code = UPNP_E_FINISH;
+        finish_delivery(d);
+    }
+
+    pthread_mutex_lock(&gEngine.mutex);
+    gEngine.shutdown = 0;
+    pthread_cond_broadcast(&gEngine.condition);
+    pthread_mutex_unlock(&gEngine.mutex);
+    UpnpPrintf(UPNP_INFO, GENA, __FILE__, __LINE__,
+               "GENA notify engine stopped\n");
+}
+
+} // anonymous namespace
+/// \endcond
+
+
+int genaNotifyEngineStart(ThreadPool* tp) {
+    ThreadPoolJob job;
+    int ret{UPNP_E_SUCCESS};
+
+    pthread_mutex_lock(&gEngine.mutex);
+    if (gEngine.running) {
+        ret = UPNP_E_INIT;
+        goto ExitFunction;
+    }
+    gEngine.wake_sock = create_wake_sock();
+    if (gEngine.wake_sock == INVALID_SOCKET) {
+        ret = UPNP_E_OUTOF_SOCKET;
+        goto ExitFunction;
+    }
+    gEngine.shutdown = 0;
+    TPJobInit(&job, notify_engine_thread, nullptr);
+    TPJobSetPriority(&job, HIGH_PRIORITY);
+    if (ThreadPoolAddPersistent(tp, &job, nullptr) != 0) {
+        CLOSE_SOCKET_P(gEngine.wake_sock);
+        gEngine.wake_sock = INVALID_SOCKET;
+        ret = UPNP_E_INIT_FAILED;
+        goto ExitFunction;
+    }
+    gEngine.running = 1;
+
+ExitFunction:
+    pthread_mutex_unlock(&gEngine.mutex);
+    return ret;
+}
+
+void genaNotifyEngineStop() {
+    pthread_mutex_lock(&gEngine.mutex);
+    if (!gEngine.running) {
+        pthread_mutex_unlock(&gEngine.mutex);
+        return;
+    }
+    gEngine.running = 0;
+    gEngine.shutdown = 1;
+    wakeup_engine();
+    while (gEngine.shutdown) {
+        /* wait for engine job to finish. */
+        pthread_cond_wait(&gEngine.condition, &gEngine.mutex);
+    }
+    CLOSE_SOCKET_P(gEngine.wake_sock);
+    gEngine.wake_sock = INVALID_SOCKET;
+    pthread_mutex_unlock(&gEngine.mutex);
+}
+
+int genaNotifyEngineIsRunning() {
+    pthread_mutex_lock(&gEngine.mutex);
+    int running = gEngine.running;
+    pthread_mutex_unlock(&gEngine.mutex);
+    return running;
+}
+
+int genaNotifyEngineSubmit(subscription* sub, const char* headers,
+                           const char* propertySet,
+                           gena_notify_done_routine done, void* cookie) {
+    notify_delivery* d = (notify_delivery*)malloc(sizeof(notify_delivery));
+    if (d == nullptr)
+        return UPNP_E_OUTOF_MEMORY;
+    memset(d, 0, sizeof(notify_delivery));
+    membuffer_init(&d->mid_msg);
+    membuffer_init(&d->start_msg);
+    if (http_MakeMessage(&d->mid_msg, 1, 1,
+                         "s"
+                         "ssc"
+                         "sdcc",
+                         headers, "SID: ", sub->sid, "SEQ: ",
+                         sub->ToSendEventKey) != 0) {
+        membuffer_destroy(&d->mid_msg);
+        free(d);
+        return UPNP_E_OUTOF_MEMORY;
+    }
+    d->propertySet = propertySet;
+    d->propertySet_len = strlen(propertySet);
+    d->sock = INVALID_SOCKET;
+    d->state = NOTIFY_CONNECTING;
+    /* same as genaNotify() if there is no delivery URL */
+    d->return_code = -1;
+    d->done = done;
+    d->cookie = cookie;
+
+    pthread_mutex_lock(&gEngine.mutex);
+    if (!gEngine.running) {
+        pthread_mutex_unlock(&gEngine.mutex);
+        membuffer_destroy(&d->mid_msg);
+        free(d);
+        return UPNP_E_FINISH;
+    }
+    // Take over the subscription copy. The caller must not free it anymore.
+    d->sub = *sub;
+    ListInit(&d->sub.outgoing, 0, 0);
+    sub->DeliveryURLs.URLs = nullptr;
+    sub->DeliveryURLs.parsedURLs = nullptr;
+    sub->DeliveryURLs.size = 0;
+    if (gEngine.submitted_tail)
+        gEngine.submitted_tail->next = d;
+    else
+        gEngine.submitted_head = d;
+    gEngine.submitted_tail = d;
+    wakeup_engine();
+    pthread_mutex_unlock(&gEngine.mutex);
+
+    return UPNP_E_SUCCESS;
+}
@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (C) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-04-09
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  * Cloned from pupnp ver 1.14.15.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,10 +48,14 @@
 #include <miniserver.hpp> // Needed for one of the compile options
 
 #include <httpreadwrite.hpp>
+#include <ObjectPool.hpp>
+#include <metrics.hpp>
 #include <ssdp_common.hpp>
 #include <statcodes.hpp>
 #include <upnpapi.hpp>
 
+#include <UPnPsdk/netadapter.hpp>
+
 #include <umock/sys_socket.hpp>
 #include <umock/stdlib.hpp>
 #include <umock/pupnp_miniserver.hpp>
@@ -59,6 +63,14 @@
 
 /// \cond
 #include <thread>
+#include <vector>
+#ifdef __linux__
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 /// \endcond
 
 namespace {
@@ -125,17 +137,27 @@ static int active_connection_cmp(void* first, void* second) {
 }
 
 /*!
- * \brief Add a socket to the active connections list
+ * \brief Initialize the active connections list if not already done
+ *
+ * It is not thread safe and must be called before more than one thread can
+ * add connections.
  */
-static void add_active_connection(SOCKET sock) {
-    TRACE("Executing add_active_connection()");
-    struct active_connection_t* conn;
-
+static void init_active_connections(void) {
     if (!gActiveConnectionsInitialized) {
         ListInit(&gActiveConnections, active_connection_cmp, free);
         pthread_mutex_init(&gActiveConnectionsMutex, NULL);
         gActiveConnectionsInitialized = 1;
     }
+}
+
+/*!
+ * \brief Add a socket to the active connections list
+ */
+static void add_active_connection(SOCKET sock) {
+    TRACE("Executing add_active_connection()");
+    struct active_connection_t* conn;
+
+    init_active_connections();
 
     conn =
         (struct active_connection_t*)malloc(sizeof(struct active_connection_t));
@@ -389,7 +411,8 @@ void free_handle_request_arg(
     mserv_request_t* request = static_cast<mserv_request_t*>(args);
     remove_active_connection(request->sock);
     sock_close(request->sock);
-    free(request);
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
+    ObjectPoolFree(request, sizeof(mserv_request_t));
 }
 
 /*!
@@ -427,7 +450,7 @@ void handle_request(
         &info, sock,
         reinterpret_cast<sockaddr*>(&request_in->foreign_sockaddr));
     if (ret_code != UPNP_E_SUCCESS) {
-        free(request_in);
+        ObjectPoolFree(request_in, sizeof(mserv_request_t));
         httpmsg_destroy(hmsg);
         return;
     }
@@ -439,6 +462,9 @@ void handle_request(
                          // Will be initialized by next function.
     ret_code = http_RecvMessage(&info, &parser, HTTPMETHOD_UNKNOWN, &timeout,
                                 &http_error_code);
+    // Count the responses to this request by its method.
+    compa::metrics_http_request(ret_code == 0 ? hmsg->method
+                                              : HTTPMETHOD_UNKNOWN);
     if (ret_code == 0) {
         UPnPsdk_LOGINFO("MSG1106") "miniserver socket=" << sock
                                                         << ": PROCESSING...\n";
@@ -454,9 +480,10 @@ void handle_request(
         http_SendStatusResponse(&info, http_error_code, http_major_version,
                                 http_minor_version);
     }
+    compa::metrics_http_request(-1);
     sock_destroy(&info, SD_BOTH);
     httpmsg_destroy(hmsg);
-    free(request_in);
+    ObjectPoolFree(request_in, sizeof(mserv_request_t));
 
     UPnPsdk_LOGINFO("MSG1058") "miniserver socket(" << sock << "); COMPLETE.\n";
 }
@@ -483,11 +510,12 @@ inline void schedule_request_job(
     }
 
     ThreadPoolJob job{};
-    mserv_request_t* request{
-        static_cast<mserv_request_t*>(std::malloc(sizeof(mserv_request_t)))};
+    mserv_request_t* request{static_cast<mserv_request_t*>(
+        ObjectPoolAlloc(sizeof(mserv_request_t)))};
     if (request == nullptr) {
         UPnPsdk_LOGCRIT("MSG1024") "Socket(" << a_sock << "): out of memory.\n";
         sock_close(a_sock);
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
         return;
     }
 
@@ -505,12 +533,315 @@ inline void schedule_request_job(
         UPnPsdk_LOGERR("MSG1025") "Socket("
             << a_sock << "): failed to add job to miniserver threadpool.\n";
         remove_active_connection(a_sock);
-        free(request);
+        ObjectPoolFree(request, sizeof(mserv_request_t));
         sock_close(a_sock);
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
     }
 }
+
+#ifdef __linux__
+/// \brief Additional listening sockets bound with SO_REUSEPORT to the
+/// addresses of the miniserver listening sockets.
+std::vector<SOCKET> gAcceptorSocks;
+/// \brief Acceptor threads, one for each additional listening socket.
+std::vector<std::thread> gAcceptorThreads;
+/// \brief Event file descriptor to stop the acceptor threads.
+int gAcceptorStopFd{-1};
+
+/*!
+ * \brief Prepare a new listening miniserver socket to share its address with
+ * additional listening sockets.
+ *
+ * This sets the socket option SO_REUSEPORT if more than one acceptor is
+ * configured with UpnpSetMiniServerAcceptors(). It must be called before the
+ * socket is bound.
+ *
+ * \returns **true** if additional listening sockets can be opened after
+ * binding, **false** otherwise.
+ */
+bool enable_acceptors(
+    /*! [in] Not yet bound listening miniserver socket. */
+    SOCKET a_sock) {
+    if (g_UpnpSdkMiniServerAcceptors <= 1)
+        return false;
+
+    constexpr int so_option{1};
+    if (umock::sys_socket_h.setsockopt(a_sock, SOL_SOCKET, SO_REUSEPORT,
+                                       &so_option, sizeof(so_option)) != 0) {
+        UPnPsdk_LOGERR("MSG1184") "Socket("
+            << a_sock << "): failed to set socket option SO_REUSEPORT: "
+            << std::strerror(errno) << ". Using only one acceptor.\n";
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Open additional listening sockets on the address of a listening
+ * miniserver socket.
+ *
+ * The sockets are non blocking so that an acceptor thread can accept all
+ * pending connections after it was woken up. If a socket cannot be opened the
+ * miniserver continues with less acceptors.
+ */
+void open_acceptor_sockets(
+    /*! [in] Local address of the listening miniserver socket that has the
+     * socket option SO_REUSEPORT set. */
+    UPnPsdk::SSockaddr& a_saObj) {
+    constexpr int so_option{1};
+
+    for (int i{1}; i < g_UpnpSdkMiniServerAcceptors; i++) {
+        SOCKET sock{umock::sys_socket_h.socket(
+            a_saObj.ss.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            0)};
+        if (sock == INVALID_SOCKET ||
+            umock::sys_socket_h.setsockopt(sock, SOL_SOCKET, SO_REUSEPORT,
+                                           &so_option,
+                                           sizeof(so_option)) != 0 ||
+            umock::sys_socket_h.bind(sock, &a_saObj.sa,
+                                     a_saObj.sizeof_saddr()) != 0 ||
+            umock::sys_socket_h.listen(sock, SOMAXCONN) != 0) {
+            UPnPsdk_LOGERR("MSG1185") "Failed to open additional listening "
+                                      "socket on \""
+                << a_saObj.netaddrp() << "\": " << std::strerror(errno)
+                << ".\n";
+            if (sock != INVALID_SOCKET)
+                sock_close(sock);
+            return;
+        }
+        gAcceptorSocks.push_back(sock);
+    }
+}
+
+/*!
+ * \brief Accept connections on an additional listening socket until the
+ * acceptor threads are stopped.
+ *
+ * This function runs in its own thread.
+ */
+void run_acceptor(
+    /*! [in] Non blocking listening socket. */
+    SOCKET a_listen_sock) {
+    pollfd fds[]{{a_listen_sock, POLLIN, 0}, {gAcceptorStopFd, POLLIN, 0}};
+    bool out_of_fds{false};
+
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            UPnPsdk_LOGCRIT("MSG1186") "Error in ::poll(): "
+                << std::strerror(errno) << ". Stopping acceptor on socket("
+                << a_listen_sock << ").\n";
+            return;
+        }
+        if (fds[1].revents != 0)
+            return;
+
+        // Accept all pending connections. The connection sockets stay blocking
+        // as expected by handle_request().
+        while (true) {
+            UPnPsdk::SSockaddr ctrlpnt_saObj;
+            socklen_t ctrlpntLen = sizeof(ctrlpnt_saObj.ss);
+            SOCKET conn_sock{umock::sys_socket_h.accept4(
+                a_listen_sock, &ctrlpnt_saObj.sa, &ctrlpntLen, SOCK_CLOEXEC)};
+            if (conn_sock == INVALID_SOCKET) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                if (errno == EMFILE || errno == ENFILE) {
+                    // The connection remains pending and the listening socket
+                    // readable. Wait for free file descriptors instead of
+                    // polling again at once, but stop on request.
+                    if (!out_of_fds)
+                        UPnPsdk_LOGERR("MSG1200") "Error in ::accept4(): "
+                            << std::strerror(errno)
+                            << ". Retrying on socket(" << a_listen_sock
+                            << ") every 100 ms.\n";
+                    out_of_fds = true;
+                    ::poll(&fds[1], 1, 100);
+                    break;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    UPnPsdk_LOGERR("MSG1187") "Error in ::accept4(): "
+                        << std::strerror(errno) << ".\n";
+                break;
+            }
+            out_of_fds = false;
+            compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
+            schedule_request_job(conn_sock, ctrlpnt_saObj);
+        }
+    }
+}
+
+/*!
+ * \brief Stop the acceptor threads and close the additional listening
+ * sockets.
+ */
+void stop_acceptors() {
+    if (gAcceptorStopFd != -1) {
+        constexpr uint64_t stop{1};
+        if (::write(gAcceptorStopFd, &stop, sizeof(stop)) == -1)
+            UPnPsdk_LOGCRIT("MSG1188") "Failed to stop acceptor threads: "
+                << std::strerror(errno) << ".\n";
+    }
+    for (std::thread& thread : gAcceptorThreads)
+        thread.join();
+    gAcceptorThreads.clear();
+    for (SOCKET sock : gAcceptorSocks)
+        sock_close(sock);
+    gAcceptorSocks.clear();
+    if (gAcceptorStopFd != -1) {
+        ::close(gAcceptorStopFd);
+        gAcceptorStopFd = -1;
+    }
+}
+
+/*!
+ * \brief Start an acceptor thread for each additional listening socket.
+ *
+ * On error the additional listening sockets are closed and the miniserver
+ * accepts connections only on its own listening sockets.
+ */
+void start_acceptors() {
+    if (gAcceptorSocks.empty())
+        return;
+
+    // Connections are now added from more than one thread.
+    init_active_connections();
+    gAcceptorStopFd = ::eventfd(0, EFD_CLOEXEC);
+    if (gAcceptorStopFd == -1) {
+        UPnPsdk_LOGCRIT("MSG1189") "Failed to create eventfd: "
+            << std::strerror(errno) << ".\n";
+        stop_acceptors();
+        return;
+    }
+    try {
+        for (SOCKET sock : gAcceptorSocks)
+            gAcceptorThreads.emplace_back(run_acceptor, sock);
+    } catch (const std::exception& ex) {
+        UPnPsdk_LOGCATCH("MSG1190") "catched next line...\n" << ex.what();
+        stop_acceptors();
+        return;
+    }
+    UPnPsdk_LOGINFO("MSG1191") "Started "
+        << gAcceptorThreads.size() << " additional acceptor threads.\n";
+}
+#endif // __linux__
 #endif // COMPA_HAVE_WEBSERVER
 
+#ifdef __linux__
+/*!
+ * \brief Open a netlink socket that reports changes of the local network
+ * adapters and load a snapshot of the network adapter list.
+ *
+ * While the miniserver is running, address lookups with UPnPsdk::CNetadapter
+ * take the network adapter list from the snapshot instead of asking the
+ * operating system each time.
+ *
+ * \returns
+ *  On success: file descriptor of the netlink socket\n
+ *  On error: -1, there is no snapshot.
+ */
+int open_netlink_sock() {
+    int sock{::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                      NETLINK_ROUTE)};
+    if (sock == -1) {
+        UPnPsdk_LOGERR("MSG1193") "Failed to open netlink socket: "
+            << std::strerror(errno) << ".\n";
+        return -1;
+    }
+    sockaddr_nl nladdr{};
+    nladdr.nl_family = AF_NETLINK;
+    nladdr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (::bind(sock, reinterpret_cast<sockaddr*>(&nladdr), sizeof(nladdr)) !=
+            0 ||
+        sock >= FD_SETSIZE) {
+        UPnPsdk_LOGERR("MSG1198") "Failed to bind netlink socket("
+            << sock << "): " << std::strerror(errno) << ".\n";
+        ::close(sock);
+        return -1;
+    }
+    try {
+        UPnPsdk::netadapter_snapshot_load();
+    } catch (const std::exception& ex) {
+        UPnPsdk_LOGCATCH("MSG1194") "catched next line...\n" << ex.what();
+        ::close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/*!
+ * \brief Read all messages from the netlink socket and reload the snapshot of
+ * the network adapter list if the local network adapters have changed.
+ */
+void netlink_read(
+    int a_sock, ///< [in] File descriptor of the netlink socket.
+    fd_set* a_set /*!< [in] Pointer to a file descriptor set as needed for
+                             \::select(). */) {
+    if (a_sock == -1 || !FD_ISSET(a_sock, a_set))
+        return;
+
+    alignas(nlmsghdr) char buf[8192];
+    bool changed{false};
+    while (true) {
+        const ssize_t len{::recv(a_sock, buf, sizeof(buf), 0)};
+        if (len == -1 && errno == EINTR)
+            continue;
+        if (len == -1 && errno == ENOBUFS) {
+            // Messages are lost on overrun, so reload the list anyway.
+            changed = true;
+            continue;
+        }
+        if (len <= 0)
+            break; // All messages read.
+
+        size_t pos{0};
+        while (pos + sizeof(nlmsghdr) <= static_cast<size_t>(len)) {
+            const nlmsghdr* nlh{reinterpret_cast<const nlmsghdr*>(buf + pos)};
+            if (nlh->nlmsg_len < sizeof(nlmsghdr) ||
+                pos + nlh->nlmsg_len > static_cast<size_t>(len))
+                break;
+            switch (nlh->nlmsg_type) {
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+                changed = true;
+                break;
+            default:
+                break;
+            }
+            pos += NLMSG_ALIGN(nlh->nlmsg_len);
+        }
+    }
+    if (!changed)
+        return;
+
+    try {
+        UPnPsdk::netadapter_snapshot_load();
+        UPnPsdk_LOGINFO("MSG1195") "Local network adapters have changed. "
+                                   "Reloaded network adapter list.\n";
+    } catch (const std::exception& ex) {
+        // Without a snapshot the list is loaded from the operating system.
+        UPnPsdk::netadapter_snapshot_clear();
+        UPnPsdk_LOGCATCH("MSG1196") "catched next line...\n" << ex.what();
+    }
+}
+
+/*!
+ * \brief Close the netlink socket and remove the snapshot of the network
+ * adapter list.
+ */
+void close_netlink_sock(
+    int a_sock ///< [in] File descriptor of the netlink socket.
+) {
+    if (a_sock == -1)
+        return;
+    ::close(a_sock);
+    UPnPsdk::netadapter_snapshot_clear();
+}
+#endif // __linux__
+
 /*!
  * \brief Add a socket file descriptor to an \p 'fd_set' structure as needed for
  * \p \::select().
@@ -603,6 +934,7 @@ int web_server_accept(
             << std::strerror(errno) << ".\n";
         return UPNP_E_SOCKET_ACCEPT;
     }
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
 
     if (UPnPsdk::g_dbug) {
         // Some helpful status information.
@@ -828,9 +1160,16 @@ void RunMiniServer(
         std::max(maxMiniSock, miniSock->ssdpReqSock6 == INVALID_SOCKET
                                   ? 0
                                   : miniSock->ssdpReqSock6);
+#endif
+#ifdef __linux__
+    const int netlinkSock{open_netlink_sock()};
+    maxMiniSock = std::max(maxMiniSock, netlinkSock == -1 ? 0 : netlinkSock);
 #endif
     ++maxMiniSock;
 
+#if defined(COMPA_HAVE_WEBSERVER) && defined(__linux__)
+    start_acceptors();
+#endif
     gMServState = MSERV_RUNNING;
     while (!stopSock) {
         FD_ZERO(&rdSet);
@@ -850,6 +1189,10 @@ void RunMiniServer(
         fdset_if_valid(miniSock->ssdpReqSock4, &rdSet);
         fdset_if_valid(miniSock->ssdpReqSock6, &rdSet);
 #endif
+#ifdef __linux__
+        if (netlinkSock != -1)
+            FD_SET(netlinkSock, &rdSet);
+#endif
 
         // select(): this call is blocking. If requested, it messured how long.
         // If modifying the 'select()' call, do it below identical two times.
@@ -912,6 +1255,9 @@ void RunMiniServer(
         ssdp_read(&miniSock->ssdpSock6, &rdSet);
         ssdp_read(&miniSock->ssdpSock6UlaGua, &rdSet);
         // }
+#ifdef __linux__
+        netlink_read(netlinkSock, &rdSet);
+#endif
 
         // Check if we have received a packet from localhost that will stop the
         // miniserver.
@@ -920,11 +1266,17 @@ void RunMiniServer(
     } // while (!stopsock)
 
 #ifdef COMPA_HAVE_WEBSERVER
+#ifdef __linux__
+    stop_acceptors();
+#endif
     /* shutdown connections */
     shutdown_all_active_connections();
 #endif
 
     /* Close all sockets. */
+#ifdef __linux__
+    close_netlink_sock(netlinkSock);
+#endif
     sock_close(miniSock->miniServerSock4);
     sock_close(miniSock->miniServerSock6);
     sock_close(miniSock->miniServerSock6UlaGua);
@@ -1004,10 +1356,17 @@ int get_miniserver_sockets(
                         std::to_string(gIF_INDEX) +
                         "]:" + std::to_string(listen_port6);
             *out->pSockLlaObj = SOCK_STREAM;
+#ifdef __linux__
+            const bool acceptors{enable_acceptors(*out->pSockLlaObj)};
+#endif
             out->pSockLlaObj->bind(&saObj, AI_PASSIVE);
             out->pSockLlaObj->listen();
             out->miniServerSock6 = *out->pSockLlaObj;
             out->pSockLlaObj->local_saddr(&saObj);
+#ifdef __linux__
+            if (acceptors)
+                open_acceptor_sockets(saObj);
+#endif
             out->miniServerPort6 = saObj.port();
             retval = UPNP_E_SUCCESS;
         } catch (const std::exception& ex) {
@@ -1027,10 +1386,17 @@ int get_miniserver_sockets(
             saObj = '[' + std::string(gIF_IPV6_ULA_GUA) +
                     "]:" + std::to_string(listen_port6UlaGua);
             *out->pSockGuaObj = SOCK_STREAM;
+#ifdef __linux__
+            const bool acceptors{enable_acceptors(*out->pSockGuaObj)};
+#endif
             out->pSockGuaObj->bind(&saObj, AI_PASSIVE);
             out->pSockGuaObj->listen();
             out->miniServerSock6UlaGua = *out->pSockGuaObj;
             out->pSockGuaObj->local_saddr(&saObj);
+#ifdef __linux__
+            if (acceptors)
+                open_acceptor_sockets(saObj);
+#endif
             out->miniServerPort6UlaGua = saObj.port();
             retval = UPNP_E_SUCCESS;
         } catch (const std::exception& ex) {
@@ -1051,10 +1417,17 @@ int get_miniserver_sockets(
             UPnPsdk::SSockaddr saObj;
             saObj = std::string(gIF_IPV4) + ':' + std::to_string(listen_port4);
             *out->pSockIp4Obj = SOCK_STREAM;
+#ifdef __linux__
+            const bool acceptors{enable_acceptors(*out->pSockIp4Obj)};
+#endif
             out->pSockIp4Obj->bind(&saObj, AI_PASSIVE);
             out->pSockIp4Obj->listen();
             out->miniServerSock4 = *out->pSockIp4Obj;
             out->pSockIp4Obj->local_saddr(&saObj);
+#ifdef __linux__
+            if (acceptors)
+                open_acceptor_sockets(saObj);
+#endif
             out->miniServerPort4 = saObj.port();
             retval = UPNP_E_SUCCESS;
         } catch (const std::exception& ex) {
@@ -1211,6 +1584,9 @@ int StartMiniServer([[maybe_unused]] in_port_t* listen_port4,
     /* Stop socket (To end miniserver processing). */
     ret_code = get_miniserver_stopsock(miniSocket);
     if (ret_code != UPNP_E_SUCCESS) {
+#if defined(COMPA_HAVE_WEBSERVER) && defined(__linux__)
+        stop_acceptors();
+#endif
         sock_close(miniSocket->miniServerSock4);
         sock_close(miniSocket->miniServerSock6);
         sock_close(miniSocket->miniServerSock6UlaGua);
@@ -1221,6 +1597,9 @@ int StartMiniServer([[maybe_unused]] in_port_t* listen_port4,
     /* SSDP socket for discovery/advertising. */
     ret_code = umock::pupnp_ssdp.get_ssdp_sockets(miniSocket);
     if (ret_code != UPNP_E_SUCCESS) {
+#if defined(COMPA_HAVE_WEBSERVER) && defined(__linux__)
+        stop_acceptors();
+#endif
         sock_close(miniSocket->miniServerSock4);
         sock_close(miniSocket->miniServerSock6);
         sock_close(miniSocket->miniServerSock6UlaGua);
@@ -1235,6 +1614,9 @@ int StartMiniServer([[maybe_unused]] in_port_t* listen_port4,
     TPJobSetFreeFunction(&job, (free_routine)free);
     ret_code = ThreadPoolAddPersistent(&gMiniServerThreadPool, &job, NULL);
     if (ret_code != 0) {
+#if defined(COMPA_HAVE_WEBSERVER) && defined(__linux__)
+        stop_acceptors();
+#endif
         sock_close(miniSocket->miniServerSock4);
         sock_close(miniSocket->miniServerSock6);
         sock_close(miniSocket->miniServerSock6UlaGua);
@@ -1258,6 +1640,9 @@ int StartMiniServer([[maybe_unused]] in_port_t* listen_port4,
     }
     if (count >= max_count) {
         /* Took it too long to start that thread. */
+#if defined(COMPA_HAVE_WEBSERVER) && defined(__linux__)
+        stop_acceptors();
+#endif
         sock_close(miniSocket->miniServerSock4);
         sock_close(miniSocket->miniServerSock6);
         sock_close(miniSocket->miniServerSock6UlaGua);
@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-17
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -1749,6 +1749,32 @@ parse_status_t parser_append(http_parser_t* parser, const char* buf,
     return parser_parse(parser);
 }
 
+char* parser_get_tail(http_parser_t* parser, size_t min_length,
+                      size_t* length) {
+    assert(parser != nullptr);
+    assert(length != nullptr);
+
+    membuffer* msg{&parser->msg.msg};
+    if (membuffer_reserve(msg, min_length) != 0) {
+        *length = 0;
+        return nullptr;
+    }
+    *length = msg->capacity - msg->length;
+    return msg->buf + msg->length;
+}
+
+parse_status_t parser_append_tail(http_parser_t* parser, size_t buf_length) {
+    assert(parser != nullptr);
+
+    membuffer* msg{&parser->msg.msg};
+    assert(buf_length <= msg->capacity - msg->length);
+    msg->length += buf_length;
+    /* null-terminate */
+    msg->buf[msg->length] = 0;
+
+    return parser_parse(parser);
+}
+
 
 int raw_to_int(memptr* raw_value, int base) {
     long num;
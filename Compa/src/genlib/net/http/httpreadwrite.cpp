@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-05-09
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -44,13 +44,16 @@
 
 #include <UpnpExtraHeaders.hpp>
 #include <UpnpIntTypes.hpp>
+#include <metrics.hpp>
 #include <statcodes.hpp>
 #include <upnpapi.hpp>
 #include <webserver.hpp>
 
 /// \cond
+#include <algorithm>
 #include <cassert>
 #include <cstdarg> // needed for MacOS
+#include <string>
 #ifdef _WIN32
 #include <malloc.h>
 #define fseeko fseek
@@ -86,6 +89,10 @@ constexpr size_t CHUNK_TAIL_SIZE{10};
  */
 constexpr time_t DEFAULT_TCP_CONNECT_TIMEOUT{5};
 
+/*! \brief Minimal free space in bytes of the message buffer to receive a HTTP
+ * message into. */
+constexpr size_t HTTP_RECV_MIN_SIZE{1024};
+
 /// \cond
 // #define PRIzd "zd"
 #define PRIzu "zu"
@@ -614,6 +621,7 @@ SOCKET http_Connect(uri_type* destination_url, uri_type* url) {
         UPnPsdk_LOGERR("MSG1167") << ex.what() << "\n";
         return static_cast<SOCKET>(UPNP_E_OUTOF_SOCKET);
     }
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
     sockaddr_len = (socklen_t)(url->hostport.IPaddress.ss_family == AF_INET6
                                    ? sizeof(struct sockaddr_in6)
                                    : sizeof(struct sockaddr_in));
@@ -629,6 +637,7 @@ SOCKET http_Connect(uri_type* destination_url, uri_type* url) {
                        "Error in shutdown: %s\n", std::strerror(errno));
         }
         umock::unistd_h.CLOSE_SOCKET_P(connfd);
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
         return static_cast<SOCKET>(UPNP_E_SOCKET_CONNECT);
     }
 
@@ -645,14 +654,9 @@ int http_RecvMessage(SOCKINFO* info, http_parser_t* parser,
     int num_read{};
     int ok_on_close{};
     char* buf;
-    size_t buf_len{1024};
+    size_t buf_len;
 
     *http_error_code = HTTP_INTERNAL_SERVER_ERROR;
-    buf = (char*)malloc(buf_len);
-    if (!buf) {
-        ret = UPNP_E_OUTOF_MEMORY;
-        goto ExitFunction;
-    }
     if (request_method == (http_method_t)HTTPMETHOD_UNKNOWN) {
         parser_request_init(parser);
     } else {
@@ -660,22 +664,17 @@ int http_RecvMessage(SOCKINFO* info, http_parser_t* parser,
     }
 
     while (1) {
-        /* Double the bet if needed */
-        /* We should have already exited the loop if the value was <= 0
-         * so the cast is safe */
-        if ((size_t)num_read >= buf_len) {
-            free(buf);
-            buf_len = 2 * buf_len;
-            buf = (char*)malloc(buf_len);
-            if (!buf) {
-                ret = UPNP_E_OUTOF_MEMORY;
-                goto ExitFunction;
-            }
+        /* Receive directly into the message buffer of the parser. Its free
+         * space grows geometrically. */
+        buf = parser_get_tail(parser, HTTP_RECV_MIN_SIZE, &buf_len);
+        if (!buf) {
+            ret = UPNP_E_OUTOF_MEMORY;
+            goto ExitFunction;
         }
         num_read = sock_read(info, buf, buf_len, timeout_secs);
         if (num_read > 0) {
             /* got data */
-            status = parser_append(parser, buf, (size_t)num_read);
+            status = parser_append_tail(parser, (size_t)num_read);
             switch (status) {
             case PARSE_SUCCESS:
                 UPnPsdk_LOGINFO("MSG1031") "<<< (RECVD) <<<\n"
@@ -732,7 +731,6 @@ int http_RecvMessage(SOCKINFO* info, http_parser_t* parser,
     }
 
 ExitFunction:
-    free(buf);
     if (ret != UPNP_E_SUCCESS) {
         UPnPsdk_LOGERR("MSG1048") "error "
             << ret << " on line " << line
@@ -991,6 +989,7 @@ int http_RequestAndResponse(uri_type* destination, const char* request,
         parser_response_init(response, req_method);
         return UPNP_E_SOCKET_ERROR;
     }
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
 
     /* connect */
     int ret_code = umock::sys_socket_h.connect(
@@ -1029,7 +1028,61 @@ end_function:
 
 int http_Download(const char* url_str, int timeout_secs, char** document,
                   size_t* doc_length, char* content_type) {
-    TRACE("Executing http_Download()")
+    return http_DownloadIfModified(url_str, timeout_secs, nullptr, nullptr,
+                                   document, doc_length, content_type);
+}
+
+namespace {
+/// \brief Copies a header value to a buffer of size LINE_SIZE.
+void copy_header_value(http_message_t* msg, const char* header_name,
+                       char* value) {
+    http_header_t* header = httpmsg_find_hdr_str(msg, header_name);
+    if (header == nullptr) {
+        *value = '\0';
+        return;
+    }
+    const size_t copy_len{std::min(header->value.length, LINE_SIZE - 1)};
+    memcpy(value, header->value.buf, copy_len);
+    value[copy_len] = '\0';
+}
+
+#ifdef UPnPsdk_HAVE_OPENSSL
+/*!
+ * \brief Gets the server name of a host to send it with SNI.
+ *
+ * \returns The host name, or an empty string for a numeric address that must
+ * not be sent with SNI.
+ */
+std::string tls_server_name(const hostport_type& a_hostport) {
+    std::string host(a_hostport.text.buff, a_hostport.text.size);
+    if (host.empty() || host.front() == '[')
+        return std::string();
+    host.erase(std::min(host.find(':'), host.size()));
+    in_addr addr;
+    if (inet_pton(AF_INET, host.c_str(), &addr) == 1)
+        return std::string();
+    return host;
+}
+
+/// \brief Checks if the server keeps the connection open after a response.
+bool response_keeps_alive(http_message_t* msg) {
+    if (msg->major_version != 1 || msg->minor_version < 1)
+        return false;
+    http_header_t* header = httpmsg_find_hdr_str(msg, "CONNECTION");
+    if (header == nullptr)
+        return true;
+    std::string value(header->value.buf, header->value.length);
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return value.find("close") == std::string::npos;
+}
+#endif
+} // anonymous namespace
+
+int http_DownloadIfModified(const char* url_str, int timeout_secs, char* etag,
+                            char* last_modified, char** document,
+                            size_t* doc_length, char* content_type) {
+    TRACE("Executing http_DownloadIfModified()")
     int ret_code;
     char* msg_start;
     char* entity_start;
@@ -1060,15 +1113,24 @@ int http_Download(const char* url_str, int timeout_secs, char** document,
             return ret_code;
         }
 
+        // Validators of a cached document for a conditional request.
+        std::string validators;
+        if (etag != nullptr && *etag != '\0')
+            validators.append("IF-NONE-MATCH: ").append(etag).append("\r\n");
+        if (last_modified != nullptr && *last_modified != '\0')
+            validators.append("IF-MODIFIED-SINCE: ")
+                .append(last_modified)
+                .append("\r\n");
+
         membuffer request_out;
         membuffer_init(&request_out); // Does not allocate memory
-        ret_code =
-            http_MakeMessage(&request_out, 1, 1,
-                             "Q"
-                             "s"
-                             "bcDCUc",
-                             HTTPMETHOD_GET, url.pathquery.buff,
-                             url.pathquery.size, "HOST: ", hoststr, hostlen);
+        ret_code = http_MakeMessage(&request_out, 1, 1,
+                                    "Q"
+                                    "s"
+                                    "bcDCUsc",
+                                    HTTPMETHOD_GET, url.pathquery.buff,
+                                    url.pathquery.size, "HOST: ", hoststr,
+                                    hostlen, validators.c_str());
         if (ret_code != 0) {
             UPnPsdk_LOGERR("MSG1100") "HTTP MakeMessage failed.\n";
             membuffer_destroy(&request_out);
@@ -1133,6 +1195,12 @@ int http_Download(const char* url_str, int timeout_secs, char** document,
     }
     if (response_in.msg.status_code == HTTP_OK) {
         ret_code = 0; /* success */
+        /* optional validators of the new document */
+        if (etag != nullptr)
+            copy_header_value(&response_in.msg, "ETAG", etag);
+        if (last_modified != nullptr)
+            copy_header_value(&response_in.msg, "LAST-MODIFIED",
+                              last_modified);
     } else {
         /* server sent error msg (not requested doc) */
         ret_code = response_in.msg.status_code;
@@ -1173,6 +1241,9 @@ int http_OpenHttpConnection(const char* url_str, void** Handle,
     SOCKET tcp_connection;
     http_connection_handle_t* handle = nullptr;
     uri_type url;
+#ifdef UPnPsdk_HAVE_OPENSSL
+    std::string server_name;
+#endif
     // BUG! *Handle should be initialized here? Otherwise possible segfault.
     // *Handle = handle;
     if (!url_str || !Handle)
@@ -1190,6 +1261,18 @@ int http_OpenHttpConnection(const char* url_str, void** Handle,
     }
     handle->requestStarted = 0;
     memset(&handle->response, 0, sizeof(handle->response));
+#ifdef UPnPsdk_HAVE_OPENSSL
+    /* For HTTPS connections take an idle connection to the server if there is
+     * one. That saves the TCP and TLS handshakes. */
+    if (token_string_casecmp(&url.scheme, "https") == 0) {
+        server_name = tls_server_name(url.hostport);
+        if (sock_ssl_take_idle(&handle->sock_info, url.hostport.IPaddress,
+                               server_name.c_str())) {
+            ret_code = UPNP_E_SUCCESS;
+            goto errorHandler;
+        }
+    }
+#endif
     /* connect to the server */
     tcp_connection = umock::sys_socket_h.socket(
         url.hostport.IPaddress.ss_family, SOCK_STREAM, 0);
@@ -1198,6 +1281,7 @@ int http_OpenHttpConnection(const char* url_str, void** Handle,
         ret_code = UPNP_E_SOCKET_ERROR;
         goto errorHandler;
     }
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
     if (sock_init(&handle->sock_info, tcp_connection) != UPNP_E_SUCCESS) {
         sock_destroy(&handle->sock_info, SD_BOTH);
         ret_code = UPNP_E_SOCKET_ERROR;
@@ -1217,7 +1301,9 @@ int http_OpenHttpConnection(const char* url_str, void** Handle,
 #ifdef UPnPsdk_HAVE_OPENSSL
     /* For HTTPS connections start the TLS/SSL handshake. */
     if (token_string_casecmp(&url.scheme, "https") == 0) {
-        ret_code = sock_ssl_connect(&handle->sock_info);
+        ret_code = sock_ssl_connect(
+            &handle->sock_info,
+            server_name.empty() ? nullptr : server_name.c_str());
         if (ret_code != UPNP_E_SUCCESS) {
             sock_destroy(&handle->sock_info, SD_BOTH);
             goto errorHandler;
@@ -1476,6 +1562,19 @@ int http_CloseHttpConnection(void* Handle) {
     http_connection_handle_t* handle = (http_connection_handle_t*)Handle;
     if (!handle)
         return UPNP_E_INVALID_PARAM;
+#ifdef UPnPsdk_HAVE_OPENSSL
+    /* Keep a TLS connection with a complete response open for the next
+     * request to the same server. */
+    if (handle->sock_info.ssl != nullptr &&
+        handle->response.position == POS_COMPLETE &&
+        !handle->requestStarted && !handle->cancel &&
+        response_keeps_alive(&handle->response.msg) &&
+        sock_ssl_keep_idle(&handle->sock_info)) {
+        httpmsg_destroy(&handle->response.msg);
+        free(handle);
+        return UPNP_E_SUCCESS;
+    }
+#endif
     /*should shutdown completely */
     sock_destroy(&handle->sock_info, SD_BOTH);
     httpmsg_destroy(&handle->response.msg);
@@ -1709,6 +1808,7 @@ int http_MakeMessage(membuffer* buf, int http_major_version,
             /*   e.g.: 'HTTP/1.1 200 OK' code */
             status_code = (int)va_arg(argp, int);
             assert(status_code > 0);
+            compa::metrics_http_response(status_code);
             rc = snprintf(tempbuf, sizeof(tempbuf), "HTTP/%d.%d %d ",
                           http_major_version, http_minor_version, status_code);
             /* str */
@@ -1856,6 +1956,7 @@ int http_OpenHttpGetEx(const char* url_str, void** Handle, char** contentType,
             free(handle);
             break;
         }
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
         if (sock_init(&handle->sock_info, tcp_connection) != UPNP_E_SUCCESS) {
             sock_destroy(&handle->sock_info, SD_BOTH);
             errCode = UPNP_E_SOCKET_ERROR;
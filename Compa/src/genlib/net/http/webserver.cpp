@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-13
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-18
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -42,6 +42,7 @@
 #include <UpnpExtraHeaders.hpp>
 #include <UpnpIntTypes.hpp>
 #include <httpreadwrite.hpp>
+#include <metrics.hpp>
 #include <statcodes.hpp>
 #include <upnpapi.hpp>
 
@@ -1513,6 +1514,41 @@ ExitFunction:
     return ret_code;
 }
 
+/*!
+ * rief Answers a GET or HEAD request with the metrics of the library, see
+ * UpnpSetMetricsPath().
+ */
+void send_metrics(
+    /*! [in] Socket info. */
+    SOCKINFO* a_info,
+    /*! [in] HTTP Request message. */
+    http_message_t* a_req) {
+    int resp_major;
+    int resp_minor;
+    int timeout{HTTP_DEFAULT_TIMEOUT};
+    membuffer headers;
+    membuffer body;
+
+    http_CalcResponseVersion(a_req->major_version, a_req->minor_version,
+                             &resp_major, &resp_minor);
+    membuffer_init(&headers);
+    membuffer_init(&body);
+    if (metrics_export(&body) != UPNP_E_SUCCESS ||
+        http_MakeMessage(&headers, resp_major, resp_minor, "RNTDSCc", HTTP_OK,
+                         static_cast<off_t>(body.length),
+                         "text/plain; version=0.0.4; charset=utf-8") != 0) {
+        http_SendStatusResponse(a_info, HTTP_INTERNAL_SERVER_ERROR,
+                                a_req->major_version, a_req->minor_version);
+    } else if (a_req->method == HTTPMETHOD_HEAD) {
+        http_SendMessage(a_info, &timeout, "b", headers.buf, headers.length);
+    } else {
+        http_SendMessage(a_info, &timeout, "bb", headers.buf, headers.length,
+                         body.buf, body.length);
+    }
+    membuffer_destroy(&headers);
+    membuffer_destroy(&body);
+}
+
 /// @} // Scope restricted to file
 } // anonymous namespace
 } // namespace compa
@@ -1584,6 +1620,14 @@ void web_server_callback(http_parser_t* a_parser,
     compa::CXmlAlias xmldoc;
     SendInstruction RespInstr;
 
+    if ((a_req->method == HTTPMETHOD_GET ||
+         a_req->method == HTTPMETHOD_HEAD) &&
+        compa::metrics_is_path(a_req->uri.pathquery.buff,
+                               a_req->uri.pathquery.size)) {
+        compa::send_metrics(a_info, a_req);
+        return;
+    }
+
     /* init */
     memset(&RespInstr, 0, sizeof(RespInstr));
     membuffer_init(&headers);
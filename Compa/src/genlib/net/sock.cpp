@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-04-16
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -39,6 +39,8 @@
  */
 
 #include <sock.hpp>
+#include <config.hpp>
+#include <metrics.hpp>
 #include <upnp.hpp>
 
 #include <UPnPsdk/connection_common.hpp>
@@ -49,7 +51,14 @@
 
 /// \cond
 #include <fcntl.h> /* for F_GETFL, F_SETFL, O_NONBLOCK */
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#ifdef UPnPsdk_HAVE_OPENSSL
+#include <map>
+#include <string>
+#include <vector>
+#endif
 /// \endcond
 
 
@@ -61,6 +70,28 @@ namespace {
  * Only this one is supported. With the given functions there is no way to use
  * more than this SSL Context. */
 SSL_CTX* gSslCtx{nullptr};
+
+/// \brief Established TLS connection that waits to be reused.
+struct IdleTlsConnection {
+    std::string key; ///< Peer address and server name.
+    SOCKINFO info;   ///< Socket and SSL object of the connection.
+    std::chrono::steady_clock::time_point since; ///< Time it became idle.
+};
+
+/// \brief Cached TLS client session.
+struct CachedTlsSession {
+    SSL_SESSION* session; ///< Session to resume.
+    std::chrono::steady_clock::time_point used; ///< Time it was last used.
+};
+
+/// \brief Mutex to protect the TLS session cache and the idle connections.
+pthread_mutex_t gSslCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief Cached TLS client sessions with peer address and server name as key.
+std::map<std::string, CachedTlsSession> gSslSessions;
+/// \brief Established TLS connections that wait to be reused.
+std::vector<IdleTlsConnection> gIdleTlsConns;
+/// \brief Index of the SSL object data with the session key.
+int gSslKeyIndex{-1};
 #endif
 
 /*! \name Scope restricted to file
@@ -466,7 +497,114 @@ int sock_init_with_ip(SOCKINFO* info, SOCKET sockfd,
 }
 
 #ifdef UPnPsdk_HAVE_OPENSSL
-int sock_ssl_connect(SOCKINFO* info) {
+namespace {
+
+/*!
+ * \brief Get the key of TLS sessions and idle connections.
+ *
+ * \returns The peer address with port and the server name.
+ */
+std::string ssl_peer_key(
+    /*! [in] Socket address of the peer. */
+    const sockaddr_storage& a_peer,
+    /*! [in] Server name for SNI or nullptr. */
+    const char* a_host) {
+    UPnPsdk::SSockaddr saObj;
+    saObj = a_peer;
+    return saObj.netaddrp() + '/' + (a_host != nullptr ? a_host : "");
+}
+
+/// \brief Frees the session key that is attached to an SSL object.
+void free_ssl_key(void*, void* a_key, CRYPTO_EX_DATA*, int, long, void*) {
+    delete static_cast<std::string*>(a_key);
+}
+
+/*!
+ * \brief Stores a new client session in the cache.
+ *
+ * Called by OpenSSL after a handshake, or with TLS 1.3 when the server has
+ * sent a session ticket.
+ *
+ * \returns 1 because the cache keeps the reference to the session.
+ */
+int ssl_new_session(SSL* a_ssl, SSL_SESSION* a_session) {
+    const std::string* key{
+        static_cast<std::string*>(SSL_get_ex_data(a_ssl, gSslKeyIndex))};
+    if (key == nullptr)
+        return 0;
+
+    const auto now{std::chrono::steady_clock::now()};
+    SSL_SESSION* old_session{nullptr};
+    pthread_mutex_lock(&gSslCacheMutex);
+    auto it{gSslSessions.find(*key)};
+    if (it != gSslSessions.end()) {
+        old_session = it->second.session;
+        it->second = {a_session, now};
+    } else {
+        if (gSslSessions.size() >= TLS_SESSION_CACHE_SIZE) {
+            // Evict the least recently used session.
+            auto lru{std::min_element(
+                gSslSessions.begin(), gSslSessions.end(),
+                [](const auto& a, const auto& b) {
+                    return a.second.used < b.second.used;
+                })};
+            old_session = lru->second.session;
+            gSslSessions.erase(lru);
+        }
+        gSslSessions.emplace(*key, CachedTlsSession{a_session, now});
+    }
+    pthread_mutex_unlock(&gSslCacheMutex);
+    if (old_session != nullptr)
+        SSL_SESSION_free(old_session);
+
+    return 1;
+}
+
+/// \brief Removes the cached session of a peer.
+void ssl_remove_session(const std::string& a_key) {
+    SSL_SESSION* session{nullptr};
+    pthread_mutex_lock(&gSslCacheMutex);
+    auto it{gSslSessions.find(a_key)};
+    if (it != gSslSessions.end()) {
+        session = it->second.session;
+        gSslSessions.erase(it);
+    }
+    pthread_mutex_unlock(&gSslCacheMutex);
+    if (session != nullptr)
+        SSL_SESSION_free(session);
+}
+
+/*!
+ * \brief Checks if an idle TLS connection can be used for a new request.
+ *
+ * The peer must not have closed the connection or sent unexpected data.
+ */
+bool ssl_connection_usable(const IdleTlsConnection& a_conn) {
+    if (std::chrono::steady_clock::now() - a_conn.since >
+        std::chrono::seconds(TLS_IDLE_CONNECTION_TIME))
+        return false;
+    if (SSL_pending(a_conn.info.ssl) > 0)
+        return false;
+
+    fd_set rdSet;
+    FD_ZERO(&rdSet);
+    FD_SET(a_conn.info.socket, &rdSet);
+    timeval timeout{};
+    return umock::sys_socket_h.select(
+               static_cast<int>(a_conn.info.socket + 1), &rdSet, nullptr,
+               nullptr, &timeout) == 0;
+}
+
+/// \brief Closes TLS connections that are not reused.
+void ssl_destroy_connections(std::vector<IdleTlsConnection>& a_conns) {
+    UPNPLIB_SCOPED_NO_SIGPIPE;
+    for (IdleTlsConnection& conn : a_conns)
+        sock_destroy(&conn.info, SD_BOTH);
+}
+
+} // anonymous namespace
+
+int sock_ssl_connect(SOCKINFO* info, const char* a_host) {
     TRACE("Executing sock_ssl_connect()");
     info->ssl = SSL_new(gSslCtx);
     if (!info->ssl) {
@@ -476,14 +614,96 @@ int sock_ssl_connect(SOCKINFO* info) {
     int status = SSL_set_fd(info->ssl, static_cast<int>(info->socket));
     if (status == 0)
         return UPNP_E_SOCKET_ERROR;
+    if (a_host != nullptr && a_host[0] != '\0' &&
+        SSL_set_tlsext_host_name(info->ssl, a_host) != 1)
+        return UPNP_E_SOCKET_ERROR;
+
+    // Resume the last session with the peer if there is one.
+    std::string* key{nullptr};
+    UPnPsdk::SSockaddr peerObj;
+    socklen_t peer_len = sizeof(peerObj.ss);
+    if (gSslKeyIndex >= 0 &&
+        umock::sys_socket_h.getpeername(info->socket, &peerObj.sa,
+                                        &peer_len) == 0) {
+        key = new std::string(ssl_peer_key(peerObj.ss, a_host));
+        SSL_set_ex_data(info->ssl, gSslKeyIndex, key);
+        pthread_mutex_lock(&gSslCacheMutex);
+        auto it{gSslSessions.find(*key)};
+        if (it != gSslSessions.end()) {
+            SSL_set_session(info->ssl, it->second.session);
+            it->second.used = std::chrono::steady_clock::now();
+        }
+        pthread_mutex_unlock(&gSslCacheMutex);
+    }
 
     UPNPLIB_SCOPED_NO_SIGPIPE;
     status = SSL_connect(info->ssl);
-    if (status != 1)
+    if (status != 1) {
+        if (key != nullptr)
+            ssl_remove_session(*key);
         return UPNP_E_SOCKET_ERROR;
+    }
+    if (SSL_session_reused(info->ssl))
+        UPnPsdk_LOGINFO("MSG1192") "Resumed TLS session with \""
+            << *key << "\".\n";
 
     return UPNP_E_SUCCESS;
 }
+
+bool sock_ssl_take_idle(SOCKINFO* info, const sockaddr_storage& a_peer,
+                        const char* a_host) {
+    TRACE("Executing sock_ssl_take_idle()");
+    const std::string key{ssl_peer_key(a_peer, a_host)};
+    std::vector<IdleTlsConnection> closed;
+    bool found{false};
+
+    pthread_mutex_lock(&gSslCacheMutex);
+    for (auto it{gIdleTlsConns.begin()}; it != gIdleTlsConns.end();) {
+        if (!ssl_connection_usable(*it)) {
+            closed.push_back(std::move(*it));
+            it = gIdleTlsConns.erase(it);
+        } else if (!found && it->key == key) {
+            *info = it->info;
+            it = gIdleTlsConns.erase(it);
+            found = true;
+        } else {
+            ++it;
+        }
+    }
+    pthread_mutex_unlock(&gSslCacheMutex);
+    ssl_destroy_connections(closed);
+
+    return found;
+}
+
+bool sock_ssl_keep_idle(SOCKINFO* info) {
+    TRACE("Executing sock_ssl_keep_idle()");
+    if (info->ssl == nullptr || gSslKeyIndex < 0 || TLS_IDLE_CONNECTIONS <= 0)
+        return false;
+    const std::string* key{
+        static_cast<std::string*>(SSL_get_ex_data(info->ssl, gSslKeyIndex))};
+    if (key == nullptr)
+        return false;
+
+    std::vector<IdleTlsConnection> closed;
+    pthread_mutex_lock(&gSslCacheMutex);
+    if (gIdleTlsConns.size() >= TLS_IDLE_CONNECTIONS) {
+        // Close the longest waiting connection.
+        auto lru{std::min_element(gIdleTlsConns.begin(), gIdleTlsConns.end(),
+                                  [](const IdleTlsConnection& a,
+                                     const IdleTlsConnection& b) {
+                                      return a.since < b.since;
+                                  })};
+        closed.push_back(std::move(*lru));
+        gIdleTlsConns.erase(lru);
+    }
+    gIdleTlsConns.push_back(
+        {*key, *info, std::chrono::steady_clock::now()});
+    pthread_mutex_unlock(&gSslCacheMutex);
+    ssl_destroy_connections(closed);
+
+    return true;
+}
 #endif
 
 int sock_destroy(SOCKINFO* info, int ShutdownMethod) {
@@ -516,6 +736,8 @@ int sock_destroy(SOCKINFO* info, int ShutdownMethod) {
             ret = UPNP_E_SOCKET_ERROR;
         }
         info->socket = INVALID_SOCKET;
+        // The socket was counted where it was opened or accepted.
+        compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
     }
 
     return ret;
@@ -604,10 +826,30 @@ int UpnpInitSslContext([[maybe_unused]] int initOpenSslLib,
     if (!gSslCtx) {
         return UPNP_E_INIT_FAILED;
     }
+    if (TLS_SESSION_CACHE_SIZE > 0) {
+        // Client sessions are cached by ssl_new_session() with a key that is
+        // attached to each SSL object.
+        if (gSslKeyIndex < 0)
+            gSslKeyIndex = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr,
+                                                free_ssl_key);
+        SSL_CTX_set_session_cache_mode(gSslCtx,
+                                       SSL_SESS_CACHE_CLIENT |
+                                           SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(gSslCtx, ssl_new_session);
+    }
     return UPNP_E_SUCCESS;
 }
 
 void freeSslCtx() {
+    std::vector<IdleTlsConnection> closed;
+    pthread_mutex_lock(&gSslCacheMutex);
+    closed.swap(gIdleTlsConns);
+    for (auto& [key, cached] : gSslSessions)
+        SSL_SESSION_free(cached.session);
+    gSslSessions.clear();
+    pthread_mutex_unlock(&gSslCacheMutex);
+    ssl_destroy_connections(closed);
+
     if (gSslCtx) {
         SSL_CTX_free(gSslCtx);
         gSslCtx = nullptr;
@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-05-29
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -162,6 +162,24 @@ int membuffer_set_size(membuffer* m, size_t new_length) {
     return 0;
 }
 
+int membuffer_reserve(membuffer* m, size_t a_len) {
+    assert(m != NULL);
+
+    const size_t new_length{m->length + a_len};
+    if (new_length <= m->capacity && m->buf != nullptr)
+        return 0;
+
+    const size_t alloc_len{std::max(new_length, 2 * m->capacity)};
+    char* temp_buf = (char*)umock::stdlib_h.realloc(m->buf, alloc_len + 1);
+    if (temp_buf == NULL)
+        return UPNP_E_OUTOF_MEMORY;
+    /* null-terminate, if it is a new buffer */
+    temp_buf[m->length] = 0;
+    m->buf = temp_buf;
+    m->capacity = alloc_len;
+    return 0;
+}
+
 void membuffer_init(membuffer* m) {
     TRACE("Executing membuffer_init()")
     assert(m != NULL);
@@ -0,0 +1,48 @@
+#ifndef COMPA_UPNPSTRINGINLINE_HPP
+#define COMPA_UPNPSTRINGINLINE_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Internal functions to embed UpnpString objects into the memory
+ * allocation of their owning object.
+ *
+ * Objects like UpnpDiscovery carry several strings. Instead of allocating
+ * each one separately the owner calculates the needed space with
+ * UpnpString_inlineSize(), allocates it together with itself and places the
+ * strings one after the other with UpnpString_inlineNew(). Strings that are
+ * longer than the embedded buffer are still allocated on the heap.
+ */
+
+#include <UpnpString.hpp>
+
+/*!
+ * \brief Returns the number of bytes needed for an embedded UpnpString with
+ * its buffer, rounded up to keep the next object aligned.
+ */
+size_t UpnpString_inlineSize(
+    /*! [in] Max. string length that fits into the embedded buffer. */
+    size_t capacity);
+
+/*!
+ * \brief Constructs an empty UpnpString in given memory.
+ *
+ * \returns Pointer to the UpnpString that was placed at \p *mem. \p *mem is
+ * advanced by UpnpString_inlineSize(capacity) to the next free byte.
+ */
+UpnpString* UpnpString_inlineNew(
+    /*! [in,out] Pointer to memory with at least
+     * UpnpString_inlineSize(capacity) free bytes. */
+    char** mem,
+    /*! [in] Max. string length that fits into the embedded buffer. */
+    size_t capacity);
+
+/*!
+ * \brief Releases a string that was set on the heap. The memory of the
+ * UpnpString itself belongs to its owner and is not freed.
+ */
+void UpnpString_inlineDelete(
+    /*! [in] Pointer to the UpnpString object. */
+    UpnpString* p);
+
+#endif // COMPA_UPNPSTRINGINLINE_HPP
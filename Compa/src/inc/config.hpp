@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2024-03-03
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -87,6 +87,17 @@
  */
 #define MAX_THREADS 12
 
+/*!
+ * \brief The `THREAD_TARGET_WAIT_TIME` constant defines the average time in
+ * milliseconds a job should wait in the queue of a thread pool inside the
+ * SDK. If set, the thread pool does not allocate a new thread whenever all
+ * threads are busy, but only if the jobs wait longer than this (up to the
+ * max). If they wait less than half of it, idle threads are released
+ * earlier. It can be set for each thread pool with UpnpSetThreadPoolLimits().
+ * The default value is 0, that disables this adaptive sizing.
+ */
+#define THREAD_TARGET_WAIT_TIME 0
+
 /*!
  * \brief The `THREAD_STACK_SIZE` constant defines the minimum stack size (in
  * bytes) allocated for the stack of each thread the thread pool inside the SDK
@@ -213,6 +224,88 @@
  */
 #define SSDP_PACKET_DISTRIBUTE 1
 
+/*!
+ * \brief The `SSDP_REPLY_RATE_LIMIT` is the maximal number of search requests
+ * per second from one source address that a device replies to. Repeated
+ * identical requests that are merged into a pending reply are not counted.
+ * It can be set with UpnpSetSsdpReplyRateLimit(). The default value is 0,
+ * that disables the limit.
+ */
+#define SSDP_REPLY_RATE_LIMIT 0
+
+/*!
+ * \brief The `SSDP_DISCOVERY_CACHE` enables the cache of discovered devices
+ * and services for control points. With the cache, repeated advertisements
+ * are only delivered to the control point if they are new or changed. Search
+ * replies are always delivered. It can be set with UpnpSetDiscoveryCache().
+ * The default value is 0, that disables the cache.
+ */
+#define SSDP_DISCOVERY_CACHE 0
+
+/*!
+ * \brief The `SSDP_CACHE_SWEEP_TIME` is the interval in seconds to check the
+ * discovery cache for expired entries. The default value is 5 seconds.
+ */
+#define SSDP_CACHE_SWEEP_TIME 5
+
+/*!
+ * \brief The `DESCRIPTION_FETCH_JOBS` is the maximal number of description
+ * documents that UpnpDownloadXmlDocAsync() downloads at the same time. The
+ * default value is 4.
+ */
+#define DESCRIPTION_FETCH_JOBS 4
+
+/*!
+ * \brief The `DESCRIPTION_CACHE_SIZE` is the maximal number of description
+ * documents that are cached for UpnpDownloadXmlDocAsync(). The default value
+ * is 256.
+ */
+#define DESCRIPTION_CACHE_SIZE 256
+
+/*!
+ * \brief The `DESCRIPTION_CACHE_FRESH_TIME` is the time in seconds a cached
+ * description document is used without asking the device if it has changed.
+ * The default value is 10 seconds.
+ */
+#define DESCRIPTION_CACHE_FRESH_TIME 10
+
+/*!
+ * \brief The `MINISERVER_ACCEPTORS` is the number of listening sockets per
+ * local address that accept incoming HTTP connections. More than one socket
+ * is bound to the same address with SO_REUSEPORT and each additional socket is
+ * served by its own thread, so that the kernel spreads the connections over
+ * them. It can be set with UpnpSetMiniServerAcceptors(). It is only used on
+ * Linux. The default value is 1.
+ */
+#define MINISERVER_ACCEPTORS 1
+
+/*!
+ * \brief The `MINISERVER_MAX_ACCEPTORS` is the maximal number of listening
+ * sockets per local address that can be set with UpnpSetMiniServerAcceptors().
+ */
+#define MINISERVER_MAX_ACCEPTORS 16
+
+/*!
+ * \brief The `TLS_SESSION_CACHE_SIZE` is the maximal number of TLS client
+ * sessions that are cached to resume them with the next connection to the same
+ * peer address and server name. 0 disables the cache. The default value is 16.
+ */
+#define TLS_SESSION_CACHE_SIZE 16
+
+/*!
+ * \brief The `TLS_IDLE_CONNECTIONS` is the maximal number of established TLS
+ * connections that are kept open after UpnpCloseHttpConnection() to be reused
+ * by the next UpnpOpenHttpConnection() to the same server. 0 disables keeping
+ * connections. The default value is 4.
+ */
+#define TLS_IDLE_CONNECTIONS 4
+
+/*!
+ * \brief The `TLS_IDLE_CONNECTION_TIME` is the time in seconds an idle TLS
+ * connection is kept for reuse. The default value is 30 seconds.
+ */
+#define TLS_IDLE_CONNECTION_TIME 30
+
 /*!
  * \brief The `GENA_NOTIFICATION_SENDING_TIMEOUT` specifies the number of
  * seconds to wait for sending GENA notifications to the Control Point.
@@ -245,6 +338,16 @@
  */
 #define GENA_NOTIFICATION_ANSWERING_TIMEOUT HTTP_DEFAULT_TIMEOUT
 
+/*!
+ * \brief The `GENA_NOTIFY_ENGINE_MAX_CONNECTIONS` specifies the maximal number
+ * of NOTIFY requests the GENA notify engine keeps in flight at the same time.
+ *
+ * Further requests wait until a connection has finished. Each connection uses
+ * one socket file descriptor. The engine is enabled with
+ * UpnpSetAsyncEventDelivery().
+ */
+#define GENA_NOTIFY_ENGINE_MAX_CONNECTIONS 256
+
 /// \cond
 // No need for documentation because these settings have no effect.
 /*!
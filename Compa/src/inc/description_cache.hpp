@@ -0,0 +1,51 @@
+#ifndef COMPA_DESCRIPTION_CACHE_HPP
+#define COMPA_DESCRIPTION_CACHE_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup compa-Description
+ * \brief Asynchronous download of description documents with a cache for
+ * control points (for internal use only).
+ *
+ * A control point gets an advertisement for each device and service of a
+ * root device, all with the same LOCATION. description_fetch() downloads each
+ * LOCATION only once:
+ * - A request for a LOCATION that is already downloading only waits for the
+ *   running download.
+ * - A document that has been downloaded less than \c
+ *   DESCRIPTION_CACHE_FRESH_TIME seconds ago is taken from the cache.
+ * - An older cached document is revalidated with a conditional request that
+ *   uses its ETag and Last-Modified validators.
+ *
+ * At most \c DESCRIPTION_FETCH_JOBS downloads run at the same time on the send
+ * thread pool. Other requests are queued. The cache keeps up to \c
+ * DESCRIPTION_CACHE_SIZE documents and removes the least recently used.
+ */
+
+#include <API.hpp>
+
+/*!
+ * \brief Requests a description document.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error: UPNP_E_OUTOF_MEMORY if no download job could be started.
+ */
+int description_fetch(
+    /*! [in] URL of the document. */
+    const char* a_url,
+    /*! [in] Function to call with the document. */
+    Upnp_DescriptionFunPtr a_fun,
+    /*! [in] User data passed to the function. */
+    const void* a_cookie);
+
+/*!
+ * \brief Removes all documents from the cache.
+ *
+ * Waiting requests are finished with UPNP_E_FINISH. Must be called after the
+ * send thread pool is shut down.
+ */
+void description_cache_clear();
+
+#endif /* COMPA_DESCRIPTION_CACHE_HPP */
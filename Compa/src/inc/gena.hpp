@@ -5,7 +5,7 @@
  * Copyright (c) 2000-2003 Intel Corporation
  * All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-06-12
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -39,6 +39,7 @@
  */
 
 #include <time.h>
+#include <cstdint>
 
 #include <client_table.hpp>
 #include <httpparser.hpp>
@@ -87,19 +88,37 @@
 /// @}
 
 /*!
- * Structure to send NOTIFY message to all subscribed control points
+ * \brief Pre-rendered event, shared by the NOTIFY messages to all subscribed
+ * control points.
+ *
+ * It is immutable after creation except of the reference count. UDN, servId
+ * and headers are stored in the same allocation as the structure. Only SID and
+ * SEQ are added for each subscription.
  */
-typedef struct NOTIFY_THREAD_STRUCT {
+typedef struct NOTIFY_EVENT {
     /// @{
-    /// Member of notify thread structure
-    char* headers;
+    /// Member of notify event structure
+    int reference_count;
     DOMString propertySet;
     char* servId;
     char* UDN;
+    /// Null terminated, all headers (including \r\n) except SID and SEQ.
+    char* headers;
+    /// @}
+} notify_event;
+
+/*!
+ * Structure to send NOTIFY message to one subscribed control point
+ */
+typedef struct NOTIFY_THREAD_STRUCT {
+    /// @{
+    /// Member of notify thread structure
+    notify_event* event;
     Upnp_SID sid;
     time_t ctime;
-    int* reference_count;
     UpnpDevice_Handle device_handle;
+    /// Start of the delivery for the notify metrics, in nanoseconds.
+    uint64_t start;
     /// @}
 } notify_thread_struct;
 
@@ -261,6 +280,27 @@ int genaNotifyAllExt(
     IXML_Document* PropSet);
 #endif
 
+/*!
+ * \brief Sends a notification to all the subscribed control points.
+ *
+ * \return int
+ *
+ * \note This function is similar to the genaNotifyAllExt. The only difference
+ *  is it takes a property set from the streaming writer instead of a xml
+ *  document.
+ */
+#ifdef COMPA_HAVE_DEVICE_SSDP
+int genaNotifyAllPropertySet(
+    /*! [in] Device handle. */
+    UpnpDevice_Handle device_handle,
+    /*! [in] Device udn. */
+    const char* UDN,
+    /*! [in] Service ID. */
+    const char* servId,
+    /*! [in] Event varible property set. */
+    const UpnpPropertySet* PropSet);
+#endif
+
 /*!
  * \brief Sends the intial state table dump to newly subscribed control point.
  *
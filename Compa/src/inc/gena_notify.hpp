@@ -0,0 +1,93 @@
+#ifndef COMPA_GENA_NOTIFY_HPP
+#define COMPA_GENA_NOTIFY_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+/*!
+ * \file
+ * \brief Event driven delivery engine for GENA notifications.
+ *
+ * The blocking delivery with genaNotify() occupies one worker of the send
+ * thread pool for the whole connect/send/receive cycle of a NOTIFY request.
+ * The engine instead runs one persistent job that keeps many NOTIFY requests
+ * in flight on non-blocking sockets, multiplexed with poll(). It only handles
+ * the network part of a delivery. Queuing of events and SEQ ordering is still
+ * done with the `outgoing` list of a subscription: only the head of that list
+ * is ever submitted, and the next event is not submitted before the done
+ * routine of the previous one has been called.
+ */
+
+#include <service_table.hpp>
+#include <ThreadPool.hpp>
+
+/*!
+ * \brief Callback that is called by the engine when a delivery has finished.
+ *
+ * It is called on the engine thread without any lock held. The return code is
+ * the same as returned by the blocking genaNotify(): GENA_SUCCESS,
+ * GENA_E_NOTIFY_UNACCEPTED, GENA_E_NOTIFY_UNACCEPTED_REMOVE_SUB or an UPNP
+ * error code. It is UPNP_E_FINISH if the engine was stopped before the
+ * delivery finished.
+ */
+typedef void (*gena_notify_done_routine)(
+    /*! [in] Cookie given with genaNotifyEngineSubmit(). */
+    void* cookie,
+    /*! [in] Result of the delivery. */
+    int return_code);
+
+/*!
+ * \brief Starts the notify engine as persistent job on a thread pool.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error:
+ *  - UPNP_E_INIT: The engine is already running.
+ *  - UPNP_E_OUTOF_SOCKET: The wakeup socket could not be created.
+ *  - UPNP_E_INIT_FAILED: The persistent job could not be started.
+ */
+int genaNotifyEngineStart(
+    /*! [in] Thread pool to run the engine on. */
+    ThreadPool* tp);
+
+/*!
+ * \brief Stops the notify engine and waits until its job has finished.
+ *
+ * All deliveries that are pending or in flight are finished with
+ * UPNP_E_FINISH. Does nothing if the engine isn't running.
+ */
+void genaNotifyEngineStop();
+
+/*!
+ * \brief Returns if the notify engine is running.
+ *
+ * \returns 1 if running, otherwise 0.
+ */
+int genaNotifyEngineIsRunning();
+
+/*!
+ * \brief Submits a NOTIFY request for asynchronous delivery.
+ *
+ * The delivery URLs of the subscription are tried in order until one is
+ * accepted, the same as genaNotify() does.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS. The engine has taken over the content of
+ *  **sub** and will call **done** exactly once.\n
+ *  On error, nothing was taken over and **done** is never called:
+ *  - UPNP_E_FINISH: The engine isn't running.
+ *  - UPNP_E_OUTOF_MEMORY: Not enough memory.
+ */
+int genaNotifyEngineSubmit(
+    /*! [in] Copy of the subscription made with copy_subscription(). Its
+     * content is moved to the engine on success. */
+    subscription* sub,
+    /*! [in] Null terminated, includes all headers (including \\r\\n) except
+     * SID and SEQ. */
+    const char* headers,
+    /*! [in] The evented XML. It must be valid until **done** is called. */
+    const char* propertySet,
+    /*! [in] Routine called when the delivery has finished. */
+    gena_notify_done_routine done,
+    /*! [in] Cookie passed to **done**. */
+    void* cookie);
+
+#endif /* COMPA_GENA_NOTIFY_HPP */
@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-17
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -480,6 +480,40 @@ parser_append(http_parser_t* parser, ///< [in,out] HTTP Parser object.
               size_t buf_length ///< [in] Size of the buffer.
 );
 
+/*!
+ * \brief Gets the free space behind the received data of the HTTP parser.
+ *
+ * Data can be received directly into this space and then be given to the
+ * parser with parser_append_tail(), without copying it. The space is
+ * increased geometrically.
+ *
+ * \returns
+ *  On success: Pointer to the free space\n
+ *  On error: nullptr if there is not enough memory.
+ */
+char* parser_get_tail(
+    http_parser_t* parser, ///< [in,out] HTTP Parser object.
+    size_t min_length,     ///< [in] Minimal size of the free space.
+    size_t* length         ///< [out] Size of the free space.
+);
+
+/*!
+ * \brief Appends data that was written into the free space got with
+ * parser_get_tail() to the HTTP parser, and does the parsing.
+ *
+ * \returns
+ *  On success: PARSE_SUCCESS\n
+ *  On error:
+ *  - PARSE_FAILURE
+ *  - PARSE_INCOMPLETE
+ *  - PARSE_INCOMPLETE_ENTITY
+ *  - PARSE_NO_MATCH
+ */
+parse_status_t parser_append_tail(
+    http_parser_t* parser, ///< [in,out] HTTP Parser object.
+    size_t buf_length      ///< [in] Number of bytes written to the free space.
+);
+
 /*!
  * \brief Matches a variable parameter list with a string and takes actions
  * based on the data type specified.
@@ -8,7 +8,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-04-04
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -209,6 +209,36 @@ int http_Download(       //
     char* content_type  ///< [out] Type of content.
 );
 
+/*!
+ * \brief Download the document message with a conditional request and extract
+ * the document from the message.
+ *
+ * If validators of a cached document are given, the server is asked to send
+ * the document only if it has been modified. The validators are updated with
+ * the ETag and Last-Modified headers of a new document.
+ *
+ * \returns
+ * On success: UPNP_E_SUCCESS\n
+ * If not modified: HTTP_NOT_MODIFIED, and no document\n
+ * On error:
+ *  - UPNP_E_INVALID_URL
+ *  - Other HTTP status codes sent by the server
+ */
+int http_DownloadIfModified( //
+    const char* url_str,     ///< [in] String as a URL.
+    int timeout_secs,        ///< [in] Time out value.
+    /*! [in,out] ETag of a cached document in a buffer of size LINE_SIZE, an
+     * empty string if unknown, or nullptr. */
+    char* etag,
+    /*! [in,out] Last-Modified date of a cached document in a buffer of size
+     * LINE_SIZE, an empty string if unknown, or nullptr. */
+    char* last_modified,
+    char** document, /*!< [out] Buffer to store the document extracted from the
+                      *   donloaded message. */
+    size_t* doc_length, ///< [out] Length of the extracted document.
+    char* content_type  ///< [out] Type of content.
+);
+
 /*!
  * \brief Extracts information from the Handle to the HTTP get object.
  *
@@ -5,7 +5,7 @@
  * Copyright (c) 2000-2003 Intel Corporation
  * All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-04-01
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-18
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -138,6 +138,13 @@ void Parser_freeNodeContent(
 
 int Parser_LoadDocument(IXML_Document** retDoc, const char* xmlFile, int file);
 
+/*!
+ * \brief Parses a xml buffer in place and reports its content to the
+ * callbacks of a SAX handler.
+ */
+int Parser_ParseBufferSax(const char* buffer, const IXML_SaxHandler* handler,
+                          void* userData);
+
 int Parser_setNodePrefixAndLocalName(IXML_Node* newIXML_NodeIXML_Attr);
 
 /// \brief ixmlAttr_init
@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft,  Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-10-01
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -138,6 +138,24 @@ int membuffer_set_size(
     /*! [in] new size to which the buffer will be modified. */
     size_t new_length);
 
+/*!
+ * \brief Increases the buffer cap so that at least 'a_len' more bytes can be
+ * stored behind its current content.
+ *
+ * The capacity is at least doubled so that many small appends need only a
+ * few reallocations. The content and its length are not modified.
+ *
+ * \return
+ * \li UPNP_E_SUCCESS - On Success
+ * \li UPNP_E_OUTOF_MEMORY - On failure to allocate memory.
+ */
+// Don't export function symbol; only used library intern.
+int membuffer_reserve(
+    /*! [in,out] buffer whose size is to be increased. */
+    membuffer* m,
+    /*! [in] number of bytes that must fit behind the content. */
+    size_t a_len);
+
 /*!
  * \brief Wrapper to membuffer_initialize().
  *
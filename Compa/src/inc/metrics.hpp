@@ -0,0 +1,143 @@
+#ifndef COMPA_METRICS_HPP
+#define COMPA_METRICS_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \brief Internal functions to count the runtime metrics of the library.
+ *
+ * The counters are held in a fixed number of shards, each on its own cache
+ * line. A thread always adds to the same shard, that it gets on its first
+ * call, with a relaxed atomic operation. Reading a metric sums up all shards.
+ * This keeps the counting on the hot paths cheap and without locks.
+ */
+
+#include <UpnpMetrics.hpp>
+#include <membuffer.hpp>
+
+/// \cond
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+/// \endcond
+
+namespace compa {
+
+/// \brief Number of counter shards.
+constexpr size_t METRICS_SHARDS{16};
+/// \brief Number of HTTP methods, see enum http_method_t.
+constexpr int METRICS_HTTP_METHODS{13};
+/// \brief Number of HTTP status classes, 1xx to 5xx.
+constexpr int METRICS_HTTP_CLASSES{5};
+
+/// \brief One shard with all counters.
+struct alignas(64) MetricsShard {
+    /// \brief Counters and gauges, see enum Upnp_Metric.
+    std::atomic<uint64_t> counter[UPNP_METRIC_COUNT];
+    /// \brief Answered HTTP requests by method and status class.
+    std::atomic<uint64_t> http[METRICS_HTTP_METHODS][METRICS_HTTP_CLASSES];
+    /// \brief Buckets of the histograms, see enum Upnp_Histogram.
+    std::atomic<uint64_t> hist[UPNP_HISTOGRAM_COUNT][UPNP_METRICS_BUCKETS];
+    /// \brief Sums of the histogram values in nanoseconds.
+    std::atomic<uint64_t> hist_sum[UPNP_HISTOGRAM_COUNT];
+};
+
+/// \brief The shards of all metrics.
+extern MetricsShard g_metrics_shards[METRICS_SHARDS];
+
+/*! \brief HTTP method of the request that is handled by the current thread,
+ * -1 if none. */
+inline thread_local int g_metrics_http_method{-1};
+
+/// \brief Returns the index of the shard for a new thread.
+size_t metrics_next_shard();
+
+/// \brief Returns the shard of the current thread.
+inline MetricsShard& metrics_shard() {
+    thread_local MetricsShard& shard{g_metrics_shards[metrics_next_shard()]};
+    return shard;
+}
+
+/// \brief Adds to a counter or gauge.
+inline void metrics_add(Upnp_Metric a_metric, int64_t a_num = 1) {
+    metrics_shard().counter[a_metric].fetch_add(static_cast<uint64_t>(a_num),
+                                                std::memory_order_relaxed);
+}
+
+/// \brief Returns a monotonic time in nanoseconds.
+inline uint64_t metrics_now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+/// \brief Returns the histogram bucket of a duration in nanoseconds.
+inline int metrics_bucket(uint64_t a_ns) {
+    // Round up to microseconds, bucket i holds values up to 2^i us.
+    const uint64_t us{a_ns / 1000 + (a_ns % 1000 != 0)};
+    const int idx{us <= 1 ? 0 : static_cast<int>(std::bit_width(us - 1))};
+    return idx < UPNP_METRICS_BUCKETS - 1 ? idx : UPNP_METRICS_BUCKETS - 1;
+}
+
+/// \brief Adds a duration in nanoseconds to a histogram.
+inline void metrics_observe(Upnp_Histogram a_hist, uint64_t a_ns) {
+    MetricsShard& shard{metrics_shard()};
+    shard.hist[a_hist][metrics_bucket(a_ns)].fetch_add(
+        1, std::memory_order_relaxed);
+    shard.hist_sum[a_hist].fetch_add(a_ns, std::memory_order_relaxed);
+}
+
+/*! \brief Sets the method of the HTTP request that the current thread
+ * handles, -1 if it has finished. */
+inline void metrics_http_request(int a_method) {
+    g_metrics_http_method = a_method;
+}
+
+/*! \brief Counts a response to the HTTP request that the current thread
+ * handles. Responses outside of a request are not counted. */
+inline void metrics_http_response(int a_status_code) {
+    const int method{g_metrics_http_method};
+    const int status_class{a_status_code / 100 - 1};
+    if (method < 0 || method >= METRICS_HTTP_METHODS || status_class < 0 ||
+        status_class >= METRICS_HTTP_CLASSES)
+        return;
+    metrics_shard().http[method][status_class].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Appends the text of all metrics in Prometheus exposition format to a
+ * buffer.
+ *
+ * \returns
+ *  On success: UPNP_E_SUCCESS\n
+ *  On error: UPNP_E_OUTOF_MEMORY
+ */
+int metrics_export(
+    /*! [in,out] Initialized buffer to append the text. */
+    membuffer* a_buf);
+
+/*!
+ * \brief Enables or disables the export of the thread pools and the timer
+ * thread.
+ *
+ * It must be enabled after they are initialized and disabled before they are
+ * shut down. Disabling waits for an export that is reading them.
+ */
+void metrics_threads_enable(
+    /*! [in] **true** to enable, **false** to disable. */
+    bool a_enable);
+
+/*! \brief Returns true if the path is the one set with UpnpSetMetricsPath().
+ */
+bool metrics_is_path(
+    /*! [in] Path of a request, not null terminated. */
+    const char* a_path,
+    /*! [in] Length of the path. */
+    size_t a_len);
+
+} // namespace compa
+
+#endif // COMPA_METRICS_HPP
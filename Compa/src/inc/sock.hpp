@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-06-15
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -128,6 +128,11 @@ int sock_init_with_ip(
  * \brief Associates an SSL object with the socket and begins
  * the client-side SSL/TLS handshake.
  *
+ * The last session with the same peer address and server name is resumed if
+ * it is cached. New sessions from the server are stored in a cache of up to
+ * \c TLS_SESSION_CACHE_SIZE entries. If it is full the least recently used
+ * session is dropped.
+ *
  * \return Integer:
  * \li \c UPNP_E_SUCCESS
  * \li \c UPNP_E_SOCKET_ERROR
@@ -136,6 +141,39 @@ int sock_init_with_ip(
 #ifdef UPnPsdk_HAVE_OPENSSL
 int sock_ssl_connect(
     /*! [out] Socket Information Object. */
+    SOCKINFO* info,
+    /*! [in] Server name sent with SNI, nullptr for none. */
+    const char* a_host = nullptr);
+
+/*!
+ * \brief Takes an idle TLS connection to a peer for a new request.
+ *
+ * Idle connections that have been closed by the peer or have been waiting
+ * longer than \c TLS_IDLE_CONNECTION_TIME seconds are closed.
+ *
+ * \returns **true** if a connection was found, **false** otherwise.
+ */
+bool sock_ssl_take_idle(
+    /*! [out] Socket Information Object that gets the connection. */
+    SOCKINFO* info,
+    /*! [in] Socket address of the peer. */
+    const sockaddr_storage& a_peer,
+    /*! [in] Server name of the connection, nullptr for none. */
+    const char* a_host);
+
+/*!
+ * \brief Keeps an established TLS connection to be taken by a later request
+ * to the same peer.
+ *
+ * At most \c TLS_IDLE_CONNECTIONS are kept. If there are more the longest
+ * waiting one is closed.
+ *
+ * \returns **true** if the connection is kept. Otherwise the caller must
+ * destroy it.
+ */
+bool sock_ssl_keep_idle(
+    /*! [in] Socket Information Object of a connection that has finished its
+     * last request and response. */
     SOCKINFO* info);
 #endif
 
@@ -239,6 +277,8 @@ int UpnpInitSslContext(
 /*!
  * \brief Free the OpenSSL context.
  *
+ * Idle TLS connections are closed and cached sessions are freed.
+ *
  * \note This method is only available if the library is compiled with OpenSSL
  * support.
  */
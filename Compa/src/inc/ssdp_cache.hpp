@@ -0,0 +1,75 @@
+#ifndef COMPA_SSDP_CACHE_HPP
+#define COMPA_SSDP_CACHE_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup compa-Discovery
+ * \brief Cache of discovered devices and services for control points (for
+ * internal use only).
+ *
+ * Devices repeat their advertisements periodically and reply to every search
+ * request. With the cache enabled, ssdp_handle_ctrlpt_msg() asks it with
+ * ssdp_cache_alive() whether an alive advertisement must be delivered to the
+ * control point. This is only the case if the USN is seen for the first time,
+ * or if its LOCATION or BOOTID.UPNP.ORG has changed. Otherwise only the expiry
+ * time from the CACHE-CONTROL max-age is refreshed. Search replies are always
+ * delivered to the searches they match and only refresh the cache.
+ * Entries that are not refreshed in time are removed by a timer job that
+ * reports them with an UPNP_DISCOVERY_ADVERTISEMENT_BYEBYE callback.
+ */
+
+#include <Callback.hpp>
+#include <UpnpDiscovery.hpp>
+
+/*!
+ * \brief Enables or disables the cache.
+ *
+ * Disabling the cache removes all entries.
+ */
+void ssdp_cache_enable(
+    /*! [in] **true** to enable, **false** to disable the cache. */
+    bool a_enable);
+
+/*!
+ * \brief Records an alive advertisement or a search reply.
+ *
+ * \returns **true** if an advertisement must be delivered to the control
+ * point, **false** if it only refreshes a known entry. Always **true** if the
+ * cache is disabled.
+ */
+bool ssdp_cache_alive(
+    /*! [in] Value of the USN header. */
+    const char* a_usn,
+    /*! [in] Value of the BOOTID.UPNP.ORG header, -1 if there is none. */
+    int a_bootid,
+    /*! [in] Discovery information of the message. */
+    const UpnpDiscovery* a_param);
+
+/*!
+ * \brief Removes the entry of a byebye advertisement.
+ */
+void ssdp_cache_byebye(
+    /*! [in] Value of the USN header. */
+    const char* a_usn);
+
+/*!
+ * \brief Calls a function for each entry of the cache.
+ *
+ * The function gets an UPNP_DISCOVERY_ADVERTISEMENT_ALIVE event with a copy
+ * of the entry. The cache is not locked while it is called.
+ */
+void ssdp_cache_get(
+    /*! [in] Function to call. */
+    Upnp_FunPtr a_fun,
+    /*! [in] User data passed to the function. */
+    void* a_cookie);
+
+/*!
+ * \brief Removes all entries and resets the expiry timer.
+ *
+ * Must be called after the timer thread is shut down.
+ */
+void ssdp_cache_clear();
+
+#endif /* COMPA_SSDP_CACHE_HPP */
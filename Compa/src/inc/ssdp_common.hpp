@@ -8,7 +8,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-27
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -48,6 +48,10 @@
 /// \brief Size of the errorBuffer variable, passed to the strerror_r() function
 inline constexpr size_t ERROR_BUFFER_LEN{256};
 
+/*! \brief Maximal number of datagrams that are received from an SSDP socket
+ * at once and handled by one thread pool job (only on Linux). */
+inline constexpr unsigned int SSDP_RECV_BATCH{16};
+
 /*! \name SSDP constants.
  * @{ */
 /// constant
@@ -134,14 +138,37 @@ struct ThreadData {
     /// @}
 };
 
-/// \brief SSDP search reply.
+/// \brief Maximal number of search targets that are replied in one batch.
+constexpr int SSDP_REPLY_TARGETS{4};
+
+/// \brief Search target of a search reply.
+struct SsdpSearchTarget {
+    /// @{
+    /// \brief part of search target, copied from the SsdpEvent
+    enum SsdpSearchType RequestType;
+    char UDN[LINE_SIZE];
+    char DeviceType[LINE_SIZE];
+    char ServiceType[LINE_SIZE];
+    /// @}
+};
+
+/*!
+ * \brief SSDP search reply.
+ *
+ * It is the pending reply of a device to the search requests from one source
+ * address. Search requests that arrive before the reply is sent are merged
+ * into it.
+ */
 struct SsdpSearchReply {
     /// @{
     /// \brief part of search reply
+    SsdpSearchReply* next;
     int MaxAge;
     UpnpDevice_Handle handle;
     struct sockaddr_storage dest_addr;
-    SsdpEvent event;
+    time_t replyTime;
+    int numTargets;
+    SsdpSearchTarget target[SSDP_REPLY_TARGETS];
     /// @}
 };
 
@@ -215,6 +242,10 @@ int ssdp_request_type(
 /*!
  * \brief This function reads the data from the ssdp socket.
  *
+ * On Linux all datagrams that are queued on the socket, up to
+ * SSDP_RECV_BATCH, are received with one recvmmsg() call and handed over to
+ * the receive thread pool as one job.
+ *
  * \returns
  *  On success: **0**\n
  *  On error: **-1**
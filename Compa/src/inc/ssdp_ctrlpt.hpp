@@ -8,7 +8,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2024+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-27
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -65,7 +65,9 @@ struct SsdpSearchArg {
  * \brief This function handles the ssdp messages from the devices.
  *
  * These messages includes the search replies, advertisement of device coming
- * alive and bye byes.
+ * alive and bye byes. With the discovery cache enabled, advertisements of
+ * known and unchanged devices are not delivered (look at ssdp_cache.hpp).
+ * Search replies are always delivered.
  */
 void ssdp_handle_ctrlpt_msg(
     /*! [in] SSDP message from the device. */
@@ -8,7 +8,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2024+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-06-12
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -46,13 +46,21 @@
 
 #include <ssdp_common.hpp>
 
+#include <UPnPsdk/socket.hpp>
+
+/// \cond
+#include <string>
+/// \endcond
+
 
 /*!
  * \brief Handles the search request.
  *
  * It does the sanity checks of the request and then schedules a thread to send
  * a random time reply (random within maximum time given by the control point to
- * reply).
+ * reply). A request from the same source that can be answered with a pending
+ * reply is merged into it. The number of replied requests per source address
+ * is limited by UpnpSetSsdpReplyRateLimit().
  *
  * \note Only available when the SSDP option for Devices was enabled on
  * compiling the library.
@@ -64,6 +72,85 @@ void ssdp_handle_device_request(
     struct sockaddr_storage* dest_addr);
 
 
+struct Handle_Info;
+
+/*!
+ * \brief Send data that is the same for all SSDP messages of a device.
+ *
+ * An advertised device keeps it in its handle info from the first
+ * advertisement until it is unregistered, see ssdp_device_send_update(). It
+ * then owns the socket and has the header lines rendered, so a message only
+ * copies them together. Otherwise it is prepared by ssdp_prepare_send() for
+ * one advertisement, reply or shutdown cycle and the messages are formatted
+ * with http_MakeMessage().
+ */
+struct SsdpSendData {
+    /// \brief Bound UDP socket to send with, or INVALID_SOCKET to open a
+    /// temporary socket for each message.
+    SOCKET sock{INVALID_SOCKET};
+    /// \brief Multicast destination for advertisements and shutdowns.
+    sockaddr_storage mcast_addr{};
+    /// \brief Value of the HOST header of advertisements and shutdowns.
+    const char* host{""};
+    /// \brief Owner of the socket of a device.
+    UPnPsdk::CSocket sockObj;
+
+    /// \name Rendered header lines of a device.
+    /// They are only valid if \b desc_url is set.
+    /// @{
+    const char* desc_url{nullptr}; ///< Description URL of \b location.
+    const char* lower_desc_url{nullptr}; ///< URL of \b lower_location.
+    int max_age{};                       ///< Age of \b cache_control.
+    std::string notify_head;    ///< NOTIFY start line and HOST header.
+    std::string cache_control;  ///< CACHE-CONTROL header.
+    std::string location;       ///< LOCATION header with the description URL.
+    std::string lower_location; ///< LOCATION header for legacy control points.
+    std::string opt;            ///< OPT and 01-NLS headers, if enabled.
+    std::string server;         ///< SERVER header.
+    std::string user_agent;     ///< X-User-Agent header, if enabled.
+    std::string power;          ///< UPnP Low Power headers, if any.
+    /// @}
+};
+
+/*!
+ * \brief Prepares the multicast destination and the HOST header value of a
+ * device.
+ *
+ * The IPv6 multicast scope is selected from the address in the device
+ * description URL. The socket member is left untouched. On an unsupported
+ * address family the destination address family is set to AF_UNSPEC.
+ */
+void ssdp_prepare_send(
+    /*! [out] Send data to prepare. */
+    SsdpSendData* a_send,
+    /*! [in] Location URL of the device description. */
+    const char* a_location,
+    /*! [in] Address family of the device. */
+    int a_af);
+
+/*!
+ * \brief Prepares the send data of an advertised device.
+ *
+ * The first call creates it with a bound UDP socket that is used for all
+ * advertisements, replies and shutdowns of the device. Each call renders the
+ * header lines again from the description URLs, the advertisement age and the
+ * UPnP Low Power values of the device, so it must be called after changing
+ * them. The handle table must be locked for writing.
+ */
+void ssdp_device_send_update(
+    /*! [in,out] Handle info of the device. */
+    Handle_Info* a_info);
+
+/*!
+ * \brief Frees the send data of a device and closes its socket.
+ *
+ * The handle table must be locked for writing.
+ */
+void ssdp_device_send_free(
+    /*! [in,out] Handle info of the device. */
+    Handle_Info* a_info);
+
+
 /*! @{
  * \ingroup SSDP-device_functions */
 
@@ -98,8 +185,10 @@ int AdvertiseAndReply(
     int Exp);
 
 /*!
- * \brief Wrapper function to reply the search request coming from the
+ * \brief Wrapper function to reply the search requests coming from the
  * control point.
+ *
+ * It sends the replies to all search targets of the pending reply.
  */
 void advertiseAndReplyThread(
     /*! [in] Structure containing the search request. */
@@ -136,7 +225,9 @@ int DeviceAdvertisement(
     /* [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /* [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /*!
  * \brief Creates the reply packet and send it to the Control Point addesss.
@@ -172,7 +263,9 @@ int SendReply(
     /*! [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /*! [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /*!
  * \brief Creates the reply packet and send it to the Control Point address.
@@ -207,7 +300,9 @@ int DeviceReply(
     /*! [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /*! [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /*!
  * \brief Creates the advertisement packet and send it to the multicast channel.
@@ -237,7 +332,9 @@ int ServiceAdvertisement(
     /*! [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /*! [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /*!
  * \brief Creates the advertisement packet and send it to the multicast channel.
@@ -267,7 +364,9 @@ int ServiceReply(
     /*! [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /*! [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /*!
  * \brief Creates a HTTP service shutdown request packet and sends it to the
@@ -298,7 +397,9 @@ int ServiceShutdown(
     /* [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /* [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /*!
  * \brief Creates a HTTP device shutdown request packet and send it to the
@@ -331,7 +432,9 @@ int DeviceShutdown(
     /*! [in] SleepPeriod as defined by UPnP Low Power. */
     int SleepPeriod,
     /*! [in] RegistrationState as defined by UPnP Low Power. */
-    int RegistrationState);
+    int RegistrationState,
+    /*! [in] Prepared send data, or nullptr to prepare it only for this call. */
+    const SsdpSendData* a_send = nullptr);
 
 /// @} SSDP Device Functions
 
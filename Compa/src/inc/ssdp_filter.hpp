@@ -0,0 +1,48 @@
+#ifndef COMPA_SSDP_FILTER_HPP
+#define COMPA_SSDP_FILTER_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup compa-Discovery
+ * \brief Drops SSDP messages that cannot be of interest before they are
+ * parsed (for internal use only).
+ *
+ * The miniserver thread checks every received datagram with
+ * ssdp_filter_accept() before it allocates memory for it and hands it over
+ * to the receive thread pool. The check only looks at the start line and the
+ * ST header and compares them with the targets of interest. These are
+ * compiled from the handle table by ssdp_filter_update() whenever a device or
+ * control point is registered or unregistered:
+ * - NOTIFY messages and search responses are only of interest if a control
+ *   point is registered.
+ * - M-SEARCH requests are only of interest if a device is registered and the
+ *   search target is "ssdp:all", "upnp:rootdevice", the UDN of one of its
+ *   devices or one of its device or service types in any version.
+ */
+
+/// \cond
+#include <cstddef>
+/// \endcond
+
+/*!
+ * \brief Compiles the targets of interest from the handle table.
+ *
+ * \note The caller must hold the handle lock.
+ */
+void ssdp_filter_update();
+
+/*!
+ * \brief Checks with a fast scan if a received SSDP message may be of
+ * interest.
+ *
+ * \returns **true** if the message must be handled, **false** if it can be
+ * dropped.
+ */
+bool ssdp_filter_accept(
+    /*! [in] Received message, null terminated. */
+    const char* a_msg,
+    /*! [in] Length of the message. */
+    size_t a_len);
+
+#endif /* COMPA_SSDP_FILTER_HPP */
@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-07-16
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -45,6 +45,8 @@
 #include <VirtualDir.hpp> /* for struct VirtualDirCallbacks */
 #include <service_table.hpp>
 
+#include <atomic>
+
 /// MAX_INTERFACES
 #define MAX_INTERFACES 256
 
@@ -68,6 +70,10 @@ constexpr int NUM_HANDLE{200};
 extern size_t g_maxContentLength;
 extern int g_UpnpSdkEQMaxLen;
 extern int g_UpnpSdkEQMaxAge;
+extern int g_UpnpSdkAsyncNotify;
+extern std::atomic<int> g_UpnpSdkEQCoalesce;
+extern int g_UpnpSdkSsdpReplyLimit;
+extern int g_UpnpSdkMiniServerAcceptors;
 
 /// UPNP_TIMEOUT
 #define UPNP_TIMEOUT 30
@@ -82,6 +88,8 @@ enum Upnp_Handle_Type {
 };
 
 
+struct SsdpSendData;
+
 /// \brief Data to be stored in handle table for Handle Info.
 struct Handle_Info {
     Upnp_Handle_Type HType; ///< Handle Type
@@ -111,6 +119,8 @@ struct Handle_Info {
     int MaxSubscriptions; ///< ???
     int MaxSubscriptionTimeOut; ///< ???
     int DeviceAf;               ///< Address family: AF_INET6 or AF_INET.
+    /// \brief Send data of an advertised device, or nullptr.
+    SsdpSendData* SsdpSend;
     /// @}
 #endif
 
@@ -240,6 +250,10 @@ extern ThreadPool gRecvThreadPool;
 extern ThreadPool gSendThreadPool;
 extern ThreadPool gMiniServerThreadPool;
 
+/*! \brief State of the Upnp SDK, == 0 if uninitialized, == 1 if
+ * initialized. */
+extern int UpnpSdkInit;
+
 /// UpnpFunName
 typedef enum {
     SUBSCRIBE,
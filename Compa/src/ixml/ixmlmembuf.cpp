@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022 GPL 3 and higher by Ingo Höft,  <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-31
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-18
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -71,8 +71,11 @@ static int ixml_membuf_set_size(
             return 0;
         }
 
+        /* Grow at least by the current capacity so that appending many
+         * small pieces only needs a logarithmic number of reallocs. */
         diff = new_length - m->length;
-        alloc_len = MAXVAL(m->size_inc, diff) + m->capacity;
+        alloc_len =
+            MAXVAL(MAXVAL(m->size_inc, diff), m->capacity) + m->capacity;
     } else {
         /* decrease length */
         assert(new_length <= m->length);
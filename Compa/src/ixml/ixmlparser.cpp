@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-04-01
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-18
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -2398,6 +2398,131 @@ ErrorHandler:
     return rc;
 }
 
+/*!
+ * \brief Parses the xml buffer and reports the nodes to the SAX handler.
+ *
+ * It uses the same token loop as Parser_parseDocument() but no DOM node is
+ * created. Only the element stack is maintained to verify end tags and to
+ * track namespace definitions.
+ *
+ * \return IXML_SUCCESS, an error code or the return value of a callback.
+ */
+static int Parser_parseSax(
+    /*! [in] The XML parser. */
+    Parser* xmlParser,
+    /*! [in] The callbacks to call. */
+    const IXML_SaxHandler* handler,
+    /*! [in] Pointer that is given to every callback. */
+    void* userData) {
+    IXML_Node newNode;
+    int bETag = 0;
+    int rc = IXML_SUCCESS;
+    const char* localName = NULL;
+
+    ixmlNode_init(&newNode);
+
+    rc = Parser_skipProlog(xmlParser);
+    if (rc != IXML_SUCCESS) {
+        goto ExitFunction;
+    }
+
+    while (bETag == 0) {
+        ixmlNode_init(&newNode);
+
+        if (Parser_getNextNode(xmlParser, &newNode, &bETag) == IXML_SUCCESS) {
+            if (bETag == 0) {
+                switch (newNode.nodeType) {
+                case eELEMENT_NODE:
+                    if (xmlParser->bHasTopLevel) {
+                        if (isTopLevelElement(xmlParser)) {
+                            rc = IXML_SYNTAX_ERR;
+                            goto ExitFunction;
+                        }
+                    } else {
+                        xmlParser->bHasTopLevel = 1;
+                    }
+                    rc = Parser_pushElement(xmlParser, &newNode);
+                    if (rc != IXML_SUCCESS) {
+                        goto ExitFunction;
+                    }
+                    if (handler->startElement != NULL) {
+                        localName = newNode.localName != NULL
+                                        ? newNode.localName
+                                        : newNode.nodeName;
+                        rc = handler->startElement(userData, newNode.nodeName,
+                                                   localName);
+                        if (rc != IXML_SUCCESS) {
+                            goto ExitFunction;
+                        }
+                    }
+                    break;
+
+                case eTEXT_NODE:
+                case eCDATA_SECTION_NODE:
+                    if (handler->characters != NULL) {
+                        rc = handler->characters(userData, newNode.nodeValue);
+                        if (rc != IXML_SUCCESS) {
+                            goto ExitFunction;
+                        }
+                    }
+                    break;
+
+                case eATTRIBUTE_NODE:
+                    if (handler->attribute != NULL) {
+                        rc = handler->attribute(userData, newNode.nodeName,
+                                                newNode.nodeValue);
+                        if (rc != IXML_SUCCESS) {
+                            goto ExitFunction;
+                        }
+                    }
+                    break;
+
+                default:
+                    break;
+                }
+            } else {
+                /* ETag==1, endof element tag. */
+                if (!Parser_isValidEndElement(xmlParser, &newNode)) {
+                    rc = IXML_SYNTAX_ERR;
+                    goto ExitFunction;
+                }
+                if (handler->endElement != NULL) {
+                    localName = strchr(newNode.nodeName, ':');
+                    localName =
+                        localName != NULL ? localName + 1 : newNode.nodeName;
+                    rc = handler->endElement(userData, newNode.nodeName,
+                                             localName);
+                    if (rc != IXML_SUCCESS) {
+                        goto ExitFunction;
+                    }
+                }
+                Parser_popElement(xmlParser);
+                xmlParser->state = eCONTENT;
+            }
+
+            /* reset bETag flag */
+            bETag = 0;
+
+        } else if (bETag) {
+            /* file is done */
+            break;
+        } else {
+            rc = IXML_FAILED;
+            goto ExitFunction;
+        }
+        Parser_freeNodeContent(&newNode);
+    }
+
+    if (xmlParser->pCurElement != NULL) {
+        rc = IXML_SYNTAX_ERR;
+    }
+
+ExitFunction:
+    Parser_freeNodeContent(&newNode);
+    Parser_free(xmlParser);
+    return rc;
+}
+
 int Parser_isValidXmlName(const DOMString name) {
     const char* pstr = NULL;
     size_t i = (size_t)0;
@@ -2544,6 +2669,21 @@ int Parser_LoadDocument(
     return rc;
 }
 
+int Parser_ParseBufferSax(const char* buffer, const IXML_SaxHandler* handler,
+                          void* userData) {
+    Parser* xmlParser = NULL;
+
+    xmlParser = Parser_init();
+    if (xmlParser == NULL) {
+        return IXML_INSUFFICIENT_MEMORY;
+    }
+
+    /* The parser never modifies the data buffer so it can be used in place.
+     * dataBuffer stays NULL so that Parser_free() does not free it. */
+    xmlParser->curPtr = (char*)buffer;
+    return Parser_parseSax(xmlParser, handler, userData);
+}
+
 void Parser_freeNodeContent(IXML_Node* nodeptr) {
     if (nodeptr == NULL) {
         return;
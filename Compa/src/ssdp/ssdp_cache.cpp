@@ -0,0 +1,196 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup compa-Discovery
+ * \brief Cache of discovered devices and services for control points (for
+ * internal use only).
+ */
+
+#include <ssdp_cache.hpp>
+#include <upnpapi.hpp>
+
+#ifndef COMPA_INTERNAL_CONFIG_HPP
+#error "No or wrong config.hpp header file included."
+#endif
+
+/// \cond
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+/// \endcond
+
+namespace {
+
+/// \brief Deletes a discovery object owned by a smart pointer.
+struct DiscoveryDeleter {
+    void operator()(UpnpDiscovery* a_param) const {
+        UpnpDiscovery_delete(a_param);
+    }
+};
+/// \brief Smart pointer to a discovery object.
+using DiscoveryPtr = std::unique_ptr<UpnpDiscovery, DiscoveryDeleter>;
+
+/// \brief Clock for the expiry time of the entries.
+using Clock = std::chrono::steady_clock;
+
+/// \brief Entry of the cache.
+struct CacheEntry {
+    DiscoveryPtr param; ///< Last delivered discovery information.
+    int bootid;         ///< Value of the BOOTID.UPNP.ORG header or -1.
+    Clock::time_point expires; ///< Time when the entry expires.
+};
+
+/// \brief Mutex to protect the cache.
+pthread_mutex_t gSsdpCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief Entries of the cache with the USN as key.
+std::map<std::string, CacheEntry> gSsdpCache;
+/// \brief Set if the cache is used.
+bool gSsdpCacheEnabled{SSDP_DISCOVERY_CACHE != 0};
+/// \brief Set if a timer job to remove expired entries is scheduled.
+bool gSsdpCacheSweepScheduled{false};
+
+/*!
+ * \brief Removes expired entries from the cache.
+ *
+ * \note The caller must hold the cache mutex.
+ *
+ * \returns The discovery information of the removed entries.
+ */
+std::vector<DiscoveryPtr> expire_entries(Clock::time_point a_now) {
+    std::vector<DiscoveryPtr> expired;
+    for (auto it{gSsdpCache.begin()}; it != gSsdpCache.end();) {
+        if (it->second.expires <= a_now) {
+            expired.push_back(std::move(it->second.param));
+            it = gSsdpCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return expired;
+}
+
+/// \brief Calls the callback of all control points with an event.
+void deliver(Upnp_EventType a_event_type, const UpnpDiscovery* a_param) {
+    Handle_Info* ctrlpt_info;
+    Upnp_FunPtr ctrlpt_callback;
+    void* ctrlpt_cookie;
+
+    for (int handle{1}; handle < NUM_HANDLE; handle++) {
+        HandleLock();
+        if (GetHandleInfo(handle, &ctrlpt_info) != HND_CLIENT) {
+            HandleUnlock();
+            continue;
+        }
+        ctrlpt_callback = ctrlpt_info->Callback;
+        ctrlpt_cookie = ctrlpt_info->Cookie;
+        HandleUnlock();
+
+        ctrlpt_callback(a_event_type, a_param, ctrlpt_cookie);
+    }
+}
+
+void sweep_cache(void*);
+
+/*!
+ * \brief Schedules the timer job that removes expired entries.
+ *
+ * \note The caller must hold the cache mutex.
+ */
+void schedule_sweep() {
+    ThreadPoolJob job;
+
+    memset(&job, 0, sizeof(job));
+    TPJobInit(&job, (UPnPsdk::start_routine)sweep_cache, nullptr);
+    TPJobSetPriority(&job, MED_PRIORITY);
+    gSsdpCacheSweepScheduled =
+        TimerThreadSchedule(&gTimerThread, SSDP_CACHE_SWEEP_TIME, REL_SEC,
+                            &job, SHORT_TERM, nullptr) == 0;
+}
+
+/*!
+ * \brief Timer job that removes expired entries and reports them to the
+ * control points.
+ *
+ * It reschedules itself as long as the cache is not empty.
+ */
+void sweep_cache(void*) {
+    pthread_mutex_lock(&gSsdpCacheMutex);
+    std::vector<DiscoveryPtr> expired{expire_entries(Clock::now())};
+    gSsdpCacheSweepScheduled = false;
+    if (!gSsdpCache.empty())
+        schedule_sweep();
+    pthread_mutex_unlock(&gSsdpCacheMutex);
+
+    for (const DiscoveryPtr& param : expired)
+        deliver(UPNP_DISCOVERY_ADVERTISEMENT_BYEBYE, param.get());
+}
+
+} // anonymous namespace
+
+
+void ssdp_cache_enable(bool a_enable) {
+    pthread_mutex_lock(&gSsdpCacheMutex);
+    gSsdpCacheEnabled = a_enable;
+    if (!a_enable)
+        gSsdpCache.clear();
+    pthread_mutex_unlock(&gSsdpCacheMutex);
+}
+
+bool ssdp_cache_alive(const char* a_usn, int a_bootid,
+                      const UpnpDiscovery* a_param) {
+    bool changed{true};
+
+    pthread_mutex_lock(&gSsdpCacheMutex);
+    if (gSsdpCacheEnabled) {
+        const Clock::time_point expires{
+            Clock::now() +
+            std::chrono::seconds(UpnpDiscovery_get_Expires(a_param))};
+        auto [it, inserted] = gSsdpCache.try_emplace(a_usn);
+        CacheEntry& entry{it->second};
+        if (!inserted) {
+            changed = entry.bootid != a_bootid ||
+                      strcmp(UpnpDiscovery_get_Location_cstr(entry.param.get()),
+                             UpnpDiscovery_get_Location_cstr(a_param)) != 0;
+        }
+        if (changed) {
+            entry.param.reset(UpnpDiscovery_dup(a_param));
+            entry.bootid = a_bootid;
+        }
+        entry.expires = expires;
+        if (!gSsdpCacheSweepScheduled)
+            schedule_sweep();
+    }
+    pthread_mutex_unlock(&gSsdpCacheMutex);
+    return changed;
+}
+
+void ssdp_cache_byebye(const char* a_usn) {
+    pthread_mutex_lock(&gSsdpCacheMutex);
+    gSsdpCache.erase(a_usn);
+    pthread_mutex_unlock(&gSsdpCacheMutex);
+}
+
+void ssdp_cache_get(Upnp_FunPtr a_fun, void* a_cookie) {
+    std::vector<DiscoveryPtr> params;
+
+    pthread_mutex_lock(&gSsdpCacheMutex);
+    const Clock::time_point now{Clock::now()};
+    for (const auto& [usn, entry] : gSsdpCache) {
+        if (entry.expires > now)
+            params.emplace_back(UpnpDiscovery_dup(entry.param.get()));
+    }
+    pthread_mutex_unlock(&gSsdpCacheMutex);
+
+    for (const DiscoveryPtr& param : params)
+        a_fun(UPNP_DISCOVERY_ADVERTISEMENT_ALIVE, param.get(), a_cookie);
+}
+
+void ssdp_cache_clear() {
+    pthread_mutex_lock(&gSsdpCacheMutex);
+    gSsdpCache.clear();
+    gSsdpCacheSweepScheduled = false;
+    pthread_mutex_unlock(&gSsdpCacheMutex);
+}
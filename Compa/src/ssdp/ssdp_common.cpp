@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-29
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -42,6 +42,9 @@
 
 #include <ssdp_ctrlpt.hpp>
 #include <ssdp_device.hpp>
+#include <ssdp_filter.hpp>
+#include <metrics.hpp>
+#include <ObjectPool.hpp>
 #include <upnpapi.hpp>
 
 #ifndef COMPA_SSDP_COMMON_HPP
@@ -78,7 +81,7 @@ void free_ssdp_event_handler_data(
         http_message_t* hmsg = &data->parser.msg;
         /* free data */
         httpmsg_destroy(hmsg);
-        free(data);
+        ObjectPoolFree(data, sizeof(ssdp_thread_data));
     }
 }
 
@@ -179,8 +182,16 @@ void ssdp_event_handler_thread(
     ssdp_thread_data* data = (ssdp_thread_data*)the_data;
     http_message_t* hmsg = &data->parser.msg;
 
-    if (start_event_handler(the_data) != 0)
+    if (start_event_handler(the_data) != 0) {
+        compa::metrics_add(UPNP_METRIC_SSDP_IN_INVALID);
         return;
+    }
+    if (hmsg->method == (http_method_t)HTTPMETHOD_NOTIFY)
+        compa::metrics_add(UPNP_METRIC_SSDP_IN_NOTIFY);
+    else if (hmsg->request_method == (http_method_t)HTTPMETHOD_MSEARCH)
+        compa::metrics_add(UPNP_METRIC_SSDP_IN_RESPONSE);
+    else
+        compa::metrics_add(UPNP_METRIC_SSDP_IN_MSEARCH);
     /* send msg to device or ctrlpt */
     if (hmsg->method == (http_method_t)HTTPMETHOD_NOTIFY ||
         hmsg->request_method == (http_method_t)HTTPMETHOD_MSEARCH) {
@@ -198,6 +209,111 @@ void ssdp_event_handler_thread(
     free_ssdp_event_handler_data(data);
 }
 
+/*!
+ * \brief Allocates an ssdp_thread_data structure with a parser initialized
+ * for messages from an SSDP socket.
+ *
+ * \returns
+ *  On success: Pointer to the structure\n
+ *  On error: nullptr
+ */
+ssdp_thread_data* new_ssdp_thread_data(
+    /*! [in] SSDP socket the message is received from. */
+    [[maybe_unused]] SOCKET socket) {
+    ssdp_thread_data* data = static_cast<ssdp_thread_data*>(
+        ObjectPoolAlloc(sizeof(ssdp_thread_data)));
+    if (data == nullptr)
+        return nullptr;
+    /* initialize parser */
+#ifdef COMPA_HAVE_CTRLPT_SSDP
+    if (socket == gSsdpReqSocket4 || socket == gSsdpReqSocket6)
+        parser_response_init(&data->parser, HTTPMETHOD_MSEARCH);
+    else
+        parser_request_init(&data->parser);
+#else  /* COMPA_HAVE_CTRLPT_SSDP */
+    parser_request_init(&data->parser);
+#endif /* COMPA_HAVE_CTRLPT_SSDP */
+    return data;
+}
+
+/*!
+ * \brief Logs a received SSDP message with its sender.
+ */
+void print_ssdp_msg(
+    /*! [in] Null terminated message. */
+    const char* requestBuf,
+    /*! [in] Socket address of the sender. */
+    const sockaddr_storage& a_ss) {
+    char ntop_buf[INET6_ADDRSTRLEN];
+
+    switch (a_ss.ss_family) {
+    case AF_INET:
+        inet_ntop(AF_INET, &((const sockaddr_in*)&a_ss)->sin_addr, ntop_buf,
+                  sizeof(ntop_buf));
+        break;
+    case AF_INET6:
+        inet_ntop(AF_INET6, &((const sockaddr_in6*)&a_ss)->sin6_addr,
+                  ntop_buf, sizeof(ntop_buf));
+        break;
+    default:
+        memset(ntop_buf, 0, sizeof(ntop_buf));
+        strncpy(ntop_buf, "<Invalid address family>", sizeof(ntop_buf) - 1);
+    }
+    /* clang-format off */
+    UpnpPrintf(UPNP_INFO, SSDP, __FILE__, __LINE__,
+           "\nStart of received response ----------------------------------------------------\n"
+           "%s\n"
+           "End of received response ------------------------------------------------------\n"
+           "From host %s\n", requestBuf, ntop_buf);
+    /* clang-format on */
+}
+
+#if defined(__linux__) || defined(DOXYGEN_RUN)
+/*!
+ * \brief Receive buffers for recvmmsg().
+ *
+ * Only the miniserver thread reads from the SSDP sockets, so the buffers are
+ * not protected.
+ */
+char gSsdpRecvBuf[SSDP_RECV_BATCH][BUFSIZE];
+
+/*!
+ * \brief SSDP messages that are received at once and handled by one thread
+ * pool job.
+ */
+struct ssdp_thread_batch {
+    int count; ///< Number of messages.
+    ssdp_thread_data* data[SSDP_RECV_BATCH]; ///< Received messages.
+};
+
+/*!
+ * \brief Frees a batch of SSDP messages that has not been handled.
+ */
+void free_ssdp_batch(
+    /*! [in] ssdp_thread_batch structure. */
+    void* a_batch) {
+    ssdp_thread_batch* batch = static_cast<ssdp_thread_batch*>(a_batch);
+
+    for (int i{0}; i < batch->count; i++)
+        free_ssdp_event_handler_data(batch->data[i]);
+    ObjectPoolFree(batch, sizeof(ssdp_thread_batch));
+}
+
+/*!
+ * \brief This function is a thread that handles a batch of SSDP messages
+ * one after the other.
+ */
+void ssdp_batch_handler_thread(
+    /*! [in] ssdp_thread_batch structure. */
+    void* a_batch) {
+    ssdp_thread_batch* batch = static_cast<ssdp_thread_batch*>(a_batch);
+
+    for (int i{0}; i < batch->count; i++)
+        ssdp_event_handler_thread(batch->data[i]);
+    ObjectPoolFree(batch, sizeof(ssdp_thread_batch));
+}
+#endif /* __linux__ */
+
 /*!
  * \brief Create an SSDP IPv4 socket.
  *
@@ -769,82 +885,111 @@ int ssdp_request_type(char* cmd, SsdpEvent* Evt) {
 int readFromSSDPSocket(SOCKET socket) {
     TRACE("Executing readFromSSDPSocket()")
 
-    char staticBuf[BUFSIZE];
-    char* requestBuf = staticBuf;
-    /* in case memory can't be allocated, still drain the socket using a
-     * static buffer. */
-    ssdp_thread_data* data =
-        static_cast<ssdp_thread_data*>(malloc(sizeof(ssdp_thread_data)));
-    if (data) {
-        /* initialize parser */
-#ifdef COMPA_HAVE_CTRLPT_SSDP
-        if (socket == gSsdpReqSocket4 || socket == gSsdpReqSocket6)
-            parser_response_init(&data->parser, HTTPMETHOD_MSEARCH);
-        else
-            parser_request_init(&data->parser);
-#else  /* COMPA_HAVE_CTRLPT_SSDP */
-        parser_request_init(&data->parser);
-#endif /* COMPA_HAVE_CTRLPT_SSDP */
-        /* set size of parser buffer */
-        if (membuffer_set_size(&data->parser.msg.msg, BUFSIZE) == 0)
-            /* use this as the buffer for recv */
-            requestBuf = data->parser.msg.msg.buf;
-        else {
-            free(data);
-            data = nullptr;
+#ifdef __linux__
+    mmsghdr msgs[SSDP_RECV_BATCH]{};
+    iovec iovs[SSDP_RECV_BATCH];
+    sockaddr_storage addrs[SSDP_RECV_BATCH];
+    for (unsigned int i{0}; i < SSDP_RECV_BATCH; i++) {
+        iovs[i].iov_base = gSsdpRecvBuf[i];
+        iovs[i].iov_len = BUFSIZE - 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    /* The socket is readable, so wait only for the first datagram and take
+     * the others that are already queued. */
+    int received = umock::sys_socket_h.recvmmsg(socket, msgs, SSDP_RECV_BATCH,
+                                                MSG_WAITFORONE, nullptr);
+    if (received < 0)
+        return -1;
+
+    /* in case memory can't be allocated, still drain the socket. */
+    ssdp_thread_batch* batch = static_cast<ssdp_thread_batch*>(
+        ObjectPoolAlloc(sizeof(ssdp_thread_batch)));
+    if (batch != nullptr)
+        batch->count = 0;
+    for (int i{0}; i < received; i++) {
+        const size_t byteReceived{msgs[i].msg_len};
+        if (byteReceived == 0)
+            continue;
+        char* requestBuf = gSsdpRecvBuf[i];
+        requestBuf[byteReceived] = '\0';
+        print_ssdp_msg(requestBuf, addrs[i]);
+        if (!ssdp_filter_accept(requestBuf, byteReceived)) {
+            compa::metrics_add(UPNP_METRIC_SSDP_IN_FILTERED);
+            continue;
+        }
+        if (batch == nullptr)
+            continue;
+
+        ssdp_thread_data* data = new_ssdp_thread_data(socket);
+        if (data == nullptr)
+            continue;
+        if (membuffer_assign(&data->parser.msg.msg, requestBuf,
+                             byteReceived) != 0) {
+            free_ssdp_event_handler_data(data);
+            continue;
         }
+        memcpy(&data->dest_addr, &addrs[i], sizeof(addrs[i]));
+        batch->data[batch->count++] = data;
     }
+
+    if (batch != nullptr) {
+        if (batch->count == 0) {
+            ObjectPoolFree(batch, sizeof(ssdp_thread_batch));
+        } else {
+            /* add one thread pool job to handle all requests */
+            ThreadPoolJob job{};
+            TPJobInit(&job, (UPnPsdk::start_routine)ssdp_batch_handler_thread,
+                      batch);
+            TPJobSetFreeFunction(&job, free_ssdp_batch);
+            TPJobSetPriority(&job, MED_PRIORITY);
+            if (ThreadPoolAdd(&gRecvThreadPool, &job, NULL) != 0)
+                free_ssdp_batch(batch);
+        }
+    }
+    return 0;
+
+#else  /* __linux__ */
+    /* Without recvmmsg() one datagram is received per call. It is filtered
+     * before memory for its handling is allocated. */
+    char requestBuf[BUFSIZE];
     struct sockaddr_storage __ss;
     socklen_t socklen = sizeof(__ss);
     ssize_t byteReceived = umock::sys_socket_h.recvfrom(
         socket, requestBuf, BUFSIZE - 1, 0, reinterpret_cast<sockaddr*>(&__ss),
         &socklen);
-    if (byteReceived > 0) {
-        requestBuf[byteReceived] = '\0';
-        char ntop_buf[INET6_ADDRSTRLEN];
-
-        switch (__ss.ss_family) {
-        case AF_INET:
-            inet_ntop(AF_INET, &((struct sockaddr_in*)&__ss)->sin_addr,
-                      ntop_buf, sizeof(ntop_buf));
-            break;
-        case AF_INET6:
-            inet_ntop(AF_INET6, &((struct sockaddr_in6*)&__ss)->sin6_addr,
-                      ntop_buf, sizeof(ntop_buf));
-            break;
-        default:
-            memset(ntop_buf, 0, sizeof(ntop_buf));
-            strncpy(ntop_buf, "<Invalid address family>", sizeof(ntop_buf) - 1);
-        }
-        /* clang-format off */
-        UpnpPrintf(UPNP_INFO, SSDP, __FILE__, __LINE__,
-               "\nStart of received response ----------------------------------------------------\n"
-               "%s\n"
-               "End of received response ------------------------------------------------------\n"
-               "From host %s\n", requestBuf, ntop_buf);
-        /* clang-format on */
-
-        /* add thread pool job to handle request */
-        if (data != nullptr) {
-            // Cast is no problem; byteReceived is guarded above to be > 0.
-            data->parser.msg.msg.length += static_cast<size_t>(byteReceived);
-            /* null-terminate */
-            data->parser.msg.msg.buf[byteReceived] = '\0';
-            memcpy(&data->dest_addr, &__ss, sizeof(__ss));
-            ThreadPoolJob job{};
-            TPJobInit(&job, (UPnPsdk::start_routine)ssdp_event_handler_thread,
-                      data);
-            TPJobSetFreeFunction(&job, free_ssdp_event_handler_data);
-            TPJobSetPriority(&job, MED_PRIORITY);
-            if (ThreadPoolAdd(&gRecvThreadPool, &job, NULL) != 0) {
-                free_ssdp_event_handler_data(data);
-            }
-        }
+    if (byteReceived <= 0)
+        return (byteReceived < 0) ? -1 : 0;
+
+    // Cast is no problem; byteReceived is guarded above to be > 0.
+    const size_t msgLen{static_cast<size_t>(byteReceived)};
+    requestBuf[msgLen] = '\0';
+    print_ssdp_msg(requestBuf, __ss);
+    if (!ssdp_filter_accept(requestBuf, msgLen)) {
+        compa::metrics_add(UPNP_METRIC_SSDP_IN_FILTERED);
         return 0;
     }
-    free_ssdp_event_handler_data(data);
 
-    return (byteReceived < 0) ? -1 : 0;
+    /* add thread pool job to handle request */
+    ssdp_thread_data* data = new_ssdp_thread_data(socket);
+    if (data == nullptr)
+        return 0;
+    if (membuffer_assign(&data->parser.msg.msg, requestBuf, msgLen) != 0) {
+        free_ssdp_event_handler_data(data);
+        return 0;
+    }
+    memcpy(&data->dest_addr, &__ss, sizeof(__ss));
+    ThreadPoolJob job{};
+    TPJobInit(&job, (UPnPsdk::start_routine)ssdp_event_handler_thread, data);
+    TPJobSetFreeFunction(&job, free_ssdp_event_handler_data);
+    TPJobSetPriority(&job, MED_PRIORITY);
+    if (ThreadPoolAdd(&gRecvThreadPool, &job, NULL) != 0)
+        free_ssdp_event_handler_data(data);
+
+    return 0;
+#endif /* __linux__ */
 }
 
 
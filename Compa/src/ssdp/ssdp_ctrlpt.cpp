@@ -6,7 +6,7 @@
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-27
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * - Redistributions of source code must retain the above copyright notice,
  * this list of conditions and the following disclaimer.
@@ -42,6 +42,8 @@
 #include <ssdp_ctrlpt.hpp>
 
 #include "SSDPResultDataCallback.hpp"
+#include <metrics.hpp>
+#include <ssdp_cache.hpp>
 #include <statcodes.hpp>
 #include <upnpapi.hpp>
 
@@ -52,6 +54,7 @@
 #endif
 
 /// \cond
+#include <string>
 #include <thread>
 /// \endcond
 
@@ -297,6 +300,9 @@ void ssdp_handle_ctrlpt_msg(http_message_t* hmsg,
     int nt_found;
     int usn_found;
     int st_found;
+    std::string usn;
+    int bootid;
+    http_header_t* hdr;
     char save_char;
     Upnp_EventType event_type;
     Upnp_FunPtr ctrlpt_callback;
@@ -383,7 +389,13 @@ void ssdp_handle_ctrlpt_msg(http_message_t* hmsg,
         hdr_value.buf[hdr_value.length] = '\0';
         usn_found = (unique_service_name(hdr_value.buf, &event) == 0);
         hdr_value.buf[hdr_value.length] = save_char;
+        usn.assign(hdr_value.buf, hdr_value.length);
     }
+    /* BOOTID.UPNP.ORG */
+    bootid = -1;
+    hdr = httpmsg_find_hdr_str(hmsg, "BOOTID.UPNP.ORG");
+    if (hdr != NULL)
+        bootid = atoi(hdr->value.buf);
     if (nt_found || usn_found) {
         UpnpDiscovery_strcpy_DeviceID(param, event.UDN);
         UpnpDiscovery_strcpy_DeviceType(param, event.DeviceType);
@@ -411,6 +423,7 @@ void ssdp_handle_ctrlpt_msg(http_message_t* hmsg,
                 goto end_ssdp_handle_ctrlpt_msg;
             }
             event_type = UPNP_DISCOVERY_ADVERTISEMENT_BYEBYE;
+            ssdp_cache_byebye(usn.c_str());
         } else {
             /* check advertisement.
              * Expires is valid if positive. This is for testing
@@ -423,6 +436,9 @@ void ssdp_handle_ctrlpt_msg(http_message_t* hmsg,
                 goto end_ssdp_handle_ctrlpt_msg;
             }
             event_type = UPNP_DISCOVERY_ADVERTISEMENT_ALIVE;
+            /* known and unchanged */
+            if (!ssdp_cache_alive(usn.c_str(), bootid, param))
+                goto end_ssdp_handle_ctrlpt_msg;
         }
         /* call callback */
         for (handle = handle_start; handle < NUM_HANDLE; handle++) {
@@ -457,6 +473,9 @@ void ssdp_handle_ctrlpt_msg(http_message_t* hmsg,
             /* bad reply */
             goto end_ssdp_handle_ctrlpt_msg;
         }
+        /* A reply is always delivered to the matching searches, it only
+         * refreshes the cache. */
+        ssdp_cache_alive(usn.c_str(), bootid, param);
         /* check each current search */
         for (handle = handle_start; handle < NUM_HANDLE; handle++) {
             HandleLock();
@@ -677,10 +696,11 @@ int SearchByTarget(int Hnd, int Mx, char* St, void* Cookie) {
         while (NumCopy < NUM_SSDP_COPY) {
             UpnpPrintf(UPNP_INFO, SSDP, __FILE__, __LINE__,
                        ">>> SSDP SEND M-SEARCH >>>\n%s\n", ReqBufv6UlaGua);
-            sendto(gSsdpReqSocket6, ReqBufv6UlaGua,
-                   (SIZEP_T)strlen(ReqBufv6UlaGua), 0,
-                   (struct sockaddr*)&__ss_v6,
-                   (SIZEP_T)sizeof(struct sockaddr_in6));
+            if (sendto(gSsdpReqSocket6, ReqBufv6UlaGua,
+                       (SIZEP_T)strlen(ReqBufv6UlaGua), 0,
+                       (struct sockaddr*)&__ss_v6,
+                       (SIZEP_T)sizeof(struct sockaddr_in6)) > 0)
+                compa::metrics_add(UPNP_METRIC_SSDP_OUT_MSEARCH);
             NumCopy++;
             std::this_thread::sleep_for(std::chrono::milliseconds(SSDP_PAUSE));
         }
@@ -689,9 +709,10 @@ int SearchByTarget(int Hnd, int Mx, char* St, void* Cookie) {
         while (NumCopy < NUM_SSDP_COPY) {
             UpnpPrintf(UPNP_INFO, SSDP, __FILE__, __LINE__,
                        ">>> SSDP SEND M-SEARCH >>>\n%s\n", ReqBufv6);
-            sendto(gSsdpReqSocket6, ReqBufv6, (SIZEP_T)strlen(ReqBufv6), 0,
-                   (struct sockaddr*)&__ss_v6,
-                   (SIZEP_T)sizeof(struct sockaddr_in6));
+            if (sendto(gSsdpReqSocket6, ReqBufv6, (SIZEP_T)strlen(ReqBufv6),
+                       0, (struct sockaddr*)&__ss_v6,
+                       (SIZEP_T)sizeof(struct sockaddr_in6)) > 0)
+                compa::metrics_add(UPNP_METRIC_SSDP_OUT_MSEARCH);
             NumCopy++;
             std::this_thread::sleep_for(std::chrono::milliseconds(SSDP_PAUSE));
         }
@@ -703,10 +724,11 @@ int SearchByTarget(int Hnd, int Mx, char* St, void* Cookie) {
         while (NumCopy < NUM_SSDP_COPY) {
             UpnpPrintf(UPNP_INFO, SSDP, __FILE__, __LINE__,
                        ">>> SSDP SEND M-SEARCH >>>\n%s\n", ReqBufv4);
-            umock::sys_socket_h.sendto(gSsdpReqSocket4, ReqBufv4,
-                                       (SIZEP_T)strlen(ReqBufv4), 0,
-                                       (struct sockaddr*)&__ss_v4,
-                                       (SIZEP_T)sizeof(struct sockaddr_in));
+            if (umock::sys_socket_h.sendto(
+                    gSsdpReqSocket4, ReqBufv4, (SIZEP_T)strlen(ReqBufv4), 0,
+                    (struct sockaddr*)&__ss_v4,
+                    (SIZEP_T)sizeof(struct sockaddr_in)) > 0)
+                compa::metrics_add(UPNP_METRIC_SSDP_OUT_MSEARCH);
             NumCopy++;
             std::this_thread::sleep_for(std::chrono::milliseconds(SSDP_PAUSE));
         }
@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (C) 2011-2012 France Telecom All rights reserved.
  * Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2026-03-19
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -43,6 +43,7 @@
 #include <ssdp_device.hpp>
 
 #include <httpreadwrite.hpp>
+#include <metrics.hpp>
 #include <statcodes.hpp>
 #include <upnpapi.hpp>
 #include <webserver.hpp>
@@ -52,6 +53,7 @@
 
 #include <umock/sys_socket.hpp>
 #include <umock/netdb.hpp>
+#include <umock/sysinfo.hpp>
 
 #ifndef COMPA_INTERNAL_CONFIG_HPP
 #error "No or wrong config.hpp header file included."
@@ -59,6 +61,9 @@
 
 /// \cond
 #include <cassert>
+#include <initializer_list>
+#include <new>
+#include <string_view>
 #include <thread>
 #ifdef _MSC_VER
 #else
@@ -77,13 +82,41 @@ constexpr int MSGTYPE_SHUTDOWN{0};
 constexpr int MSGTYPE_ADVERTISEMENT{1};
 constexpr int MSGTYPE_REPLY{2};
 /// @}
+
+/// \brief Maximal number of pending search replies.
+constexpr int SSDP_REPLY_PENDING{256};
+/// \brief Number of source addresses tracked by the reply rate limit.
+constexpr int SSDP_REPLY_SOURCES{32};
+
+/// \brief Result of adding a search request to the pending replies.
+enum SsdpReplyAdd {
+    SSDP_REPLY_NEW,    ///< A new reply must be scheduled.
+    SSDP_REPLY_MERGED, ///< The request is merged into a pending reply.
+    SSDP_REPLY_DROPPED ///< The request exceeds the rate limit or resources.
+};
+
+/// \brief Replied search requests of a source address within one second.
+struct SsdpReplySource {
+    sockaddr_storage addr; ///< Source address, the port is not used.
+    time_t second;         ///< Second of the counted requests.
+    int count;             ///< Number of counted requests.
+};
+
+/// \brief Mutex to protect the pending search replies and the rate limit.
+pthread_mutex_t gSsdpReplyMutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief List of pending search replies.
+SsdpSearchReply* gSsdpReplies{nullptr};
+/// \brief Number of pending search replies.
+int gSsdpRepliesCount{0};
+/// \brief Source addresses tracked by the reply rate limit.
+SsdpReplySource gSsdpReplySources[SSDP_REPLY_SOURCES];
 /// @}
 
 /*! \name Functions scope restricted to file
  * @{ */
 
-int send_stateless(sockaddr* a_dest_saddr, int a_num_packet,
-                   char** a_rq_packet) {
+int send_stateless(const sockaddr* a_dest_saddr, int a_num_packet,
+                   char** a_rq_packet, SOCKET a_sock = INVALID_SOCKET) {
     if (a_dest_saddr == nullptr || a_rq_packet == nullptr)
         return UPNP_E_INVALID_PARAM;
 
@@ -92,18 +125,23 @@ int send_stateless(sockaddr* a_dest_saddr, int a_num_packet,
         return UPNP_E_SUCCESS;
     }
 
+    // Without a given socket, a socket is opened only for this call.
     UPnPsdk::CSocket sockObj;
-    try {
-        sockObj = SOCK_DGRAM;
-        sockObj.bind(nullptr, AI_PASSIVE);
-    } catch (const std::exception& ex) {
-        UPnPsdk_LOGCATCH("MSG1166") "catched next line...\n" << ex.what();
-        return UPNP_E_SOCKET_ERROR;
+    SOCKET sock{a_sock};
+    if (sock == INVALID_SOCKET) {
+        try {
+            sockObj = SOCK_DGRAM;
+            sockObj.bind(nullptr, AI_PASSIVE);
+        } catch (const std::exception& ex) {
+            UPnPsdk_LOGCATCH("MSG1166") "catched next line...\n" << ex.what();
+            return UPNP_E_SOCKET_ERROR;
+        }
+        sock = sockObj;
     }
 
     if (UPnPsdk::g_dbug) {
         UPnPsdk::SSockaddr saObj;
-        saObj = *reinterpret_cast<sockaddr_storage*>(a_dest_saddr);
+        saObj = *reinterpret_cast<const sockaddr_storage*>(a_dest_saddr);
         UPnPsdk_LOGINFO("MSG1154") "syscall ::sendto() \""
             << saObj.netaddrp() << "\", " << a_num_packet << " messages.\n";
     }
@@ -115,7 +153,7 @@ int send_stateless(sockaddr* a_dest_saddr, int a_num_packet,
             continue;
 
         // Send data. The sent string is not zero terminated.
-        ssize_t bytes_sent = ::sendto(sockObj, *(a_rq_packet + index),
+        ssize_t bytes_sent = ::sendto(sock, *(a_rq_packet + index),
                                       (SIZEP_T)strlen(*(a_rq_packet + index)),
                                       0, a_dest_saddr, sizeof(sockaddr_in6));
         if (bytes_sent == SOCKET_ERROR) {
@@ -124,6 +162,10 @@ int send_stateless(sockaddr* a_dest_saddr, int a_num_packet,
                 << serrObj << " - " << serrObj.error_str() << '\n';
             return UPNP_E_SOCKET_WRITE;
         }
+        // Advertisements start with "NOTIFY", search replies with "HTTP".
+        compa::metrics_add(**(a_rq_packet + index) == 'N'
+                               ? UPNP_METRIC_SSDP_OUT_NOTIFY
+                               : UPNP_METRIC_SSDP_OUT_RESPONSE);
     }
 
     return UPNP_E_SUCCESS;
@@ -143,17 +185,19 @@ int send_stateless(sockaddr* a_dest_saddr, int a_num_packet,
  */
 int NewRequestHandler(
     /*! [in] Ip address, to send the reply. */
-    struct sockaddr* a_dest_saddr,
+    const struct sockaddr* a_dest_saddr,
     /*! [in] Number of packets to be sent. */
     int a_num_packet,
     /*! [in] Pointer to Array of pointer for multicast packets to send. */
-    char** a_rq_packet) {
+    char** a_rq_packet,
+    /*! [in] Socket to send, or INVALID_SOCKET to open one for this call. */
+    SOCKET a_sock = INVALID_SOCKET) {
     if (a_dest_saddr == nullptr)
         return UPNP_E_INVALID_PARAM;
 
     switch (a_dest_saddr->sa_family) {
     case AF_INET6:
-        return send_stateless(a_dest_saddr, a_num_packet, a_rq_packet);
+        return send_stateless(a_dest_saddr, a_num_packet, a_rq_packet, a_sock);
     // case AF_INET:
     //     return send_stateless_ip4(a_dest_saddr, a_num_packet, a_rq_packet,
     //                               a_ttl);
@@ -177,7 +221,7 @@ int NewRequestHandler(
  * \returns **1** if an inet6 has been found, othherwise **0**.
  */
 inline int extractIPv6address( //
-    char* url,                 ///< [in]
+    const char* url,           ///< [in]
     char* address              ///< [out] Extracted IPv6 address.
 ) {
     int i = 0;
@@ -217,8 +261,8 @@ exit_function:
  * \returns **1** if the Url contains an ULA or GUA IPv6 address, **0**
  * otherwise.
  */
-int isUrlV6UlaGua(   //
-    char* descdocUrl ///< [in] Url
+int isUrlV6UlaGua(         //
+    const char* descdocUrl ///< [in] Url
 ) {
     char address[INET6_ADDRSTRLEN];
     struct in6_addr v6_addr;
@@ -251,8 +295,8 @@ void CreateServicePacket(
     int duration,
     /*! [out] Output buffer filled with HTTP statement. */
     char** packet,
-    /*! [in] Address family of the HTTP request. */
-    int AddressFamily,
+    /*! [in] Value of the HOST header of advertisements and shutdowns. */
+    const char* host,
     /*! [in] PowerState as defined by UPnP Low Power. */
     int PowerState,
     /*! [in] SleepPeriod as defined by UPnP Low Power. */
@@ -354,8 +398,6 @@ void CreateServicePacket(
         }
     } else if (msg_type == MSGTYPE_ADVERTISEMENT ||
                msg_type == MSGTYPE_SHUTDOWN) {
-        const char* host = NULL;
-
         if (msg_type == MSGTYPE_ADVERTISEMENT)
             nts = "ssdp:alive";
         else
@@ -363,16 +405,6 @@ void CreateServicePacket(
             nts = "ssdp:byebye";
         /* NOTE: The CACHE-CONTROL and LOCATION headers are not present in a
          * shutdown msg, but are present here for MS WinMe interop. */
-        switch (AddressFamily) {
-        case AF_INET:
-            host = SSDP_IP;
-            break;
-        default:
-            if (isUrlV6UlaGua(location))
-                host = "[" SSDP_IPV6_SITELOCAL "]";
-            else
-                host = "[" SSDP_IPV6_LINKLOCAL "]";
-        }
         if (PowerState > 0) {
 #ifdef COMPA_HAVE_OPTION_SSDP
             ret_code = http_MakeMessage(
@@ -468,10 +500,460 @@ void CreateServicePacket(
     return;
 }
 
+/*!
+ * \brief Renders the DATE header with the current time, as
+ * http_MakeMessage() does.
+ *
+ * \returns **true** on success, **false** otherwise.
+ */
+bool date_header(
+    /*! [out] Buffer for the header line. */
+    char* a_buf,
+    /*! [in] Size of the buffer. */
+    size_t a_size) {
+    constexpr char weekday[][4]{"Sun", "Mon", "Tue", "Wed",
+                                "Thu", "Fri", "Sat"};
+    constexpr char month[][4]{"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                              "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    time_t curr_time{umock::sysinfo.time(nullptr)};
+    tm date_storage;
+    tm* date{http_gmtime_r(&curr_time, &date_storage)};
+    if (date == nullptr)
+        return false;
+    int rc = snprintf(a_buf, a_size,
+                      "DATE: %s, %02d %s %d %02d:%02d:%02d GMT\r\n",
+                      weekday[date->tm_wday], date->tm_mday,
+                      month[date->tm_mon], date->tm_year + 1900, date->tm_hour,
+                      date->tm_min, date->tm_sec);
+    return rc > 0 && (size_t)rc < a_size;
+}
+
+/*!
+ * \brief Copies the parts of a packet together.
+ *
+ * \returns Allocated zero terminated packet, or nullptr if out of memory.
+ */
+char* join_packet(std::initializer_list<std::string_view> a_parts) {
+    size_t length{0};
+    for (const std::string_view& part : a_parts)
+        length += part.size();
+    char* packet{static_cast<char*>(malloc(length + 1))};
+    if (packet == nullptr)
+        return nullptr;
+    char* pos{packet};
+    for (const std::string_view& part : a_parts) {
+        memcpy(pos, part.data(), part.size());
+        pos += part.size();
+    }
+    *pos = '\0';
+    return packet;
+}
+
+/*!
+ * \brief Creates a packet from the rendered header lines of a device.
+ *
+ * It creates the same packet as CreateServicePacket(), but only copies the
+ * header lines together. With a reply only the DATE header is rendered for
+ * each packet. A location or duration that differs from the rendered one of
+ * the device is formatted for this packet.
+ */
+void CreatePreparedPacket(
+    /*! [in] Type of the message (Search Reply, Advertisement or Shutdown). */
+    int msg_type,
+    /*! [in] SSDP type. */
+    const char* nt,
+    /*! [in] Unique service name. */
+    const char* usn,
+    /*! [in] Location URL. */
+    const char* location,
+    /*! [in] Service duration in sec. */
+    int duration,
+    /*! [out] Output buffer filled with the packet, nullptr on error. */
+    char** packet,
+    /*! [in] Send data of the device with rendered header lines. */
+    const SsdpSendData* a_send) {
+    std::string location_line;
+    std::string cache_line;
+    std::string_view location_hdr{a_send->location};
+    std::string_view cache_hdr{a_send->cache_control};
+    char date[64];
+
+    *packet = nullptr;
+    if (location == a_send->lower_desc_url) {
+        location_hdr = a_send->lower_location;
+    } else if (location != a_send->desc_url) {
+        location_line = std::string("LOCATION: ") + location + "\r\n";
+        location_hdr = location_line;
+    }
+    if (duration != a_send->max_age) {
+        cache_line =
+            "CACHE-CONTROL: max-age=" + std::to_string(duration) + "\r\n";
+        cache_hdr = cache_line;
+    }
+
+    switch (msg_type) {
+    case MSGTYPE_REPLY:
+        if (!date_header(date, sizeof(date)))
+            return;
+        *packet = join_packet({"HTTP/1.1 200 OK\r\n", cache_hdr, date,
+                               "EXT:\r\n", location_hdr, a_send->opt,
+                               a_send->server, a_send->user_agent, "ST: ", nt,
+                               "\r\nUSN: ", usn, "\r\n", a_send->power,
+                               "\r\n"});
+        break;
+    case MSGTYPE_ADVERTISEMENT:
+    case MSGTYPE_SHUTDOWN:
+        /* NOTE: The CACHE-CONTROL and LOCATION headers are not present in a
+         * shutdown msg, but are present here for MS WinMe interop. */
+        *packet = join_packet(
+            {a_send->notify_head, cache_hdr, location_hdr, a_send->opt,
+             "NT: ", nt, "\r\nNTS: ",
+             msg_type == MSGTYPE_ADVERTISEMENT ? "ssdp:alive" : "ssdp:byebye",
+             "\r\n", a_send->server, a_send->user_agent, "USN: ", usn,
+             "\r\n", a_send->power, "\r\n"});
+        break;
+    default:
+        /* unknown msg */
+        assert(0);
+    }
+}
+
+/*!
+ * \brief Creates a packet with the rendered header lines of a device if
+ * there are some, otherwise with CreateServicePacket().
+ */
+void create_packet(
+    /*! [in] Prepared send data, or nullptr. */
+    const SsdpSendData* a_send,
+    /*! [in] Type of the message (Search Reply, Advertisement or Shutdown). */
+    int msg_type,
+    /*! [in] SSDP type. */
+    const char* nt,
+    /*! [in] Unique service name. */
+    char* usn,
+    /*! [in] Location URL. */
+    char* location,
+    /*! [in] Service duration in sec. */
+    int duration,
+    /*! [out] Output buffer filled with the packet, nullptr on error. */
+    char** packet,
+    /*! [in] PowerState as defined by UPnP Low Power. */
+    int PowerState,
+    /*! [in] SleepPeriod as defined by UPnP Low Power. */
+    int SleepPeriod,
+    /*! [in] RegistrationState as defined by UPnP Low Power. */
+    int RegistrationState) {
+    if (a_send != nullptr && a_send->desc_url != nullptr)
+        // The UPnP Low Power values are rendered from the device.
+        CreatePreparedPacket(msg_type, nt, usn, location, duration, packet,
+                             a_send);
+    else
+        CreateServicePacket(msg_type, nt, usn, location, duration, packet,
+                            a_send != nullptr ? a_send->host : "", PowerState,
+                            SleepPeriod, RegistrationState);
+}
+
+/// \brief Returns the socket of prepared send data, if there is one.
+inline SOCKET reply_sock(const SsdpSendData* a_send) {
+    return a_send == nullptr ? INVALID_SOCKET : a_send->sock;
+}
+
+/*!
+ * \brief Compares the addresses of two sockets.
+ *
+ * \returns **true** if the families, the IP addresses and, if requested, the
+ * ports are equal.
+ */
+bool same_address(const sockaddr_storage* a_ss1, const sockaddr_storage* a_ss2,
+                  bool a_with_port) {
+    if (a_ss1->ss_family != a_ss2->ss_family)
+        return false;
+    switch (a_ss1->ss_family) {
+    case AF_INET: {
+        const sockaddr_in* sin1{reinterpret_cast<const sockaddr_in*>(a_ss1)};
+        const sockaddr_in* sin2{reinterpret_cast<const sockaddr_in*>(a_ss2)};
+        return sin1->sin_addr.s_addr == sin2->sin_addr.s_addr &&
+               (!a_with_port || sin1->sin_port == sin2->sin_port);
+    }
+    case AF_INET6: {
+        const sockaddr_in6* sin1{reinterpret_cast<const sockaddr_in6*>(a_ss1)};
+        const sockaddr_in6* sin2{reinterpret_cast<const sockaddr_in6*>(a_ss2)};
+        return memcmp(&sin1->sin6_addr, &sin2->sin6_addr,
+                      sizeof(sin1->sin6_addr)) == 0 &&
+               sin1->sin6_scope_id == sin2->sin6_scope_id &&
+               (!a_with_port || sin1->sin6_port == sin2->sin6_port);
+    }
+    default:
+        return false;
+    }
+}
+
+/*!
+ * \brief Checks if a search target is already replied with a pending reply.
+ *
+ * \returns **true** if the reply contains the same target or "ssdp:all".
+ */
+bool reply_covers(const SsdpSearchReply* a_reply,
+                  const SsdpSearchTarget* a_target) {
+    for (int i{0}; i < a_reply->numTargets; i++) {
+        const SsdpSearchTarget* target{&a_reply->target[i]};
+        if (target->RequestType == SSDP_ALL)
+            return true;
+        if (target->RequestType == a_target->RequestType &&
+            strcmp(target->UDN, a_target->UDN) == 0 &&
+            strcmp(target->DeviceType, a_target->DeviceType) == 0 &&
+            strcmp(target->ServiceType, a_target->ServiceType) == 0)
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief Counts a search request of a source address for the rate limit.
+ *
+ * Must be called with locked gSsdpReplyMutex.
+ *
+ * \returns **true** if the request may be replied, **false** if the source
+ * exceeds the rate limit.
+ */
+bool reply_rate_ok(const sockaddr_storage* a_src, time_t a_now) {
+    const int limit{g_UpnpSdkSsdpReplyLimit};
+    if (limit <= 0)
+        return true;
+
+    SsdpReplySource* source{nullptr};
+    SsdpReplySource* oldest{&gSsdpReplySources[0]};
+    for (SsdpReplySource& entry : gSsdpReplySources) {
+        if (same_address(&entry.addr, a_src, false)) {
+            source = &entry;
+            break;
+        }
+        if (entry.second < oldest->second)
+            oldest = &entry;
+    }
+    if (source == nullptr) {
+        // Reuse the entry that was not used for the longest time.
+        source = oldest;
+        memcpy(&source->addr, a_src, sizeof(source->addr));
+        source->count = 0;
+    }
+    if (source->second != a_now) {
+        source->second = a_now;
+        source->count = 0;
+    }
+    if (source->count >= limit)
+        return false;
+    source->count++;
+    return true;
+}
+
+/*!
+ * \brief Adds a search request to the pending replies of a device.
+ *
+ * The request is merged into a pending reply to the same source address and
+ * port, if that is sent within the MX time of the request. Otherwise a new
+ * reply is created with a random reply time within the MX time and added to
+ * the pending replies. The caller must schedule a new reply.
+ *
+ * \returns
+ *  - SSDP_REPLY_NEW, \p *a_reply is set to the new reply.
+ *  - SSDP_REPLY_MERGED
+ *  - SSDP_REPLY_DROPPED
+ */
+SsdpReplyAdd reply_add(
+    /*! [in] Handle of the device that replies. */
+    UpnpDevice_Handle a_handle,
+    /*! [in] Advertisement age of the device. */
+    int a_maxAge,
+    /*! [in] Source address of the search request. */
+    const sockaddr_storage* a_src,
+    /*! [in] Parsed search request. */
+    const SsdpEvent* a_event,
+    /*! [in] Current time in seconds. */
+    time_t a_now,
+    /*! [in] Time in seconds to reply, at least 1. */
+    int a_mx,
+    /*! [out] New reply to schedule. */
+    SsdpSearchReply** a_reply) {
+    SsdpSearchTarget target;
+    target.RequestType = a_event->RequestType;
+    memcpy(target.UDN, a_event->UDN, sizeof(target.UDN));
+    memcpy(target.DeviceType, a_event->DeviceType, sizeof(target.DeviceType));
+    memcpy(target.ServiceType, a_event->ServiceType,
+           sizeof(target.ServiceType));
+
+    SsdpReplyAdd ret{SSDP_REPLY_DROPPED};
+    SsdpSearchReply* reply;
+    pthread_mutex_lock(&gSsdpReplyMutex);
+    for (reply = gSsdpReplies; reply != nullptr; reply = reply->next) {
+        if (reply->handle == a_handle && reply->replyTime <= a_now + a_mx &&
+            same_address(&reply->dest_addr, a_src, true))
+            break;
+    }
+    if (reply != nullptr && reply_covers(reply, &target)) {
+        ret = SSDP_REPLY_MERGED;
+        goto exit_function;
+    }
+    if (!reply_rate_ok(a_src, a_now))
+        goto exit_function;
+
+    if (reply != nullptr) {
+        if (target.RequestType == SSDP_ALL) {
+            // "ssdp:all" replaces all other targets.
+            reply->target[0] = target;
+            reply->numTargets = 1;
+            ret = SSDP_REPLY_MERGED;
+            goto exit_function;
+        }
+        if (reply->numTargets < SSDP_REPLY_TARGETS) {
+            reply->target[reply->numTargets++] = target;
+            ret = SSDP_REPLY_MERGED;
+            goto exit_function;
+        }
+    }
+
+    if (gSsdpRepliesCount >= SSDP_REPLY_PENDING)
+        goto exit_function;
+    reply = (SsdpSearchReply*)malloc(sizeof(SsdpSearchReply));
+    if (reply == nullptr)
+        goto exit_function;
+    reply->handle = a_handle;
+    reply->MaxAge = a_maxAge;
+    memcpy(&reply->dest_addr, a_src, sizeof(reply->dest_addr));
+    reply->replyTime = a_now + rand() % a_mx;
+    reply->target[0] = target;
+    reply->numTargets = 1;
+    reply->next = gSsdpReplies;
+    gSsdpReplies = reply;
+    gSsdpRepliesCount++;
+    *a_reply = reply;
+    ret = SSDP_REPLY_NEW;
+
+exit_function:
+    pthread_mutex_unlock(&gSsdpReplyMutex);
+    return ret;
+}
+
+/*!
+ * \brief Removes a search reply from the pending replies, so that no more
+ * search requests are merged into it.
+ */
+void reply_unlink(SsdpSearchReply* a_reply) {
+    pthread_mutex_lock(&gSsdpReplyMutex);
+    for (SsdpSearchReply** next = &gSsdpReplies; *next != nullptr;
+         next = &(*next)->next) {
+        if (*next == a_reply) {
+            *next = a_reply->next;
+            gSsdpRepliesCount--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&gSsdpReplyMutex);
+}
+
+/*!
+ * \brief Frees a search reply that is not sent.
+ *
+ * It is the free function of the reply job.
+ */
+void free_search_reply(
+    /*! [in] Search reply. */
+    void* a_reply) {
+    SsdpSearchReply* reply{static_cast<SsdpSearchReply*>(a_reply)};
+    reply_unlink(reply);
+    free(reply);
+}
+
 /// @} // Functions scope restricted to file
 } // anonymous namespace
 
 
+void ssdp_prepare_send(SsdpSendData* a_send, const char* a_location,
+                       int a_af) {
+    sockaddr_in* dest4{reinterpret_cast<sockaddr_in*>(&a_send->mcast_addr)};
+    sockaddr_in6* dest6{reinterpret_cast<sockaddr_in6*>(&a_send->mcast_addr)};
+
+    memset(&a_send->mcast_addr, 0, sizeof(a_send->mcast_addr));
+    a_send->host = "";
+    switch (a_af) {
+    case AF_INET:
+        dest4->sin_family = (sa_family_t)AF_INET;
+        inet_pton(AF_INET, SSDP_IP, &dest4->sin_addr);
+        dest4->sin_port = htons(SSDP_PORT);
+        a_send->host = SSDP_IP;
+        break;
+    case AF_INET6:
+        dest6->sin6_family = (sa_family_t)AF_INET6;
+        if (isUrlV6UlaGua(a_location)) {
+            inet_pton(AF_INET6, SSDP_IPV6_SITELOCAL, &dest6->sin6_addr);
+            a_send->host = "[" SSDP_IPV6_SITELOCAL "]";
+        } else {
+            inet_pton(AF_INET6, SSDP_IPV6_LINKLOCAL, &dest6->sin6_addr);
+            a_send->host = "[" SSDP_IPV6_LINKLOCAL "]";
+        }
+        dest6->sin6_port = htons(SSDP_PORT);
+        dest6->sin6_scope_id = gIF_INDEX;
+        break;
+    default:
+        UpnpPrintf(UPNP_CRITICAL, SSDP, __FILE__, __LINE__,
+                   "Invalid device address family.\n");
+    }
+}
+
+void ssdp_device_send_update(Handle_Info* a_info) {
+    SsdpSendData* sdata{a_info->SsdpSend};
+    char server[200];
+
+    if (sdata == nullptr) {
+        sdata = new (std::nothrow) SsdpSendData;
+        if (sdata == nullptr)
+            return;
+        // Without a socket each message opens its own one.
+        try {
+            sdata->sockObj = SOCK_DGRAM;
+            sdata->sockObj.bind(nullptr, AI_PASSIVE);
+            sdata->sock = sdata->sockObj;
+        } catch (const std::exception& ex) {
+            UPnPsdk_LOGCATCH("MSG1199") "catched next line...\n" << ex.what();
+        }
+        a_info->SsdpSend = sdata;
+    }
+    ssdp_prepare_send(sdata, a_info->DescURL, a_info->DeviceAf);
+
+    // Render the header lines of all messages.
+    get_sdk_info(server, sizeof(server));
+    sdata->desc_url = a_info->DescURL;
+    sdata->lower_desc_url = a_info->LowerDescURL;
+    sdata->max_age = a_info->MaxAge;
+    sdata->notify_head = std::string("NOTIFY * HTTP/1.1\r\nHOST: ") +
+                         sdata->host + ":" + std::to_string(SSDP_PORT) +
+                         "\r\n";
+    sdata->cache_control =
+        "CACHE-CONTROL: max-age=" + std::to_string(a_info->MaxAge) + "\r\n";
+    sdata->location = std::string("LOCATION: ") + a_info->DescURL + "\r\n";
+    sdata->lower_location =
+        std::string("LOCATION: ") + a_info->LowerDescURL + "\r\n";
+#ifdef COMPA_HAVE_OPTION_SSDP
+    sdata->opt = std::string("OPT: \"http://schemas.upnp.org/upnp/1/0/\"; "
+                             "ns=01\r\n01-NLS: ") +
+                 gUpnpSdkNLSuuid + "\r\n";
+    sdata->user_agent = "X-User-Agent: " X_USER_AGENT "\r\n";
+#endif
+    sdata->server = std::string("SERVER: ") + server;
+    sdata->power.clear();
+    if (a_info->PowerState > 0)
+        sdata->power =
+            "Powerstate: " + std::to_string(a_info->PowerState) +
+            "\r\nSleepPeriod: " + std::to_string(a_info->SleepPeriod) +
+            "\r\nRegistrationState: " +
+            std::to_string(a_info->RegistrationState) + "\r\n";
+}
+
+void ssdp_device_send_free(Handle_Info* a_info) {
+    delete a_info->SsdpSend;
+    a_info->SsdpSend = nullptr;
+}
+
 void ssdp_handle_device_request(http_message_t* hmsg,
                                 struct sockaddr_storage* dest_addr) {
     constexpr int MX_FUDGE_FACTOR{10};
@@ -482,9 +964,9 @@ void ssdp_handle_device_request(http_message_t* hmsg,
     char save_char;
     SsdpEvent event;
     int ret_code;
-    SsdpSearchReply* threadArg = NULL;
+    SsdpSearchReply* reply = NULL;
     ThreadPoolJob job;
-    int replyTime;
+    time_t now;
     int maxAge;
 
     memset(&job, 0, sizeof(job));
@@ -510,6 +992,14 @@ void ssdp_handle_device_request(http_message_t* hmsg,
         /* bad ST header. */
         return;
 
+    /* Subtract a percentage from the mx to allow for network and processing
+     * delays (i.e. if search is for 30 seconds, respond
+     * within 0 - 27 seconds). */
+    if (mx >= 2)
+        mx -= std::max(1, mx / MX_FUDGE_FACTOR);
+    if (mx < 1)
+        mx = 1;
+
     start = 0;
     for (;;) {
         HandleLock();
@@ -536,37 +1026,27 @@ void ssdp_handle_device_request(http_message_t* hmsg,
                    event.UDN);
         UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__, "ServiceType =  %s\n",
                    event.ServiceType);
-        threadArg = (SsdpSearchReply*)malloc(sizeof(SsdpSearchReply));
-        if (threadArg == NULL)
-            return;
-        threadArg->handle = handle;
-        memcpy(&threadArg->dest_addr, dest_addr, sizeof(threadArg->dest_addr));
-        threadArg->event = event;
-        threadArg->MaxAge = maxAge;
-
-        TPJobInit(&job, advertiseAndReplyThread, threadArg);
-        TPJobSetFreeFunction(&job, (free_routine)free);
-
-        /* Subtract a percentage from the mx to allow for network and processing
-         * delays (i.e. if search is for 30 seconds, respond
-         * within 0 - 27 seconds). */
-        if (mx >= 2)
-            mx -= std::max(1, mx / MX_FUDGE_FACTOR);
-        if (mx < 1)
-            mx = 1;
-        replyTime = rand() % mx;
-        TimerThreadSchedule(&gTimerThread, replyTime, REL_SEC, &job, SHORT_TERM,
-                            NULL);
+        /* Merge repeated and overlapping requests from a control point
+         * into one reply. */
+        now = time(NULL);
+        if (reply_add(handle, maxAge, dest_addr, &event, now, mx, &reply) ==
+            SSDP_REPLY_NEW) {
+            TPJobInit(&job, advertiseAndReplyThread, reply);
+            TPJobSetFreeFunction(&job, free_search_reply);
+            if (TimerThreadSchedule(&gTimerThread,
+                                    (int)(reply->replyTime - now), REL_SEC,
+                                    &job, SHORT_TERM, NULL) != 0)
+                free_search_reply(reply);
+        }
         start = handle;
     }
 }
 
 int DeviceAdvertisement(char* DevType, int RootDev, char* Udn, char* Location,
                         int Duration, int AddressFamily, int PowerState,
-                        int SleepPeriod, int RegistrationState) {
-    struct sockaddr_storage __ss;
-    struct sockaddr_in* DestAddr4 = (struct sockaddr_in*)&__ss;
-    struct sockaddr_in6* DestAddr6 = (struct sockaddr_in6*)&__ss;
+                        int SleepPeriod, int RegistrationState,
+                        const SsdpSendData* a_send) {
+    SsdpSendData send_data;
     /* char Mil_Nt[LINE_SIZE] */
     char Mil_Usn[LINE_SIZE];
     char* msgs[3];
@@ -578,25 +1058,11 @@ int DeviceAdvertisement(char* DevType, int RootDev, char* Udn, char* Location,
     msgs[0] = NULL;
     msgs[1] = NULL;
     msgs[2] = NULL;
-    memset(&__ss, 0, sizeof(__ss));
-    switch (AddressFamily) {
-    case AF_INET:
-        DestAddr4->sin_family = (sa_family_t)AF_INET;
-        inet_pton(AF_INET, SSDP_IP, &DestAddr4->sin_addr);
-        DestAddr4->sin_port = htons(SSDP_PORT);
-        break;
-    case AF_INET6:
-        DestAddr6->sin6_family = (sa_family_t)AF_INET6;
-        inet_pton(AF_INET6,
-                  (isUrlV6UlaGua(Location)) ? SSDP_IPV6_SITELOCAL
-                                            : SSDP_IPV6_LINKLOCAL,
-                  &DestAddr6->sin6_addr);
-        DestAddr6->sin6_port = htons(SSDP_PORT);
-        DestAddr6->sin6_scope_id = gIF_INDEX;
-        break;
-    default:
-        UpnpPrintf(UPNP_CRITICAL, SSDP, __FILE__, __LINE__,
-                   "Invalid device address family.\n");
+    if (a_send == nullptr) {
+        ssdp_prepare_send(&send_data, Location, AddressFamily);
+        a_send = &send_data;
+    }
+    if (a_send->mcast_addr.ss_family == AF_UNSPEC) {
         ret_code = UPNP_E_INVALID_PARAM;
         goto error_handler;
     }
@@ -605,20 +1071,19 @@ int DeviceAdvertisement(char* DevType, int RootDev, char* Udn, char* Location,
         rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::upnp:rootdevice", Udn);
         if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
             goto error_handler;
-        CreateServicePacket(MSGTYPE_ADVERTISEMENT, "upnp:rootdevice", Mil_Usn,
-                            Location, Duration, &msgs[0], AddressFamily,
-                            PowerState, SleepPeriod, RegistrationState);
+        create_packet(a_send, MSGTYPE_ADVERTISEMENT, "upnp:rootdevice", Mil_Usn,
+                      Location, Duration, &msgs[0], PowerState, SleepPeriod,
+                      RegistrationState);
     }
     /* both root and sub-devices need to send these two messages */
-    CreateServicePacket(MSGTYPE_ADVERTISEMENT, Udn, Udn, Location, Duration,
-                        &msgs[1], AddressFamily, PowerState, SleepPeriod,
-                        RegistrationState);
+    create_packet(a_send, MSGTYPE_ADVERTISEMENT, Udn, Udn, Location, Duration,
+                  &msgs[1], PowerState, SleepPeriod, RegistrationState);
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, DevType);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
         goto error_handler;
-    CreateServicePacket(MSGTYPE_ADVERTISEMENT, DevType, Mil_Usn, Location,
-                        Duration, &msgs[2], AddressFamily, PowerState,
-                        SleepPeriod, RegistrationState);
+    create_packet(a_send, MSGTYPE_ADVERTISEMENT, DevType, Mil_Usn, Location,
+                  Duration, &msgs[2], PowerState, SleepPeriod,
+                  RegistrationState);
     /* check error */
     if ((RootDev && msgs[0] == NULL) || msgs[1] == NULL || msgs[2] == NULL) {
         goto error_handler;
@@ -626,11 +1091,15 @@ int DeviceAdvertisement(char* DevType, int RootDev, char* Udn, char* Location,
     /* send packets */
     if (RootDev) {
         /* send 3 msg types */
-        ret_code = NewRequestHandler((struct sockaddr*)&__ss, 3, &msgs[0]);
+        ret_code = NewRequestHandler(
+            (const struct sockaddr*)&a_send->mcast_addr, 3, &msgs[0],
+            a_send->sock);
     } else { /* sub-device */
 
         /* send 2 msg types */
-        ret_code = NewRequestHandler((struct sockaddr*)&__ss, 2, &msgs[1]);
+        ret_code = NewRequestHandler(
+            (const struct sockaddr*)&a_send->mcast_addr, 2, &msgs[1],
+            a_send->sock);
     }
 
 error_handler:
@@ -644,7 +1113,8 @@ error_handler:
 
 int SendReply(struct sockaddr* DestAddr, char* DevType, int RootDev, char* Udn,
               char* Location, int Duration, int ByType, int PowerState,
-              int SleepPeriod, int RegistrationState) {
+              int SleepPeriod, int RegistrationState,
+              const SsdpSendData* a_send) {
     int ret_code = UPNP_E_OUTOF_MEMORY;
     char* msgs[2];
     int num_msgs;
@@ -661,25 +1131,24 @@ int SendReply(struct sockaddr* DestAddr, char* DevType, int RootDev, char* Udn,
         rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::upnp:rootdevice", Udn);
         if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
             goto error_handler;
-        CreateServicePacket(MSGTYPE_REPLY, "upnp:rootdevice", Mil_Usn, Location,
-                            Duration, &msgs[0], (int)DestAddr->sa_family,
-                            PowerState, SleepPeriod, RegistrationState);
+        create_packet(a_send, MSGTYPE_REPLY, "upnp:rootdevice", Mil_Usn,
+                      Location, Duration, &msgs[0], PowerState, SleepPeriod,
+                      RegistrationState);
     } else {
         /* two msgs for embedded devices */
         num_msgs = 1;
 
         /*NK: FIX for extra response when someone searches by udn */
         if (!ByType) {
-            CreateServicePacket(MSGTYPE_REPLY, Udn, Udn, Location, Duration,
-                                &msgs[0], (int)DestAddr->sa_family, PowerState,
-                                SleepPeriod, RegistrationState);
+            create_packet(a_send, MSGTYPE_REPLY, Udn, Udn, Location, Duration,
+                          &msgs[0], PowerState, SleepPeriod, RegistrationState);
         } else {
             rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, DevType);
             if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
                 goto error_handler;
-            CreateServicePacket(MSGTYPE_REPLY, DevType, Mil_Usn, Location,
-                                Duration, &msgs[0], (int)DestAddr->sa_family,
-                                PowerState, SleepPeriod, RegistrationState);
+            create_packet(a_send, MSGTYPE_REPLY, DevType, Mil_Usn, Location,
+                          Duration, &msgs[0], PowerState, SleepPeriod,
+                          RegistrationState);
         }
     }
     /* check error */
@@ -689,7 +1158,7 @@ int SendReply(struct sockaddr* DestAddr, char* DevType, int RootDev, char* Udn,
         }
     }
     /* send msgs */
-    ret_code = NewRequestHandler(DestAddr, num_msgs, msgs);
+    ret_code = NewRequestHandler(DestAddr, num_msgs, msgs, reply_sock(a_send));
 
 error_handler:
     for (i = 0; i < num_msgs; i++) {
@@ -702,7 +1171,8 @@ error_handler:
 
 int DeviceReply(struct sockaddr* DestAddr, char* DevType, int RootDev,
                 char* Udn, char* Location, int Duration, int PowerState,
-                int SleepPeriod, int RegistrationState) {
+                int SleepPeriod, int RegistrationState,
+                const SsdpSendData* a_send) {
     char *szReq[3], Mil_Nt[LINE_SIZE], Mil_Usn[LINE_SIZE];
     int RetVal = UPNP_E_OUTOF_MEMORY;
     int rc = 0;
@@ -718,9 +1188,9 @@ int DeviceReply(struct sockaddr* DestAddr, char* DevType, int RootDev,
         rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::upnp:rootdevice", Udn);
         if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
             goto error_handler;
-        CreateServicePacket(MSGTYPE_REPLY, Mil_Nt, Mil_Usn, Location, Duration,
-                            &szReq[0], (int)DestAddr->sa_family, PowerState,
-                            SleepPeriod, RegistrationState);
+        create_packet(a_send, MSGTYPE_REPLY, Mil_Nt, Mil_Usn, Location,
+                      Duration, &szReq[0], PowerState, SleepPeriod,
+                      RegistrationState);
     }
     rc = snprintf(Mil_Nt, sizeof(Mil_Nt), "%s", Udn);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Nt))
@@ -728,27 +1198,26 @@ int DeviceReply(struct sockaddr* DestAddr, char* DevType, int RootDev,
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s", Udn);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
         goto error_handler;
-    CreateServicePacket(MSGTYPE_REPLY, Mil_Nt, Mil_Usn, Location, Duration,
-                        &szReq[1], (int)DestAddr->sa_family, PowerState,
-                        SleepPeriod, RegistrationState);
+    create_packet(a_send, MSGTYPE_REPLY, Mil_Nt, Mil_Usn, Location, Duration,
+                  &szReq[1], PowerState, SleepPeriod, RegistrationState);
     rc = snprintf(Mil_Nt, sizeof(Mil_Nt), "%s", DevType);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Nt))
         goto error_handler;
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, DevType);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
         goto error_handler;
-    CreateServicePacket(MSGTYPE_REPLY, Mil_Nt, Mil_Usn, Location, Duration,
-                        &szReq[2], (int)DestAddr->sa_family, PowerState,
-                        SleepPeriod, RegistrationState);
+    create_packet(a_send, MSGTYPE_REPLY, Mil_Nt, Mil_Usn, Location, Duration,
+                  &szReq[2], PowerState, SleepPeriod, RegistrationState);
     /* check error */
     if ((RootDev && szReq[0] == NULL) || szReq[1] == NULL || szReq[2] == NULL) {
         goto error_handler;
     }
     /* send replies */
     if (RootDev) {
-        RetVal = NewRequestHandler(DestAddr, 3, szReq);
+        RetVal = NewRequestHandler(DestAddr, 3, szReq, reply_sock(a_send));
     } else {
-        RetVal = NewRequestHandler(DestAddr, 2, &szReq[1]);
+        RetVal =
+            NewRequestHandler(DestAddr, 2, &szReq[1], reply_sock(a_send));
     }
 
 error_handler:
@@ -762,48 +1231,32 @@ error_handler:
 
 int ServiceAdvertisement(char* Udn, char* ServType, char* Location,
                          int Duration, int AddressFamily, int PowerState,
-                         int SleepPeriod, int RegistrationState) {
+                         int SleepPeriod, int RegistrationState,
+                         const SsdpSendData* a_send) {
     char Mil_Usn[LINE_SIZE];
     char* szReq[1];
     int RetVal = UPNP_E_OUTOF_MEMORY;
-    struct sockaddr_storage __ss;
-    struct sockaddr_in* DestAddr4 = (struct sockaddr_in*)&__ss;
-    struct sockaddr_in6* DestAddr6 = (struct sockaddr_in6*)&__ss;
+    SsdpSendData send_data;
     int rc = 0;
 
-    memset(&__ss, 0, sizeof(__ss));
     szReq[0] = NULL;
-    switch (AddressFamily) {
-    case AF_INET:
-        DestAddr4->sin_family = (sa_family_t)AddressFamily;
-        inet_pton(AF_INET, SSDP_IP, &DestAddr4->sin_addr);
-        DestAddr4->sin_port = htons(SSDP_PORT);
-        break;
-    case AF_INET6:
-        DestAddr6->sin6_family = (sa_family_t)AddressFamily;
-        inet_pton(AF_INET6,
-                  (isUrlV6UlaGua(Location)) ? SSDP_IPV6_SITELOCAL
-                                            : SSDP_IPV6_LINKLOCAL,
-                  &DestAddr6->sin6_addr);
-        DestAddr6->sin6_port = htons(SSDP_PORT);
-        DestAddr6->sin6_scope_id = gIF_INDEX;
-        break;
-    default:
-        UpnpPrintf(UPNP_CRITICAL, SSDP, __FILE__, __LINE__,
-                   "Invalid device address family.\n");
+    if (a_send == nullptr) {
+        ssdp_prepare_send(&send_data, Location, AddressFamily);
+        a_send = &send_data;
     }
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, ServType);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
         goto error_handler;
     /* CreateServiceRequestPacket(1,szReq[0],Mil_Nt,Mil_Usn,
      * Server,Location,Duration); */
-    CreateServicePacket(MSGTYPE_ADVERTISEMENT, ServType, Mil_Usn, Location,
-                        Duration, &szReq[0], AddressFamily, PowerState,
-                        SleepPeriod, RegistrationState);
+    create_packet(a_send, MSGTYPE_ADVERTISEMENT, ServType, Mil_Usn, Location,
+                  Duration, &szReq[0], PowerState, SleepPeriod,
+                  RegistrationState);
     if (szReq[0] == NULL) {
         goto error_handler;
     }
-    RetVal = NewRequestHandler((struct sockaddr*)&__ss, 1, szReq);
+    RetVal = NewRequestHandler((const struct sockaddr*)&a_send->mcast_addr, 1,
+                               szReq, a_send->sock);
 
 error_handler:
     free(szReq[0]);
@@ -813,7 +1266,7 @@ error_handler:
 
 int ServiceReply(struct sockaddr* DestAddr, char* ServType, char* Udn,
                  char* Location, int Duration, int PowerState, int SleepPeriod,
-                 int RegistrationState) {
+                 int RegistrationState, const SsdpSendData* a_send) {
     char Mil_Usn[LINE_SIZE];
     char* szReq[1];
     int RetVal = UPNP_E_OUTOF_MEMORY;
@@ -823,12 +1276,11 @@ int ServiceReply(struct sockaddr* DestAddr, char* ServType, char* Udn,
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, ServType);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
         goto error_handler;
-    CreateServicePacket(MSGTYPE_REPLY, ServType, Mil_Usn, Location, Duration,
-                        &szReq[0], (int)DestAddr->sa_family, PowerState,
-                        SleepPeriod, RegistrationState);
+    create_packet(a_send, MSGTYPE_REPLY, ServType, Mil_Usn, Location, Duration,
+                  &szReq[0], PowerState, SleepPeriod, RegistrationState);
     if (szReq[0] == NULL)
         goto error_handler;
-    RetVal = NewRequestHandler(DestAddr, 1, szReq);
+    RetVal = NewRequestHandler(DestAddr, 1, szReq, reply_sock(a_send));
 
 error_handler:
     free(szReq[0]);
@@ -838,35 +1290,17 @@ error_handler:
 
 int ServiceShutdown(char* Udn, char* ServType, char* Location, int Duration,
                     int AddressFamily, int PowerState, int SleepPeriod,
-                    int RegistrationState) {
+                    int RegistrationState, const SsdpSendData* a_send) {
     char Mil_Usn[LINE_SIZE];
     char* szReq[1];
-    struct sockaddr_storage __ss;
-    struct sockaddr_in* DestAddr4 = (struct sockaddr_in*)&__ss;
-    struct sockaddr_in6* DestAddr6 = (struct sockaddr_in6*)&__ss;
+    SsdpSendData send_data;
     int RetVal = UPNP_E_OUTOF_MEMORY;
     int rc = 0;
 
-    memset(&__ss, 0, sizeof(__ss));
     szReq[0] = NULL;
-    switch (AddressFamily) {
-    case AF_INET:
-        DestAddr4->sin_family = (sa_family_t)AddressFamily;
-        inet_pton(AF_INET, SSDP_IP, &DestAddr4->sin_addr);
-        DestAddr4->sin_port = htons(SSDP_PORT);
-        break;
-    case AF_INET6:
-        DestAddr6->sin6_family = (sa_family_t)AddressFamily;
-        inet_pton(AF_INET6,
-                  (isUrlV6UlaGua(Location)) ? SSDP_IPV6_SITELOCAL
-                                            : SSDP_IPV6_LINKLOCAL,
-                  &DestAddr6->sin6_addr);
-        DestAddr6->sin6_port = htons(SSDP_PORT);
-        DestAddr6->sin6_scope_id = gIF_INDEX;
-        break;
-    default:
-        UpnpPrintf(UPNP_CRITICAL, SSDP, __FILE__, __LINE__,
-                   "Invalid device address family.\n");
+    if (a_send == nullptr) {
+        ssdp_prepare_send(&send_data, Location, AddressFamily);
+        a_send = &send_data;
     }
     /* sprintf(Mil_Nt,"%s",ServType); */
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, ServType);
@@ -874,12 +1308,13 @@ int ServiceShutdown(char* Udn, char* ServType, char* Location, int Duration,
         goto error_handler;
     /* CreateServiceRequestPacket(0,szReq[0],Mil_Nt,Mil_Usn,
      * Server,Location,Duration); */
-    CreateServicePacket(MSGTYPE_SHUTDOWN, ServType, Mil_Usn, Location, Duration,
-                        &szReq[0], AddressFamily, PowerState, SleepPeriod,
-                        RegistrationState);
+    create_packet(a_send, MSGTYPE_SHUTDOWN, ServType, Mil_Usn, Location,
+                  Duration, &szReq[0], PowerState, SleepPeriod,
+                  RegistrationState);
     if (szReq[0] == NULL)
         goto error_handler;
-    RetVal = NewRequestHandler((struct sockaddr*)&__ss, 1, szReq);
+    RetVal = NewRequestHandler((const struct sockaddr*)&a_send->mcast_addr, 1,
+                               szReq, a_send->sock);
 
 error_handler:
     free(szReq[0]);
@@ -889,10 +1324,9 @@ error_handler:
 
 int DeviceShutdown(char* DevType, int RootDev, char* Udn, char* Location,
                    int Duration, int AddressFamily, int PowerState,
-                   int SleepPeriod, int RegistrationState) {
-    struct sockaddr_storage __ss;
-    struct sockaddr_in* DestAddr4 = (struct sockaddr_in*)&__ss;
-    struct sockaddr_in6* DestAddr6 = (struct sockaddr_in6*)&__ss;
+                   int SleepPeriod, int RegistrationState,
+                   const SsdpSendData* a_send) {
+    SsdpSendData send_data;
     char* msgs[3];
     char Mil_Usn[LINE_SIZE];
     int ret_code = UPNP_E_OUTOF_MEMORY;
@@ -901,47 +1335,30 @@ int DeviceShutdown(char* DevType, int RootDev, char* Udn, char* Location,
     msgs[0] = NULL;
     msgs[1] = NULL;
     msgs[2] = NULL;
-    memset(&__ss, 0, sizeof(__ss));
-    switch (AddressFamily) {
-    case AF_INET:
-        DestAddr4->sin_family = (sa_family_t)AddressFamily;
-        inet_pton(AF_INET, SSDP_IP, &DestAddr4->sin_addr);
-        DestAddr4->sin_port = htons(SSDP_PORT);
-        break;
-    case AF_INET6:
-        DestAddr6->sin6_family = (sa_family_t)AddressFamily;
-        inet_pton(AF_INET6,
-                  (isUrlV6UlaGua(Location)) ? SSDP_IPV6_SITELOCAL
-                                            : SSDP_IPV6_LINKLOCAL,
-                  &DestAddr6->sin6_addr);
-        DestAddr6->sin6_port = htons(SSDP_PORT);
-        DestAddr6->sin6_scope_id = gIF_INDEX;
-        break;
-    default:
-        UpnpPrintf(UPNP_CRITICAL, SSDP, __FILE__, __LINE__,
-                   "Invalid device address family.\n");
+    if (a_send == nullptr) {
+        ssdp_prepare_send(&send_data, Location, AddressFamily);
+        a_send = &send_data;
     }
     /* root device has one extra msg */
     if (RootDev) {
         rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::upnp:rootdevice", Udn);
         if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
             goto error_handler;
-        CreateServicePacket(MSGTYPE_SHUTDOWN, "upnp:rootdevice", Mil_Usn,
-                            Location, Duration, &msgs[0], AddressFamily,
-                            PowerState, SleepPeriod, RegistrationState);
+        create_packet(a_send, MSGTYPE_SHUTDOWN, "upnp:rootdevice", Mil_Usn,
+                      Location, Duration, &msgs[0], PowerState, SleepPeriod,
+                      RegistrationState);
     }
     UpnpPrintf(UPNP_INFO, SSDP, __FILE__, __LINE__,
                "In function DeviceShutdown\n");
     /* both root and sub-devices need to send these two messages */
-    CreateServicePacket(MSGTYPE_SHUTDOWN, Udn, Udn, Location, Duration,
-                        &msgs[1], AddressFamily, PowerState, SleepPeriod,
-                        RegistrationState);
+    create_packet(a_send, MSGTYPE_SHUTDOWN, Udn, Udn, Location, Duration,
+                  &msgs[1], PowerState, SleepPeriod, RegistrationState);
     rc = snprintf(Mil_Usn, sizeof(Mil_Usn), "%s::%s", Udn, DevType);
     if (rc < 0 || (unsigned int)rc >= sizeof(Mil_Usn))
         goto error_handler;
-    CreateServicePacket(MSGTYPE_SHUTDOWN, DevType, Mil_Usn, Location, Duration,
-                        &msgs[2], AddressFamily, PowerState, SleepPeriod,
-                        RegistrationState);
+    create_packet(a_send, MSGTYPE_SHUTDOWN, DevType, Mil_Usn, Location,
+                  Duration, &msgs[2], PowerState, SleepPeriod,
+                  RegistrationState);
     /* check error */
     if ((RootDev && msgs[0] == NULL) || msgs[1] == NULL || msgs[2] == NULL) {
         goto error_handler;
@@ -949,11 +1366,15 @@ int DeviceShutdown(char* DevType, int RootDev, char* Udn, char* Location,
     /* send packets */
     if (RootDev) {
         /* send 3 msg types */
-        ret_code = NewRequestHandler((struct sockaddr*)&__ss, 3, &msgs[0]);
+        ret_code = NewRequestHandler(
+            (const struct sockaddr*)&a_send->mcast_addr, 3, &msgs[0],
+            a_send->sock);
     } else {
         /* sub-device */
         /* send 2 msg types */
-        ret_code = NewRequestHandler((struct sockaddr*)&__ss, 2, &msgs[1]);
+        ret_code = NewRequestHandler(
+            (const struct sockaddr*)&a_send->mcast_addr, 2, &msgs[1],
+            a_send->sock);
     }
 
 error_handler:
@@ -986,6 +1407,8 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
     const DOMString tmpStr;
     const DOMString dbgStr;
     int NumCopy = 0;
+    SsdpSendData send_data;
+    const SsdpSendData* sdata;
 
     memset(UDNstr, 0, sizeof(UDNstr));
     memset(devType, 0, sizeof(devType));
@@ -1001,6 +1424,22 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
         goto end_function;
     }
     defaultExp = SInfo->MaxAge;
+    // An advertised device has its send data. Otherwise destination, HOST
+    // header and socket are prepared for the messages of this call. Without
+    // a socket each message opens its own one.
+    sdata = SInfo->SsdpSend;
+    if (sdata == nullptr) {
+        ssdp_prepare_send(&send_data, SInfo->DescURL, SInfo->DeviceAf);
+        try {
+            send_data.sockObj = SOCK_DGRAM;
+            send_data.sockObj.bind(nullptr, AI_PASSIVE);
+            send_data.sock = send_data.sockObj;
+        } catch (const std::exception& ex) {
+            UPnPsdk_LOGCATCH("MSG1197") "catched next line...\n"
+                << ex.what();
+        }
+        sdata = &send_data;
+    }
     /* parse the device list and send advertisements/replies */
     while (NumCopy == 0 || (AdFlag && NumCopy < NUM_SSDP_COPY)) {
         if (NumCopy != 0)
@@ -1085,26 +1524,28 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                     DeviceAdvertisement(devType, i == 0lu, UDNstr,
                                         SInfo->DescURL, Exp, SInfo->DeviceAf,
                                         SInfo->PowerState, SInfo->SleepPeriod,
-                                        SInfo->RegistrationState);
+                                        SInfo->RegistrationState, sdata);
                 } else {
                     /* AdFlag == -1 */
                     DeviceShutdown(devType, i == 0lu, UDNstr, SInfo->DescURL,
                                    Exp, SInfo->DeviceAf, SInfo->PowerState,
                                    SInfo->SleepPeriod,
-                                   SInfo->RegistrationState);
+                                   SInfo->RegistrationState, sdata);
                 }
             } else {
                 switch (SearchType) {
                 case SSDP_ALL:
                     DeviceReply(DestAddr, devType, i == 0lu, UDNstr,
                                 SInfo->DescURL, defaultExp, SInfo->PowerState,
-                                SInfo->SleepPeriod, SInfo->RegistrationState);
+                                SInfo->SleepPeriod, SInfo->RegistrationState,
+                                sdata);
                     break;
                 case SSDP_ROOTDEVICE:
                     if (i == 0lu) {
                         SendReply(DestAddr, devType, 1, UDNstr, SInfo->DescURL,
                                   defaultExp, 0, SInfo->PowerState,
-                                  SInfo->SleepPeriod, SInfo->RegistrationState);
+                                  SInfo->SleepPeriod, SInfo->RegistrationState,
+                                  sdata);
                     }
                     break;
                 case SSDP_DEVICEUDN: {
@@ -1121,7 +1562,7 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                             SendReply(DestAddr, devType, 0, UDNstr, SInfo->DescURL, defaultExp, 0,
                                 SInfo->PowerState,
                                 SInfo->SleepPeriod,
-                                SInfo->RegistrationState);
+                                SInfo->RegistrationState, sdata);
                         }
                     }
                     /* clang-format on */
@@ -1142,7 +1583,7 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                                   defaultExp, 1,
                                   SInfo->PowerState,
                                   SInfo->SleepPeriod,
-                                  SInfo->RegistrationState);
+                                  SInfo->RegistrationState, sdata);
                         } else if (atoi(strrchr(DeviceType, ':') + 1)
                                == atoi(&devType[strlen(devType) - (size_t)1])) {
                             UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
@@ -1152,7 +1593,7 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                                   defaultExp, 1,
                                   SInfo->PowerState,
                                   SInfo->SleepPeriod,
-                                  SInfo->RegistrationState);
+                                  SInfo->RegistrationState, sdata);
                         } else {
                             UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
                                    "DeviceType=%s and search devType=%s DID NOT MATCH\n",
@@ -1230,13 +1671,14 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                         ServiceAdvertisement(
                             UDNstr, servType, SInfo->DescURL, Exp,
                             SInfo->DeviceAf, SInfo->PowerState,
-                            SInfo->SleepPeriod, SInfo->RegistrationState);
+                            SInfo->SleepPeriod, SInfo->RegistrationState,
+                            sdata);
                     } else {
                         /* AdFlag == -1 */
                         ServiceShutdown(UDNstr, servType, SInfo->DescURL, Exp,
                                         SInfo->DeviceAf, SInfo->PowerState,
                                         SInfo->SleepPeriod,
-                                        SInfo->RegistrationState);
+                                        SInfo->RegistrationState, sdata);
                     }
                 } else {
                     switch (SearchType) {
@@ -1244,7 +1686,7 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                         ServiceReply(DestAddr, servType, UDNstr, SInfo->DescURL,
                                      defaultExp, SInfo->PowerState,
                                      SInfo->SleepPeriod,
-                                     SInfo->RegistrationState);
+                                     SInfo->RegistrationState, sdata);
                         break;
                     case SSDP_SERVICE:
                         /* clang-format off */
@@ -1262,7 +1704,7 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                                           defaultExp, 1,
                                           SInfo->PowerState,
                                           SInfo->SleepPeriod,
-                                          SInfo->RegistrationState);
+                                          SInfo->RegistrationState, sdata);
                                 } else if (atoi(strrchr (ServiceType, ':') + 1) ==
                                        atoi(&servType[strlen(servType) - (size_t)1])) {
                                     UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
@@ -1272,7 +1714,7 @@ int AdvertiseAndReply(int AdFlag, UpnpDevice_Handle Hnd,
                                           defaultExp, 1,
                                           SInfo->PowerState,
                                           SInfo->SleepPeriod,
-                                          SInfo->RegistrationState);
+                                          SInfo->RegistrationState, sdata);
                                 } else {
                                     UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
                                        "ServiceType=%s and search servType=%s DID NOT MATCH\n",
@@ -1311,8 +1753,13 @@ end_function:
 void advertiseAndReplyThread(void* data) {
     SsdpSearchReply* arg = (SsdpSearchReply*)data;
 
-    AdvertiseAndReply(0, arg->handle, arg->event.RequestType,
-                      (struct sockaddr*)&arg->dest_addr, arg->event.DeviceType,
-                      arg->event.UDN, arg->event.ServiceType, arg->MaxAge);
+    /* Requests arriving from now on get a new reply. */
+    reply_unlink(arg);
+    for (int i = 0; i < arg->numTargets; i++) {
+        SsdpSearchTarget* target = &arg->target[i];
+        AdvertiseAndReply(0, arg->handle, target->RequestType,
+                          (struct sockaddr*)&arg->dest_addr, target->DeviceType,
+                          target->UDN, target->ServiceType, arg->MaxAge);
+    }
     free(arg);
 }
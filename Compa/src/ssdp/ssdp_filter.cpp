@@ -0,0 +1,178 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup compa-Discovery
+ * \brief Drops SSDP messages that cannot be of interest before they are
+ * parsed (for internal use only).
+ */
+
+#include <ssdp_filter.hpp>
+#include <upnpapi.hpp>
+
+/// \cond
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+/// \endcond
+
+namespace {
+
+/// \brief Targets of interest, compiled from the handle table.
+struct SsdpFilter {
+    /// \brief UDNs of all registered devices and their embedded devices.
+    std::vector<std::string> udns;
+    /// \brief Device and service types up to the version number.
+    std::vector<std::string> types;
+};
+
+/// \brief Number of registered control points. It is read without the mutex.
+std::atomic<int> gSsdpFilterCtrlpts{0};
+/// \brief Number of registered devices. It is read without the mutex.
+std::atomic<int> gSsdpFilterDevices{0};
+/// \brief Mutex to protect the filter.
+pthread_mutex_t gSsdpFilterMutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief The filter that is used by ssdp_filter_accept().
+SsdpFilter gSsdpFilter;
+
+/*!
+ * \brief Returns the length of a device or service type without its version
+ * number, but with the colon in front of it.
+ */
+size_t type_length(const char* a_type, size_t a_len) {
+    size_t len{a_len};
+    while (len > 0 && a_type[len - 1] != ':')
+        len--;
+    return len;
+}
+
+/// \brief Adds the text of all elements with a tag name to a list.
+void add_elements(IXML_Document* a_doc, const char* a_tag, bool a_type,
+                  std::vector<std::string>& a_list) {
+    IXML_NodeList* nodeList = ixmlDocument_getElementsByTagName(a_doc, a_tag);
+    const unsigned long count{ixmlNodeList_length(nodeList)};
+    for (unsigned long i{0}; i < count; i++) {
+        IXML_Node* textNode =
+            ixmlNode_getFirstChild(ixmlNodeList_item(nodeList, i));
+        const char* text = ixmlNode_getNodeValue(textNode);
+        if (text == nullptr)
+            continue;
+        size_t len{strlen(text)};
+        if (a_type)
+            len = type_length(text, len);
+        if (len > 0)
+            a_list.emplace_back(text, len);
+    }
+    ixmlNodeList_free(nodeList);
+}
+
+/*!
+ * \brief Returns the value of the ST header.
+ *
+ * \returns Pointer to the value, or nullptr if there is no ST header.
+ */
+const char* find_st(const char* a_msg, size_t a_len, size_t* a_st_len) {
+    const char* end{a_msg + a_len};
+    const char* line = static_cast<const char*>(memchr(a_msg, '\n', a_len));
+    while (line != nullptr && ++line < end) {
+        const char* eol = static_cast<const char*>(
+            memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (eol == nullptr)
+            eol = end;
+        if (eol - line >= 3 && strncasecmp(line, "ST:", 3) == 0) {
+            const char* value{line + 3};
+            while (value < eol && (*value == ' ' || *value == '\t'))
+                value++;
+            const char* value_end{eol};
+            while (value_end > value &&
+                   (value_end[-1] == '\r' || value_end[-1] == ' ' ||
+                    value_end[-1] == '\t'))
+                value_end--;
+            *a_st_len = static_cast<size_t>(value_end - value);
+            return value;
+        }
+        line = eol;
+    }
+    return nullptr;
+}
+
+/// \brief Checks if a string is in a list, ignoring case.
+bool contains(const std::vector<std::string>& a_list, const char* a_str,
+              size_t a_len) {
+    for (const std::string& entry : a_list) {
+        if (entry.size() == a_len &&
+            strncasecmp(entry.c_str(), a_str, a_len) == 0)
+            return true;
+    }
+    return false;
+}
+
+/// \brief Checks if a search target may match a registered device.
+bool accept_search_target(const SsdpFilter& a_filter, const char* a_st,
+                          size_t a_len) {
+    if ((a_len == 8 && strncasecmp(a_st, "ssdp:all", 8) == 0) ||
+        (a_len == 15 && strncasecmp(a_st, "upnp:rootdevice", 15) == 0))
+        return true;
+    if (a_len > 5 && strncasecmp(a_st, "uuid:", 5) == 0)
+        return contains(a_filter.udns, a_st, a_len);
+    if (a_len > 4 && strncasecmp(a_st, "urn:", 4) == 0)
+        return contains(a_filter.types, a_st, type_length(a_st, a_len));
+    return false;
+}
+
+} // anonymous namespace
+
+
+void ssdp_filter_update() {
+    SsdpFilter filter{};
+    int ctrlpts{0};
+    int devices{0};
+    Handle_Info* info;
+
+    for (int hnd{1}; hnd < NUM_HANDLE; hnd++) {
+        switch (GetHandleInfo(hnd, &info)) {
+        case HND_CLIENT:
+            ctrlpts++;
+            break;
+        case HND_DEVICE:
+            devices++;
+            if (info->DescDocument == nullptr)
+                break;
+            add_elements(info->DescDocument, "UDN", false, filter.udns);
+            add_elements(info->DescDocument, "deviceType", true, filter.types);
+            add_elements(info->DescDocument, "serviceType", true,
+                         filter.types);
+            break;
+        default:
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&gSsdpFilterMutex);
+    gSsdpFilter = std::move(filter);
+    pthread_mutex_unlock(&gSsdpFilterMutex);
+    gSsdpFilterCtrlpts.store(ctrlpts, std::memory_order_relaxed);
+    gSsdpFilterDevices.store(devices, std::memory_order_relaxed);
+}
+
+bool ssdp_filter_accept(const char* a_msg, size_t a_len) {
+    bool accept{false};
+
+    if (strncmp(a_msg, "NOTIFY ", 7) == 0 || strncmp(a_msg, "HTTP/", 5) == 0) {
+        /* Advertisements and search responses go to control points. */
+        accept = gSsdpFilterCtrlpts.load(std::memory_order_relaxed) > 0;
+    } else if (strncmp(a_msg, "M-SEARCH ", 9) == 0 &&
+               gSsdpFilterDevices.load(std::memory_order_relaxed) > 0) {
+        /* Only search requests to a device need the target lists. */
+        size_t st_len{};
+        const char* st = find_st(a_msg, a_len, &st_len);
+        if (st != nullptr) {
+            pthread_mutex_lock(&gSsdpFilterMutex);
+            accept = accept_search_target(gSsdpFilter, st, st_len);
+            pthread_mutex_unlock(&gSsdpFilterMutex);
+        }
+    }
+
+    return accept;
+}
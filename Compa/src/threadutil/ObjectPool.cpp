@@ -0,0 +1,225 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup threadutil
+ * \brief Thread caching pool for small fixed size objects (for internal use
+ * only).
+ */
+
+#include <ObjectPool.hpp>
+#include <UPnPsdk/pthread.hpp>
+#include <umock/stdlib.hpp>
+
+/// \cond
+#include <bit>
+#include <cstring>
+/// \endcond
+
+namespace {
+
+/// \brief Size of the smallest size class.
+constexpr size_t POOL_MIN_OBJECT_SIZE{64};
+/// \brief Number of size classes, each twice the size of the previous one.
+constexpr int POOL_CLASSES{6};
+static_assert((POOL_MIN_OBJECT_SIZE << (POOL_CLASSES - 1)) ==
+              POOL_MAX_OBJECT_SIZE);
+
+/// \brief Magazine of a thread.
+struct Magazine {
+    int rounds; ///< Number of cached objects.
+    void* round[POOL_MAGAZINE_SIZE]; ///< Cached objects.
+};
+
+/// \brief Magazine of the depot, always full if it is on the full list.
+struct DepotMagazine {
+    DepotMagazine* next; ///< Next magazine on the list.
+    void* round[POOL_MAGAZINE_SIZE]; ///< Cached objects.
+};
+
+/// \brief Depot of one size class.
+struct Depot {
+    DepotMagazine* full;  ///< List of full magazines.
+    DepotMagazine* empty; ///< List of empty magazines for reuse.
+    int fullCount;        ///< Number of magazines on the full list.
+};
+
+/// \brief Mutex to protect the depots.
+pthread_mutex_t g_depot_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// \brief Depots of all size classes.
+Depot g_depot[POOL_CLASSES];
+
+/// \brief Returns the size class of an object size.
+inline int size_class(size_t a_size) {
+    if (a_size <= POOL_MIN_OBJECT_SIZE)
+        return 0;
+    return static_cast<int>(
+        std::bit_width((a_size - 1) / POOL_MIN_OBJECT_SIZE));
+}
+
+/// \brief Returns all objects of a magazine to the operating system.
+void free_rounds(Magazine& a_mag) {
+    for (int i{0}; i < a_mag.rounds; i++)
+        umock::stdlib_h.free(a_mag.round[i]);
+    a_mag.rounds = 0;
+}
+
+/*!
+ * \brief Gives the objects of a full magazine to the depot.
+ *
+ * \returns **true** if the magazine is empty now, **false** if the depot is
+ * full.
+ */
+bool depot_put(int a_cls, Magazine& a_mag) {
+    Depot& depot{g_depot[a_cls]};
+    DepotMagazine* dmag{nullptr};
+
+    pthread_mutex_lock(&g_depot_mutex);
+    if (depot.fullCount < POOL_DEPOT_SIZE) {
+        dmag = depot.empty;
+        if (dmag != nullptr)
+            depot.empty = dmag->next;
+        else
+            dmag = static_cast<DepotMagazine*>(
+                umock::stdlib_h.malloc(sizeof(DepotMagazine)));
+    }
+    if (dmag != nullptr) {
+        memcpy(dmag->round, a_mag.round, sizeof(dmag->round));
+        dmag->next = depot.full;
+        depot.full = dmag;
+        depot.fullCount++;
+        a_mag.rounds = 0;
+    }
+    pthread_mutex_unlock(&g_depot_mutex);
+
+    return dmag != nullptr;
+}
+
+/*!
+ * \brief Fills an empty magazine with the objects of a full magazine from the
+ * depot.
+ *
+ * \returns **true** if the magazine is full now, **false** if the depot is
+ * empty.
+ */
+bool depot_get(int a_cls, Magazine& a_mag) {
+    Depot& depot{g_depot[a_cls]};
+
+    pthread_mutex_lock(&g_depot_mutex);
+    DepotMagazine* dmag{depot.full};
+    if (dmag != nullptr) {
+        depot.full = dmag->next;
+        depot.fullCount--;
+        memcpy(a_mag.round, dmag->round, sizeof(a_mag.round));
+        a_mag.rounds = POOL_MAGAZINE_SIZE;
+        dmag->next = depot.empty;
+        depot.empty = dmag;
+    }
+    pthread_mutex_unlock(&g_depot_mutex);
+
+    return dmag != nullptr;
+}
+
+/*!
+ * \brief Magazines of a thread.
+ *
+ * Each size class has two magazines. The loaded one is used for allocating
+ * and freeing, the previous one is always empty or full.
+ */
+struct ThreadCache {
+    /// \brief The two magazines of each size class.
+    Magazine mag[2][POOL_CLASSES];
+    /// \brief Index of the loaded magazine of each size class.
+    unsigned char loaded[POOL_CLASSES];
+
+    /// \brief Returns the loaded magazine of a size class.
+    Magazine& loaded_mag(int a_cls) { return mag[loaded[a_cls]][a_cls]; }
+    /// \brief Returns the previous magazine of a size class.
+    Magazine& previous_mag(int a_cls) { return mag[loaded[a_cls] ^ 1][a_cls]; }
+
+    /// \brief Gives full magazines to the depot and frees the other objects
+    /// when the thread finishes.
+    ~ThreadCache() {
+        for (int cls{0}; cls < POOL_CLASSES; cls++) {
+            for (int i{0}; i < 2; i++) {
+                Magazine& magazine{mag[i][cls]};
+                if (magazine.rounds != POOL_MAGAZINE_SIZE ||
+                    !depot_put(cls, magazine))
+                    free_rounds(magazine);
+            }
+        }
+    }
+};
+
+/// \brief Magazines of the current thread.
+thread_local ThreadCache tl_cache;
+
+} // anonymous namespace
+
+
+void* ObjectPoolAlloc(size_t a_size) {
+    if (a_size > POOL_MAX_OBJECT_SIZE)
+        return umock::stdlib_h.malloc(a_size);
+
+    const int cls{size_class(a_size)};
+    ThreadCache& cache{tl_cache};
+    Magazine* loaded{&cache.loaded_mag(cls)};
+    if (loaded->rounds == 0) {
+        if (cache.previous_mag(cls).rounds > 0) {
+            cache.loaded[cls] ^= 1;
+            loaded = &cache.loaded_mag(cls);
+        } else if (!depot_get(cls, *loaded)) {
+            return umock::stdlib_h.malloc(POOL_MIN_OBJECT_SIZE << cls);
+        }
+    }
+
+    return loaded->round[--loaded->rounds];
+}
+
+void ObjectPoolFree(void* a_obj, size_t a_size) {
+    if (a_obj == nullptr)
+        return;
+    if (a_size > POOL_MAX_OBJECT_SIZE) {
+        umock::stdlib_h.free(a_obj);
+        return;
+    }
+
+    const int cls{size_class(a_size)};
+    ThreadCache& cache{tl_cache};
+    Magazine* loaded{&cache.loaded_mag(cls)};
+    if (loaded->rounds == POOL_MAGAZINE_SIZE) {
+        Magazine& previous{cache.previous_mag(cls)};
+        if (previous.rounds == POOL_MAGAZINE_SIZE &&
+            !depot_put(cls, previous))
+            free_rounds(previous);
+        cache.loaded[cls] ^= 1;
+        loaded = &previous;
+    }
+    loaded->round[loaded->rounds++] = a_obj;
+}
+
+void ObjectPoolTrim() {
+    ThreadCache& cache{tl_cache};
+    for (int cls{0}; cls < POOL_CLASSES; cls++) {
+        free_rounds(cache.mag[0][cls]);
+        free_rounds(cache.mag[1][cls]);
+    }
+
+    pthread_mutex_lock(&g_depot_mutex);
+    for (Depot& depot : g_depot) {
+        while (depot.full != nullptr) {
+            DepotMagazine* dmag{depot.full};
+            depot.full = dmag->next;
+            for (void* obj : dmag->round)
+                umock::stdlib_h.free(obj);
+            umock::stdlib_h.free(dmag);
+        }
+        while (depot.empty != nullptr) {
+            DepotMagazine* dmag{depot.empty};
+            depot.empty = dmag->next;
+            umock::stdlib_h.free(dmag);
+        }
+        depot.fullCount = 0;
+    }
+    pthread_mutex_unlock(&g_depot_mutex);
+}
@@ -0,0 +1,71 @@
+#ifndef COMPA_OBJECT_POOL_HPP
+#define COMPA_OBJECT_POOL_HPP
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+/*!
+ * \file
+ * \ingroup threadutil
+ * \brief Thread caching pool for small fixed size objects (for internal use
+ * only).
+ *
+ * Objects are grouped into size classes. Every thread caches freed objects of
+ * each size class in two magazines of POOL_MAGAZINE_SIZE objects, so that
+ * allocating and freeing normally neither locks nor calls the operating
+ * system. Only if both magazines of a thread are full or empty a whole
+ * magazine is exchanged with a global depot under a mutex. This way objects
+ * that are allocated by one thread and freed by another, like thread pool
+ * jobs, flow back to the allocating thread in bunches.
+ *
+ * Because this is for internal use, parameters are NOT checked for validity.
+ * The caller must ensure valid parameters.
+ */
+
+/// \cond
+#include <cstddef>
+/// \endcond
+
+/// \brief Number of objects in a magazine.
+constexpr int POOL_MAGAZINE_SIZE{32};
+/// \brief Maximal number of full magazines kept by the depot per size class.
+constexpr int POOL_DEPOT_SIZE{16};
+/*! \brief Size of the largest size class. Larger objects are allocated from
+ * the operating system. */
+constexpr size_t POOL_MAX_OBJECT_SIZE{2048};
+
+/*!
+ * \brief Allocates an object.
+ *
+ * The object is taken from the magazines of the current thread, from the
+ * depot or from the operating system, in this order.
+ *
+ * \returns
+ *  On success: Pointer to the uninitialized object\n
+ *  On error: nullptr
+ */
+void* ObjectPoolAlloc(
+    /*! [in] Size of the object. */
+    size_t a_size);
+
+/*!
+ * \brief Returns an object to the pool.
+ *
+ * The object is put to the magazines of the current thread. If they are full,
+ * one of them is given to the depot. If the depot is also full, the objects
+ * of the magazine are returned to the operating system.
+ */
+void ObjectPoolFree(
+    /*! [in] Object allocated with ObjectPoolAlloc(), may be nullptr. */
+    void* a_obj,
+    /*! [in] Size of the object, the same as given on allocation. */
+    size_t a_size);
+
+/*!
+ * \brief Returns all objects from the depot and from the magazines of the
+ * current thread to the operating system.
+ *
+ * Objects in the magazines of other threads are returned when these threads
+ * finish.
+ */
+void ObjectPoolTrim();
+
+#endif /* COMPA_OBJECT_POOL_HPP */
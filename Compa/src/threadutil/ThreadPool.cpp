@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-05-01
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -42,6 +42,8 @@
  */
 
 #include <ThreadPool.hpp>
+#include <ObjectPool.hpp>
+#include <metrics.hpp>
 
 #include <UPnPsdk/synclog.hpp>
 
@@ -52,8 +54,6 @@
 #include <cstring> /* for memset()*/
 /// \endcond
 
-/*! Size of job free list. */
-constexpr int JOBFREELISTSIZE{100};
 /*! Infinite threads. */
 constexpr int INFINITE_THREADS{-1};
 /*! Error: maximun threads. */
@@ -67,25 +67,6 @@ namespace {
  * @{
  */
 
-/*!
- * \brief Returns the difference in milliseconds between two timeval structures.
- *
- * \returns The difference in milliseconds, time1-time2.
- */
-long DiffMillis(timeval* time1, timeval* time2) {
-    double temp = 0.0;
-
-    temp = static_cast<double>(time1->tv_sec - time2->tv_sec);
-    /* convert to milliseconds */
-    temp *= 1000.0;
-
-    /* convert microseconds to milliseconds and add to temp */
-    /* implicit flooring of unsigned long data type */
-    temp += static_cast<double>(time1->tv_usec - time2->tv_usec) / 1000.0;
-
-    return static_cast<long>(temp);
-}
-
 #if defined(STATS) || defined(DOXYGEN_RUN)
 /*!
  * \brief Initializes the statistics structure.
@@ -93,96 +74,83 @@ long DiffMillis(timeval* time1, timeval* time2) {
 void StatsInit(
     /*! Valid non null stats structure. */
     ThreadPoolStats* stats) {
-    stats->totalIdleTime = 0.0;
-    stats->totalJobsHQ = 0;
-    stats->totalJobsLQ = 0;
-    stats->totalJobsMQ = 0;
-    stats->totalTimeHQ = 0.0;
-    stats->totalTimeMQ = 0.0;
-    stats->totalTimeLQ = 0.0;
-    stats->totalWorkTime = 0.0;
-    stats->totalIdleTime = 0.0;
-    stats->avgWaitHQ = 0.0;
-    stats->avgWaitMQ = 0.0;
-    stats->avgWaitLQ = 0.0;
-    stats->workerThreads = 0;
-    stats->idleThreads = 0;
-    stats->persistentThreads = 0;
-    stats->maxThreads = 0;
-    stats->totalThreads = 0;
+    memset(stats, 0, sizeof(*stats));
 }
 
 /*!
- * \brief StatsAccountLQ
+ * \brief Adds to a counter of the current worker.
+ *
+ * Only the worker that owns the counter writes to it. So a relaxed load and
+ * store is enough and there is no need for a locked read-modify-write.
  */
-void StatsAccountLQ(
-    /*! [in] Valid, non null, pointer to ThreadPool. */
-    ThreadPool* tp,
-    /*! . */
-    long diffTime) {
-    tp->stats.totalJobsLQ++;
-    tp->stats.totalTimeLQ += static_cast<double>(diffTime);
+inline void StatsAdd(
+    /*! [in,out] Counter of the current worker. */
+    std::atomic<uint64_t>& counter,
+    /*! [in] Value to add. */
+    uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
 }
 
 /*!
- * \brief StatsAccountMQ
+ * \brief Accounts the time of a job to the counters of the current worker.
  */
-void StatsAccountMQ(
-    /*! [in] Valid, non null, pointer to ThreadPool. */
-    ThreadPool* tp,
-    /*! . */
-    long diffTime) {
-    tp->stats.totalJobsMQ++;
-    tp->stats.totalTimeMQ += static_cast<double>(diffTime);
+void StatsAccount(
+    /*! [in,out] Counters of the current worker. */
+    ThreadPoolWorkerStats::Times& times,
+    /*! [in] Time in nanoseconds. */
+    uint64_t ns) {
+    StatsAdd(times.jobs, 1);
+    StatsAdd(times.sum_ns, ns);
+    StatsAdd(times.bucket[compa::metrics_bucket(ns)], 1);
 }
 
 /*!
- * \brief StatsAccountHQ
+ * \brief Adds the counters of a worker to a statistics structure.
+ *
+ * The worker may still be running. tp->mutex must be locked.
  */
-void StatsAccountHQ(
-    /*! [in] Valid, non null, pointer to ThreadPool. */
-    ThreadPool* tp,
-    /*! . */
-    long diffTime) {
-    tp->stats.totalJobsHQ++;
-    tp->stats.totalTimeHQ += static_cast<double>(diffTime);
+void StatsCollect(
+    /*! [in,out] Statistics to add to. */
+    ThreadPoolStats* stats,
+    /*! [in] Counters of a worker. */
+    const ThreadPoolWorkerStats* worker) {
+    const auto add = [](ThreadPoolTimes& to,
+                        const ThreadPoolWorkerStats::Times& from) {
+        to.jobs += from.jobs.load(std::memory_order_relaxed);
+        to.sum_ns += from.sum_ns.load(std::memory_order_relaxed);
+        for (int i{0}; i < UPNP_METRICS_BUCKETS; i++)
+            to.bucket[i] += from.bucket[i].load(std::memory_order_relaxed);
+    };
+    for (int p{0}; p < TP_PRIORITIES; p++) {
+        add(stats->waitTime[p], worker->wait[p]);
+        add(stats->runTime[p], worker->run[p]);
+    }
+    stats->totalWorkTime +=
+        static_cast<double>(worker->workTime.load(std::memory_order_relaxed)) /
+        1e9;
+    stats->totalIdleTime +=
+        static_cast<double>(worker->idleTime.load(std::memory_order_relaxed)) /
+        1e9;
 }
 
 /*!
- * \brief Calculates the time the job has been waiting at the specified
- * priority.
+ * \brief Removes the counters of an exiting worker from the thread pool and
+ * keeps its values in the statistics of the thread pool.
  *
- * Adds to the totalTime and totalJobs kept in the thread pool statistics
- * structure.
+ * tp->mutex must be locked.
  */
-void CalcWaitTime(
+void StatsRetireWorker(
     /*! [in] Valid, non null, pointer to ThreadPool. */
     ThreadPool* tp,
-    /*! [in] Thread priority. */
-    ThreadPriority p,
-    /*! [in] Valid thread pool job. */
-    ThreadPoolJob* job) {
-    struct timeval now;
-    long diff;
-
-    assert(tp != NULL);
-    assert(job != NULL);
-
-    gettimeofday(&now, NULL);
-    diff = DiffMillis(&now, &job->requestTime);
-    switch (p) {
-    case LOW_PRIORITY:
-        StatsAccountLQ(tp, diff);
-        break;
-    case MED_PRIORITY:
-        StatsAccountMQ(tp, diff);
-        break;
-    case HIGH_PRIORITY:
-        StatsAccountHQ(tp, diff);
-        break;
-    default:
-        assert(0);
-    }
+    /*! [in] Counters of the exiting worker. */
+    ThreadPoolWorkerStats* worker) {
+    ThreadPoolWorkerStats** link{&tp->workerStats};
+    while (*link && *link != worker)
+        link = &(*link)->next;
+    if (*link)
+        *link = worker->next;
+    StatsCollect(&tp->stats, worker);
 }
 
 /*!
@@ -201,10 +169,9 @@ time_t StatsTime(
 }
 #else  /* STATS */
 inline void StatsInit(ThreadPoolStats* stats) {}
-inline void StatsAccountLQ(ThreadPool* tp, long diffTime) {}
-inline void StatsAccountMQ(ThreadPool* tp, long diffTime) {}
-inline void StatsAccountHQ(ThreadPool* tp, long diffTime) {}
-inline void CalcWaitTime(ThreadPool* tp, ThreadPriority p, ThreadPoolJob* job) {
+inline void StatsAdd(std::atomic<uint64_t>& counter, uint64_t value) {}
+inline void StatsAccount(ThreadPoolWorkerStats::Times& times, uint64_t ns) {}
+inline void StatsRetireWorker(ThreadPool* tp, ThreadPoolWorkerStats* worker) {
 }
 inline time_t StatsTime(time_t* t) { return 0; }
 #endif /* STATS */
@@ -224,10 +191,10 @@ int CmpThreadPoolJob(void* jobA, void* jobB) {
  */
 void FreeThreadPoolJob(
     /*! [in] Valid, non null, pointer to ThreadPool. */
-    ThreadPool* tp,
+    [[maybe_unused]] ThreadPool* tp,
     /*! [in] Must be allocated with CreateThreadPoolJob. */
     ThreadPoolJob* tpj) {
-    FreeListFree(&tp->jobFreeList, tpj);
+    ObjectPoolFree(tpj, sizeof(ThreadPoolJob));
 }
 
 /*!
@@ -328,19 +295,18 @@ void BumpPriority(
     /*! [in] Valid, non null, pointer to ThreadPool. */
     ThreadPool* tp) {
     int done = 0;
-    struct timeval now;
+    const uint64_t now{compa::metrics_now()};
     long diffTime = 0;
     ThreadPoolJob* tempJob = NULL;
 
-    gettimeofday(&now, NULL);
     while (!done) {
         if (tp->medJobQ.size) {
             tempJob = (ThreadPoolJob*)tp->medJobQ.head.next->item;
-            diffTime = DiffMillis(&now, &tempJob->requestTime);
+            diffTime =
+                static_cast<long>((now - tempJob->requestTime) / 1000000);
             if (diffTime >= tp->attr.starvationTime) {
                 /* If job has waited longer than the starvation time, bump
                  * priority (add to higher priority Q) */
-                StatsAccountMQ(tp, diffTime);
                 ListDelNode(&tp->medJobQ, tp->medJobQ.head.next, 0);
                 ListAddTail(&tp->highJobQ, tempJob);
                 continue;
@@ -348,11 +314,11 @@ void BumpPriority(
         }
         if (tp->lowJobQ.size) {
             tempJob = (ThreadPoolJob*)tp->lowJobQ.head.next->item;
-            diffTime = DiffMillis(&now, &tempJob->requestTime);
+            diffTime =
+                static_cast<long>((now - tempJob->requestTime) / 1000000);
             if (diffTime >= tp->attr.maxIdleTime) {
                 /* If job has waited longer than the starvation time, bump
                  * priority (add to higher priority Q) */
-                StatsAccountLQ(tp, diffTime);
                 ListDelNode(&tp->lowJobQ, tp->lowJobQ.head.next, 0);
                 ListAddTail(&tp->medJobQ, tempJob);
                 continue;
@@ -413,6 +379,60 @@ void SetSeed(void) {
 #endif
 }
 
+/*!
+ * \brief Returns true if the adaptive sizing is enabled and the jobs wait
+ * longer than a part of the target waiting time.
+ */
+bool WaitTimeAbove(
+    /*! [in] Valid, non null, pointer to ThreadPool. */
+    ThreadPool* tp,
+    /*! [in] Divisor of the target waiting time. */
+    int divisor) {
+    return tp->attr.targetWaitTime > 0 &&
+           tp->avgWaitTime.load(std::memory_order_relaxed) >
+               static_cast<uint64_t>(tp->attr.targetWaitTime) * 1000000 /
+                   static_cast<uint64_t>(divisor);
+}
+
+/*!
+ * \brief Returns the time in nanoseconds the oldest job is waiting in the
+ * queues.
+ *
+ * tp->mutex must be locked.
+ */
+uint64_t OldestWaitTime(
+    /*! [in] Valid, non null, pointer to ThreadPool. */
+    ThreadPool* tp) {
+    const uint64_t now{compa::metrics_now()};
+    uint64_t oldest{0};
+    for (LinkedList* queue : {&tp->highJobQ, &tp->medJobQ, &tp->lowJobQ}) {
+        if (queue->size == 0)
+            continue;
+        const ThreadPoolJob* job{
+            static_cast<ThreadPoolJob*>(queue->head.next->item)};
+        if (now - job->requestTime > oldest)
+            oldest = now - job->requestTime;
+    }
+    return oldest;
+}
+
+/*!
+ * \brief Adds the waiting time of a job to the moving average of the thread
+ * pool.
+ *
+ * Workers may update it concurrently without locking. A lost update only
+ * delays the average a bit.
+ */
+void UpdateAvgWaitTime(
+    /*! [in] Valid, non null, pointer to ThreadPool. */
+    ThreadPool* tp,
+    /*! [in] Waiting time in nanoseconds. */
+    uint64_t waitTime) {
+    const uint64_t avg{tp->avgWaitTime.load(std::memory_order_relaxed)};
+    tp->avgWaitTime.store(avg - avg / 8 + waitTime / 8,
+                          std::memory_order_relaxed);
+}
+
 /*!
  * \brief Implements a thread pool worker.
  *
@@ -423,9 +443,15 @@ void SetSeed(void) {
 void* WorkerThread(
     /*! arg -> is cast to (ThreadPool *). */
     void* arg) {
-    time_t start = 0;
+    /* Times in nanoseconds, measured outside of the locked sections. */
+    uint64_t idleStart = 0;
+    uint64_t workStart = 0;
+    uint64_t runStart = 0;
+    /* Time counters of this worker, summed up by ThreadPoolGetStats(). */
+    ThreadPoolWorkerStats wstats{};
 
     ThreadPoolJob* job = NULL;
+    ThreadPriority priority = DEFAULT_PRIORITY;
     ListNode* head = NULL;
 
     timespec timeout;
@@ -439,11 +465,13 @@ void* WorkerThread(
     pthread_mutex_lock(&tp->mutex);
     tp->totalThreads++;
     tp->pendingWorkerThreadStart = 0;
+    wstats.next = tp->workerStats;
+    tp->workerStats = &wstats;
     pthread_cond_broadcast(&tp->start_and_shutdown);
     pthread_mutex_unlock(&tp->mutex);
 
     SetSeed();
-    StatsTime(&start);
+    idleStart = compa::metrics_now();
     while (1) {
         pthread_mutex_lock(&tp->mutex);
         if (job) {
@@ -453,8 +481,6 @@ void* WorkerThread(
         }
         retCode = 0;
         tp->stats.idleThreads++;
-        tp->stats.totalWorkTime += (double)StatsTime(NULL) - (double)start;
-        StatsTime(&start);
         if (persistent == 0) {
             tp->stats.workerThreads--;
         } else if (persistent == 1) {
@@ -476,7 +502,13 @@ void* WorkerThread(
                 tp->stats.idleThreads--;
                 goto exit_function;
             }
-            SetRelTimeout(&timeout, tp->attr.maxIdleTime);
+            /* With short waiting times there are more workers than needed.
+             * Then let the idle ones exit earlier. */
+            if (tp->attr.targetWaitTime > 0 && !WaitTimeAbove(tp, 2) &&
+                tp->stats.idleThreads > 1)
+                SetRelTimeout(&timeout, tp->attr.maxIdleTime / 4);
+            else
+                SetRelTimeout(&timeout, tp->attr.maxIdleTime);
 
             /* wait for a job up to the specified max time */
             retCode =
@@ -484,9 +516,8 @@ void* WorkerThread(
         }
         tp->stats.idleThreads--;
         /* idle time */
-        tp->stats.totalIdleTime += (double)StatsTime(NULL) - (double)start;
-        /* work time */
-        StatsTime(&start);
+        workStart = compa::metrics_now();
+        StatsAdd(wstats.idleTime, workStart - idleStart);
         /* bump priority of starved jobs */
         BumpPriority(tp);
         /* if shutdown then stop */
@@ -511,7 +542,7 @@ void* WorkerThread(
                         goto exit_function;
                     }
                     job = (ThreadPoolJob*)head->item;
-                    CalcWaitTime(tp, HIGH_PRIORITY, job);
+                    priority = HIGH_PRIORITY;
                     ListDelNode(&tp->highJobQ, head, 0);
                 } else if (tp->medJobQ.size > 0) {
                     head = ListHead(&tp->medJobQ);
@@ -520,7 +551,7 @@ void* WorkerThread(
                         goto exit_function;
                     }
                     job = (ThreadPoolJob*)head->item;
-                    CalcWaitTime(tp, MED_PRIORITY, job);
+                    priority = MED_PRIORITY;
                     ListDelNode(&tp->medJobQ, head, 0);
                 } else if (tp->lowJobQ.size > 0) {
                     head = ListHead(&tp->lowJobQ);
@@ -529,7 +560,7 @@ void* WorkerThread(
                         goto exit_function;
                     }
                     job = (ThreadPoolJob*)head->item;
-                    CalcWaitTime(tp, LOW_PRIORITY, job);
+                    priority = LOW_PRIORITY;
                     ListDelNode(&tp->lowJobQ, head, 0);
                 } else {
                     /* Should never get here */
@@ -542,6 +573,12 @@ void* WorkerThread(
         tp->busyThreads++;
         pthread_mutex_unlock(&tp->mutex);
 
+        /* waiting time of the job in its queue */
+        runStart = compa::metrics_now();
+        if (persistent == 0) {
+            StatsAccount(wstats.wait[priority], runStart - job->requestTime);
+            UpdateAvgWaitTime(tp, runStart - job->requestTime);
+        }
         /* In the future can log info */
         if (SetPriority(job->priority) != 0) {
         } else {
@@ -550,9 +587,15 @@ void* WorkerThread(
         job->func(job->arg);
         /* return to Normal */
         SetPriority(DEFAULT_PRIORITY);
+        /* running time of the job and work time */
+        idleStart = compa::metrics_now();
+        if (persistent == 0)
+            StatsAccount(wstats.run[priority], idleStart - runStart);
+        StatsAdd(wstats.workTime, idleStart - workStart);
     }
 
 exit_function:
+    StatsRetireWorker(tp, &wstats);
     tp->totalThreads--;
     pthread_cond_broadcast(&tp->start_and_shutdown);
     pthread_mutex_unlock(&tp->mutex);
@@ -574,14 +617,14 @@ ThreadPoolJob* CreateThreadPoolJob(
     /*! id of job. */
     int id,
     /*! [in] Valid, non null, pointer to ThreadPool. */
-    ThreadPool* tp) {
+    [[maybe_unused]] ThreadPool* tp) {
     ThreadPoolJob* newJob{nullptr};
 
-    newJob = (ThreadPoolJob*)FreeListAlloc(&tp->jobFreeList);
+    newJob = (ThreadPoolJob*)ObjectPoolAlloc(sizeof(ThreadPoolJob));
     if (newJob) {
         *newJob = *job;
         newJob->jobId = id;
-        gettimeofday(&newJob->requestTime, NULL);
+        newJob->requestTime = compa::metrics_now();
     }
 
     return newJob;
@@ -620,7 +663,25 @@ int CreateWorker(
     pthread_attr_init(&attr);
     pthread_attr_setstacksize(&attr, tp->attr.stackSize);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+#ifdef TP_HAVE_AFFINITY
+    /* Pin the worker before it starts, so its stack and other memory it
+     * touches first are allocated on the NUMA node of its CPUs. */
+    if (CPU_COUNT(&tp->attr.cpuSet) > 0)
+        pthread_attr_setaffinity_np(&attr, sizeof(tp->attr.cpuSet),
+                                    &tp->attr.cpuSet);
+#endif
     rc = pthread_create(&temp, &attr, WorkerThread, tp);
+#ifdef TP_HAVE_AFFINITY
+    if (rc == EINVAL && CPU_COUNT(&tp->attr.cpuSet) > 0) {
+        /* None of the CPUs is available, run the worker unpinned. */
+        UPnPsdk_LOGERR("MSG1183") "Unable to pin worker thread to CPUs.\n";
+        pthread_attr_destroy(&attr);
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, tp->attr.stackSize);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        rc = pthread_create(&temp, &attr, WorkerThread, tp);
+    }
+#endif
     pthread_attr_destroy(&attr);
     if (rc == 0) {
         tp->pendingWorkerThreadStart = 1;
@@ -654,12 +715,22 @@ void AddWorker(
     jobs = tp->highJobQ.size + tp->lowJobQ.size + tp->medJobQ.size;
     threads = tp->totalThreads - tp->persistentThreads;
     while (threads == 0 || (jobs / threads) >= tp->attr.jobsPerThread ||
-           (tp->totalThreads == tp->busyThreads)) {
+           (tp->totalThreads == tp->busyThreads &&
+            tp->attr.targetWaitTime == 0)) {
         if (CreateWorker(tp) != 0) {
             return;
         }
         threads++;
     }
+    /* Adaptive sizing: instead of adding a worker whenever all are busy, add
+     * one if there are not enough idle workers for the jobs and they wait too
+     * long. The oldest job also shows workers that are blocked for long. */
+    if (tp->attr.targetWaitTime > 0 &&
+        jobs > tp->totalThreads - tp->busyThreads &&
+        (WaitTimeAbove(tp, 1) ||
+         OldestWaitTime(tp) > static_cast<uint64_t>(tp->attr.targetWaitTime) *
+                                  1000000))
+        CreateWorker(tp);
 }
 
 /// @} // Functions (scope restricted to file)
@@ -700,8 +771,6 @@ int ThreadPoolInit(ThreadPool* tp, ThreadPoolAttr* attr) {
 
         return INVALID_POLICY;
     }
-    retCode +=
-        FreeListInit(&tp->jobFreeList, sizeof(ThreadPoolJob), JOBFREELISTSIZE);
     StatsInit(&tp->stats);
     retCode += ListInit(&tp->highJobQ, CmpThreadPoolJob, NULL);
     retCode += ListInit(&tp->medJobQ, CmpThreadPoolJob, NULL);
@@ -716,6 +785,8 @@ int ThreadPoolInit(ThreadPool* tp, ThreadPoolAttr* attr) {
         tp->busyThreads = 0;
         tp->persistentThreads = 0;
         tp->pendingWorkerThreadStart = 0;
+        tp->workerStats = NULL;
+        tp->avgWaitTime.store(0, std::memory_order_relaxed);
         for (i = 0; i < tp->attr.minThreads; ++i) {
             retCode = CreateWorker(tp);
             if (retCode) {
@@ -1010,8 +1081,6 @@ int ThreadPoolShutdown(ThreadPool* tp) {
     }
     while (pthread_cond_destroy(&tp->start_and_shutdown) != 0) {
     }
-    FreeListDestroy(&tp->jobFreeList);
-
     pthread_mutex_unlock(&tp->mutex);
 
     /* destroy mutex */
@@ -1036,6 +1105,10 @@ int TPAttrInit(ThreadPoolAttr* attr) {
     attr->schedPolicy = DEFAULT_POLICY;
     attr->starvationTime = DEFAULT_STARVATION_TIME;
     attr->maxJobsTotal = maxJobsTotal;
+    attr->targetWaitTime = DEFAULT_TARGET_WAIT_TIME;
+#ifdef TP_HAVE_AFFINITY
+    CPU_ZERO(&attr->cpuSet);
+#endif
 
     return 0;
 }
@@ -1121,6 +1194,27 @@ int TPAttrSetStarvationTime(ThreadPoolAttr* attr, int starvationTime) {
     return 0;
 }
 
+int TPAttrSetTargetWaitTime(ThreadPoolAttr* attr, int targetWaitTime) {
+    if (!attr)
+        return EINVAL;
+    attr->targetWaitTime = targetWaitTime;
+
+    return 0;
+}
+
+#ifdef TP_HAVE_AFFINITY
+int TPAttrSetCpuSet(ThreadPoolAttr* attr, const cpu_set_t* cpuSet) {
+    if (!attr)
+        return EINVAL;
+    if (cpuSet)
+        attr->cpuSet = *cpuSet;
+    else
+        CPU_ZERO(&attr->cpuSet);
+
+    return 0;
+}
+#endif
+
 int TPAttrSetSchedPolicy(ThreadPoolAttr* attr, PolicyType schedPolicy) {
     if (!attr)
         return EINVAL;
@@ -1173,6 +1267,17 @@ int ThreadPoolGetStats(ThreadPool* tp, ThreadPoolStats* stats) {
         pthread_mutex_lock(&tp->mutex);
 
     *stats = tp->stats;
+    for (const ThreadPoolWorkerStats* worker = tp->workerStats; worker;
+         worker = worker->next)
+        StatsCollect(stats, worker);
+    /* The waiting times are counted in nanoseconds but given in
+     * milliseconds. */
+    stats->totalJobsHQ = (int)stats->waitTime[HIGH_PRIORITY].jobs;
+    stats->totalTimeHQ = (double)stats->waitTime[HIGH_PRIORITY].sum_ns / 1e6;
+    stats->totalJobsMQ = (int)stats->waitTime[MED_PRIORITY].jobs;
+    stats->totalTimeMQ = (double)stats->waitTime[MED_PRIORITY].sum_ns / 1e6;
+    stats->totalJobsLQ = (int)stats->waitTime[LOW_PRIORITY].jobs;
+    stats->totalTimeLQ = (double)stats->waitTime[LOW_PRIORITY].sum_ns / 1e6;
     if (stats->totalJobsHQ > 0)
         stats->avgWaitHQ = stats->totalTimeHQ / (double)stats->totalJobsHQ;
     else
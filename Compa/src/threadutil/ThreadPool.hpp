@@ -6,7 +6,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-04-30
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -44,8 +44,14 @@
  */
 
 #include "LinkedList.hpp"
+#include <UpnpMetrics.hpp>
 #include <UPnPsdk/port_sock.hpp>
 
+/// \cond
+#include <atomic>
+#include <cstdint>
+/// \endcond
+
 #if defined(_WIN32) || defined(DOXYGEN_RUN)
 #if !defined(_TIMEZONE_DEFINED) || defined(DOXYGEN_RUN)
 /// \brief Timezone
@@ -97,6 +103,9 @@ constexpr int DEFAULT_STARVATION_TIME{500};
 /*! default idle time used by TPAttrInit */
 constexpr int DEFAULT_IDLE_TIME{10 * 1000};
 
+/*! default target waiting time used by TPAttrInit, 0 disables it */
+constexpr int DEFAULT_TARGET_WAIT_TIME{0};
+
 /*! default free routine used TPJobInit */
 constexpr free_routine DEFAULT_FREE_ROUTINE{nullptr};
 
@@ -116,6 +125,18 @@ extern int maxJobsTotal;
 #define DEBUG 1
 #endif
 
+#if defined(__linux__) || defined(DOXYGEN_RUN)
+/*!
+ * \brief Workers can be pinned to a set of CPUs.
+ *
+ * Only available on Linux with pthread_attr_setaffinity_np().
+ */
+#define TP_HAVE_AFFINITY 1
+/// \cond
+#include <sched.h>
+/// \endcond
+#endif
+
 /// \brief Type of the thread policy.
 typedef int PolicyType;
 
@@ -144,6 +165,18 @@ struct ThreadPoolAttr {
     int starvationTime;
     /*! \brief Scheduling policy to use. */
     PolicyType schedPolicy;
+    /*! \brief Average time a job should wait in the queues (in
+     * milliseconds). If set, a worker is not added whenever all workers are
+     * busy but only if the jobs wait longer than this, up to maxThreads. If
+     * they wait less than half of it, idle workers exit earlier. 0 disables
+     * the adaptive sizing. */
+    int targetWaitTime;
+#if defined(TP_HAVE_AFFINITY) || defined(DOXYGEN_RUN)
+    /*! \brief CPUs to run the workers on. Each worker is pinned to this set
+     * from its start, so that the memory it touches first is allocated on
+     * the NUMA node of these CPUs. An empty set does not pin the workers. */
+    cpu_set_t cpuSet;
+#endif
 };
 
 /*! \brief Internal ThreadPool Job. */
@@ -151,12 +184,59 @@ struct ThreadPoolJob {
     UPnPsdk::start_routine func;
     void* arg;
     free_routine free_func;
-    struct timeval requestTime;
+    /*! Monotonic time in nanoseconds when the job was added. */
+    uint64_t requestTime;
     ThreadPriority priority;
     int jobId;
 };
 
-/*! \brief Structure to hold statistics. */
+/*! \brief Number of job priorities, see enum ThreadPriority. */
+constexpr int TP_PRIORITIES{3};
+
+/*! \brief Times of the jobs with one priority. */
+struct ThreadPoolTimes {
+    /*! \brief Number of jobs. */
+    unsigned long long jobs;
+    /*! \brief Sum of the times in nanoseconds. */
+    unsigned long long sum_ns;
+    /*! \brief Histogram of the times, not cumulative. The buckets are the
+     * same as those of UpnpMetricsHistogram. */
+    unsigned long long bucket[UPNP_METRICS_BUCKETS];
+};
+
+/*!
+ * \brief Time counters of one worker thread.
+ *
+ * Only the worker itself writes to its counters without locking.
+ * ThreadPoolGetStats() reads them and sums them up with the counters of the
+ * other workers. When the worker exits its counters are added to the
+ * statistics of the thread pool.
+ */
+struct ThreadPoolWorkerStats {
+    /*! \brief Atomic version of ThreadPoolTimes. */
+    struct Times {
+        std::atomic<uint64_t> jobs;
+        std::atomic<uint64_t> sum_ns;
+        std::atomic<uint64_t> bucket[UPNP_METRICS_BUCKETS];
+    };
+    /*! \brief Time the jobs waited in a queue, index is the priority of the
+     * queue. */
+    Times wait[TP_PRIORITIES];
+    /*! \brief Time the jobs were running, index is the priority of the queue
+     * they were taken from. */
+    Times run[TP_PRIORITIES];
+    /*! \brief Time the worker spent with jobs in nanoseconds. */
+    std::atomic<uint64_t> workTime;
+    /*! \brief Time the worker waited for jobs in nanoseconds. */
+    std::atomic<uint64_t> idleTime;
+    /*! \brief Next worker of the thread pool. */
+    ThreadPoolWorkerStats* next;
+};
+
+/*! \brief Structure to hold statistics.
+ *
+ * The job counts and times of the priority queues are summed up from
+ * waitTime on each call of ThreadPoolGetStats(). */
 struct ThreadPoolStats {
     double totalTimeHQ;
     int totalJobsHQ;
@@ -177,6 +257,12 @@ struct ThreadPoolStats {
     int currentJobsHQ;
     int currentJobsLQ;
     int currentJobsMQ;
+    /*! \brief Time the jobs waited in the queues, index is ThreadPriority.
+     */
+    ThreadPoolTimes waitTime[TP_PRIORITIES];
+    /*! \brief Time the jobs were running, index is ThreadPriority. Persistent
+     * jobs are not counted. */
+    ThreadPoolTimes runTime[TP_PRIORITIES];
 };
 
 /*!
@@ -210,8 +296,6 @@ struct ThreadPool {
     int busyThreads;
     /*! number of persistent threads */
     int persistentThreads;
-    /*! free list of jobs */
-    FreeList jobFreeList;
     /*! low priority job Q */
     LinkedList lowJobQ;
     /*! med priority job Q */
@@ -224,6 +308,10 @@ struct ThreadPool {
     ThreadPoolAttr attr;
     /*! statistics */
     ThreadPoolStats stats;
+    /*! time counters of the running workers */
+    ThreadPoolWorkerStats* workerStats;
+    /*! moving average of the waiting time of jobs in nanoseconds */
+    std::atomic<uint64_t> avgWaitTime;
 };
 
 /*!
@@ -499,6 +587,19 @@ int TPAttrSetStarvationTime(
     /*! [in] Milliseconds. */
     int starvationTime);
 
+/*!
+ * \brief Sets the target waiting time of jobs for the thread pool attributes.
+ *
+ * \returns
+ *  On success: **0**\n
+ *  On  error: EINVAL.
+ */
+int TPAttrSetTargetWaitTime(
+    /*! [in] Must be valid thread pool attributes. */
+    ThreadPoolAttr* attr,
+    /*! [in] Milliseconds, 0 disables the adaptive sizing. */
+    int targetWaitTime);
+
 /*!
  * \brief Sets the scheduling policy for the thread pool attributes.
  *
@@ -525,6 +626,21 @@ int TPAttrSetMaxJobsTotal(
     /*! [in] Maximum number of jobs. */
     int totalMaxJobs);
 
+#if defined(TP_HAVE_AFFINITY) || defined(DOXYGEN_RUN)
+/*!
+ * \brief Sets the CPUs to run the workers on for the thread pool attributes.
+ *
+ * \returns
+ *  On success: **0**\n
+ *  On  error: EINVAL.
+ */
+int TPAttrSetCpuSet(
+    /*! [in] Must be valid thread pool attributes. */
+    ThreadPoolAttr* attr,
+    /*! [in] CPU set, nullptr or an empty set does not pin the workers. */
+    const cpu_set_t* cpuSet);
+#endif
+
 /*!
  * \brief Returns various statistics about the thread pool.
  *
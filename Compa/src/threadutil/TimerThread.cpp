@@ -4,7 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2012 France Telecom All rights reserved.
  * Copyright (C) 2021+ GPL 3 and higher by Ingo Höft,  Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-04-28
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -42,6 +42,7 @@
  */
 
 #include "TimerThread.hpp"
+#include <ObjectPool.hpp>
 
 #include <assert.h>
 
@@ -78,7 +79,7 @@ struct TimerEvent {
  */
 inline TimerEvent* CreateTimerEvent(
     /*! [in] Valid timer thread pointer. */
-    TimerThread* timer,
+    [[maybe_unused]] TimerThread* timer,
     /*! [in] . */
     ThreadPoolJob* job,
     /*! [in] . */
@@ -92,7 +93,7 @@ inline TimerEvent* CreateTimerEvent(
     assert(timer != NULL);
     assert(job != NULL);
 
-    temp = (TimerEvent*)FreeListAlloc(&timer->freeEvents);
+    temp = (TimerEvent*)ObjectPoolAlloc(sizeof(TimerEvent));
     if (temp == NULL)
         return temp;
     temp->job = (*job);
@@ -108,12 +109,12 @@ inline TimerEvent* CreateTimerEvent(
  */
 void FreeTimerEvent(
     /*! [in] Valid timer thread pointer. */
-    TimerThread* timer,
+    [[maybe_unused]] TimerThread* timer,
     /*! [in] Must be allocated with CreateTimerEvent. */
     TimerEvent* event) {
     assert(timer != nullptr);
 
-    FreeListFree(&timer->freeEvents, event);
+    ObjectPoolFree(event, sizeof(TimerEvent));
 }
 
 /*!
@@ -241,9 +242,6 @@ int TimerThreadInit(TimerThread* timer, ThreadPool* tp) {
     rc += pthread_cond_init(&timer->condition, NULL);
     assert(rc == 0);
 
-    rc += FreeListInit(&timer->freeEvents, sizeof(TimerEvent), 100);
-    assert(rc == 0);
-
     timer->shutdown = 0;
     timer->tp = tp;
     timer->lastEventId = 0;
@@ -266,7 +264,6 @@ int TimerThreadInit(TimerThread* timer, ThreadPool* tp) {
     if (rc != 0) {
         pthread_cond_destroy(&timer->condition);
         pthread_mutex_destroy(&timer->mutex);
-        FreeListDestroy(&timer->freeEvents);
         ListDestroy(&timer->eventQ, 0);
     }
 
@@ -398,7 +395,6 @@ int TimerThreadShutdown(TimerThread* timer) {
     }
 
     ListDestroy(&timer->eventQ, 0);
-    FreeListDestroy(&timer->freeEvents);
 
     pthread_cond_broadcast(&timer->condition);
 
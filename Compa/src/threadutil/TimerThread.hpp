@@ -5,7 +5,7 @@
  * Copyright (c) 2000-2003 Intel Corporation
  * All rights reserved.
  * Copyright (C) 2021 GPL 3 and higher by Ingo Höft,  <Ingo@Hoeft-online.de>
- * Redistribution only with this Copyright remark. Last modified: 2025-04-28
+ * Redistribution only with this Copyright remark. Last modified: 2026-10-19
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
@@ -64,7 +64,6 @@ struct TimerThread {
     int lastEventId;          ///< [in]
     LinkedList eventQ;        ///< [in]
     int shutdown;             ///< [in]
-    FreeList freeEvents;      ///< [in]
     ThreadPool* tp;           ///< [in]
 };
 
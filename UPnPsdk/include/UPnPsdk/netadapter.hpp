@@ -1,7 +1,7 @@
 #ifndef UPnPsdk_NETADAPTER_HPP
 #define UPnPsdk_NETADAPTER_HPP
 // Copyright (C) 2024+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-04-28
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 /*!
  * \file
  * \brief Manage information about network adapters.
@@ -87,6 +87,9 @@ void bitmask_to_netmask(
  * memory and is relatively expensive. You should try to use it infrequently as
  * possible. Using it in a busy loop is not a good idea. Once loaded it is no
  * problem to use find_first() multiple times.
+ * On Unix like platforms the list is taken from a snapshot instead, if one is
+ * loaded with netadapter_snapshot_load(). The miniserver does this on Linux
+ * and reloads it when it gets a netlink message about changed addresses.
  *
  * With find_first() and find_next() you can get more practical filtered
  * information. So all IPv4 addresses of a netadapter are suppressed. This SDK
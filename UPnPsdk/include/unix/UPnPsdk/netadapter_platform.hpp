@@ -1,7 +1,7 @@
 #ifndef UPnPsdk_UNIX_NETADAPTER_HPP
 #define UPnPsdk_UNIX_NETADAPTER_HPP
 // Copyright (C) 2024+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2025-02-24
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 /*!
  * \file
  * \brief Manage information from Unix like platforms about network adapters.
@@ -15,6 +15,36 @@
 
 namespace UPnPsdk {
 
+/// \cond
+// List of network adapters as loaded from the operating system.
+struct SIfaddrsList;
+/// \endcond
+
+/*!
+ * \brief Load a snapshot of the network adapter list that is used by all
+ * network adapter objects.
+ *
+ * Without a snapshot each CNetadapter::get_first() loads the list from the
+ * operating system. With a snapshot it only takes a reference to it. This does
+ * not call the operating system and never blocks on a netlink update or while
+ * a new list is built. The snapshot is never modified. To take up changes of the network adapters, this function
+ * must be called again, e.g. on netlink messages RTM_NEWADDR and RTM_DELADDR.
+ * Objects that have loaded the old snapshot keep it until their next
+ * get_first().
+ *
+ * \exception std::runtime_error Failed to get information from the network
+ * adapters: (detail information appended)
+ */
+UPnPsdk_API void netadapter_snapshot_load();
+
+/*!
+ * \brief Remove the snapshot of the network adapter list.
+ *
+ * Following CNetadapter::get_first() load the list from the operating system
+ * again.
+ */
+UPnPsdk_API void netadapter_snapshot_clear() noexcept;
+
 /*!
  * \brief Manage information from Unix like platforms about network adapters.
  */
@@ -36,10 +66,9 @@ class UPnPsdk_API CNetadapter_platform : public INetadapter {
     unsigned int bitmask() const override;
 
   private:
-    // Pointer to the first network adapter structure. This pointer must not be
-    // modified because it is needed to free the allocated memory space for the
-    // adapter list.
-    ifaddrs* m_ifa_first{nullptr};
+    // Network adapter list. It may be shared with the snapshot and other
+    // objects, and is freed with the last reference.
+    std::shared_ptr<const SIfaddrsList> m_ifa_list;
 
     // Pointer to the current network adapter in work.
     ifaddrs* m_ifa_current{nullptr};
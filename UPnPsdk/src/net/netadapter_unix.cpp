@@ -1,5 +1,5 @@
 // Copyright (C) 2024+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2025-03-25
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 /*!
  * \file
  * \brief Manage information from Unix like platforms about network adapters.
@@ -10,11 +10,93 @@
 /// \cond
 #include <umock/ifaddrs.hpp>
 #include <umock/net_if.hpp>
+#include <atomic>
 #include <cstring>
+#include <map>
 /// \endcond
 
 namespace UPnPsdk {
 
+/// \cond
+struct SIfaddrsList {
+    SIfaddrsList() {
+        if (getifaddrs(&ifa_first) != 0) {
+            throw std::runtime_error(
+                UPnPsdk_LOGEXCEPT("MSG1119") "Failed to get information from "
+                                             "the network adapters: " +
+                std::string(std::strerror(errno)) + '\n');
+        }
+        UPnPsdk_LOGINFO("MSG1132") "syscall ::getifaddrs() gets " << ifa_first
+                                                                  << "\n";
+    }
+
+    ~SIfaddrsList() {
+        if (ifa_first != nullptr) {
+            UPnPsdk_LOGINFO("MSG1116") "syscall ::freeifaddrs(" << ifa_first
+                                                                << ")\n";
+            freeifaddrs(ifa_first);
+        }
+    }
+
+    SIfaddrsList(const SIfaddrsList&) = delete;
+    SIfaddrsList& operator=(const SIfaddrsList&) = delete;
+
+    // First entry of the list as given by ::getifaddrs().
+    ifaddrs* ifa_first{nullptr};
+    // Index numbers of the network adapters by name. Only a snapshot has them
+    // so that index() need not ask the operating system.
+    std::map<std::string, unsigned int> indexes;
+};
+/// \endcond
+
+namespace {
+
+using PIfaddrsList = std::shared_ptr<const SIfaddrsList>;
+
+// Snapshot of the network adapter list. It is replaced as a whole and readers
+// keep the old one as long as they use it (read-copy-update). A new list is
+// built before it is published, so readers never block on a netlink update or
+// a rebuild of the list.
+#if __cpp_lib_atomic_shared_ptr
+std::atomic<PIfaddrsList> gIfaddrsSnapshot;
+
+inline PIfaddrsList snapshot_get() noexcept { return gIfaddrsSnapshot.load(); }
+
+inline void snapshot_set(PIfaddrsList a_list) noexcept {
+    gIfaddrsSnapshot.store(std::move(a_list));
+}
+#else
+PIfaddrsList gIfaddrsSnapshot;
+
+inline PIfaddrsList snapshot_get() noexcept {
+    return std::atomic_load(&gIfaddrsSnapshot);
+}
+
+inline void snapshot_set(PIfaddrsList a_list) noexcept {
+    std::atomic_store(&gIfaddrsSnapshot, std::move(a_list));
+}
+#endif
+
+} // anonymous namespace
+
+
+void netadapter_snapshot_load() {
+    TRACE("Executing netadapter_snapshot_load()")
+    auto list{std::make_shared<SIfaddrsList>()};
+    for (ifaddrs* ifa{list->ifa_first}; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (!list->indexes.contains(ifa->ifa_name))
+            list->indexes.emplace(
+                ifa->ifa_name, umock::net_if_h.if_nametoindex(ifa->ifa_name));
+    }
+    snapshot_set(std::move(list));
+}
+
+void netadapter_snapshot_clear() noexcept {
+    TRACE("Executing netadapter_snapshot_clear()")
+    snapshot_set(nullptr);
+}
+
+
 CNetadapter_platform::CNetadapter_platform(){
     TRACE2(this, " Construct CNetadapter_platform()") //
 }
@@ -27,16 +109,11 @@ CNetadapter_platform::~CNetadapter_platform() {
 void CNetadapter_platform::get_first() {
     TRACE2(this, " Executing CNetadapter_platform::get_first()")
 
-    // Get system adapters addresses.
+    // Get system adapters addresses, from the snapshot if there is one.
     this->free_ifaddrs();
-    if (getifaddrs(&m_ifa_first) != 0) {
-        throw std::runtime_error(
-            UPnPsdk_LOGEXCEPT("MSG1119") "Failed to get information from "
-                                         "the network adapters: " +
-            std::string(std::strerror(errno)) + '\n');
-    }
-    UPnPsdk_LOGINFO("MSG1132") "syscall ::getifaddrs() gets " << m_ifa_first
-                                                              << "\n";
+    m_ifa_list = snapshot_get();
+    if (!m_ifa_list)
+        m_ifa_list = std::make_shared<const SIfaddrsList>(); // May throw
     this->reset();
 }
 
@@ -56,8 +133,11 @@ bool CNetadapter_platform::get_next() {
 
 unsigned int CNetadapter_platform::index() const {
     TRACE2(this, " Executing CNetadapter_platform::index()")
-    return (m_ifa_current == nullptr)
-               ? 0
+    if (m_ifa_current == nullptr)
+        return 0;
+    const auto it{m_ifa_list->indexes.find(m_ifa_current->ifa_name)};
+    return (it != m_ifa_list->indexes.end())
+               ? it->second
                : umock::net_if_h.if_nametoindex(m_ifa_current->ifa_name);
 }
 
@@ -113,12 +193,7 @@ unsigned int CNetadapter_platform::bitmask() const {
 //
 void CNetadapter_platform::free_ifaddrs() noexcept {
     TRACE2(this, " Executing CNetadapter::free_ifaddrs()")
-    if (m_ifa_first != nullptr) {
-        UPnPsdk_LOGINFO("MSG1116") "syscall ::freeifaddrs(" << m_ifa_first
-                                                            << ")\n";
-        freeifaddrs(m_ifa_first);
-        m_ifa_first = nullptr;
-    }
+    m_ifa_list.reset();
     m_ifa_current = nullptr;
 }
 
@@ -145,9 +220,11 @@ CNetadapter_platform::is_valid_if(const ifaddrs* a_ifa) const noexcept {
 void CNetadapter_platform::reset() noexcept {
     TRACE2(this, " Executing CNetadapter_platform::reset()")
     m_ifa_current = nullptr;
-    // m_ifa_first is not necessary a valid entry. I have to look for the first
-    // valid entry.
-    for (ifaddrs* ifa_current = m_ifa_first; ifa_current != nullptr;
+    if (!m_ifa_list)
+        return;
+    // The first list entry is not necessary a valid entry. I have to look for
+    // the first valid entry.
+    for (ifaddrs* ifa_current = m_ifa_list->ifa_first; ifa_current != nullptr;
          ifa_current = ifa_current->ifa_next) {
         if (is_valid_if(ifa_current)) {
             m_ifa_current = ifa_current;
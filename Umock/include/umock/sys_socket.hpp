@@ -1,7 +1,7 @@
 #ifndef UMOCK_SYS_SOCKET_HPP
 #define UMOCK_SYS_SOCKET_HPP
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2025-06-11
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #include <UPnPsdk/port.hpp>
 #include <UPnPsdk/port_sock.hpp>
@@ -18,8 +18,14 @@ class UPnPsdk_VIS Sys_socketInterface {
     virtual int bind(SOCKET sockfd, const struct sockaddr* addr, socklen_t addrlen) = 0;
     virtual int listen(SOCKET sockfd, int backlog) = 0;
     virtual SOCKET accept(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen) = 0;
+#ifdef __linux__
+    virtual SOCKET accept4(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen, int flags) = 0;
+#endif
     virtual SSIZEP_T recv(SOCKET sockfd, char* buf, SIZEP_T len, int flags) = 0;
     virtual SSIZEP_T recvfrom(SOCKET sockfd, char* buf, SIZEP_T len, int flags, struct sockaddr* src_addr, socklen_t* addrlen) = 0;
+#ifdef __linux__
+    virtual int recvmmsg(SOCKET sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags, struct timespec* timeout) = 0;
+#endif
     virtual SSIZEP_T send(SOCKET sockfd, const char* buf, SIZEP_T len, int flags) = 0;
     virtual SSIZEP_T sendto(SOCKET sockfd, const char* buf, SIZEP_T len, int flags, const struct sockaddr* dest_addr, socklen_t addrlen) = 0;
     virtual int connect(SOCKET sockfd, const struct sockaddr* addr, socklen_t addrlen) = 0;
@@ -44,8 +50,14 @@ class Sys_socketReal : public Sys_socketInterface {
     int bind(SOCKET sockfd, const struct sockaddr* addr, socklen_t addrlen) override;
     int listen(SOCKET sockfd, int backlog) override;
     SOCKET accept(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen) override;
+#ifdef __linux__
+    SOCKET accept4(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen, int flags) override;
+#endif
     SSIZEP_T recv(SOCKET sockfd, char* buf, SIZEP_T len, int flags) override;
     SSIZEP_T recvfrom(SOCKET sockfd, char* buf, SIZEP_T len, int flags, struct sockaddr* src_addr, socklen_t* addrlen) override;
+#ifdef __linux__
+    int recvmmsg(SOCKET sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags, struct timespec* timeout) override;
+#endif
     SSIZEP_T send(SOCKET sockfd, const char* buf, SIZEP_T len, int flags) override;
     SSIZEP_T sendto(SOCKET sockfd, const char* buf, SIZEP_T len, int flags, const struct sockaddr* dest_addr, socklen_t addrlen) override;
     int connect(SOCKET sockfd, const struct sockaddr* addr, socklen_t addrlen) override;
@@ -91,8 +103,14 @@ class UPnPsdk_VIS Sys_socket {
     virtual int bind(SOCKET sockfd, const struct sockaddr* addr, socklen_t addrlen);
     virtual int listen(SOCKET sockfd, int backlog);
     virtual SOCKET accept(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen);
+#ifdef __linux__
+    virtual SOCKET accept4(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen, int flags);
+#endif
     virtual SSIZEP_T recv(SOCKET sockfd, char* buf, SIZEP_T len, int flags);
     virtual SSIZEP_T recvfrom(SOCKET sockfd, char* buf, SIZEP_T len, int flags, struct sockaddr* src_addr, socklen_t* addrlen);
+#ifdef __linux__
+    virtual int recvmmsg(SOCKET sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags, struct timespec* timeout);
+#endif
     virtual SSIZEP_T send(SOCKET sockfd, const char* buf, SIZEP_T len, int flags);
     virtual SSIZEP_T sendto(SOCKET sockfd, const char* buf, SIZEP_T len, int flags, const struct sockaddr* dest_addr, socklen_t addrlen);
     virtual int connect(SOCKET sockfd, const struct sockaddr* addr, socklen_t addrlen);
@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2025-06-11
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #include <umock/sys_socket.hpp>
 
@@ -27,6 +27,12 @@ SOCKET Sys_socketReal::accept(SOCKET sockfd, struct sockaddr* addr, socklen_t* a
     return ::accept(sockfd, addr, addrlen);
 }
 
+#ifdef __linux__
+SOCKET Sys_socketReal::accept4(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen, int flags) {
+    return ::accept4(sockfd, addr, addrlen, flags);
+}
+#endif
+
 SSIZEP_T Sys_socketReal::recv(SOCKET sockfd, char* buf, SIZEP_T len, int flags) {
     return ::recv(sockfd, buf, len, flags);
 }
@@ -35,6 +41,12 @@ SSIZEP_T Sys_socketReal::recvfrom(SOCKET sockfd, char* buf, SIZEP_T len, int fla
     return ::recvfrom(sockfd, buf, len, flags, src_addr, addrlen);
 }
 
+#ifdef __linux__
+int Sys_socketReal::recvmmsg(SOCKET sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags, struct timespec* timeout) {
+    return ::recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+}
+#endif
+
 SSIZEP_T Sys_socketReal::send(SOCKET sockfd, const char* buf, SIZEP_T len, int flags) {
     return ::send(sockfd, buf, len, flags);
 }
@@ -112,12 +124,22 @@ int Sys_socket::listen(SOCKET sockfd, int backlog) {
 SOCKET Sys_socket::accept(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen) {
     return m_ptr_workerObj->accept(sockfd, addr, addrlen);
 }
+#ifdef __linux__
+SOCKET Sys_socket::accept4(SOCKET sockfd, struct sockaddr* addr, socklen_t* addrlen, int flags) {
+    return m_ptr_workerObj->accept4(sockfd, addr, addrlen, flags);
+}
+#endif
 SSIZEP_T Sys_socket::recv(SOCKET sockfd, char* buf, SIZEP_T len, int flags) {
     return m_ptr_workerObj->recv(sockfd, buf, len, flags);
 }
 SSIZEP_T Sys_socket::recvfrom(SOCKET sockfd, char* buf, SIZEP_T len, int flags, struct sockaddr* src_addr, socklen_t* addrlen) {
     return m_ptr_workerObj->recvfrom(sockfd, buf, len, flags, src_addr, addrlen);
 }
+#ifdef __linux__
+int Sys_socket::recvmmsg(SOCKET sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags, struct timespec* timeout) {
+    return m_ptr_workerObj->recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+}
+#endif
 SSIZEP_T Sys_socket::send(SOCKET sockfd, const char* buf, SIZEP_T len, int flags) {
     return m_ptr_workerObj->send(sockfd, buf, len, flags);
 }
@@ -1,5 +1,5 @@
 // Copyright (C) 2024+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-04-29
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 // There are additional Unit Tests at
 // git commit a18cff7d3dfd3266ad63a9efacba672ab1bd88b2.
@@ -12,6 +12,9 @@
 
 #include <UPnPsdk/netadapter.hpp>
 #include <utest/utest.hpp>
+#ifndef _MSC_VER
+#include <umock/net_if_mock.hpp>
+#endif
 
 namespace utest {
 
@@ -119,6 +122,41 @@ TEST(NetadapterTestSuite, find_loopback_and_lla) {
     } while (nadObj.find_next());
 }
 
+#ifndef _MSC_VER
+TEST(NetadapterTestSuite, get_adapters_from_snapshot) {
+    CNetadapter nad1Obj;
+    nad1Obj.get_first();
+    ASSERT_TRUE(nad1Obj.find_first(ADDRS::lo));
+    const unsigned int index{nad1Obj.index()};
+
+    UPnPsdk::netadapter_snapshot_load();
+    CNetadapter nad2Obj;
+    {
+        // With the snapshot the index is not requested from the operating
+        // system.
+        umock::Net_ifMock net_ifObj;
+        umock::Net_if net_if_injectObj(&net_ifObj);
+        EXPECT_CALL(net_ifObj, if_nametoindex(_)).Times(0);
+
+        nad2Obj.get_first();
+        ASSERT_TRUE(nad2Obj.find_first(ADDRS::lo));
+        EXPECT_EQ(nad2Obj.index(), index);
+    }
+
+    // A reloaded snapshot does not affect objects that have loaded the old one.
+    UPnPsdk::netadapter_snapshot_load();
+    EXPECT_EQ(nad2Obj.index(), index);
+    nad2Obj.sockaddr(saddrObj);
+    EXPECT_EQ(saddrObj.netaddr(), "[::1]");
+    UPnPsdk::netadapter_snapshot_clear();
+
+    // Without snapshot the list is loaded from the operating system again.
+    nad1Obj.get_first();
+    ASSERT_TRUE(nad1Obj.find_first(ADDRS::lo));
+    EXPECT_EQ(nad1Obj.index(), index);
+}
+#endif
+
 #if 0
 // Get Subnet mask from address prefix length, first version with two nested
 // loops working on 128 bits. I have made a more performant version working on
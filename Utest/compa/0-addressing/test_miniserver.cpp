@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-05-10
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 // All functions of the miniserver module have been covered by a gtest. Some
 // tests are skipped and must be completed when missed information is
@@ -37,6 +37,7 @@
 namespace utest {
 
 using ::testing::_;
+using ::testing::Between;
 using ::testing::DoAll;
 using ::testing::Ge;
 using ::testing::InSequence;
@@ -448,6 +449,66 @@ TEST(StartMiniServerTestSuite, start_miniserver_already_running) {
         << errStrEx(ret_StartMiniServer, UPNP_E_INTERNAL_ERROR);
 }
 
+#if !defined(UPnPsdk_WITH_NATIVE_PUPNP) && defined(__linux__)
+TEST(StartMiniServerTestSuite, share_listening_address_with_more_acceptors) {
+    UPnPsdk::CSocket sockObj(SOCK_STREAM);
+    // With one acceptor the listening address is not shared.
+    EXPECT_FALSE(enable_acceptors(sockObj));
+
+    g_UpnpSdkMiniServerAcceptors = 3;
+    ASSERT_TRUE(enable_acceptors(sockObj));
+    UPnPsdk::SSockaddr saObj;
+    saObj = "[::1]";
+    sockObj.bind(&saObj);
+    sockObj.listen();
+    sockObj.local_saddr(&saObj);
+
+    // Test Unit
+    open_acceptor_sockets(saObj);
+    EXPECT_EQ(gAcceptorSocks.size(), 2u);
+    start_acceptors();
+    EXPECT_EQ(gAcceptorThreads.size(), 2u);
+    stop_acceptors();
+
+    EXPECT_TRUE(gAcceptorSocks.empty());
+    EXPECT_TRUE(gAcceptorThreads.empty());
+    EXPECT_EQ(gAcceptorStopFd, -1);
+    g_UpnpSdkMiniServerAcceptors = MINISERVER_ACCEPTORS;
+}
+
+TEST(StartMiniServerTestSuite, acceptor_waits_without_file_descriptors) {
+    // A pending connection keeps the listening socket readable.
+    UPnPsdk::CSocket sockObj(SOCK_STREAM);
+    UPnPsdk::SSockaddr saObj;
+    saObj = "[::1]";
+    sockObj.bind(&saObj);
+    sockObj.listen();
+    sockObj.local_saddr(&saObj);
+    UPnPsdk::CSocket clientObj(SOCK_STREAM);
+    ASSERT_EQ(::connect(clientObj, &saObj.sa, saObj.sizeof_saddr()), 0);
+    gAcceptorStopFd = ::eventfd(0, EFD_CLOEXEC);
+    ASSERT_NE(gAcceptorStopFd, -1);
+
+    StrictMock<umock::Sys_socketMock> sys_socketObj;
+    umock::Sys_socket sys_socket_injectObj{&sys_socketObj};
+    // Without waiting it would be called in a busy loop.
+    EXPECT_CALL(sys_socketObj, accept4(_, _, _, _))
+        .Times(Between(1, 5))
+        .WillRepeatedly(SetErrnoAndReturn(EMFILE, INVALID_SOCKET));
+
+    // Test Unit
+    std::thread acceptor(run_acceptor, static_cast<SOCKET>(sockObj));
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    uint64_t stop{1};
+    EXPECT_EQ(::write(gAcceptorStopFd, &stop, sizeof(stop)),
+              (ssize_t)sizeof(stop));
+    acceptor.join();
+
+    ::close(gAcceptorStopFd);
+    gAcceptorStopFd = -1;
+}
+#endif
+
 // Subroutine for multiple check of extended expectations.
 void chk_minisocket(MiniServerSockArray& minisocket) {
     EXPECT_EQ(minisocket.miniServerSock4, INVALID_SOCKET);
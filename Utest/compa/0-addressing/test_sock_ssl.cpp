@@ -1,8 +1,9 @@
 // Copyright (C) 2023+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2025-01-26
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #include <upnp.hpp>
 #include <sock.hpp>
+#include <cmake_vars.hpp>
 
 #include <UPnPsdk/port.hpp>
 #include <UPnPsdk/synclog.hpp>
@@ -16,6 +17,8 @@
 
 #include <utest/utest.hpp>
 
+#include <thread>
+
 #ifdef UPnPsdk_WITH_NATIVE_PUPNP
 UPnPsdk_EXTERN SSL_CTX* gSslCtx;
 #endif
@@ -199,6 +202,64 @@ TEST(SockDeathTest, sock_ssl_connect_signal_broken_pipe) {
     CLOSE_SOCKET_P(info.socket);
 }
 
+#ifndef UPnPsdk_WITH_NATIVE_PUPNP
+TEST(SockTestSuite, sock_ssl_connect_resumes_session) {
+    // Provide a TLS server on the loopback interface that accepts two
+    // connections.
+    SSL_CTX* server_ctx = SSL_CTX_new(TLS_server_method());
+    ASSERT_NE(server_ctx, nullptr);
+    ASSERT_EQ(SSL_CTX_use_certificate_file(
+                  server_ctx, CMAKE_SOURCE_DIR "/Utest/cert.pem",
+                  SSL_FILETYPE_PEM),
+              1);
+    ASSERT_EQ(SSL_CTX_use_PrivateKey_file(server_ctx,
+                                          CMAKE_SOURCE_DIR "/Utest/key.pem",
+                                          SSL_FILETYPE_PEM),
+              1);
+    CSocket listenObj(SOCK_STREAM);
+    UPnPsdk::SSockaddr saObj;
+    saObj = "[::1]";
+    listenObj.bind(&saObj);
+    listenObj.listen();
+    listenObj.local_saddr(&saObj);
+
+    std::thread server([&listenObj, server_ctx] {
+        for (int i{0}; i < 2; i++) {
+            SOCKET client = ::accept(listenObj, nullptr, nullptr);
+            SSL* ssl = SSL_new(server_ctx);
+            SSL_set_fd(ssl, static_cast<int>(client));
+            if (SSL_accept(ssl) == 1) {
+                SSL_write(ssl, "test", 4);
+                SSL_shutdown(ssl);
+            }
+            SSL_free(ssl);
+            CLOSE_SOCKET_P(client);
+        }
+    });
+
+    CGsslCtx gSslCtxObj;
+    bool reused[2]{};
+    for (bool& session_reused : reused) {
+        ::SOCKINFO info{};
+        info.socket = ::socket(AF_INET6, SOCK_STREAM, 0);
+        ASSERT_EQ(::connect(info.socket, &saObj.sa, saObj.sizeof_saddr()), 0);
+        // Test Unit
+        EXPECT_EQ(sock_ssl_connect(&info), UPNP_E_SUCCESS);
+        // The client gets the session ticket of TLS 1.3 with reading.
+        char buf[4];
+        int timeout{5};
+        EXPECT_EQ(sock_read(&info, buf, sizeof(buf), &timeout), 4);
+        session_reused = SSL_session_reused(info.ssl) == 1;
+        sock_destroy(&info, SD_BOTH);
+    }
+    server.join();
+    SSL_CTX_free(server_ctx);
+
+    EXPECT_FALSE(reused[0]);
+    EXPECT_TRUE(reused[1]);
+}
+#endif
+
 } // namespace utest
 
 
@@ -0,0 +1,228 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Include source code for testing. So we have also direct access to the
+// cache in the anonymous namespace.
+#include <Compa/src/ssdp/ssdp_cache.cpp>
+#include <Compa/src/ssdp/ssdp_ctrlpt.cpp>
+
+#include <utest/utest.hpp>
+#include <utest/threadpool_init.hpp>
+
+#include <condition_variable>
+
+
+namespace utest {
+
+class SsdpCacheFTestSuite : public ::testing::Test {
+  protected:
+    UpnpDiscovery* m_param{::UpnpDiscovery_new()};
+
+    SsdpCacheFTestSuite() {
+        ::ssdp_cache_clear();
+        ::ssdp_cache_enable(true);
+        // There is no timer thread.
+        gSsdpCacheSweepScheduled = true;
+        ::UpnpDiscovery_set_Expires(m_param, 1800);
+        ::UpnpDiscovery_strcpy_Location(m_param,
+                                        "http://192.168.1.2:50001/desc.xml");
+    }
+    ~SsdpCacheFTestSuite() override {
+        ::ssdp_cache_enable(SSDP_DISCOVERY_CACHE != 0);
+        ::ssdp_cache_clear();
+        ::UpnpDiscovery_delete(m_param);
+    }
+
+    static int count_entry(Upnp_EventType a_event_type, const void*,
+                           void* a_cookie) {
+        if (a_event_type == UPNP_DISCOVERY_ADVERTISEMENT_ALIVE)
+            (*static_cast<int*>(a_cookie))++;
+        return 0;
+    }
+};
+
+constexpr char usn[]{"uuid:12345678-9abc-def0-1234-56789abcdef0::"
+                     "urn:schemas-upnp-org:device:Light:1"};
+
+/*!
+ * \brief A registered control point with an active search for all devices.
+ *
+ * Messages from devices are given to ssdp_handle_ctrlpt_msg() and the
+ * callbacks are counted by their event type.
+ */
+class SsdpCacheCtrlptFTestSuite : public SsdpCacheFTestSuite {
+  protected:
+    UpnpClient_Handle m_hnd{-1};
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    int m_alive{};
+    int m_search_result{};
+    // Destructed first, so no job calls the callback afterwards.
+    CThreadPoolInit m_tp{gRecvThreadPool};
+
+    SsdpCacheCtrlptFTestSuite() {
+        UpnpSdkInit = 1;
+        EXPECT_EQ(::UpnpRegisterClient(callback, this, &m_hnd),
+                  UPNP_E_SUCCESS);
+        Handle_Info* info;
+        if (::GetHandleInfo(m_hnd, &info) != HND_CLIENT)
+            return;
+        SsdpSearchArg* arg =
+            static_cast<SsdpSearchArg*>(malloc(sizeof(SsdpSearchArg)));
+        arg->timeoutEventId = 0;
+        arg->searchTarget = strdup("ssdp:all");
+        arg->cookie = this;
+        arg->requestType = SSDP_ALL;
+        ListAddTail(&info->SsdpSearchList, arg);
+    }
+    ~SsdpCacheCtrlptFTestSuite() override {
+        ::UpnpUnRegisterClient(m_hnd);
+        UpnpSdkInit = 0;
+    }
+
+    static int callback(Upnp_EventType a_event_type, const void*,
+                        void* a_cookie) {
+        SsdpCacheCtrlptFTestSuite* self =
+            static_cast<SsdpCacheCtrlptFTestSuite*>(a_cookie);
+        std::lock_guard lock(self->m_mutex);
+        if (a_event_type == UPNP_DISCOVERY_ADVERTISEMENT_ALIVE)
+            self->m_alive++;
+        else if (a_event_type == UPNP_DISCOVERY_SEARCH_RESULT)
+            self->m_search_result++;
+        self->m_cond.notify_all();
+        return 0;
+    }
+
+    /// Parses a message from a device and handles it.
+    void handle(const std::string& a_msg, bool a_reply) {
+        http_parser_t parser;
+        if (a_reply)
+            ::parser_response_init(&parser, HTTPMETHOD_MSEARCH);
+        else
+            ::parser_request_init(&parser);
+        ASSERT_EQ(::membuffer_append(&parser.msg.msg, a_msg.data(),
+                                     a_msg.size()),
+                  0);
+        // A NOTIFY without body may fail to parse, as in the SSDP server.
+        const parse_status_t status{::parser_parse(&parser)};
+        EXPECT_TRUE(status == PARSE_SUCCESS || parser.valid_ssdp_notify_hack);
+        sockaddr_storage dest_addr{};
+        ::ssdp_handle_ctrlpt_msg(&parser.msg, &dest_addr, 0);
+        ::httpmsg_destroy(&parser.msg);
+    }
+
+    /// Waits for the given number of search results and returns it.
+    int search_results(int a_expected) {
+        std::unique_lock lock(m_mutex);
+        m_cond.wait_for(lock, std::chrono::seconds(5), [this, a_expected] {
+            return m_search_result >= a_expected;
+        });
+        return m_search_result;
+    }
+};
+
+constexpr char root_usn[]{
+    "uuid:12345678-9abc-def0-1234-56789abcdef0::upnp:rootdevice"};
+
+
+TEST_F(SsdpCacheFTestSuite, deliver_only_new_or_changed_entries) {
+    // First sighting.
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+    // Repeated advertisement.
+    EXPECT_FALSE(::ssdp_cache_alive(usn, 1, m_param));
+    // Changed BOOTID.UPNP.ORG.
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 2, m_param));
+    EXPECT_FALSE(::ssdp_cache_alive(usn, 2, m_param));
+    // Changed LOCATION.
+    ::UpnpDiscovery_strcpy_Location(m_param,
+                                    "http://192.168.1.3:50001/desc.xml");
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 2, m_param));
+    EXPECT_FALSE(::ssdp_cache_alive(usn, 2, m_param));
+    // Another USN of the same device.
+    EXPECT_TRUE(::ssdp_cache_alive(
+        "uuid:12345678-9abc-def0-1234-56789abcdef0::upnp:rootdevice", 2,
+        m_param));
+
+    int count{};
+    ::ssdp_cache_get(count_entry, &count);
+    EXPECT_EQ(count, 2);
+}
+
+TEST_F(SsdpCacheFTestSuite, byebye_removes_entry) {
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+    ::ssdp_cache_byebye(usn);
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+}
+
+TEST_F(SsdpCacheFTestSuite, expired_entries_are_removed) {
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+    ::UpnpDiscovery_set_Expires(m_param, 0);
+    EXPECT_TRUE(::ssdp_cache_alive("uuid:other", 1, m_param));
+
+    // Expired entries are not returned.
+    int count{};
+    ::ssdp_cache_get(count_entry, &count);
+    EXPECT_EQ(count, 1);
+
+    std::vector<DiscoveryPtr> expired{expire_entries(Clock::now())};
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(::UpnpDiscovery_get_Expires(expired[0].get()), 0);
+    EXPECT_EQ(gSsdpCache.size(), 1u);
+
+    expired = expire_entries(Clock::now() + std::chrono::seconds(1801));
+    EXPECT_EQ(expired.size(), 1u);
+    EXPECT_TRUE(gSsdpCache.empty());
+}
+
+TEST_F(SsdpCacheFTestSuite, disabled_cache_delivers_everything) {
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+    ::ssdp_cache_enable(false);
+    EXPECT_TRUE(gSsdpCache.empty());
+
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+    EXPECT_TRUE(::ssdp_cache_alive(usn, 1, m_param));
+    EXPECT_TRUE(gSsdpCache.empty());
+}
+
+TEST_F(SsdpCacheCtrlptFTestSuite, search_finds_cached_device) {
+    const std::string alive{
+        "NOTIFY * HTTP/1.1\r\n"
+        "HOST: 239.255.255.250:1900\r\n"
+        "CACHE-CONTROL: max-age=1800\r\n"
+        "LOCATION: http://192.168.1.2:50001/desc.xml\r\n"
+        "NT: upnp:rootdevice\r\n"
+        "NTS: ssdp:alive\r\n"
+        "USN: " +
+        std::string(root_usn) + "\r\n\r\n"};
+    const std::string reply{"HTTP/1.1 200 OK\r\n"
+                            "CACHE-CONTROL: max-age=1800\r\n"
+                            "EXT:\r\n"
+                            "LOCATION: http://192.168.1.2:50001/desc.xml\r\n"
+                            "ST: upnp:rootdevice\r\n"
+                            "USN: " +
+                            std::string(root_usn) + "\r\n\r\n"};
+
+    // The device is cached by its advertisement, a repeated one is dropped.
+    this->handle(alive, false);
+    this->handle(alive, false);
+    EXPECT_EQ(m_alive, 1);
+
+    // Each search for the cached device gets its reply.
+    this->handle(reply, true);
+    EXPECT_EQ(this->search_results(1), 1);
+    this->handle(reply, true);
+    EXPECT_EQ(this->search_results(2), 2);
+
+    // The replies don't make the advertisement new again.
+    this->handle(alive, false);
+    EXPECT_EQ(m_alive, 1);
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
@@ -1,5 +1,5 @@
 // Copyright (C) 2023+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-03-28
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 // Include source code for testing. So we have also direct access to static
 // functions which need to be tested.
@@ -7,6 +7,7 @@
 #include <Pupnp/upnp/src/ssdp/ssdp_server.cpp>
 #else
 #include <Compa/src/ssdp/ssdp_common.cpp>
+#include <Compa/src/ssdp/ssdp_filter.cpp>
 #endif
 
 #include <UPnPsdk/upnptools.hpp> // for errStrEx
@@ -20,6 +21,8 @@
 #include <utest/threadpool_init.hpp>
 #include <utest/utest.hpp>
 
+#include <future>
+
 
 namespace utest {
 
@@ -68,9 +71,12 @@ class SsdpFTestSuite : public ::testing::Test {
         //        sizeof(GlobalClientSubscribeMutex));
         memset(&gUpnpSdkNLSuuid, 0, sizeof(gUpnpSdkNLSuuid));
         // memset(&HandleTable, 0xAA, sizeof(HandleTable));
-        memset(&gSendThreadPool, 0xAA, sizeof(gSendThreadPool));
-        memset(&gRecvThreadPool, 0xAA, sizeof(gRecvThreadPool));
-        memset(&gMiniServerThreadPool, 0xAA, sizeof(gMiniServerThreadPool));
+        memset(static_cast<void*>(&gSendThreadPool), 0xAA,
+               sizeof(gSendThreadPool));
+        memset(static_cast<void*>(&gRecvThreadPool), 0xAA,
+               sizeof(gRecvThreadPool));
+        memset(static_cast<void*>(&gMiniServerThreadPool), 0xAA,
+               sizeof(gMiniServerThreadPool));
         memset(&gTimerThread, 0xAA, sizeof(gTimerThread));
         memset(&bWebServerState, 0xAA, sizeof(bWebServerState));
         memset(&gSsdpReqSocket4, 0xAA, sizeof(gSsdpReqSocket4));
@@ -152,6 +158,25 @@ void InitMiniServerSockArray(MiniServerSockArray* miniSocket) {
 }
 
 
+#if !defined(UPnPsdk_WITH_NATIVE_PUPNP) && defined(__linux__)
+#define SSDP_RECVMMSG
+// Action for a mocked recvmmsg() that receives the given messages from one
+// sender.
+auto RecvMmsg(const std::vector<std::string>& a_msgs, const SSockaddr& a_sa) {
+    return [a_msgs, ss = a_sa.ss](SOCKET, mmsghdr* msgvec, unsigned int vlen,
+                                  int, timespec*) -> int {
+        unsigned int i{0};
+        for (; i < a_msgs.size() && i < vlen; i++) {
+            memcpy(msgvec[i].msg_hdr.msg_iov->iov_base, a_msgs[i].data(),
+                   a_msgs[i].size());
+            msgvec[i].msg_len = static_cast<unsigned int>(a_msgs[i].size());
+            memcpy(msgvec[i].msg_hdr.msg_name, &ss, sizeof(ss));
+        }
+        return static_cast<int>(i);
+    };
+}
+#endif
+
 TEST_F(SsdpMockFTestSuite, read_from_ssdp_socket_successful) {
     SOCKET sockfd{1005}; // mocked socket file descriptor
     gSsdpReqSocket6 = sockfd;
@@ -164,9 +189,14 @@ TEST_F(SsdpMockFTestSuite, read_from_ssdp_socket_successful) {
 
     // Here I mock receiving of the message.
     constexpr char recv_msg[]("This is a test message.");
-    constexpr SIZEP_T strlen{sizeof(recv_msg) - 1};
     SSockaddr saObj;
     saObj = "[::1]:50123";
+#ifdef SSDP_RECVMMSG
+    EXPECT_CALL(m_sys_socketObj, recvmmsg(sockfd, _, SSDP_RECV_BATCH,
+                                          MSG_WAITFORONE, nullptr))
+        .WillOnce(RecvMmsg({recv_msg}, saObj));
+#else
+    constexpr SIZEP_T strlen{sizeof(recv_msg) - 1};
     const socklen_t saddrlen{saObj.sizeof_saddr()};
     // It is important to expect strlen.
     EXPECT_CALL(m_sys_socketObj, recvfrom(sockfd, _, Ge(strlen), 0, _,
@@ -174,6 +204,7 @@ TEST_F(SsdpMockFTestSuite, read_from_ssdp_socket_successful) {
         .WillOnce(DoAll(StrCpyToArg<1>(recv_msg),
                         StructCpyToArg<4>(&saObj.sa, saddrlen),
                         SetArgPtrSocklen_tValue<5>(saddrlen), Return(strlen)));
+#endif
 
     // Test Unit
     EXPECT_EQ(readFromSSDPSocket(sockfd), 0);
@@ -185,9 +216,14 @@ TEST_F(SsdpMockFTestSuite, read_from_ssdp_socket_empty_message) {
 
     // Here I mock receiving of the message.
     constexpr char recv_msg[]("");
-    constexpr SIZEP_T strlen{sizeof(recv_msg) - 1};
     SSockaddr saObj;
     saObj = "[::1]:50124";
+#ifdef SSDP_RECVMMSG
+    EXPECT_CALL(m_sys_socketObj, recvmmsg(sockfd, _, SSDP_RECV_BATCH,
+                                          MSG_WAITFORONE, nullptr))
+        .WillOnce(RecvMmsg({recv_msg}, saObj));
+#else
+    constexpr SIZEP_T strlen{sizeof(recv_msg) - 1};
     const socklen_t saddrlen{saObj.sizeof_saddr()};
     // It is important to expect strlen.
     EXPECT_CALL(m_sys_socketObj, recvfrom(sockfd, _, Ge(strlen), 0, _,
@@ -195,11 +231,142 @@ TEST_F(SsdpMockFTestSuite, read_from_ssdp_socket_empty_message) {
         .WillOnce(DoAll(StrCpyToArg<1>(recv_msg),
                         StructCpyToArg<4>(&saObj.sa, saddrlen),
                         SetArgPtrSocklen_tValue<5>(saddrlen), Return(strlen)));
+#endif
 
     // Test Unit
     EXPECT_EQ(readFromSSDPSocket(sockfd), 0);
 }
 
+#ifdef SSDP_RECVMMSG
+// On Linux readFromSSDPSocket() receives with recvmmsg() only. Its recvfrom()
+// path is not compiled there and is tested by the tests above on platforms
+// without recvmmsg().
+
+// The receive thread pool gets one worker that is blocked by a job, so the
+// jobs queued by the Unit can be inspected before they run.
+class SsdpBatchFTestSuite : public SsdpMockFTestSuite {
+  protected:
+    std::promise<void> m_started;
+    std::promise<void> m_release;
+
+    SsdpBatchFTestSuite() {
+        // Search responses pass the SSDP filter only with a control point.
+        gSsdpFilterCtrlpts = 1;
+
+        ThreadPoolAttr attr;
+        TPAttrInit(&attr);
+        TPAttrSetMinThreads(&attr, 1);
+        TPAttrSetMaxThreads(&attr, 1);
+        if (ThreadPoolInit(&gRecvThreadPool, &attr) != 0)
+            throw std::runtime_error("Failed to initialize thread pool.");
+        ThreadPoolJob job{};
+        TPJobInit(&job, (UPnPsdk::start_routine)block_worker, this);
+        if (ThreadPoolAdd(&gRecvThreadPool, &job, nullptr) != 0)
+            throw std::runtime_error("Failed to block thread pool.");
+        m_started.get_future().wait();
+    }
+
+    ~SsdpBatchFTestSuite() override {
+        m_release.set_value();
+        ThreadPoolShutdown(&gRecvThreadPool);
+        gSsdpFilterCtrlpts = 0;
+    }
+
+    static void block_worker(void* a_arg) {
+        SsdpBatchFTestSuite* self = static_cast<SsdpBatchFTestSuite*>(a_arg);
+        self->m_started.set_value();
+        self->m_release.get_future().wait();
+    }
+
+    /// Returns the number of jobs waiting in the receive thread pool.
+    static long queued_jobs() {
+        pthread_mutex_lock(&gRecvThreadPool.mutex);
+        long jobs{gRecvThreadPool.highJobQ.size +
+                  gRecvThreadPool.medJobQ.size + gRecvThreadPool.lowJobQ.size};
+        pthread_mutex_unlock(&gRecvThreadPool.mutex);
+        return jobs;
+    }
+
+    /*! Removes the first job waiting with medium priority and returns its
+     * batch, that must be freed. */
+    static ssdp_thread_batch* take_queued_batch() {
+        int jobId{-1};
+        pthread_mutex_lock(&gRecvThreadPool.mutex);
+        ListNode* node = ListHead(&gRecvThreadPool.medJobQ);
+        if (node != nullptr)
+            jobId = static_cast<ThreadPoolJob*>(node->item)->jobId;
+        pthread_mutex_unlock(&gRecvThreadPool.mutex);
+
+        ThreadPoolJob job{};
+        if (ThreadPoolRemove(&gRecvThreadPool, jobId, &job) != 0)
+            return nullptr;
+        EXPECT_EQ(job.func, (UPnPsdk::start_routine)ssdp_batch_handler_thread);
+        return static_cast<ssdp_thread_batch*>(job.arg);
+    }
+};
+
+TEST_F(SsdpBatchFTestSuite, read_batch_from_ssdp_socket) {
+    SOCKET sockfd{1007}; // mocked socket file descriptor
+    gSsdpReqSocket6 = sockfd;
+
+    constexpr char response1[]{"HTTP/1.1 200 OK\r\n"
+                               "ST: upnp:rootdevice\r\n\r\n"};
+    constexpr char response3[]{"HTTP/1.1 200 OK\r\n"
+                               "ST: ssdp:all\r\n\r\n"};
+
+    SSockaddr saObj;
+    saObj = "[::1]:50125";
+    // All queued messages are received with one call.
+    EXPECT_CALL(m_sys_socketObj, recvmmsg(sockfd, _, SSDP_RECV_BATCH,
+                                          MSG_WAITFORONE, nullptr))
+        .WillOnce(RecvMmsg({response1, "", response3}, saObj));
+
+    // Test Unit
+    EXPECT_EQ(readFromSSDPSocket(sockfd), 0);
+
+    // One job handles all messages of the batch, the empty one is skipped.
+    EXPECT_EQ(queued_jobs(), 1);
+    ssdp_thread_batch* batch = take_queued_batch();
+    ASSERT_NE(batch, nullptr);
+    EXPECT_EQ(batch->count, 2);
+    if (batch->count == 2) {
+        EXPECT_STREQ(batch->data[0]->parser.msg.msg.buf, response1);
+        EXPECT_STREQ(batch->data[1]->parser.msg.msg.buf, response3);
+        EXPECT_EQ(memcmp(&batch->data[1]->dest_addr, &saObj.ss,
+                         sizeof(saObj.ss)),
+                  0);
+    }
+    free_ssdp_batch(batch);
+}
+
+TEST_F(SsdpBatchFTestSuite, read_batch_of_empty_messages_from_ssdp_socket) {
+    SOCKET sockfd{1009}; // mocked socket file descriptor
+    gSsdpReqSocket6 = sockfd;
+
+    SSockaddr saObj;
+    saObj = "[::1]:50126";
+    EXPECT_CALL(m_sys_socketObj, recvmmsg(sockfd, _, SSDP_RECV_BATCH,
+                                          MSG_WAITFORONE, nullptr))
+        .WillOnce(RecvMmsg({"", ""}, saObj));
+
+    // Test Unit
+    EXPECT_EQ(readFromSSDPSocket(sockfd), 0);
+
+    // Without a message no job is queued.
+    EXPECT_EQ(queued_jobs(), 0);
+}
+
+TEST_F(SsdpMockFTestSuite, read_batch_from_ssdp_socket_fails) {
+    SOCKET sockfd{1008}; // mocked socket file descriptor
+
+    EXPECT_CALL(m_sys_socketObj, recvmmsg(sockfd, _, _, _, _))
+        .WillOnce(SetErrnoAndReturn(EBADF, -1));
+
+    // Test Unit
+    EXPECT_EQ(readFromSSDPSocket(sockfd), -1);
+}
+#endif
+
 TEST_F(SsdpMockFTestSuite, create_sock_reqv4_successful) {
     // Steps as given by the Unit and expected results:
     // 1. get a socket succeeds
@@ -1,5 +1,5 @@
 // Copyright (C) 2023+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-05-10
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 // This tests network communication. The usual way to do it is to use mocking to
 // be independent from current hardware. But with mocking you can only test what
@@ -164,9 +164,12 @@ class SsdpDeviceFTestSuite : public ::testing::Test {
         memset(&GlobalHndRWLock, 0xAA, sizeof(GlobalHndRWLock));
         memset(&gUpnpSdkNLSuuid, 0xAA, sizeof(gUpnpSdkNLSuuid));
         // memset(&HandleTable, 0xAA, sizeof(HandleTable));
-        memset(&gSendThreadPool, 0xAA, sizeof(gSendThreadPool));
-        memset(&gRecvThreadPool, 0xAA, sizeof(gRecvThreadPool));
-        memset(&gMiniServerThreadPool, 0xAA, sizeof(gMiniServerThreadPool));
+        memset(static_cast<void*>(&gSendThreadPool), 0xAA,
+               sizeof(gSendThreadPool));
+        memset(static_cast<void*>(&gRecvThreadPool), 0xAA,
+               sizeof(gRecvThreadPool));
+        memset(static_cast<void*>(&gMiniServerThreadPool), 0xAA,
+               sizeof(gMiniServerThreadPool));
         memset(&gTimerThread, 0xAA, sizeof(gTimerThread));
         memset(&bWebServerState, 0xAA, sizeof(bWebServerState));
 #if 0 // #ifdef UPnPsdk_WITH_NATIVE_PUPNP
@@ -881,6 +884,222 @@ TEST_F(SsdpDeviceFTestSuite, NewRequestHandler_with_multible_netadapter) {
 }
 #endif
 
+#ifndef UPnPsdk_WITH_NATIVE_PUPNP
+TEST(SsdpDeviceTestSuite, merge_search_requests_into_pending_reply) {
+    SSockaddr srcObj;
+    srcObj = "192.168.99.3:50001";
+    SsdpEvent event{};
+    char st_root[]{"upnp:rootdevice"};
+    ASSERT_EQ(ssdp_request_type(st_root, &event), 0);
+    SsdpSearchReply* reply{nullptr};
+
+    // First request gets a new reply.
+    ASSERT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 1000, 1, &reply),
+              SSDP_REPLY_NEW);
+    ASSERT_NE(reply, nullptr);
+    EXPECT_EQ(reply->replyTime, 1000);
+    EXPECT_EQ(reply->numTargets, 1);
+    EXPECT_EQ(reply->target[0].RequestType, SSDP_ROOTDEVICE);
+
+    // The repeated request is merged.
+    SsdpSearchReply* reply2{nullptr};
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 1000, 1, &reply2),
+              SSDP_REPLY_MERGED);
+    EXPECT_EQ(reply2, nullptr);
+    EXPECT_EQ(reply->numTargets, 1);
+
+    // Another target is added to the reply.
+    char st_type[]{"urn:schemas-upnp-org:device:MediaServer:1"};
+    ASSERT_EQ(ssdp_request_type(st_type, &event), 0);
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 1000, 1, &reply2),
+              SSDP_REPLY_MERGED);
+    ASSERT_EQ(reply->numTargets, 2);
+    EXPECT_EQ(reply->target[1].RequestType, SSDP_DEVICETYPE);
+    EXPECT_STREQ(reply->target[1].DeviceType, st_type);
+
+    // "ssdp:all" replaces the targets and covers all others.
+    char st_all[]{"ssdp:all"};
+    ASSERT_EQ(ssdp_request_type(st_all, &event), 0);
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 1000, 1, &reply2),
+              SSDP_REPLY_MERGED);
+    ASSERT_EQ(reply->numTargets, 1);
+    EXPECT_EQ(reply->target[0].RequestType, SSDP_ALL);
+    ASSERT_EQ(ssdp_request_type(st_type, &event), 0);
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 1000, 1, &reply2),
+              SSDP_REPLY_MERGED);
+    EXPECT_EQ(reply->numTargets, 1);
+
+    // Another device handle, another source port or a reply that is sent
+    // after the MX time of the request get a new reply.
+    EXPECT_EQ(reply_add(2, 1800, &srcObj.ss, &event, 1000, 1, &reply2),
+              SSDP_REPLY_NEW);
+    free_search_reply(reply2);
+    SSockaddr src2Obj;
+    src2Obj = "192.168.99.3:50002";
+    EXPECT_EQ(reply_add(1, 1800, &src2Obj.ss, &event, 1000, 1, &reply2),
+              SSDP_REPLY_NEW);
+    free_search_reply(reply2);
+    reply->replyTime = 1005;
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 1000, 2, &reply2),
+              SSDP_REPLY_NEW);
+    free_search_reply(reply2);
+
+    free_search_reply(reply);
+    EXPECT_EQ(gSsdpReplies, nullptr);
+    EXPECT_EQ(gSsdpRepliesCount, 0);
+}
+
+TEST(SsdpDeviceTestSuite, limit_rate_of_search_replies) {
+    SsdpEvent event{};
+    char st_all[]{"ssdp:all"};
+    ASSERT_EQ(ssdp_request_type(st_all, &event), 0);
+    SSockaddr srcObj;
+    SsdpSearchReply* reply[3]{};
+
+    g_UpnpSdkSsdpReplyLimit = 2;
+    srcObj = "[2001:db8::3]:50001";
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 2000, 1, &reply[0]),
+              SSDP_REPLY_NEW);
+    // Merged requests are not counted.
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 2000, 1, &reply[1]),
+              SSDP_REPLY_MERGED);
+    // The limit is per address, not per port.
+    srcObj = "[2001:db8::3]:50002";
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 2000, 1, &reply[1]),
+              SSDP_REPLY_NEW);
+    srcObj = "[2001:db8::3]:50003";
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 2000, 1, &reply[2]),
+              SSDP_REPLY_DROPPED);
+    // Another address has its own limit.
+    srcObj = "[2001:db8::4]:50003";
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 2000, 1, &reply[2]),
+              SSDP_REPLY_NEW);
+    free_search_reply(reply[2]);
+    // The next second the address may be replied again.
+    srcObj = "[2001:db8::3]:50003";
+    EXPECT_EQ(reply_add(1, 1800, &srcObj.ss, &event, 2001, 1, &reply[2]),
+              SSDP_REPLY_NEW);
+
+    for (SsdpSearchReply* r : reply)
+        free_search_reply(r);
+    EXPECT_EQ(gSsdpRepliesCount, 0);
+
+    EXPECT_EQ(::UpnpSetSsdpReplyRateLimit(-1), UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(g_UpnpSdkSsdpReplyLimit, 2);
+    EXPECT_EQ(::UpnpSetSsdpReplyRateLimit(0), UPNP_E_SUCCESS);
+    EXPECT_EQ(g_UpnpSdkSsdpReplyLimit, 0);
+}
+
+TEST(SsdpDeviceTestSuite, prepare_send_data_once) {
+    SsdpSendData send_data;
+    EXPECT_EQ(send_data.sock, INVALID_SOCKET);
+    SSockaddr saObj;
+    gIF_INDEX = 2;
+
+    // Link-local device address uses the link-local multicast group.
+    ::ssdp_prepare_send(&send_data, "http://[fe80::1]:50001/d.xml", AF_INET6);
+    saObj = send_data.mcast_addr;
+    EXPECT_EQ(saObj.netaddrp(), "[ff02::c]:1900");
+    EXPECT_EQ(reinterpret_cast<sockaddr_in6*>(&send_data.mcast_addr)
+                  ->sin6_scope_id,
+              2u);
+    EXPECT_STREQ(send_data.host, "[" SSDP_IPV6_LINKLOCAL "]");
+
+    // Global unicast device address uses the site-local multicast group.
+    ::ssdp_prepare_send(&send_data, "http://[2001:db8::1]:50001/d.xml",
+                        AF_INET6);
+    saObj = send_data.mcast_addr;
+    EXPECT_EQ(saObj.netaddrp(), "[ff05::c]:1900");
+    EXPECT_STREQ(send_data.host, "[" SSDP_IPV6_SITELOCAL "]");
+
+    ::ssdp_prepare_send(&send_data, "http://192.168.1.2:50001/d.xml", AF_INET);
+    saObj = send_data.mcast_addr;
+    EXPECT_EQ(saObj.netaddrp(), SSDP_IP ":1900");
+    EXPECT_STREQ(send_data.host, SSDP_IP);
+
+    // Invalid address family leaves no destination.
+    ::ssdp_prepare_send(&send_data, "http://192.168.1.2:50001/", AF_UNIX);
+    EXPECT_EQ(send_data.mcast_addr.ss_family, AF_UNSPEC);
+    EXPECT_STREQ(send_data.host, "");
+    EXPECT_EQ(::DeviceAdvertisement(nullptr, 0, nullptr, nullptr, 0, AF_UNIX,
+                                    0, 0, 0, &send_data),
+              UPNP_E_INVALID_PARAM);
+
+    gIF_INDEX = 0;
+}
+
+// Returns the packet without its DATE header and frees it.
+std::string without_date(char* a_packet) {
+    std::string packet{a_packet != nullptr ? a_packet : ""};
+    free(a_packet);
+    const size_t pos{packet.find("DATE: ")};
+    if (pos != std::string::npos)
+        packet.erase(pos, packet.find("\r\n", pos) + 2 - pos);
+    return packet;
+}
+
+TEST(SsdpDeviceTestSuite, device_send_data_renders_packets) {
+    Handle_Info info{};
+    strcpy(info.DescURL, "http://192.168.1.2:50001/desc.xml");
+    strcpy(info.LowerDescURL, "http://192.168.1.2:50001/desc1.xml");
+    info.MaxAge = 1800;
+    info.DeviceAf = AF_INET;
+    char nt[]{"upnp:rootdevice"};
+    char usn[]{"uuid:device-1::upnp:rootdevice"};
+    char other_url[]{"http://192.168.1.2:50001/other.xml"};
+    char* prepared;
+    char* formatted;
+
+    // Test Unit
+    ::ssdp_device_send_update(&info);
+    ASSERT_NE(info.SsdpSend, nullptr);
+    const SsdpSendData* sdata{info.SsdpSend};
+    EXPECT_NE(sdata->sock, INVALID_SOCKET);
+    EXPECT_STREQ(sdata->host, SSDP_IP);
+
+    // Rendered packets are the same as formatted ones.
+    for (int msg_type : {MSGTYPE_REPLY, MSGTYPE_ADVERTISEMENT,
+                         MSGTYPE_SHUTDOWN}) {
+        ::create_packet(sdata, msg_type, nt, usn, info.DescURL, 1800,
+                        &prepared, 0, 0, 0);
+        ::CreateServicePacket(msg_type, nt, usn, info.DescURL, 1800,
+                              &formatted, SSDP_IP, 0, 0, 0);
+        if (msg_type == MSGTYPE_REPLY)
+            EXPECT_NE(strstr(prepared, "\r\nDATE: "), nullptr);
+        EXPECT_EQ(without_date(prepared), without_date(formatted));
+    }
+
+    // Legacy or other location and other duration.
+    ::create_packet(sdata, MSGTYPE_REPLY, nt, usn, info.LowerDescURL, 1800,
+                    &prepared, 0, 0, 0);
+    ::CreateServicePacket(MSGTYPE_REPLY, nt, usn, info.LowerDescURL, 1800,
+                          &formatted, SSDP_IP, 0, 0, 0);
+    EXPECT_EQ(without_date(prepared), without_date(formatted));
+    ::create_packet(sdata, MSGTYPE_ADVERTISEMENT, nt, usn, other_url, 100,
+                    &prepared, 0, 0, 0);
+    ::CreateServicePacket(MSGTYPE_ADVERTISEMENT, nt, usn, other_url, 100,
+                          &formatted, SSDP_IP, 0, 0, 0);
+    EXPECT_EQ(without_date(prepared), without_date(formatted));
+
+    // Updated UPnP Low Power values keep the socket.
+    const SOCKET sock{sdata->sock};
+    info.PowerState = 1;
+    info.SleepPeriod = 60;
+    info.RegistrationState = 2;
+    ::ssdp_device_send_update(&info);
+    EXPECT_EQ(info.SsdpSend, sdata);
+    EXPECT_EQ(sdata->sock, sock);
+    ::create_packet(sdata, MSGTYPE_ADVERTISEMENT, nt, usn, info.DescURL, 1800,
+                    &prepared, 1, 60, 2);
+    ::CreateServicePacket(MSGTYPE_ADVERTISEMENT, nt, usn, info.DescURL, 1800,
+                          &formatted, SSDP_IP, 1, 60, 2);
+    EXPECT_EQ(without_date(prepared), without_date(formatted));
+
+    ::ssdp_device_send_free(&info);
+    EXPECT_EQ(info.SsdpSend, nullptr);
+}
+#endif
+
 } // namespace utest
 
 
@@ -0,0 +1,119 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Include source code for testing. So we have also direct access to the
+// filter in the anonymous namespace.
+#include <Compa/src/ssdp/ssdp_filter.cpp>
+
+#include <utest/utest.hpp>
+
+
+namespace utest {
+
+class SsdpFilterFTestSuite : public ::testing::Test {
+  protected:
+    SsdpFilterFTestSuite() {
+        gSsdpFilter = SsdpFilter{};
+        gSsdpFilterCtrlpts = 0;
+        gSsdpFilterDevices = 0;
+        gSsdpFilter.udns.emplace_back(
+            "uuid:12345678-9abc-def0-1234-56789abcdef0");
+        gSsdpFilter.types.emplace_back("urn:schemas-upnp-org:device:Light:");
+        gSsdpFilter.types.emplace_back(
+            "urn:schemas-upnp-org:service:SwitchPower:");
+    }
+    ~SsdpFilterFTestSuite() override {
+        gSsdpFilter = SsdpFilter{};
+        gSsdpFilterCtrlpts = 0;
+        gSsdpFilterDevices = 0;
+    }
+
+    bool accept(const std::string& a_msg) {
+        return ::ssdp_filter_accept(a_msg.c_str(), a_msg.size());
+    }
+
+    std::string msearch(const std::string& a_st) {
+        return "M-SEARCH * HTTP/1.1\r\n"
+               "HOST: 239.255.255.250:1900\r\n"
+               "MAN: \"ssdp:discover\"\r\n"
+               "MX: 1\r\n"
+               "ST: " +
+               a_st + "\r\n\r\n";
+    }
+};
+
+
+TEST(SsdpFilterTestSuite, type_length_without_version) {
+    const char type[]{"urn:schemas-upnp-org:device:Light:1"};
+    EXPECT_EQ(type_length(type, sizeof(type) - 1), sizeof(type) - 2);
+    EXPECT_EQ(type_length("nocolon", 7), 0u);
+}
+
+TEST_F(SsdpFilterFTestSuite, notify_and_responses_need_control_point) {
+    const std::string notify{"NOTIFY * HTTP/1.1\r\n"
+                             "NT: upnp:rootdevice\r\n\r\n"};
+    const std::string response{"HTTP/1.1 200 OK\r\n"
+                               "ST: upnp:rootdevice\r\n\r\n"};
+
+    gSsdpFilterDevices = 1;
+    EXPECT_FALSE(this->accept(notify));
+    EXPECT_FALSE(this->accept(response));
+
+    gSsdpFilterCtrlpts = 1;
+    EXPECT_TRUE(this->accept(notify));
+    EXPECT_TRUE(this->accept(response));
+}
+
+TEST_F(SsdpFilterFTestSuite, msearch_needs_device) {
+    gSsdpFilterCtrlpts = 1;
+    EXPECT_FALSE(this->accept(this->msearch("ssdp:all")));
+}
+
+TEST_F(SsdpFilterFTestSuite, msearch_for_registered_targets) {
+    gSsdpFilterDevices = 1;
+
+    EXPECT_TRUE(this->accept(this->msearch("ssdp:all")));
+    EXPECT_TRUE(this->accept(this->msearch("upnp:rootdevice")));
+    // Search targets are compared case insensitive.
+    EXPECT_TRUE(this->accept(this->msearch("SSDP:ALL")));
+    EXPECT_TRUE(this->accept(this->msearch("UPnP:RootDevice")));
+    EXPECT_TRUE(this->accept(
+        this->msearch("uuid:12345678-9ABC-DEF0-1234-56789ABCDEF0")));
+    // Any version of a registered type is accepted.
+    EXPECT_TRUE(
+        this->accept(this->msearch("urn:schemas-upnp-org:device:Light:1")));
+    EXPECT_TRUE(
+        this->accept(this->msearch("urn:schemas-upnp-org:device:Light:2")));
+    EXPECT_TRUE(this->accept(
+        this->msearch("urn:schemas-upnp-org:service:SwitchPower:1")));
+    // Header names are case insensitive, white space is ignored.
+    EXPECT_TRUE(this->accept("M-SEARCH * HTTP/1.1\r\nst:\tssdp:all \r\n\r\n"));
+
+    EXPECT_FALSE(this->accept(
+        this->msearch("uuid:12345678-9abc-def0-1234-000000000000")));
+    EXPECT_FALSE(
+        this->accept(this->msearch("urn:schemas-upnp-org:device:Lights:1")));
+    EXPECT_FALSE(this->accept(
+        this->msearch("urn:schemas-upnp-org:device:MediaServer:1")));
+    EXPECT_FALSE(this->accept(this->msearch("garbage")));
+    // Without ST header.
+    EXPECT_FALSE(this->accept("M-SEARCH * HTTP/1.1\r\nMX: 1\r\n\r\n"));
+}
+
+TEST_F(SsdpFilterFTestSuite, drop_unknown_messages) {
+    gSsdpFilterDevices = 1;
+    gSsdpFilterCtrlpts = 1;
+
+    EXPECT_FALSE(this->accept("GET / HTTP/1.1\r\n\r\n"));
+    EXPECT_FALSE(this->accept("This is a test message."));
+    EXPECT_FALSE(this->accept(""));
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
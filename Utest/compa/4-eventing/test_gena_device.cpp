@@ -0,0 +1,196 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Include source code for testing. So we have also direct access to the
+// functions in the anonymous namespace.
+#include <Compa/src/gena/gena_device.cpp>
+
+#include <utest/utest.hpp>
+
+
+namespace utest {
+
+constexpr char prop_status0[]{
+    "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">"
+    "<e:property><Status>0</Status></e:property>"
+    "</e:propertyset>"};
+constexpr char prop_status1_level5[]{
+    "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">"
+    "<e:property><Status>1</Status></e:property>"
+    "<e:property><Level>5</Level></e:property>"
+    "</e:propertyset>"};
+
+
+class GenaDeviceCoalesceFTestSuite : public ::testing::Test {
+  protected:
+    service_info m_service{};
+    subscription m_sub[2]{};
+    notify_event* m_active_event;
+    notify_event* m_queued_event;
+    // Creation time of the queued event.
+    time_t m_ctime{time(nullptr) - 100};
+
+    GenaDeviceCoalesceFTestSuite() {
+        // Two subscriptions with the same backlog: the active event given to
+        // the thread pool and one queued event.
+        m_active_event = ::new_notify_event(
+            "uuid:device-1", "urn:upnp-org:serviceId:Dimming1",
+            ixmlCloneDOMString(prop_status0));
+        m_queued_event = ::new_notify_event(
+            "uuid:device-1", "urn:upnp-org:serviceId:Dimming1",
+            ixmlCloneDOMString(prop_status0));
+        for (subscription& sub : m_sub) {
+            sub.active = 1;
+            ListInit(&sub.outgoing, nullptr, nullptr);
+            this->queue(&sub, m_active_event);
+            notify_thread_struct* queued = this->queue(&sub, m_queued_event);
+            queued->ctime = m_ctime;
+        }
+        strcpy(m_sub[0].sid, "uuid:sid-0");
+        strcpy(m_sub[1].sid, "uuid:sid-1");
+        m_sub[0].next = &m_sub[1];
+        m_service.subscriptionList = &m_sub[0];
+    }
+
+    ~GenaDeviceCoalesceFTestSuite() override {
+        for (subscription& sub : m_sub) {
+            ListNode* node;
+            while ((node = ListHead(&sub.outgoing)) != nullptr) {
+                ThreadPoolJob* job = (ThreadPoolJob*)node->item;
+                ::free_notify_struct(job->arg);
+                ::free_notify_job(job);
+                ListDelNode(&sub.outgoing, node, 0);
+            }
+            ListDestroy(&sub.outgoing, 0);
+        }
+    }
+
+    notify_thread_struct* queue(subscription* a_sub, notify_event* a_event) {
+        ThreadPoolJob* job = ::alloc_notify_job();
+        notify_thread_struct* ntsp =
+            ::alloc_notify_struct(a_event, a_sub->sid, 1);
+        TPJobInit(job, (UPnPsdk::start_routine)genaNotifyThread, ntsp);
+        ListAddTail(&a_sub->outgoing, job);
+        return ntsp;
+    }
+
+    static notify_thread_struct* tail(subscription* a_sub) {
+        return (notify_thread_struct*)((ThreadPoolJob*)ListTail(
+                                           &a_sub->outgoing)
+                                           ->item)
+            ->arg;
+    }
+};
+
+
+TEST(GenaDeviceTestSuite, merge_property_sets) {
+    DOMString merged = ::MergePropertySets(prop_status0, prop_status1_level5);
+    ASSERT_NE(merged, nullptr);
+    std::string merged_str{merged};
+    ixmlFreeDOMString(merged);
+
+    EXPECT_NE(merged_str.find("<Status>1</Status>"), std::string::npos);
+    EXPECT_NE(merged_str.find("<Level>5</Level>"), std::string::npos);
+    EXPECT_EQ(merged_str.find("<Status>0</Status>"), std::string::npos);
+
+    EXPECT_EQ(::MergePropertySets(prop_status0, "<no_xml"), nullptr);
+}
+
+TEST_F(GenaDeviceCoalesceFTestSuite, merge_once_for_all_subscriptions) {
+    std::vector<coalesce_merge> merges;
+
+    // The queued event shared by both subscriptions is collected once.
+    ::collectCoalesceEvents(&m_service, merges);
+    ASSERT_EQ(merges.size(), 1u);
+    EXPECT_EQ(merges[0].queued, m_queued_event);
+
+    ::mergeCoalesceEvents(merges, prop_status1_level5);
+    ASSERT_NE(merges[0].merged, nullptr);
+
+    EXPECT_EQ(::coalesceEvent(&m_sub[0].outgoing, merges), 1);
+    EXPECT_EQ(::coalesceEvent(&m_sub[1].outgoing, merges), 1);
+    ::releaseCoalesceEvents(merges);
+
+    // Both subscriptions share the merged event.
+    notify_event* merged = tail(&m_sub[0])->event;
+    EXPECT_EQ(tail(&m_sub[1])->event, merged);
+    EXPECT_EQ(merged->reference_count, 2);
+    EXPECT_EQ(ListSize(&m_sub[0].outgoing), 2);
+    std::string merged_str{merged->propertySet};
+    EXPECT_NE(merged_str.find("<Status>1</Status>"), std::string::npos);
+    EXPECT_NE(merged_str.find("<Level>5</Level>"), std::string::npos);
+
+    // The merged event keeps the age of the queued event.
+    EXPECT_EQ(tail(&m_sub[0])->ctime, m_ctime);
+    EXPECT_EQ(tail(&m_sub[1])->ctime, m_ctime);
+    int old_max_age{g_UpnpSdkEQMaxAge};
+    g_UpnpSdkEQMaxAge = 10;
+    ::maybeDiscardEvents(&m_sub[0].outgoing);
+    g_UpnpSdkEQMaxAge = old_max_age;
+    EXPECT_EQ(ListSize(&m_sub[0].outgoing), 1);
+}
+
+TEST_F(GenaDeviceCoalesceFTestSuite, active_event_is_not_merged) {
+    std::vector<coalesce_merge> merges;
+
+    // Only the active event is left in the queue of the first subscription.
+    ListNode* node = ListTail(&m_sub[0].outgoing);
+    ThreadPoolJob* job = (ThreadPoolJob*)node->item;
+    ::free_notify_struct(job->arg);
+    ::free_notify_job(job);
+    ListDelNode(&m_sub[0].outgoing, node, 0);
+
+    ::collectCoalesceEvents(&m_service, merges);
+    ::mergeCoalesceEvents(merges, prop_status1_level5);
+    EXPECT_EQ(::coalesceEvent(&m_sub[0].outgoing, merges), 0);
+    EXPECT_EQ(::coalesceEvent(&m_sub[1].outgoing, merges), 1);
+    ::releaseCoalesceEvents(merges);
+
+    EXPECT_EQ(tail(&m_sub[0])->event, m_active_event);
+}
+
+TEST_F(GenaDeviceCoalesceFTestSuite, failed_merge_queues_as_usual) {
+    std::vector<coalesce_merge> merges;
+
+    ::collectCoalesceEvents(&m_service, merges);
+    ::mergeCoalesceEvents(merges, "<no_xml");
+    EXPECT_EQ(merges[0].merged, nullptr);
+    EXPECT_EQ(::coalesceEvent(&m_sub[0].outgoing, merges), 0);
+    ::releaseCoalesceEvents(merges);
+
+    // The queued event is still alive.
+    EXPECT_EQ(tail(&m_sub[0])->event, m_queued_event);
+    EXPECT_EQ(m_queued_event->reference_count, 2);
+}
+
+TEST(GenaDeviceTestSuite, notify_done_records_metrics) {
+    ::UpnpMetricsReset();
+    notify_event* ev = ::new_notify_event("uuid:device-1",
+                                          "urn:upnp-org:serviceId:Dimming1",
+                                          ixmlCloneDOMString(prop_status0));
+    ASSERT_NE(ev, nullptr);
+
+    // The device handle is not valid so only the metrics are recorded. The
+    // notify structure is freed, and with it the event.
+    notify_thread_struct* in = ::alloc_notify_struct(ev, "uuid:sid-0", 1);
+    ASSERT_NE(in, nullptr);
+    in->start = compa::metrics_now() - 3'000'000;
+    ::genaNotifyThreadDone(in, GENA_E_NOTIFY_UNACCEPTED);
+
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_GENA_NOTIFY_OK), 0);
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_GENA_NOTIFY_FAILED), 1);
+    UpnpMetricsHistogram hist{};
+    ASSERT_EQ(::UpnpMetricsGetHistogram(UPNP_HISTOGRAM_GENA_NOTIFY, &hist),
+              UPNP_E_SUCCESS);
+    EXPECT_EQ(hist.count, 1u);
+    EXPECT_GE(hist.sum_ns, 3'000'000u);
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleMock(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
@@ -0,0 +1,261 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Shorten the timeouts of a delivery so the tests need not to wait 30 s.
+#include <config.hpp>
+#undef GENA_NOTIFICATION_SENDING_TIMEOUT
+#define GENA_NOTIFICATION_SENDING_TIMEOUT 1
+#undef GENA_NOTIFICATION_ANSWERING_TIMEOUT
+#define GENA_NOTIFICATION_ANSWERING_TIMEOUT 1
+
+// Include source code for testing. So we have also direct access to the
+// engine in the anonymous namespace.
+#include <Compa/src/gena/gena_notify.cpp>
+
+#include <utest/utest.hpp>
+#include <umock/sys_socket_mock.hpp>
+
+#include <future>
+#include <thread>
+
+
+namespace utest {
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+constexpr char sid[]{"uuid:b14e5b7c-1dd1-11b2-9b4c-a5a4f7c1a2b3"};
+constexpr char headers[]{"CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+                         "NT: upnp:event\r\n"
+                         "NTS: upnp:propchange\r\n"
+                         "CONTENT-LENGTH: 38\r\n"};
+constexpr char property_set[]{"<e:propertyset></e:propertyset>\r\n\r\n"};
+
+
+/*!
+ * \brief Control point stub listening on the IPv4 loopback interface.
+ *
+ * It accepts one connection, receives the complete NOTIFY request and answers
+ * with the given response. Without response it never accepts.
+ */
+class CCtrlptStub {
+  public:
+    CCtrlptStub() {
+        m_sock = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in saddr{};
+        socklen_t saddr_len{sizeof(saddr)};
+        saddr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &saddr.sin_addr);
+        if (::bind(m_sock, reinterpret_cast<sockaddr*>(&saddr), saddr_len) !=
+                0 ||
+            ::getsockname(m_sock, reinterpret_cast<sockaddr*>(&saddr),
+                          &saddr_len) != 0 ||
+            ::listen(m_sock, 4) != 0)
+            throw std::runtime_error("Failed to set up control point stub.");
+        m_port = ntohs(saddr.sin_port);
+    }
+    ~CCtrlptStub() {
+        if (m_thread.joinable())
+            m_thread.join();
+        CLOSE_SOCKET_P(m_sock);
+    }
+
+    std::string url() const {
+        return "<http://127.0.0.1:" + std::to_string(m_port) + "/notify>";
+    }
+
+    void answer(const std::string& a_response) {
+        m_thread = std::thread([this, a_response] {
+            SOCKET conn = ::accept(m_sock, nullptr, nullptr);
+            char buf[1024];
+            SSIZEP_T len{};
+            // The request ends with the property set.
+            while (m_request.find(property_set) == std::string::npos &&
+                   (len = ::recv(conn, buf, sizeof(buf), 0)) > 0)
+                m_request.append(buf, static_cast<size_t>(len));
+            ::send(conn, a_response.data(),
+                   static_cast<SIZEP_T>(a_response.size()), 0);
+            CLOSE_SOCKET_P(conn);
+        });
+    }
+
+    /// Request as received, valid after the delivery has finished.
+    std::string m_request;
+
+  private:
+    SOCKET m_sock{INVALID_SOCKET};
+    uint16_t m_port{};
+    std::thread m_thread;
+};
+
+
+class GenaNotifyFTestSuite : public ::testing::Test {
+  protected:
+    ThreadPool m_tp;
+    std::promise<int> m_done;
+
+    GenaNotifyFTestSuite() {
+        EXPECT_EQ(::ThreadPoolInit(&m_tp, nullptr), 0);
+        EXPECT_EQ(::genaNotifyEngineStart(&m_tp), UPNP_E_SUCCESS);
+    }
+    ~GenaNotifyFTestSuite() override {
+        ::genaNotifyEngineStop();
+        ::ThreadPoolShutdown(&m_tp);
+    }
+
+    static void done(void* a_cookie, int a_return_code) {
+        static_cast<std::promise<int>*>(a_cookie)->set_value(a_return_code);
+    }
+
+    /// Submits a delivery to the given delivery URLs.
+    int submit(const std::string& a_urls) {
+        subscription sub{};
+        strcpy(sub.sid, sid);
+        ListInit(&sub.outgoing, 0, 0);
+        std::string urls{a_urls};
+        memptr urls_ptr{urls.data(), urls.size()};
+        if (::create_url_list(&urls_ptr, &sub.DeliveryURLs) <= 0)
+            return UPNP_E_INVALID_URL;
+        int ret = ::genaNotifyEngineSubmit(&sub, headers, property_set, done,
+                                           &m_done);
+        ::freeSubscription(&sub);
+        return ret;
+    }
+
+    /// Returns the result of the delivery, or -999 if done wasn't called.
+    int result() {
+        std::future<int> result{m_done.get_future()};
+        if (result.wait_for(std::chrono::seconds(10)) !=
+            std::future_status::ready)
+            return -999;
+        return result.get();
+    }
+};
+
+
+TEST(GenaNotifyTestSuite, wakeup_socket_loops_back) {
+    SOCKET sock = create_wake_sock();
+    ASSERT_NE(sock, INVALID_SOCKET);
+
+    EXPECT_EQ(::send(sock, "W", 1, 0), 1);
+    pollfd pfd{sock, POLLIN, 0};
+    EXPECT_EQ(poll_sockets(&pfd, 1, 1000), 1);
+    char buf[4];
+    EXPECT_EQ(::recv(sock, buf, sizeof(buf), 0), 1);
+    CLOSE_SOCKET_P(sock);
+}
+
+TEST(GenaNotifyTestSuite, wakeup_socket_without_ipv6_uses_ipv4_loopback) {
+    // Mock a host with IPv6 disabled. IPv4 sockets are real.
+    NiceMock<umock::Sys_socketMock> sys_socketObj;
+    umock::Sys_socket sys_socket_injectObj(&sys_socketObj);
+    ON_CALL(sys_socketObj, socket(AF_INET6, _, _))
+        .WillByDefault(Return(INVALID_SOCKET));
+    ON_CALL(sys_socketObj, socket(AF_INET, _, _))
+        .WillByDefault([](int a_domain, int a_type, int a_protocol) {
+            return ::socket(a_domain, a_type, a_protocol);
+        });
+    ON_CALL(sys_socketObj, bind(_, _, _))
+        .WillByDefault([](SOCKET a_sock, const sockaddr* a_addr,
+                          socklen_t a_addrlen) {
+            return ::bind(a_sock, a_addr, a_addrlen);
+        });
+    ON_CALL(sys_socketObj, getsockname(_, _, _))
+        .WillByDefault(
+            [](SOCKET a_sock, sockaddr* a_addr, socklen_t* a_addrlen) {
+                return ::getsockname(a_sock, a_addr, a_addrlen);
+            });
+    ON_CALL(sys_socketObj, connect(_, _, _))
+        .WillByDefault([](SOCKET a_sock, const sockaddr* a_addr,
+                          socklen_t a_addrlen) {
+            return ::connect(a_sock, a_addr, a_addrlen);
+        });
+
+    SOCKET sock = create_wake_sock();
+    ASSERT_NE(sock, INVALID_SOCKET);
+
+    sockaddr_storage saddr{};
+    socklen_t saddr_len{sizeof(saddr)};
+    ASSERT_EQ(::getsockname(sock, reinterpret_cast<sockaddr*>(&saddr),
+                            &saddr_len),
+              0);
+    EXPECT_EQ(saddr.ss_family, AF_INET);
+    EXPECT_EQ(::send(sock, "W", 1, 0), 1);
+    pollfd pfd{sock, POLLIN, 0};
+    EXPECT_EQ(poll_sockets(&pfd, 1, 1000), 1);
+    CLOSE_SOCKET_P(sock);
+}
+
+TEST_F(GenaNotifyFTestSuite, send_notify_successful) {
+    CCtrlptStub cpObj;
+    cpObj.answer("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+    const long long sockets_open{::UpnpMetricsGet(UPNP_METRIC_SOCKETS_OPEN)};
+
+    ASSERT_EQ(this->submit(cpObj.url()), UPNP_E_SUCCESS);
+    EXPECT_EQ(this->result(), GENA_SUCCESS);
+    // The connection is closed before done is called.
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_SOCKETS_OPEN), sockets_open);
+
+    EXPECT_EQ(cpObj.m_request.rfind("NOTIFY /notify HTTP/1.1\r\n", 0), 0u);
+    EXPECT_NE(cpObj.m_request.find("\r\nSID: " + std::string(sid) + "\r\n"),
+              std::string::npos);
+    EXPECT_NE(cpObj.m_request.find("\r\nSEQ: 0\r\n\r\n"), std::string::npos);
+    EXPECT_NE(cpObj.m_request.find(property_set), std::string::npos);
+}
+
+TEST_F(GenaNotifyFTestSuite, send_notify_to_invalid_sid) {
+    CCtrlptStub cpObj;
+    cpObj.answer("HTTP/1.1 412 Precondition Failed\r\n"
+                 "Content-Length: 0\r\n\r\n");
+
+    ASSERT_EQ(this->submit(cpObj.url()), UPNP_E_SUCCESS);
+    EXPECT_EQ(this->result(), GENA_E_NOTIFY_UNACCEPTED_REMOVE_SUB);
+}
+
+TEST_F(GenaNotifyFTestSuite, send_notify_connection_refused) {
+    std::string url;
+    {
+        // Get a free port without listening on it.
+        CCtrlptStub cpObj;
+        url = cpObj.url();
+    }
+    const long long sockets_open{::UpnpMetricsGet(UPNP_METRIC_SOCKETS_OPEN)};
+
+    ASSERT_EQ(this->submit(url), UPNP_E_SUCCESS);
+    EXPECT_EQ(this->result(), UPNP_E_SOCKET_CONNECT);
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_SOCKETS_OPEN), sockets_open);
+}
+
+TEST_F(GenaNotifyFTestSuite, send_notify_without_answer_times_out) {
+    // The connection is accepted by the listen backlog but never answered.
+    CCtrlptStub cpObj;
+
+    ASSERT_EQ(this->submit(cpObj.url()), UPNP_E_SUCCESS);
+    EXPECT_EQ(this->result(), UPNP_E_TIMEDOUT);
+}
+
+TEST_F(GenaNotifyFTestSuite, stop_engine_drops_queued_deliveries) {
+    CCtrlptStub cpObj;
+
+    ASSERT_EQ(this->submit(cpObj.url()), UPNP_E_SUCCESS);
+    ::genaNotifyEngineStop();
+    EXPECT_EQ(this->result(), UPNP_E_FINISH);
+    EXPECT_FALSE(::genaNotifyEngineIsRunning());
+
+    // A stopped engine doesn't take deliveries and never calls done.
+    std::promise<int> done_after_stop;
+    m_done.swap(done_after_stop);
+    EXPECT_EQ(this->submit(cpObj.url()), UPNP_E_FINISH);
+    EXPECT_EQ(m_done.get_future().wait_for(std::chrono::milliseconds(100)),
+              std::future_status::timeout);
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleMock(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
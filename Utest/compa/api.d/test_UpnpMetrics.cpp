@@ -0,0 +1,163 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+
+#include <metrics.hpp>
+#include <upnp.hpp>
+
+#include <utest/utest.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace utest {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+
+class UpnpMetricsFTestSuite : public ::testing::Test {
+  protected:
+    UpnpMetricsFTestSuite() { ::UpnpMetricsReset(); }
+    ~UpnpMetricsFTestSuite() override { ::UpnpSetMetricsPath(nullptr); }
+
+    std::string export_text() {
+        size_t len{};
+        EXPECT_EQ(::UpnpMetricsExport(nullptr, &len), UPNP_E_BUFFER_TOO_SMALL);
+        std::string text(len, '\0');
+        EXPECT_EQ(::UpnpMetricsExport(text.data(), &len), UPNP_E_SUCCESS);
+        text.resize(len - 1);
+        return text;
+    }
+};
+
+
+TEST(UpnpMetricsTestSuite, histogram_buckets) {
+    EXPECT_EQ(compa::metrics_bucket(0), 0);
+    EXPECT_EQ(compa::metrics_bucket(1000), 0);
+    EXPECT_EQ(compa::metrics_bucket(1001), 1);
+    EXPECT_EQ(compa::metrics_bucket(2000), 1);
+    EXPECT_EQ(compa::metrics_bucket(2001), 2);
+    EXPECT_EQ(compa::metrics_bucket(1'000'000), 10);
+    EXPECT_EQ(compa::metrics_bucket(~0ULL), UPNP_METRICS_BUCKETS - 1);
+}
+
+TEST_F(UpnpMetricsFTestSuite, count_from_several_threads) {
+    constexpr int threads{8};
+    constexpr int loops{10000};
+
+    std::vector<std::thread> pool;
+    for (int i{0}; i < threads; i++) {
+        pool.emplace_back([] {
+            for (int j{0}; j < loops; j++)
+                compa::metrics_add(UPNP_METRIC_SSDP_IN_NOTIFY);
+        });
+    }
+    for (std::thread& thread : pool)
+        thread.join();
+
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_SSDP_IN_NOTIFY), threads * loops);
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_SSDP_IN_MSEARCH), 0);
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_COUNT), 0);
+}
+
+TEST_F(UpnpMetricsFTestSuite, gauge_is_not_reset) {
+    const long long open{::UpnpMetricsGet(UPNP_METRIC_SOCKETS_OPEN)};
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN);
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
+    ::UpnpMetricsReset();
+    EXPECT_EQ(::UpnpMetricsGet(UPNP_METRIC_SOCKETS_OPEN), open + 1);
+    compa::metrics_add(UPNP_METRIC_SOCKETS_OPEN, -1);
+}
+
+TEST_F(UpnpMetricsFTestSuite, observe_histogram) {
+    compa::metrics_observe(UPNP_HISTOGRAM_GENA_NOTIFY, 500);
+    compa::metrics_observe(UPNP_HISTOGRAM_GENA_NOTIFY, 3'000);
+    compa::metrics_observe(UPNP_HISTOGRAM_GENA_NOTIFY, 3'500);
+
+    UpnpMetricsHistogram hist;
+    ASSERT_EQ(::UpnpMetricsGetHistogram(UPNP_HISTOGRAM_GENA_NOTIFY, &hist),
+              UPNP_E_SUCCESS);
+    EXPECT_EQ(hist.count, 3u);
+    EXPECT_EQ(hist.sum_ns, 7'000u);
+    EXPECT_EQ(hist.bucket[0], 1u);
+    EXPECT_EQ(hist.bucket[2], 2u);
+
+    EXPECT_EQ(::UpnpMetricsGetHistogram(UPNP_HISTOGRAM_COUNT, &hist),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(::UpnpMetricsGetHistogram(UPNP_HISTOGRAM_GENA_NOTIFY, nullptr),
+              UPNP_E_INVALID_PARAM);
+}
+
+TEST_F(UpnpMetricsFTestSuite, count_http_responses_of_a_request) {
+    // Not within a request.
+    compa::metrics_http_response(200);
+
+    compa::metrics_http_request(2); // HTTPMETHOD_GET
+    compa::metrics_http_response(200);
+    compa::metrics_http_response(404);
+    compa::metrics_http_request(-1);
+
+    std::string text = this->export_text();
+    EXPECT_THAT(text, HasSubstr("upnp_http_requests_total{method=\"GET\","
+                                "code=\"2xx\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("upnp_http_requests_total{method=\"GET\","
+                                "code=\"4xx\"} 1\n"));
+    EXPECT_THAT(text, Not(HasSubstr("method=\"UNKNOWN\"")));
+}
+
+TEST_F(UpnpMetricsFTestSuite, export_text) {
+    compa::metrics_add(UPNP_METRIC_SSDP_OUT_MSEARCH, 3);
+    compa::metrics_add(UPNP_METRIC_GENA_NOTIFY_FAILED);
+    compa::metrics_observe(UPNP_HISTOGRAM_GENA_NOTIFY, 1'500'000);
+
+    std::string text = this->export_text();
+    EXPECT_THAT(text, HasSubstr("# TYPE upnp_ssdp_packets_total counter\n"));
+    EXPECT_THAT(text, HasSubstr("upnp_ssdp_packets_total{direction=\"out\","
+                                "type=\"msearch\"} 3\n"));
+    EXPECT_THAT(text,
+                HasSubstr("upnp_gena_notify_total{result=\"failure\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("upnp_gena_notify_duration_seconds_bucket{le="
+                                "\"0.001024\"} 0\n"));
+    EXPECT_THAT(text, HasSubstr("upnp_gena_notify_duration_seconds_bucket{le="
+                                "\"0.002048\"} 1\n"));
+    EXPECT_THAT(text,
+                HasSubstr("upnp_gena_notify_duration_seconds_sum 0.0015"));
+    EXPECT_THAT(text, HasSubstr("upnp_gena_notify_duration_seconds_count 1\n"));
+    // Without initialized library there are no thread pools.
+    EXPECT_THAT(text, Not(HasSubstr("upnp_threadpool")));
+
+    size_t len{10};
+    char buf[10];
+    EXPECT_EQ(::UpnpMetricsExport(buf, &len), UPNP_E_BUFFER_TOO_SMALL);
+    EXPECT_EQ(len, text.size() + 1);
+    EXPECT_EQ(::UpnpMetricsExport(buf, nullptr), UPNP_E_INVALID_PARAM);
+}
+
+TEST_F(UpnpMetricsFTestSuite, set_metrics_path) {
+    EXPECT_FALSE(compa::metrics_is_path("/metrics", 8));
+
+    EXPECT_EQ(::UpnpSetMetricsPath("/metrics"), UPNP_E_SUCCESS);
+    EXPECT_TRUE(compa::metrics_is_path("/metrics", 8));
+    EXPECT_TRUE(compa::metrics_is_path("/metrics/more", 8));
+    EXPECT_FALSE(compa::metrics_is_path("/metrics/more", 13));
+    EXPECT_FALSE(compa::metrics_is_path("/metric", 7));
+
+    EXPECT_EQ(::UpnpSetMetricsPath("metrics"), UPNP_E_INVALID_PARAM);
+    EXPECT_TRUE(compa::metrics_is_path("/metrics", 8));
+
+    EXPECT_EQ(::UpnpSetMetricsPath(std::string(LINE_SIZE, '/').c_str()),
+              UPNP_E_INVALID_PARAM);
+
+    EXPECT_EQ(::UpnpSetMetricsPath(""), UPNP_E_SUCCESS);
+    EXPECT_FALSE(compa::metrics_is_path("/metrics", 8));
+}
+
+} // namespace utest
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+
+#include <UpnpPropertySet.hpp>
+#include <API.hpp>
+
+#include <utest/utest.hpp>
+
+#include <string>
+
+
+namespace utest {
+
+// Testsuite
+// =========
+TEST(UpnpPropertySetTestSuite, empty_property_set) {
+    UpnpPropertySet* propset = UpnpPropertySet_new();
+    ASSERT_NE(propset, nullptr);
+
+    EXPECT_STREQ(UpnpPropertySet_get_String(propset),
+                 "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n"
+                 "</e:propertyset>\n\n");
+    EXPECT_EQ(UpnpPropertySet_get_Length(propset),
+              strlen(UpnpPropertySet_get_String(propset)));
+    EXPECT_EQ(UpnpPropertySet_get_Count(propset), 0);
+
+    UpnpPropertySet_delete(propset);
+}
+
+TEST(UpnpPropertySetTestSuite, add_properties_and_clear) {
+    UpnpPropertySet* propset = UpnpPropertySet_new();
+    ASSERT_NE(propset, nullptr);
+
+    EXPECT_EQ(UpnpPropertySet_add(propset, "Volume", "42"), UPNP_E_SUCCESS);
+    EXPECT_EQ(UpnpPropertySet_addRaw(propset, "Title", "a&amp;b"),
+              UPNP_E_SUCCESS);
+    EXPECT_EQ(UpnpPropertySet_get_Count(propset), 2);
+    EXPECT_STREQ(UpnpPropertySet_get_String(propset),
+                 "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n"
+                 "<e:property>\n<Volume>42</Volume>\n</e:property>\n"
+                 "<e:property>\n<Title>a&amp;b</Title>\n</e:property>\n"
+                 "</e:propertyset>\n\n");
+    EXPECT_EQ(UpnpPropertySet_get_Length(propset),
+              strlen(UpnpPropertySet_get_String(propset)));
+
+    UpnpPropertySet_clear(propset);
+    EXPECT_EQ(UpnpPropertySet_get_Count(propset), 0);
+    EXPECT_STREQ(UpnpPropertySet_get_String(propset),
+                 "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n"
+                 "</e:propertyset>\n\n");
+
+    UpnpPropertySet_delete(propset);
+}
+
+TEST(UpnpPropertySetTestSuite, escape_value) {
+    UpnpPropertySet* propset = UpnpPropertySet_new();
+    ASSERT_NE(propset, nullptr);
+
+    EXPECT_EQ(UpnpPropertySet_add(propset, "Name", "<a href=\"x\">&'</a>"),
+              UPNP_E_SUCCESS);
+    EXPECT_STREQ(UpnpPropertySet_get_String(propset),
+                 "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n"
+                 "<e:property>\n<Name>&lt;a href=&quot;x&quot;&gt;&amp;&apos;"
+                 "&lt;/a&gt;</Name>\n</e:property>\n"
+                 "</e:propertyset>\n\n");
+
+    UpnpPropertySet_delete(propset);
+}
+
+TEST(UpnpPropertySetTestSuite, grow_buffer) {
+    UpnpPropertySet* propset = UpnpPropertySet_new();
+    ASSERT_NE(propset, nullptr);
+
+    std::string value(1000, 'x');
+    value += '&';
+    for (int i{0}; i < 100; i++) {
+        ASSERT_EQ(UpnpPropertySet_add(propset, "LongValue", value.c_str()),
+                  UPNP_E_SUCCESS);
+    }
+    EXPECT_EQ(UpnpPropertySet_get_Count(propset), 100);
+    std::string propset_str{UpnpPropertySet_get_String(propset)};
+    EXPECT_EQ(UpnpPropertySet_get_Length(propset), propset_str.size());
+    EXPECT_EQ(propset_str.find(value + "<"), std::string::npos);
+    EXPECT_NE(propset_str.find(std::string(1000, 'x') + "&amp;</LongValue>"),
+              std::string::npos);
+    EXPECT_EQ(propset_str.substr(propset_str.size() - 18),
+              "</e:propertyset>\n\n");
+
+    UpnpPropertySet_delete(propset);
+}
+
+TEST(UpnpPropertySetTestSuite, invalid_arguments) {
+    UpnpPropertySet* propset = UpnpPropertySet_new();
+    ASSERT_NE(propset, nullptr);
+
+    EXPECT_EQ(UpnpPropertySet_add(nullptr, "Name", "value"),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpPropertySet_add(propset, nullptr, "value"),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpPropertySet_add(propset, "", "value"),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpPropertySet_addRaw(propset, "Name", nullptr),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpPropertySet_get_Count(propset), 0);
+
+    UpnpPropertySet_delete(propset);
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
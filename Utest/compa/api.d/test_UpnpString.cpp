@@ -1,7 +1,8 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-08-18
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #include <UpnpString.hpp>
+#include <UpnpDiscovery.hpp>
 #if defined UPnPsdk_WITH_NATIVE_PUPNP && !defined PUPNP_UPNPSTRING_HPP
 #error "Wrong UpnpString.hpp header file included for PUPNP"
 #endif
@@ -36,6 +37,12 @@ struct s_UpnpString {
     /*! \brief Pointer to a dynamically allocated area that holds the NULL
      * terminated string. */
     char* m_string;
+    /*! \brief Embedded buffer behind this structure, or NULL if the object
+     * was created with UpnpString_new(). */
+    char* m_buffer;
+    /*! \brief Max. string length excluding terminating null byte ('\0') that
+     * fits into the embedded buffer. */
+    size_t m_capacity;
 };
 
 namespace utest {
@@ -95,7 +102,9 @@ TEST(UpnpStringMockTestSuite, create_new_upnp_string) {
 TEST(UpnpStringMockTestSuite, delete_upnp_string) {
     // provide an UpnpString
     char mstring[] = "hello world";
-    UpnpString upnpstr = {11, mstring};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 11;
+    upnpstr.m_string = mstring;
     UpnpString* p = &upnpstr;
 
     // Test Unit, check edge condition
@@ -118,7 +127,9 @@ TEST(UpnpStringMockTestSuite, delete_upnp_string) {
 TEST_F(UpnpStringFTestSuite, set_upnp_string) {
     // provide an empty UpnpString
     char mstring1[]{""};
-    UpnpString upnpstr{0, mstring1};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 0;
+    upnpstr.m_string = mstring1;
     UpnpString* p = &upnpstr;
 
     char mstring2[]{"set string"}; // This string will be set to the UpnpString.
@@ -145,7 +156,9 @@ TEST_F(UpnpStringFTestSuite, set_upnp_string) {
 TEST_F(UpnpStringFTestSuite, set_upnp_string_n) {
     // provide an empty UpnpString
     char mstring_empty[]{""};
-    UpnpString upnpstr{0, mstring_empty};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 0;
+    upnpstr.m_string = mstring_empty;
     UpnpString* p = &upnpstr;
 
     char mstring2[]{"hello world"}; // This string will set to the UpnpString.
@@ -256,7 +269,9 @@ TEST(UpnpStringTestSuite, strndup_called_with_various_parameter) {
 TEST(UpnpStringTestSuite, clear_upnp_string) {
     // provide an UpnpString
     char mstring[]{"hello world"};
-    UpnpString upnpstr{11, mstring};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 11;
+    upnpstr.m_string = mstring;
     UpnpString* p = &upnpstr;
 
     // call the unit
@@ -265,6 +280,45 @@ TEST(UpnpStringTestSuite, clear_upnp_string) {
     EXPECT_STREQ(upnpstr.m_string, "");
 }
 
+TEST(UpnpStringTestSuite, strings_of_discovery_object) {
+    // The strings of an UpnpDiscovery object are embedded into its memory
+    // allocation as long as they fit into the buffer, otherwise they are
+    // allocated. Switching between both must always hold the right value.
+    const std::string long_str(300, 'x');
+
+    UpnpDiscovery* p = UpnpDiscovery_new();
+    ASSERT_NE(p, nullptr);
+    EXPECT_STREQ(UpnpDiscovery_get_DeviceID_cstr(p), "");
+    EXPECT_STREQ(UpnpDiscovery_get_Ext_cstr(p), "");
+
+    ASSERT_TRUE(UpnpDiscovery_strcpy_DeviceID(p, "uuid:short"));
+    EXPECT_STREQ(UpnpDiscovery_get_DeviceID_cstr(p), "uuid:short");
+    EXPECT_EQ(UpnpDiscovery_get_DeviceID_Length(p), (size_t)10);
+
+    ASSERT_TRUE(UpnpDiscovery_strcpy_DeviceID(p, long_str.c_str()));
+    EXPECT_EQ(UpnpDiscovery_get_DeviceID_cstr(p), long_str);
+    EXPECT_EQ(UpnpDiscovery_get_DeviceID_Length(p), long_str.size());
+
+    ASSERT_TRUE(UpnpDiscovery_strncpy_DeviceID(p, "uuid:again", 4));
+    EXPECT_STREQ(UpnpDiscovery_get_DeviceID_cstr(p), "uuid");
+
+    // Other strings are not touched.
+    ASSERT_TRUE(UpnpDiscovery_strcpy_Ext(p, long_str.c_str()));
+    ASSERT_TRUE(UpnpDiscovery_strcpy_Date(p, "Sun, 18 Oct 2026 10:00:00 GMT"));
+    EXPECT_STREQ(UpnpDiscovery_get_DeviceID_cstr(p), "uuid");
+    EXPECT_EQ(UpnpDiscovery_get_Ext_cstr(p), long_str);
+    EXPECT_STREQ(UpnpDiscovery_get_Date_cstr(p),
+                 "Sun, 18 Oct 2026 10:00:00 GMT");
+
+    UpnpDiscovery* q = UpnpDiscovery_dup(p);
+    ASSERT_NE(q, nullptr);
+    EXPECT_STREQ(UpnpDiscovery_get_DeviceID_cstr(q), "uuid");
+    EXPECT_EQ(UpnpDiscovery_get_Ext_cstr(q), long_str);
+
+    UpnpDiscovery_delete(q);
+    UpnpDiscovery_delete(p);
+}
+
 // testsuite with death tests
 //---------------------------
 // Test suites with a name ending in “DeathTest” are run before all other tests.
@@ -274,7 +328,9 @@ TEST(UpnpStringTestSuite, clear_upnp_string) {
 TEST(UpnpStringDeathTest, upnp_string_get_length) {
     // provide an UpnpString
     char mstring[] = "hello world";
-    UpnpString upnpstr{11, mstring};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 11;
+    upnpstr.m_string = mstring;
     UpnpString* p = &upnpstr;
 
     EXPECT_EQ(NS::UpnpString_get_Length(p), (size_t)11);
@@ -299,7 +355,9 @@ TEST(UpnpStringDeathTest, upnp_string_get_length) {
 TEST(UpnpStringDeathTest, get_upnp_string) {
     // provide an UpnpString
     char mstring[] = "hello world";
-    UpnpString upnpstr = {11, mstring};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 11;
+    upnpstr.m_string = mstring;
     UpnpString* p = &upnpstr;
 
     EXPECT_STREQ(NS::UpnpString_get_String(p), "hello world");
@@ -338,7 +396,9 @@ TEST(UpnpStringDeathTest, set_upnp_string_with_nullptr) {
 TEST(UpnpStringDeathTest, set_upnp_string_with_nullptr_to_string) {
     // provide an UpnpString
     char mstring[]{"hello world"};
-    UpnpString upnpstr{11, mstring};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 11;
+    upnpstr.m_string = mstring;
     UpnpString* p{&upnpstr};
 
     if (old_code) {
@@ -382,7 +442,9 @@ TEST(UpnpStringDeathTest, set_upnp_string_n_with_nullptr) {
 TEST(UpnpStringDeathTest, set_upnp_string_n_with_nullptr_to_string) {
     // provide an UpnpString
     char mstring[]{"hello world"};
-    UpnpString upnpstr{11, mstring};
+    UpnpString upnpstr{};
+    upnpstr.m_length = 11;
+    upnpstr.m_string = mstring;
     UpnpString* p{&upnpstr};
 
     if (old_code) {
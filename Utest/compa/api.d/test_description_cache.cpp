@@ -0,0 +1,134 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Include source code for testing. So we have also direct access to the
+// cache in the anonymous namespace.
+#include <Compa/src/api/description_cache.cpp>
+
+#include <utest/utest.hpp>
+
+
+namespace utest {
+
+/// \brief Collects the results of the requests.
+struct Results {
+    std::vector<int> ret_codes;
+    std::vector<std::string> root_names;
+};
+
+class DescriptionCacheFTestSuite : public ::testing::Test {
+  protected:
+    Results m_results;
+
+    DescriptionCacheFTestSuite() {
+        ::description_cache_clear();
+        // There is no thread pool. Downloads are completed by the test.
+        gDescJobs = DESCRIPTION_FETCH_JOBS;
+    }
+    ~DescriptionCacheFTestSuite() override {
+        gDescJobs = 0;
+        ::description_cache_clear();
+    }
+
+    static void collect(int a_ret_code, const char*, IXML_Document* a_xml,
+                        const void* a_cookie) {
+        Results* results =
+            static_cast<Results*>(const_cast<void*>(a_cookie));
+        results->ret_codes.push_back(a_ret_code);
+        if (a_xml != nullptr) {
+            results->root_names.emplace_back(
+                ixmlNode_getNodeName(ixmlNode_getFirstChild(&a_xml->n)));
+            ixmlDocument_free(a_xml);
+        }
+    }
+
+    int fetch(const char* a_url) {
+        return ::description_fetch(a_url, collect, &m_results);
+    }
+};
+
+constexpr char url[]{"http://192.168.1.2:50001/desc.xml"};
+constexpr char xml[]{"<?xml version=\"1.0\"?><root><device/></root>"};
+
+
+TEST_F(DescriptionCacheFTestSuite, download_once_for_concurrent_requests) {
+    EXPECT_EQ(this->fetch(url), UPNP_E_SUCCESS);
+    EXPECT_EQ(this->fetch(url), UPNP_E_SUCCESS);
+    EXPECT_EQ(this->fetch(url), UPNP_E_SUCCESS);
+    ASSERT_EQ(gDescQueue.size(), 1u);
+    EXPECT_TRUE(m_results.ret_codes.empty());
+
+    complete_fetch(url, UPNP_E_SUCCESS, strdup(xml), "\"1\"", "");
+    EXPECT_EQ(m_results.ret_codes, std::vector<int>(3, UPNP_E_SUCCESS));
+    EXPECT_EQ(m_results.root_names, std::vector<std::string>(3, "root"));
+    EXPECT_EQ(gDescCache[url].etag, "\"1\"");
+}
+
+TEST_F(DescriptionCacheFTestSuite, fresh_document_from_cache) {
+    this->fetch(url);
+    gDescQueue.clear();
+    complete_fetch(url, UPNP_E_SUCCESS, strdup(xml), "", "");
+
+    // Delivered without download.
+    EXPECT_EQ(this->fetch(url), UPNP_E_SUCCESS);
+    EXPECT_TRUE(gDescQueue.empty());
+    EXPECT_EQ(m_results.ret_codes.size(), 2u);
+    EXPECT_EQ(m_results.root_names.size(), 2u);
+}
+
+TEST_F(DescriptionCacheFTestSuite, revalidate_old_document) {
+    this->fetch(url);
+    gDescQueue.clear();
+    complete_fetch(url, UPNP_E_SUCCESS, strdup(xml), "\"1\"", "");
+    gDescCache[url].fetched -=
+        std::chrono::seconds(DESCRIPTION_CACHE_FRESH_TIME + 1);
+
+    // The old document is downloaded again, but is not modified.
+    this->fetch(url);
+    EXPECT_EQ(gDescQueue.size(), 1u);
+    complete_fetch(url, HTTP_NOT_MODIFIED, nullptr, "", "");
+    EXPECT_EQ(m_results.ret_codes, std::vector<int>(2, UPNP_E_SUCCESS));
+    EXPECT_EQ(m_results.root_names, std::vector<std::string>(2, "root"));
+    EXPECT_EQ(gDescCache[url].etag, "\"1\"");
+}
+
+TEST_F(DescriptionCacheFTestSuite, failed_download_is_not_cached) {
+    this->fetch(url);
+    complete_fetch(url, HTTP_NOT_FOUND, nullptr, "", "");
+    EXPECT_EQ(m_results.ret_codes, std::vector<int>{UPNP_E_INVALID_URL});
+    EXPECT_TRUE(m_results.root_names.empty());
+    EXPECT_FALSE(gDescCache.contains(url));
+}
+
+TEST_F(DescriptionCacheFTestSuite, evict_least_recently_used) {
+    for (int i{0}; i < DESCRIPTION_CACHE_SIZE; i++) {
+        DescEntry& entry{gDescCache["http://host/" + std::to_string(i)]};
+        entry.doc = xml;
+        entry.used = ++gDescUsed;
+    }
+    // Use the oldest entry again.
+    gDescCache["http://host/0"].used = ++gDescUsed;
+
+    this->fetch(url);
+    EXPECT_EQ(gDescCache.size(), static_cast<size_t>(DESCRIPTION_CACHE_SIZE));
+    EXPECT_TRUE(gDescCache.contains("http://host/0"));
+    EXPECT_FALSE(gDescCache.contains("http://host/1"));
+    EXPECT_TRUE(gDescCache.contains(url));
+}
+
+TEST_F(DescriptionCacheFTestSuite, clear_finishes_waiting_requests) {
+    this->fetch(url);
+    ::description_cache_clear();
+    EXPECT_EQ(m_results.ret_codes, std::vector<int>{UPNP_E_FINISH});
+    EXPECT_TRUE(gDescCache.empty());
+    EXPECT_TRUE(gDescQueue.empty());
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
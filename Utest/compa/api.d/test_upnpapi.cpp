@@ -1,5 +1,5 @@
 // Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-05-12
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #ifdef UPnPsdk_WITH_NATIVE_PUPNP
 #include <Pupnp/upnp/src/api/upnpapi.cpp>
@@ -158,9 +158,12 @@ class UpnpapiFTestSuite : public ::testing::Test {
         memset(&GlobalHndRWLock, 0xAA, sizeof(GlobalHndRWLock));
         memset(&gUpnpSdkNLSuuid, 0xAA, sizeof(gUpnpSdkNLSuuid));
         memset(&HandleTable, 0xAA, sizeof(HandleTable));
-        memset(&gSendThreadPool, 0xAA, sizeof(gSendThreadPool));
-        memset(&gRecvThreadPool, 0xAA, sizeof(gRecvThreadPool));
-        memset(&gMiniServerThreadPool, 0xAA, sizeof(gMiniServerThreadPool));
+        memset(static_cast<void*>(&gSendThreadPool), 0xAA,
+               sizeof(gSendThreadPool));
+        memset(static_cast<void*>(&gRecvThreadPool), 0xAA,
+               sizeof(gRecvThreadPool));
+        memset(static_cast<void*>(&gMiniServerThreadPool), 0xAA,
+               sizeof(gMiniServerThreadPool));
         memset(&gTimerThread, 0xAA, sizeof(gTimerThread));
         memset(&bWebServerState, 0xAA, sizeof(bWebServerState));
         memset(&sdkInit_mutex, 0xAA, sizeof(sdkInit_mutex));
@@ -370,6 +373,140 @@ TEST_F(UpnpapiFTestSuite, UpnpFinish_without_initialization) {
     EXPECT_EQ(UpnpSdkInit, 0);
 }
 
+#ifndef UPnPsdk_WITH_NATIVE_PUPNP
+TEST_F(UpnpapiFTestSuite, set_thread_pool_limits) {
+    sdkInit_mutex = PTHREAD_MUTEX_INITIALIZER;
+    UpnpSdkInit = 0;
+
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_COUNT, 1, 2, 0),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_SEND, 0, 2, 0),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_SEND, 3, 2, 0),
+              UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_SEND, 1, 2, -1),
+              UPNP_E_INVALID_PARAM);
+
+    // Test Unit
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_SEND, 2, 30, 10),
+              UPNP_E_SUCCESS);
+    EXPECT_EQ(threadPoolLimits[UPNP_THREADPOOL_SEND].tp, &gSendThreadPool);
+    EXPECT_EQ(threadPoolLimits[UPNP_THREADPOOL_SEND].minThreads, 2);
+    EXPECT_EQ(threadPoolLimits[UPNP_THREADPOOL_SEND].maxThreads, 30);
+    EXPECT_EQ(threadPoolLimits[UPNP_THREADPOOL_SEND].targetWaitTime, 10);
+    EXPECT_EQ(threadPoolLimits[UPNP_THREADPOOL_RECV].maxThreads, MAX_THREADS);
+
+    // Not possible after initialization.
+    UpnpSdkInit = 1;
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_RECV, 1, 2, 0),
+              UPNP_E_INIT);
+    EXPECT_EQ(threadPoolLimits[UPNP_THREADPOOL_RECV].maxThreads, MAX_THREADS);
+    UpnpSdkInit = 0;
+
+    // Restore the defaults.
+    EXPECT_EQ(UpnpSetThreadPoolLimits(UPNP_THREADPOOL_SEND, MIN_THREADS,
+                                      MAX_THREADS, THREAD_TARGET_WAIT_TIME),
+              UPNP_E_SUCCESS);
+}
+
+#ifdef COMPA_HAVE_WEBSERVER
+TEST_F(UpnpapiFTestSuite, set_miniserver_acceptors) {
+    sdkInit_mutex = PTHREAD_MUTEX_INITIALIZER;
+    UpnpSdkInit = 0;
+
+    EXPECT_EQ(UpnpSetMiniServerAcceptors(0), UPNP_E_INVALID_PARAM);
+    EXPECT_EQ(UpnpSetMiniServerAcceptors(MINISERVER_MAX_ACCEPTORS + 1),
+              UPNP_E_INVALID_PARAM);
+
+    // Test Unit
+    EXPECT_EQ(UpnpSetMiniServerAcceptors(4), UPNP_E_SUCCESS);
+    EXPECT_EQ(g_UpnpSdkMiniServerAcceptors, 4);
+
+    // Not possible after initialization.
+    UpnpSdkInit = 1;
+    EXPECT_EQ(UpnpSetMiniServerAcceptors(2), UPNP_E_INIT);
+    EXPECT_EQ(g_UpnpSdkMiniServerAcceptors, 4);
+    UpnpSdkInit = 0;
+
+    // Restore the default.
+    EXPECT_EQ(UpnpSetMiniServerAcceptors(MINISERVER_ACCEPTORS),
+              UPNP_E_SUCCESS);
+}
+#endif
+
+#ifdef COMPA_HAVE_DEVICE_GENA
+TEST_F(UpnpapiFTestSuite, set_async_event_delivery) {
+    sdkInit_mutex = PTHREAD_MUTEX_INITIALIZER;
+    UpnpSdkInit = 0;
+
+    // Test Unit
+    EXPECT_EQ(UpnpSetAsyncEventDelivery(5), UPNP_E_SUCCESS);
+    EXPECT_EQ(g_UpnpSdkAsyncNotify, 1);
+
+    // Not possible after initialization.
+    UpnpSdkInit = 1;
+    EXPECT_EQ(UpnpSetAsyncEventDelivery(0), UPNP_E_INIT);
+    EXPECT_EQ(g_UpnpSdkAsyncNotify, 1);
+    UpnpSdkInit = 0;
+
+    // Restore the default.
+    EXPECT_EQ(UpnpSetAsyncEventDelivery(0), UPNP_E_SUCCESS);
+    EXPECT_EQ(g_UpnpSdkAsyncNotify, 0);
+}
+
+TEST_F(UpnpapiFTestSuite, set_event_coalescing) {
+    UpnpSdkInit = 1;
+
+    // Test Unit, also possible after initialization.
+    EXPECT_EQ(UpnpSetEventCoalescing(5), UPNP_E_SUCCESS);
+    EXPECT_EQ(g_UpnpSdkEQCoalesce, 1);
+    EXPECT_EQ(UpnpSetEventCoalescing(0), UPNP_E_SUCCESS);
+    EXPECT_EQ(g_UpnpSdkEQCoalesce, 0);
+    UpnpSdkInit = 0;
+}
+#endif
+
+#ifdef TP_HAVE_AFFINITY
+TEST_F(UpnpapiFTestSuite, set_thread_pool_cpus) {
+    sdkInit_mutex = PTHREAD_MUTEX_INITIALIZER;
+    UpnpSdkInit = 0;
+    cpu_set_t& cpuSet{threadPoolLimits[UPNP_THREADPOOL_MINISERVER].cpuSet};
+
+    // Test Unit
+    EXPECT_EQ(UpnpSetThreadPoolCpus(UPNP_THREADPOOL_MINISERVER, "0-2,5,7-7"),
+              UPNP_E_SUCCESS);
+    EXPECT_EQ(CPU_COUNT(&cpuSet), 5);
+    EXPECT_TRUE(CPU_ISSET(0, &cpuSet));
+    EXPECT_TRUE(CPU_ISSET(2, &cpuSet));
+    EXPECT_FALSE(CPU_ISSET(3, &cpuSet));
+    EXPECT_TRUE(CPU_ISSET(5, &cpuSet));
+    EXPECT_TRUE(CPU_ISSET(7, &cpuSet));
+
+    // Invalid lists do not modify the set.
+    for (const char* cpus : {"a", "1,", ",1", "1-", "3-1", "1;2", "-1",
+                             "1- 2", "100000"}) {
+        EXPECT_EQ(UpnpSetThreadPoolCpus(UPNP_THREADPOOL_MINISERVER, cpus),
+                  UPNP_E_INVALID_PARAM)
+            << "  with \"" << cpus << "\"";
+    }
+    EXPECT_EQ(CPU_COUNT(&cpuSet), 5);
+    EXPECT_EQ(UpnpSetThreadPoolCpus(UPNP_THREADPOOL_COUNT, "0"),
+              UPNP_E_INVALID_PARAM);
+
+    UpnpSdkInit = 1;
+    EXPECT_EQ(UpnpSetThreadPoolCpus(UPNP_THREADPOOL_MINISERVER, "1"),
+              UPNP_E_INIT);
+    UpnpSdkInit = 0;
+
+    EXPECT_EQ(UpnpSetThreadPoolCpus(UPNP_THREADPOOL_MINISERVER, nullptr),
+              UPNP_E_SUCCESS);
+    EXPECT_EQ(CPU_COUNT(&cpuSet), 0);
+    EXPECT_EQ(UpnpSetThreadPoolCpus(UPNP_THREADPOOL_MINISERVER, ""),
+              UPNP_E_SUCCESS);
+}
+#endif
+#endif
+
 TEST_F(UpnpapiFTestSuite, webserver_enable_and_disable) {
     // Note that UpnpSetWebServerRootDir(<rootDir>) also enables the webserver,
     //  and that UpnpSetWebServerRootDir(nullptr) also disables the webserver.
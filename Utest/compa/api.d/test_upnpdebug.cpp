@@ -1,5 +1,5 @@
 // Copyright (C) 2022+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2024-08-18
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #ifdef UPnPsdk_WITH_NATIVE_PUPNP
 #include <Pupnp/upnp/src/api/upnpdebug.cpp>
@@ -15,6 +15,8 @@ FILE*& filed{fp}; // Other alias for variable fp
 #include <umock/pthread_mock.hpp>
 #include <umock/stdio_mock.hpp>
 
+#include <thread>
+
 namespace utest {
 
 using ::testing::_;
@@ -133,6 +135,91 @@ TEST_F(UpnpdebugFTestSuite, UpnpPrintf_successful) {
     ::UpnpCloseLog();
 }
 
+#ifndef UPnPsdk_WITH_NATIVE_PUPNP
+TEST_F(UpnpdebugFTestSuite, UpnpPrintf_async_successful) {
+    ::UpnpSetLogAsync(1);
+    ::UpnpSetLogLevel(UPNP_ALL);
+    ASSERT_EQ(::UpnpInitLog(), UPNP_E_SUCCESS);
+
+    CaptureStdOutErr captureObj(STDERR_FILENO);
+    captureObj.start();
+
+    // Test Unit
+    ::UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__, "Async Unit Test %d.\n",
+                 1);
+    std::thread thr([] {
+        ::UpnpPrintf(UPNP_INFO, GENA, __FILE__, __LINE__,
+                     "Async Unit Test %d.\n", 2);
+    });
+    thr.join();
+
+    // Closing the log writes all pending messages.
+    ::UpnpCloseLog();
+    ::UpnpSetLogAsync(0);
+
+    std::string output = captureObj.str();
+    EXPECT_THAT(output, MatchesStdRegex("[\\s\\S]*UPNP-API_-2: Thread:0x.+ "
+                                        "\\[.+\\]: Async Unit Test 1\\.\n"
+                                        "[\\s\\S]*"));
+    EXPECT_THAT(output, MatchesStdRegex("[\\s\\S]*UPNP-GENA-2: Thread:0x.+ "
+                                        "\\[.+\\]: Async Unit Test 2\\.\n"
+                                        "[\\s\\S]*"));
+}
+
+TEST_F(UpnpdebugFTestSuite, UpnpPrintf_async_drops_if_buffer_full) {
+    ::UpnpSetLogAsync(1);
+    ::UpnpSetLogLevel(UPNP_ALL);
+    ASSERT_EQ(::UpnpInitLog(), UPNP_E_SUCCESS);
+
+    CaptureStdOutErr captureObj(STDERR_FILENO);
+    captureObj.start();
+
+    // The first message creates the ring buffer of this thread.
+    ::UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__, "Create ring.\n");
+    unsigned long dropped_before = ::UpnpGetLogDropCount();
+
+    // Block the writer thread so that the ring buffer fills up.
+    pthread_mutex_lock(&log_ring_mutex);
+    for (size_t i{0}; i < LOG_RING_SIZE + 10; i++)
+        ::UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__, "Message %zu.\n", i);
+    EXPECT_GE(::UpnpGetLogDropCount() - dropped_before, 10ul);
+    pthread_mutex_unlock(&log_ring_mutex);
+
+    ::UpnpCloseLog();
+    ::UpnpSetLogAsync(0);
+
+    EXPECT_THAT(captureObj.str(),
+                MatchesStdRegex("[\\s\\S]*UPnPsdk: \\d+ log messages dropped, "
+                                "buffer full\\.\n[\\s\\S]*"));
+}
+
+TEST_F(UpnpdebugFTestSuite, UpnpPrintf_after_writer_stopped_writes_sync) {
+    ::UpnpSetLogAsync(1);
+    ::UpnpSetLogLevel(UPNP_ALL);
+    ASSERT_EQ(::UpnpInitLog(), UPNP_E_SUCCESS);
+    // The first message creates the ring buffer of this thread.
+    ::UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__, "Create ring.\n");
+
+    CaptureStdOutErr captureObj(STDERR_FILENO);
+    captureObj.start();
+
+    // A message after the final drain of the writer thread must not be left
+    // in the ring buffer.
+    UpnpLogWriterStop();
+    ::UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__, "After stop %d.\n", 1);
+    EXPECT_EQ(log_ring_owner.ring->head.load(),
+              log_ring_owner.ring->tail.load());
+    EXPECT_EQ(log_pushers.load(), 0);
+
+    ::UpnpCloseLog();
+    ::UpnpSetLogAsync(0);
+
+    EXPECT_THAT(captureObj.str(),
+                MatchesStdRegex("[\\s\\S]*UPNP-API_-2: Thread:0x.+ "
+                                "\\[.+\\]: After stop 1\\.\n"));
+}
+#endif
+
 TEST_F(UpnpdebugFTestSuite, UpnpPrintf_without_init) {
     // Process unit
     ::UpnpPrintf(UPNP_INFO, API, __FILE__, __LINE__,
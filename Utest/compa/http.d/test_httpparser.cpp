@@ -1,5 +1,5 @@
 // Copyright (C) 2021+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
-// Redistribution only with this Copyright remark. Last modified: 2026-03-17
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
 
 #ifdef UPnPsdk_WITH_NATIVE_PUPNP
 #include <Pupnp/upnp/src/genlib/net/http/httpparser.cpp>
@@ -310,6 +310,39 @@ TEST(HttpparserTestSuite, parser_response_init_a_nullptr) {
     }
 }
 
+#ifndef UPnPsdk_WITH_NATIVE_PUPNP
+TEST(HttpparserTestSuite, receive_into_tail_of_parser_buffer) {
+    http_parser_t parser;
+    ::parser_response_init(&parser, HTTPMETHOD_GET);
+
+    const char msg1[]{"HTTP/1.1 200 OK\r\nCONTENT-LENGTH: 5\r\n"};
+    const char msg2[]{"\r\nhello"};
+
+    size_t len{};
+    char* buf = ::parser_get_tail(&parser, sizeof(msg1), &len);
+    ASSERT_NE(buf, nullptr);
+    EXPECT_GE(len, sizeof(msg1));
+    memcpy(buf, msg1, sizeof(msg1) - 1);
+    EXPECT_EQ(::parser_append_tail(&parser, sizeof(msg1) - 1),
+              PARSE_INCOMPLETE);
+
+    // The tail follows the received data, the buffer grows geometric.
+    const size_t capacity{parser.msg.msg.capacity};
+    buf = ::parser_get_tail(&parser, capacity, &len);
+    ASSERT_NE(buf, nullptr);
+    EXPECT_EQ(buf, parser.msg.msg.buf + sizeof(msg1) - 1);
+    EXPECT_GE(parser.msg.msg.capacity, 2 * capacity);
+    memcpy(buf, msg2, sizeof(msg2) - 1);
+    EXPECT_EQ(::parser_append_tail(&parser, sizeof(msg2) - 1), PARSE_SUCCESS);
+
+    EXPECT_EQ(parser.msg.status_code, 200);
+    EXPECT_EQ(parser.msg.entity.length, 5u);
+    EXPECT_EQ(std::string(parser.msg.entity.buf, parser.msg.entity.length),
+              "hello");
+    ::httpmsg_destroy(&parser.msg);
+}
+#endif
+
 } // namespace utest
 
 
@@ -0,0 +1,126 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Include source code for testing. So we have also direct access to static
+// functions.
+#include <Compa/src/ixml/ixml.cpp>
+
+#include <utest/utest.hpp>
+
+#include <string>
+
+
+namespace utest {
+
+class IxmlMembufFTestSuite : public ::testing::Test {
+  protected:
+    ixml_membuf m_buf;
+
+    IxmlMembufFTestSuite() { ixml_membuf_init(&m_buf); }
+    ~IxmlMembufFTestSuite() override { ixml_membuf_destroy(&m_buf); }
+
+    std::string str() const { return std::string(m_buf.buf, m_buf.length); }
+};
+
+
+TEST_F(IxmlMembufFTestSuite, escape_each_special_character) {
+    const struct {
+        const char* value;
+        const char* escaped;
+    } chars[]{{"<", "&lt;"},
+              {">", "&gt;"},
+              {"&", "&amp;"},
+              {"'", "&apos;"},
+              {"\"", "&quot;"}};
+
+    for (const auto& chr : chars) {
+        ixml_membuf_destroy(&m_buf);
+        // Test Unit
+        copy_with_escape(&m_buf, chr.value);
+        EXPECT_EQ(this->str(), chr.escaped) << "value: " << chr.value;
+    }
+}
+
+TEST_F(IxmlMembufFTestSuite, escape_between_text) {
+    // Test Unit
+    copy_with_escape(&m_buf, "a<b>c&d'e\"f");
+
+    EXPECT_EQ(this->str(), "a&lt;b&gt;c&amp;d&apos;e&quot;f");
+    EXPECT_EQ(m_buf.buf[m_buf.length], '\0');
+}
+
+TEST_F(IxmlMembufFTestSuite, escape_appends_to_buffer) {
+    ASSERT_EQ(ixml_membuf_append_str(&m_buf, "<a>"), 0);
+
+    // Test Unit
+    copy_with_escape(&m_buf, "x&y");
+    copy_with_escape(&m_buf, nullptr);
+    copy_with_escape(&m_buf, "");
+
+    EXPECT_EQ(this->str(), "<a>x&amp;y");
+}
+
+TEST_F(IxmlMembufFTestSuite, escape_value_longer_than_initial_buffer) {
+    std::string value;
+    std::string escaped;
+    for (int i{0}; i < 200; i++) {
+        value += "text <&> ";
+        escaped += "text &lt;&amp;&gt; ";
+    }
+    ASSERT_GT(value.size(), MEMBUF_DEF_SIZE_INC);
+
+    // Test Unit
+    copy_with_escape(&m_buf, value.c_str());
+
+    EXPECT_EQ(this->str(), escaped);
+    EXPECT_GE(m_buf.capacity, m_buf.length);
+    EXPECT_EQ(m_buf.buf[m_buf.length], '\0');
+}
+
+TEST_F(IxmlMembufFTestSuite, grow_geometrically_on_append) {
+    int reallocs{0};
+    size_t capacity{m_buf.capacity};
+
+    for (int i{0}; i < 10000; i++) {
+        ASSERT_EQ(ixml_membuf_append(&m_buf, "x"), 0);
+        if (m_buf.capacity != capacity) {
+            reallocs++;
+            capacity = m_buf.capacity;
+        }
+    }
+
+    EXPECT_EQ(m_buf.length, 10000u);
+    EXPECT_EQ(this->str(), std::string(10000, 'x'));
+    EXPECT_EQ(m_buf.buf[m_buf.length], '\0');
+    // Growing by MEMBUF_DEF_SIZE_INC would need 500 reallocs.
+    EXPECT_LT(reallocs, 20);
+}
+
+TEST(IxmlPrintTestSuite, print_escaped_text_node) {
+    IXML_Document* doc{};
+    ASSERT_EQ(ixmlParseBufferEx("<root>x</root>", &doc), IXML_SUCCESS);
+    IXML_Node* text = ixmlNode_getFirstChild(
+        ixmlNode_getFirstChild(reinterpret_cast<IXML_Node*>(doc)));
+    ASSERT_NE(text, nullptr);
+    ASSERT_EQ(ixmlNode_setNodeValue(text, "1 < 2 & \"3\" > '0'"),
+              IXML_SUCCESS);
+
+    // Test Unit
+    DOMString str = ixmlPrintNode(reinterpret_cast<IXML_Node*>(doc));
+
+    ASSERT_NE(str, nullptr);
+    EXPECT_EQ(std::string(str),
+              "<root>1 &lt; 2 &amp; &quot;3&quot; &gt; &apos;0&apos;"
+              "</root>\r\n");
+    ixmlFreeDOMString(str);
+    ixmlDocument_free(doc);
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
@@ -0,0 +1,131 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-18
+
+#include <ixml/ixml.hpp>
+
+#include <utest/utest.hpp>
+
+#include <string>
+
+
+namespace utest {
+
+// Records all SAX events into one string.
+int start_element(void* a_data, const char* a_name, const char* a_local) {
+    *static_cast<std::string*>(a_data) +=
+        std::string("<") + a_name + "|" + a_local + ">";
+    return IXML_SUCCESS;
+}
+
+int attribute(void* a_data, const char* a_name, const char* a_value) {
+    *static_cast<std::string*>(a_data) +=
+        std::string("@") + a_name + "=" + a_value + ";";
+    return IXML_SUCCESS;
+}
+
+int end_element(void* a_data, const char* a_name, const char* a_local) {
+    *static_cast<std::string*>(a_data) +=
+        std::string("</") + a_name + "|" + a_local + ">";
+    return IXML_SUCCESS;
+}
+
+int characters(void* a_data, const char* a_text) {
+    *static_cast<std::string*>(a_data) += std::string("[") + a_text + "]";
+    return IXML_SUCCESS;
+}
+
+const IXML_SaxHandler sax_recorder{start_element, attribute, end_element,
+                                   characters};
+
+
+// Testsuite
+// =========
+TEST(IxmlSaxTestSuite, parse_soap_response) {
+    const char soap_msg[]{
+        "<?xml version=\"1.0\"?>\n"
+        "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\">"
+        "<s:Body>"
+        "<u:GetVolumeResponse xmlns:u=\"urn:schemas-upnp-org:service:"
+        "RenderingControl:1\">"
+        "<CurrentVolume>42</CurrentVolume>"
+        "<Name>a&amp;b</Name>"
+        "<Empty/>"
+        "</u:GetVolumeResponse>"
+        "</s:Body>"
+        "</s:Envelope>"};
+    std::string events;
+
+    EXPECT_EQ(ixmlParseBufferSax(soap_msg, &sax_recorder, &events),
+              IXML_SUCCESS);
+    EXPECT_EQ(events, "<s:Envelope|Envelope>"
+                      "@xmlns:s=http://schemas.xmlsoap.org/soap/envelope/;"
+                      "<s:Body|Body>"
+                      "<u:GetVolumeResponse|GetVolumeResponse>"
+                      "@xmlns:u=urn:schemas-upnp-org:service:"
+                      "RenderingControl:1;"
+                      "<CurrentVolume|CurrentVolume>[42]"
+                      "</CurrentVolume|CurrentVolume>"
+                      "<Name|Name>[a&b]</Name|Name>"
+                      "<Empty|Empty></Empty|Empty>"
+                      "</u:GetVolumeResponse|GetVolumeResponse>"
+                      "</s:Body|Body>"
+                      "</s:Envelope|Envelope>");
+}
+
+TEST(IxmlSaxTestSuite, parse_cdata_and_null_callbacks) {
+    const char xml_msg[]{"<root><![CDATA[<raw>]]></root>"};
+    const IXML_SaxHandler text_only{nullptr, nullptr, nullptr, characters};
+    std::string events;
+
+    EXPECT_EQ(ixmlParseBufferSax(xml_msg, &text_only, &events), IXML_SUCCESS);
+    EXPECT_EQ(events, "[<raw>]");
+}
+
+TEST(IxmlSaxTestSuite, stop_parsing_from_callback) {
+    const char xml_msg[]{"<a><b>1</b><c>2</c></a>"};
+    const IXML_SaxHandler stop_at_text{
+        nullptr, nullptr, nullptr,
+        [](void* a_data, const char* a_text) -> int {
+            *static_cast<std::string*>(a_data) = a_text;
+            return IXML_FILE_DONE;
+        }};
+    std::string first_text;
+
+    EXPECT_EQ(ixmlParseBufferSax(xml_msg, &stop_at_text, &first_text),
+              IXML_FILE_DONE);
+    EXPECT_EQ(first_text, "1");
+}
+
+TEST(IxmlSaxTestSuite, syntax_errors) {
+    std::string events;
+
+    EXPECT_EQ(ixmlParseBufferSax("<a><b></a></b>", &sax_recorder, &events),
+              IXML_SYNTAX_ERR);
+    events.clear();
+    EXPECT_EQ(ixmlParseBufferSax("<a><b></b>", &sax_recorder, &events),
+              IXML_SYNTAX_ERR);
+    events.clear();
+    EXPECT_EQ(ixmlParseBufferSax("<a/><b/>", &sax_recorder, &events),
+              IXML_SYNTAX_ERR);
+}
+
+TEST(IxmlSaxTestSuite, invalid_arguments) {
+    std::string events;
+
+    EXPECT_EQ(ixmlParseBufferSax(nullptr, &sax_recorder, &events),
+              IXML_INVALID_PARAMETER);
+    EXPECT_EQ(ixmlParseBufferSax("", &sax_recorder, &events),
+              IXML_INVALID_PARAMETER);
+    EXPECT_EQ(ixmlParseBufferSax("<a/>", nullptr, &events),
+              IXML_INVALID_PARAMETER);
+    EXPECT_TRUE(events.empty());
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
@@ -0,0 +1,138 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+#include <ObjectPool.hpp>
+
+#include <utest/utest.hpp>
+#include <umock/stdlib_mock.hpp>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+namespace utest {
+
+using ::testing::_;
+using ::testing::Return;
+
+
+class ObjectPoolFTestSuite : public ::testing::Test {
+  protected:
+    ~ObjectPoolFTestSuite() override { ::ObjectPoolTrim(); }
+};
+
+
+TEST_F(ObjectPoolFTestSuite, reuse_freed_object_in_same_thread) {
+    void* obj1 = ::ObjectPoolAlloc(40);
+    ASSERT_NE(obj1, nullptr);
+    ::ObjectPoolFree(obj1, 40);
+
+    // Objects of the same size class are interchangeable.
+    void* obj2 = ::ObjectPoolAlloc(64);
+    EXPECT_EQ(obj2, obj1);
+    ::ObjectPoolFree(obj2, 64);
+
+    // Another size class does not get the object.
+    void* obj3 = ::ObjectPoolAlloc(65);
+    ASSERT_NE(obj3, nullptr);
+    EXPECT_NE(obj3, obj1);
+    ::ObjectPoolFree(obj3, 65);
+
+    ::ObjectPoolFree(nullptr, 40);
+}
+
+TEST_F(ObjectPoolFTestSuite, large_objects_bypass_the_pool) {
+    char obj{};
+
+    umock::StdlibMock stdlibObj;
+    umock::Stdlib stdlib_injectObj(&stdlibObj);
+    EXPECT_CALL(stdlibObj, malloc(POOL_MAX_OBJECT_SIZE + 1))
+        .WillOnce(Return(&obj));
+    EXPECT_CALL(stdlibObj, free(&obj)).Times(1);
+
+    EXPECT_EQ(::ObjectPoolAlloc(POOL_MAX_OBJECT_SIZE + 1), &obj);
+    ::ObjectPoolFree(&obj, POOL_MAX_OBJECT_SIZE + 1);
+}
+
+TEST_F(ObjectPoolFTestSuite, allocate_from_operating_system_if_empty) {
+    char obj[128];
+
+    umock::StdlibMock stdlibObj;
+    umock::Stdlib stdlib_injectObj(&stdlibObj);
+    // The object is allocated with the size of its size class.
+    EXPECT_CALL(stdlibObj, malloc(128)).WillOnce(Return(&obj));
+    EXPECT_CALL(stdlibObj, free(_)).Times(0);
+
+    EXPECT_EQ(::ObjectPoolAlloc(100), &obj);
+    // The object is cached, not freed.
+    ::ObjectPoolFree(&obj, 100);
+    EXPECT_EQ(::ObjectPoolAlloc(100), &obj);
+}
+
+TEST_F(ObjectPoolFTestSuite, objects_flow_back_from_other_thread) {
+    constexpr int objects{4 * POOL_MAGAZINE_SIZE};
+
+    std::vector<void*> allocated;
+    for (int i{0}; i < objects; i++) {
+        void* obj = ::ObjectPoolAlloc(sizeof(void*) * 20);
+        ASSERT_NE(obj, nullptr);
+        allocated.push_back(obj);
+    }
+
+    // Another thread frees the objects. Full magazines go to the depot.
+    std::thread thread([&allocated] {
+        for (void* obj : allocated)
+            ::ObjectPoolFree(obj, sizeof(void*) * 20);
+    });
+    thread.join();
+
+    // All objects are reused without allocating new ones.
+    std::set<void*> known(allocated.begin(), allocated.end());
+    std::vector<void*> reused;
+    for (int i{0}; i < objects; i++) {
+        void* obj = ::ObjectPoolAlloc(sizeof(void*) * 20);
+        EXPECT_TRUE(known.contains(obj));
+        reused.push_back(obj);
+    }
+    for (void* obj : reused)
+        ::ObjectPoolFree(obj, sizeof(void*) * 20);
+}
+
+TEST_F(ObjectPoolFTestSuite, alloc_and_free_from_several_threads) {
+    constexpr int threads{4};
+    constexpr int loops{10000};
+
+    std::atomic<int> errors{0};
+    std::vector<std::thread> pool;
+    for (int i{0}; i < threads; i++) {
+        pool.emplace_back([&errors] {
+            int* objs[POOL_MAGAZINE_SIZE * 3];
+            for (int j{0}; j < loops; j++) {
+                for (int*& obj : objs) {
+                    obj = static_cast<int*>(::ObjectPoolAlloc(sizeof(int)));
+                    *obj = j;
+                }
+                for (int* obj : objs) {
+                    if (*obj != j)
+                        errors++;
+                    ::ObjectPoolFree(obj, sizeof(int));
+                }
+            }
+        });
+    }
+    for (std::thread& thread : pool)
+        thread.join();
+
+    EXPECT_EQ(errors, 0);
+}
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}
@@ -0,0 +1,169 @@
+// Copyright (C) 2026+ GPL 3 and higher by Ingo Höft, <Ingo@Hoeft-online.de>
+// Redistribution only with this Copyright remark. Last modified: 2026-10-19
+
+// Tests for the ThreadPool extensions that are only available with the
+// compatible library. The general ThreadPool tests are in
+// test_ThreadPool.cpp. As noted there, ThreadPoolShutdown() always has to be
+// executed after using ThreadPoolInit().
+
+#include <ThreadPool.hpp>
+
+#include <utest/utest.hpp>
+
+#include <chrono>
+#include <thread>
+
+
+namespace utest {
+
+// This start routine for a threadpool job runs about two milliseconds.
+void sleep_function([[maybe_unused]] void* arg) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+TEST(ThreadPoolNormalTestSuite, get_waiting_and_running_times_of_jobs) {
+    ThreadPool tp{};         // Structure for a threadpool
+    ThreadPoolJob TPJob{};   // Structure for a threadpool job
+    ThreadPoolStats stats{}; // Structure for the threadpool status
+
+    ASSERT_EQ(ThreadPoolInit(&tp, nullptr), 0);
+    EXPECT_EQ(TPJobInit(&TPJob, &sleep_function, nullptr), 0);
+    EXPECT_EQ(TPJobSetPriority(&TPJob, HIGH_PRIORITY), 0);
+    for (int i{0}; i < 3; i++)
+        EXPECT_EQ(ThreadPoolAdd(&tp, &TPJob, nullptr), 0);
+
+    // The workers account a job after it has finished.
+    for (int i{0}; i < 1000; i++) {
+        EXPECT_EQ(ThreadPoolGetStats(&tp, &stats), 0);
+        if (stats.runTime[HIGH_PRIORITY].jobs == 3)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(stats.totalJobsHQ, 3);
+    EXPECT_EQ(stats.totalJobsMQ, 0);
+    EXPECT_EQ(stats.waitTime[HIGH_PRIORITY].jobs, 3u);
+    EXPECT_EQ(stats.runTime[HIGH_PRIORITY].jobs, 3u);
+    EXPECT_GE(stats.runTime[HIGH_PRIORITY].sum_ns, 3u * 2'000'000u);
+    EXPECT_DOUBLE_EQ(stats.totalTimeHQ,
+                     (double)stats.waitTime[HIGH_PRIORITY].sum_ns / 1e6);
+    unsigned long long jobs{};
+    for (unsigned long long num : stats.runTime[HIGH_PRIORITY].bucket)
+        jobs += num;
+    EXPECT_EQ(jobs, 3u);
+    // Running 2 ms is above the 1024 us bucket.
+    EXPECT_EQ(stats.runTime[HIGH_PRIORITY].bucket[10], 0u);
+
+    // The times of exited workers are kept.
+    EXPECT_EQ(ThreadPoolShutdown(&tp), 0);
+    EXPECT_EQ(ThreadPoolGetStats(&tp, &stats), 0);
+    EXPECT_EQ(stats.waitTime[HIGH_PRIORITY].jobs, 3u);
+    EXPECT_EQ(stats.runTime[HIGH_PRIORITY].jobs, 3u);
+    EXPECT_GT(stats.totalWorkTime, 0.0);
+}
+
+// This start routine for a threadpool job runs about 50 milliseconds.
+void block_function([[maybe_unused]] void* arg) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+TEST(ThreadPoolNormalTestSuite, add_worker_adaptive_to_waiting_time) {
+    ThreadPool tp{};         // Structure for a threadpool
+    ThreadPoolAttr TPAttr{}; // Structure for a threadpool attribute
+    ThreadPoolJob TPJob{};   // Structure for a threadpool job
+    ThreadPoolStats stats{}; // Structure for the threadpool status
+
+    EXPECT_EQ(TPAttrInit(&TPAttr), 0);
+    EXPECT_EQ(TPAttr.targetWaitTime, DEFAULT_TARGET_WAIT_TIME);
+    EXPECT_EQ(TPAttrSetMinThreads(&TPAttr, 1), 0);
+    EXPECT_EQ(TPAttrSetMaxThreads(&TPAttr, 4), 0);
+    EXPECT_EQ(TPAttrSetJobsPerThread(&TPAttr, 100), 0);
+    EXPECT_EQ(TPAttrSetTargetWaitTime(&TPAttr, 5), 0);
+    ASSERT_EQ(ThreadPoolInit(&tp, &TPAttr), 0);
+    EXPECT_EQ(TPJobInit(&TPJob, &block_function, nullptr), 0);
+
+    // Let the only worker block on a job.
+    EXPECT_EQ(ThreadPoolAdd(&tp, &TPJob, nullptr), 0);
+    for (int i{0}; i < 1000 && stats.workerThreads == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        EXPECT_EQ(ThreadPoolGetStats(&tp, &stats), 0);
+    }
+    ASSERT_EQ(stats.workerThreads, 1);
+
+    // A busy worker alone does not add a worker.
+    EXPECT_EQ(ThreadPoolAdd(&tp, &TPJob, nullptr), 0);
+    EXPECT_EQ(ThreadPoolGetStats(&tp, &stats), 0);
+    EXPECT_EQ(stats.totalThreads, 1);
+
+    // But a job waiting longer than the target time. The next added job
+    // finds the waiting one.
+    for (int i{0}; i < 1000 && stats.totalThreads < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        EXPECT_EQ(ThreadPoolAdd(&tp, &TPJob, nullptr), 0);
+        EXPECT_EQ(ThreadPoolGetStats(&tp, &stats), 0);
+    }
+    EXPECT_EQ(stats.totalThreads, 2);
+
+    EXPECT_EQ(ThreadPoolShutdown(&tp), 0);
+}
+
+TEST(ThreadPoolErrorCondTestSuite, set_target_wait_time_to_attribute) {
+    EXPECT_EQ(TPAttrSetTargetWaitTime(nullptr, 0), EINVAL);
+}
+
+#ifdef TP_HAVE_AFFINITY
+// This start routine for a threadpool job gets the CPUs it may run on.
+void get_affinity_function(void* arg) {
+    pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                           static_cast<cpu_set_t*>(arg));
+}
+
+TEST(ThreadPoolNormalTestSuite, pin_workers_to_cpus) {
+    ThreadPool tp{};         // Structure for a threadpool
+    ThreadPoolAttr TPAttr{}; // Structure for a threadpool attribute
+    ThreadPoolJob TPJob{};   // Structure for a threadpool job
+    cpu_set_t cpuSet;
+    cpu_set_t jobCpuSet;
+
+    EXPECT_EQ(TPAttrInit(&TPAttr), 0);
+    EXPECT_EQ(CPU_COUNT(&TPAttr.cpuSet), 0);
+    CPU_ZERO(&cpuSet);
+    CPU_SET(0, &cpuSet);
+    EXPECT_EQ(TPAttrSetCpuSet(&TPAttr, &cpuSet), 0);
+    ASSERT_EQ(ThreadPoolInit(&tp, &TPAttr), 0);
+
+    CPU_ZERO(&jobCpuSet);
+    EXPECT_EQ(TPJobInit(&TPJob, &get_affinity_function, &jobCpuSet), 0);
+    EXPECT_EQ(TPJobSetPriority(&TPJob, HIGH_PRIORITY), 0);
+    EXPECT_EQ(ThreadPoolAdd(&tp, &TPJob, nullptr), 0);
+    // Shutdown does not run queued jobs so wait for the job to finish.
+    ThreadPoolStats stats;
+    for (int i{0}; i < 1000; i++) {
+        EXPECT_EQ(ThreadPoolGetStats(&tp, &stats), 0);
+        if (stats.runTime[HIGH_PRIORITY].jobs == 1)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(ThreadPoolShutdown(&tp), 0);
+
+    EXPECT_EQ(CPU_COUNT(&jobCpuSet), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &jobCpuSet));
+
+    EXPECT_EQ(TPAttrSetCpuSet(&TPAttr, nullptr), 0);
+    EXPECT_EQ(CPU_COUNT(&TPAttr.cpuSet), 0);
+}
+
+TEST(ThreadPoolErrorCondTestSuite, set_cpu_set_to_attribute) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    EXPECT_EQ(TPAttrSetCpuSet(nullptr, &cpuSet), EINVAL);
+}
+#endif
+
+} // namespace utest
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+#include <utest/utest_main.inc>
+    return gtest_return_code; // managed in gtest_main.inc
+}